@@ -293,6 +293,8 @@ void BKE_animsys_eval_driver(struct Depsgraph *depsgraph,
                              struct FCurve *fcu_orig);
 
 void BKE_animsys_update_driver_array(struct ID *id);
+void BKE_animsys_free_binding_cache(struct AnimData *adt);
+void BKE_animsys_action_tag_copied(struct bAction *act);
 
 /* ************************************* */
 
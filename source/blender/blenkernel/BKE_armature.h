@@ -483,6 +483,9 @@ void BKE_armature_deform_coords_with_editmesh(const struct Object *ob_arm,
                                               const char *defgrp_name,
                                               struct BMEditMesh *em_target);
 
+/* Free the vertex group weights cached for armature deformation in the mesh runtime data. */
+void BKE_armature_deform_weights_discard(struct Mesh *mesh);
+
 /** \} */
 
 #ifdef __cplusplus
@@ -74,6 +74,12 @@ typedef enum eCDAllocType {
   CD_REFERENCE = 3,
   /** Do a full copy of all layers, only allowed if source has same number of elements. */
   CD_DUPLICATE = 4,
+  /**
+   * Like #CD_DUPLICATE, but share the data of the source layers until either layer is made
+   * writable with #CustomData_duplicate_referenced_layer, both layers are referenced then.
+   * Only layers prepared with #CustomData_share_prepare are shared, others are duplicated.
+   */
+  CD_SHARE = 5,
 } eCDAllocType;
 
 #define CD_TYPE_AS_MASK(_type) (CustomDataMask)((CustomDataMask)1 << (CustomDataMask)(_type))
@@ -137,6 +143,10 @@ void CustomData_copy(const struct CustomData *source,
                      eCDAllocType alloctype,
                      int totelem);
 
+/* Allow copies with #CD_SHARE to share the data of the layers in mask. Modifies the layers,
+ * so it must be called by the owner of the data before copies are made from other threads. */
+void CustomData_share_prepare(struct CustomData *data, CustomDataMask mask, int totelem);
+
 /* BMESH_TODO, not really a public function but readfile.c needs it */
 void CustomData_update_typemap(struct CustomData *data);
 
@@ -327,6 +327,16 @@ float calculate_fcurve(struct PathResolvedRNA *anim_rna,
                        struct FCurve *fcu,
                        const struct AnimationEvalContext *anim_eval_context);
 
+/* Evaluation of many F-Curves at once, faster than evaluating them one by one when the same
+ * curves are evaluated on consecutive frames. */
+struct FCurveBatchEval;
+struct FCurveBatchEval *BKE_fcurve_batch_eval_create(struct FCurve **fcurves,
+                                                     const int fcurves_num);
+void BKE_fcurve_batch_eval_destroy(struct FCurveBatchEval *batch);
+void BKE_fcurve_batch_evaluate(struct FCurveBatchEval *batch,
+                               const float evaltime,
+                               float *r_values);
+
 /* ************* F-Curve Samples API ******************** */
 
 /* -------- Defines -------- */
@@ -157,6 +157,9 @@ enum {
   G_DEBUG_XR_TIME = (1 << 20),               /* XR/OpenXR timing messages */
 
   G_DEBUG_GHOST = (1 << 21), /* Debug GHOST module. */
+
+  G_DEBUG_DEPSGRAPH_VERIFY = (1 << 22), /* Compare partial depsgraph relations updates against
+                                         * a full rebuild. */
 };
 
 #define G_DEBUG_ALL \
@@ -184,6 +184,9 @@ void BKE_image_pool_free(struct ImagePool *pool);
 struct ImBuf *BKE_image_pool_acquire_ibuf(struct Image *ima,
                                           struct ImageUser *iuser,
                                           struct ImagePool *pool);
+struct ImBuf *BKE_image_pool_acquire_ibuf_tilecache(struct Image *ima,
+                                                    struct ImageUser *iuser,
+                                                    struct ImagePool *pool);
 void BKE_image_pool_release_ibuf(struct Image *ima, struct ImBuf *ibuf, struct ImagePool *pool);
 
 /* set an alpha mode based on file extension */
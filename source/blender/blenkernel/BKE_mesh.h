@@ -125,6 +125,9 @@ void BKE_mesh_eval_delete(struct Mesh *mesh_eval);
  * optional referencing original arrays to reduce memory. */
 struct Mesh *BKE_mesh_copy_for_eval(struct Mesh *source, bool reference);
 
+/* Let copies made with #LIB_ID_COPY_CD_SHARE share the geometry arrays of the mesh. */
+void BKE_mesh_share_prepare(struct Mesh *me);
+
 /* These functions construct a new Mesh,
  * contrary to BKE_mesh_to_curve_nurblist which modifies ob itself. */
 struct Mesh *BKE_mesh_new_nomain_from_curve(const struct Object *ob);
@@ -43,6 +43,7 @@
 #include "BLI_math.h"
 #include "BLI_task.h"
 #include "BLI_task.hh"
+#include "BLI_trace.h"
 #include "BLI_utildefines.h"
 #include "BLI_vector.hh"
 
@@ -951,7 +952,10 @@ static Mesh *modifier_modify_mesh_and_geometry_set(ModifierData *md,
     mesh_component.replace(input_mesh, GeometryOwnershipType::Editable);
 
     /* Let the modifier change the geometry set. */
-    mti->modifyGeometrySet(md, &mectx, &geometry_set);
+    {
+      blender::TraceScope trace_scope("modifier", md->name);
+      mti->modifyGeometrySet(md, &mectx, &geometry_set);
+    }
 
     /* Release the mesh from the geometry set again. */
     if (geometry_set.has<MeshComponent>()) {
@@ -881,6 +881,156 @@ void animsys_evaluate_action(PointerRNA *ptr,
   animsys_evaluate_fcurves(ptr, &act->curves, anim_eval_context, flush_to_original);
 }
 
+/* ----------------------------------------- */
+
+/* Binding Cache
+ *
+ * Resolving the RNA path of every F-Curve on every frame is a big part of the evaluation time of
+ * actions with many channels (e.g. rigs with thousands of bones). Evaluated data-blocks keep the
+ * resolved paths of their active action, which stay valid until either the data-block or the
+ * action is copied again by the dependency graph, or its relations are rebuilt.
+ *
+ * The action can be copied again without its users being updated, for example when only the
+ * action is tagged after editing its keys. So every copy gets a new generation, which the caches
+ * of its users are compared against.
+ */
+
+typedef enum eAnimBindingType {
+  /* The path does not resolve, the F-Curve is skipped. */
+  ANIM_BINDING_INVALID = 0,
+  /* The path resolves to data owned by the animated ID itself. */
+  ANIM_BINDING_RESOLVED = 1,
+  /* The path goes through another ID, which can be copied independently from the animated one,
+   * so it is resolved on every evaluation. */
+  ANIM_BINDING_DYNAMIC = 2,
+} eAnimBindingType;
+
+typedef struct AnimBinding {
+  FCurve *fcu;
+  PathResolvedRNA rna;
+  /* eAnimBindingType. */
+  char type;
+} AnimBinding;
+
+typedef struct AnimBindingCache {
+  /* The action the paths were resolved for, and its #bAction.eval_generation at that time. */
+  bAction *action;
+  unsigned int action_generation;
+  /* One binding per F-Curve of the action, in the order of the F-Curves. */
+  AnimBinding *bindings;
+  int bindings_num;
+  /* Evaluates all F-Curves of the action, into one value per binding. */
+  struct FCurveBatchEval *batch;
+  float *values;
+} AnimBindingCache;
+
+void BKE_animsys_free_binding_cache(AnimData *adt)
+{
+  AnimBindingCache *cache = adt->binding_cache;
+  if (cache == NULL) {
+    return;
+  }
+  MEM_SAFE_FREE(cache->bindings);
+  MEM_SAFE_FREE(cache->values);
+  if (cache->batch != NULL) {
+    BKE_fcurve_batch_eval_destroy(cache->batch);
+  }
+  MEM_freeN(cache);
+  adt->binding_cache = NULL;
+}
+
+/* Generation of the last copy of any action, generations of evaluated actions start at 1. */
+static unsigned int action_eval_generation = 0;
+
+/**
+ * Called by the dependency graph every time an evaluated action is copied from its original,
+ * so binding caches which refer to its previous F-Curves are rebuilt.
+ */
+void BKE_animsys_action_tag_copied(bAction *act)
+{
+  act->eval_generation = atomic_add_and_fetch_u(&action_eval_generation, 1);
+}
+
+static bool animsys_binding_cache_is_valid(const AnimBindingCache *cache, const bAction *act)
+{
+  /* F-Curves of the action were re-allocated if its evaluated copy was updated. */
+  return cache != NULL && cache->action == act && cache->action_generation == act->eval_generation;
+}
+
+static AnimBindingCache *animsys_binding_cache_ensure(PointerRNA *ptr, AnimData *adt)
+{
+  bAction *act = adt->action;
+  if (animsys_binding_cache_is_valid(adt->binding_cache, act)) {
+    return adt->binding_cache;
+  }
+  BKE_animsys_free_binding_cache(adt);
+
+  AnimBindingCache *cache = MEM_callocN(sizeof(AnimBindingCache), "AnimBindingCache");
+  cache->action = act;
+  cache->action_generation = act->eval_generation;
+  cache->bindings_num = BLI_listbase_count(&act->curves);
+  cache->bindings = MEM_malloc_arrayN(cache->bindings_num, sizeof(AnimBinding), __func__);
+  cache->values = MEM_malloc_arrayN(cache->bindings_num, sizeof(float), __func__);
+  FCurve **fcurves = MEM_malloc_arrayN(cache->bindings_num, sizeof(FCurve *), __func__);
+
+  int index = 0;
+  LISTBASE_FOREACH (FCurve *, fcu, &act->curves) {
+    AnimBinding *binding = &cache->bindings[index];
+    fcurves[index] = fcu;
+    binding->fcu = fcu;
+    if (!BKE_animsys_rna_path_resolve(ptr, fcu->rna_path, fcu->array_index, &binding->rna)) {
+      binding->type = ANIM_BINDING_INVALID;
+    }
+    else if (binding->rna.ptr.owner_id != ptr->owner_id) {
+      binding->type = ANIM_BINDING_DYNAMIC;
+    }
+    else {
+      binding->type = ANIM_BINDING_RESOLVED;
+    }
+    index++;
+  }
+
+  cache->batch = BKE_fcurve_batch_eval_create(fcurves, cache->bindings_num);
+  MEM_freeN(fcurves);
+
+  adt->binding_cache = cache;
+  return cache;
+}
+
+/* Same as #animsys_evaluate_action for the active action of an evaluated ID, using the resolved
+ * paths of its binding cache and evaluating all F-Curves as a batch. */
+static void animsys_evaluate_action_bindings(PointerRNA *ptr,
+                                             AnimData *adt,
+                                             const AnimationEvalContext *anim_eval_context,
+                                             const bool flush_to_original)
+{
+  action_idcode_patch_check(ptr->owner_id, adt->action);
+
+  const AnimBindingCache *cache = animsys_binding_cache_ensure(ptr, adt);
+  BKE_fcurve_batch_evaluate(cache->batch, anim_eval_context->eval_time, cache->values);
+
+  for (int i = 0; i < cache->bindings_num; i++) {
+    const AnimBinding *binding = &cache->bindings[i];
+    FCurve *fcu = binding->fcu;
+    if (binding->type == ANIM_BINDING_INVALID || !is_fcurve_evaluatable(fcu)) {
+      continue;
+    }
+
+    PathResolvedRNA anim_rna = binding->rna;
+    if (binding->type == ANIM_BINDING_DYNAMIC &&
+        !BKE_animsys_rna_path_resolve(ptr, fcu->rna_path, fcu->array_index, &anim_rna)) {
+      continue;
+    }
+
+    const float curval = cache->values[i];
+    fcu->curval = curval; /* Debug display only, same as #calculate_fcurve. */
+    BKE_animsys_write_to_rna_path(&anim_rna, curval);
+    if (flush_to_original) {
+      animsys_write_orig_anim_rna(ptr, fcu->rna_path, fcu->array_index, curval);
+    }
+  }
+}
+
 /* Evaluate Action and blend it into the current values of the animated properties. */
 void animsys_blend_in_action(PointerRNA *ptr,
                              bAction *act,
@@ -3307,7 +3457,13 @@ void BKE_animsys_evaluate_animdata(ID *id,
     }
     /* evaluate Active Action only */
     else if (adt->action) {
-      animsys_evaluate_action(&id_ptr, adt->action, anim_eval_context, flush_to_original);
+      /* Original data can be changed at any time, only evaluated IDs keep resolved paths. */
+      if (DEG_is_evaluated_id(id) && adt == BKE_animdata_from_id(id)) {
+        animsys_evaluate_action_bindings(&id_ptr, adt, anim_eval_context, flush_to_original);
+      }
+      else {
+        animsys_evaluate_action(&id_ptr, adt->action, anim_eval_context, flush_to_original);
+      }
     }
   }
 
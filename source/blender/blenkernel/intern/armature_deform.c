@@ -34,7 +34,9 @@
 
 #include "BLI_listbase.h"
 #include "BLI_math.h"
+#include "BLI_simd.h"
 #include "BLI_task.h"
+#include "BLI_threads.h"
 #include "BLI_utildefines.h"
 
 #include "DNA_armature_types.h"
@@ -53,6 +55,7 @@
 #include "BKE_lattice.h"
 
 #include "DEG_depsgraph_build.h"
+#include "DEG_depsgraph_query.h"
 
 #include "CLG_log.h"
 
@@ -232,6 +235,130 @@ static void pchan_bone_deform(bPoseChannel *pchan,
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name Armature Deform Weights
+ *
+ * The vertex group weights of a mesh gathered into contiguous arrays, so vertices can be
+ * deformed without following the separately allocated weights of every #MDeformVert.
+ * The weights are cached in the runtime data of evaluated meshes, which is freed when the mesh
+ * is copied again after changes to the original.
+ * \{ */
+
+typedef struct ArmatureDeformWeight {
+  int def_nr;
+  float weight;
+} ArmatureDeformWeight;
+
+typedef struct ArmatureDeformWeights {
+  /* The data the weights were gathered from. */
+  const MDeformVert *dverts;
+  int verts_len;
+  int defbase_len;
+
+  /* Weights of vertex groups that exist, in vertex order. */
+  ArmatureDeformWeight *weights;
+  /* Index of the first weight of every vertex, with one more item for the end of the last. */
+  int *vert_offsets;
+} ArmatureDeformWeights;
+
+static ArmatureDeformWeights *armature_deform_weights_create(const MDeformVert *dverts,
+                                                             const int verts_len,
+                                                             const int defbase_len)
+{
+  int weights_len = 0;
+  for (int i = 0; i < verts_len; i++) {
+    for (int j = 0; j < dverts[i].totweight; j++) {
+      if (dverts[i].dw[j].def_nr < defbase_len) {
+        weights_len++;
+      }
+    }
+  }
+
+  ArmatureDeformWeights *deform_weights = MEM_mallocN(sizeof(*deform_weights), __func__);
+  deform_weights->dverts = dverts;
+  deform_weights->verts_len = verts_len;
+  deform_weights->defbase_len = defbase_len;
+  deform_weights->weights = MEM_malloc_arrayN(
+      max_ii(weights_len, 1), sizeof(*deform_weights->weights), __func__);
+  deform_weights->vert_offsets = MEM_malloc_arrayN(
+      verts_len + 1, sizeof(*deform_weights->vert_offsets), __func__);
+
+  int weight_index = 0;
+  for (int i = 0; i < verts_len; i++) {
+    deform_weights->vert_offsets[i] = weight_index;
+    for (int j = 0; j < dverts[i].totweight; j++) {
+      const MDeformWeight *dw = &dverts[i].dw[j];
+      if (dw->def_nr < defbase_len) {
+        deform_weights->weights[weight_index].def_nr = (int)dw->def_nr;
+        deform_weights->weights[weight_index].weight = dw->weight;
+        weight_index++;
+      }
+    }
+  }
+  deform_weights->vert_offsets[verts_len] = weight_index;
+
+  return deform_weights;
+}
+
+/**
+ * Get the cached weights of the deformed mesh, or NULL when the weights can't be cached because
+ * the coordinates don't belong to the evaluated mesh of the object.
+ */
+static const ArmatureDeformWeights *armature_deform_weights_ensure(const Object *ob_target,
+                                                                   const Mesh *me_target,
+                                                                   const int verts_len,
+                                                                   const int defbase_len)
+{
+  if (ob_target->type != OB_MESH) {
+    return NULL;
+  }
+
+  Mesh *mesh = ob_target->data;
+  /* Original meshes can change without their runtime data being freed. */
+  if (!DEG_is_evaluated_id(&mesh->id)) {
+    return NULL;
+  }
+
+  const MDeformVert *dverts = me_target ? me_target->dvert : mesh->dvert;
+  if (dverts == NULL || dverts != mesh->dvert || verts_len != mesh->totvert) {
+    return NULL;
+  }
+
+  /* Objects sharing the mesh are deformed in parallel. */
+  ThreadMutex *mesh_eval_mutex = (ThreadMutex *)mesh->runtime.eval_mutex;
+  BLI_mutex_lock(mesh_eval_mutex);
+  if (mesh->runtime.armature_deform_weights == NULL) {
+    mesh->runtime.armature_deform_weights = armature_deform_weights_create(
+        dverts, verts_len, defbase_len);
+  }
+  const ArmatureDeformWeights *deform_weights = mesh->runtime.armature_deform_weights;
+  BLI_mutex_unlock(mesh_eval_mutex);
+
+  if (deform_weights->dverts != dverts || deform_weights->verts_len != verts_len ||
+      deform_weights->defbase_len != defbase_len) {
+    BLI_assert_msg(0, "Cached armature deform weights are out of date");
+    return NULL;
+  }
+
+  return deform_weights;
+}
+
+void BKE_armature_deform_weights_discard(Mesh *mesh)
+{
+  ArmatureDeformWeights *deform_weights = mesh->runtime.armature_deform_weights;
+  if (deform_weights == NULL) {
+    return;
+  }
+
+  MEM_freeN(deform_weights->weights);
+  MEM_freeN(deform_weights->vert_offsets);
+  MEM_freeN(deform_weights);
+
+  mesh->runtime.armature_deform_weights = NULL;
+}
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name Armature Deform #BKE_armature_deform_coords API
  *
@@ -262,6 +389,13 @@ typedef struct ArmatureUserdata {
   float premat[4][4];
   float postmat[4][4];
 
+  /** Used by #armature_vert_task_weights. */
+  const ArmatureDeformWeights *deform_weights;
+  /** Deform matrix of the bone of every vertex group, zero for groups without a bone. */
+  const float (*group_mats)[4][4];
+  /** One for vertex groups with a deforming bone, zero otherwise. */
+  const float *group_factors;
+
   /** Specific data types. */
   struct {
     int cd_dvert_offset;
@@ -445,6 +579,93 @@ static void armature_vert_task(void *__restrict userdata,
   armature_vert_task_with_dvert(data, i, dvert);
 }
 
+/**
+ * Linear blend skinning with the cached #ArmatureDeformWeights, same as #armature_vert_task when
+ * no bone needs per-vertex evaluation (B-Bones or multiplication by envelopes).
+ *
+ * The bone matrices are blended first and the coordinate is transformed once,
+ * instead of transforming it by every bone.
+ */
+static void armature_vert_task_weights(void *__restrict userdata,
+                                       const int i,
+                                       const TaskParallelTLS *__restrict tls)
+{
+  const ArmatureUserdata *data = userdata;
+  const ArmatureDeformWeights *deform_weights = data->deform_weights;
+  const ArmatureDeformWeight *weights = deform_weights->weights;
+  const int weights_end = deform_weights->vert_offsets[i + 1];
+  float(*const vert_deform_mats)[3][3] = data->vert_deform_mats;
+  float blend_mat[4][4];
+  float contrib = 0.0f;
+  float deformed = 0.0f;
+
+#ifdef BLI_HAVE_SSE2
+  __m128 blend_cols[4] = {_mm_setzero_ps(), _mm_setzero_ps(), _mm_setzero_ps(), _mm_setzero_ps()};
+#else
+  zero_m4(blend_mat);
+#endif
+
+  for (int j = deform_weights->vert_offsets[i]; j < weights_end; j++) {
+    const int def_nr = weights[j].def_nr;
+    const float factor = data->group_factors[def_nr];
+    const float weight = weights[j].weight * factor;
+
+    deformed += factor;
+    contrib += weight;
+
+#ifdef BLI_HAVE_SSE2
+    const __m128 weight_vec = _mm_set1_ps(weight);
+    for (int col = 0; col < 4; col++) {
+      const __m128 group_col = _mm_load_ps(data->group_mats[def_nr][col]);
+      blend_cols[col] = _mm_add_ps(blend_cols[col], _mm_mul_ps(group_col, weight_vec));
+    }
+#else
+    madd_m4_m4m4fl(blend_mat, blend_mat, data->group_mats[def_nr], weight);
+#endif
+  }
+
+  /* Vertices without deforming vertex groups can still be deformed by envelopes. */
+  if (deformed == 0.0f) {
+    armature_vert_task(userdata, i, tls);
+    return;
+  }
+
+#ifdef BLI_HAVE_SSE2
+  for (int col = 0; col < 4; col++) {
+    _mm_storeu_ps(blend_mat[col], blend_cols[col]);
+  }
+#endif
+
+  float *co = data->vert_coords[i];
+  mul_m4_v3(data->premat, co);
+
+  /* Same threshold as #armature_vert_task_with_dvert. */
+  if (contrib > 0.0001f) {
+    /* The sum of the weighted offsets of every bone, see #pchan_deform_accumulate. */
+    float vec[3];
+    mul_v3_m4v3(vec, blend_mat, co);
+    madd_v3_v3fl(vec, co, -contrib);
+
+    mul_v3_fl(vec, 1.0f / contrib);
+    add_v3_v3(co, vec);
+
+    if (vert_deform_mats) {
+      float pre[3][3], post[3][3], tmpmat[3][3], smat[3][3];
+
+      copy_m3_m4(pre, data->premat);
+      copy_m3_m4(post, data->postmat);
+      copy_m3_m3(tmpmat, vert_deform_mats[i]);
+      copy_m3_m4(smat, blend_mat);
+
+      mul_m3_fl(smat, 1.0f / contrib);
+
+      mul_m3_series(vert_deform_mats[i], post, smat, pre, tmpmat);
+    }
+  }
+
+  mul_m4_v3(data->postmat, co);
+}
+
 static void armature_vert_task_editmesh(void *__restrict userdata,
                                         MempoolIterData *iter,
                                         const TaskParallelTLS *__restrict UNUSED(tls))
@@ -464,6 +685,51 @@ static void armature_vert_task_editmesh_no_dvert(void *__restrict userdata,
   armature_vert_task_with_dvert(data, BM_elem_index_get(v), NULL);
 }
 
+/**
+ * Create the bone matrices used with #ArmatureDeformWeights, returns false when a bone
+ * needs per-vertex evaluation and #armature_vert_task_weights can't be used.
+ */
+static bool armature_deform_group_mats_create(bPoseChannel **pchan_from_defbase,
+                                              const int defbase_len,
+                                              float (**r_group_mats)[4][4],
+                                              float **r_group_factors)
+{
+  for (int i = 0; i < defbase_len; i++) {
+    const bPoseChannel *pchan = pchan_from_defbase[i];
+    if (pchan == NULL) {
+      continue;
+    }
+    const Bone *bone = pchan->bone;
+    if (bone->flag & BONE_MULT_VG_ENV) {
+      return false;
+    }
+    if (bone->segments > 1 && pchan->runtime.bbone_segments == bone->segments) {
+      return false;
+    }
+  }
+
+  /* Aligned for SIMD loads of the matrix columns. */
+  float(*group_mats)[4][4] = MEM_mallocN_aligned(
+      sizeof(*group_mats) * (size_t)defbase_len, 16, __func__);
+  float *group_factors = MEM_malloc_arrayN(defbase_len, sizeof(*group_factors), __func__);
+
+  for (int i = 0; i < defbase_len; i++) {
+    const bPoseChannel *pchan = pchan_from_defbase[i];
+    if (pchan) {
+      copy_m4_m4(group_mats[i], pchan->chan_mat);
+      group_factors[i] = 1.0f;
+    }
+    else {
+      zero_m4(group_mats[i]);
+      group_factors[i] = 0.0f;
+    }
+  }
+
+  *r_group_mats = group_mats;
+  *r_group_factors = group_factors;
+  return true;
+}
+
 static void armature_deform_coords_impl(const Object *ob_arm,
                                         const Object *ob_target,
                                         float (*vert_coords)[3],
@@ -592,6 +858,22 @@ static void armature_deform_coords_impl(const Object *ob_arm,
   mul_m4_m4m4(data.postmat, obinv, ob_arm->obmat);
   invert_m4_m4(data.premat, data.postmat);
 
+  /* Dual quaternions, the armature vertex group and blending with the previous coordinates
+   * are only supported by the generic per-vertex evaluation. */
+  float(*group_mats)[4][4] = NULL;
+  float *group_factors = NULL;
+  if (use_dverts && em_target == NULL && gps_target == NULL && defbase_len > 0 &&
+      !use_quaternion && armature_def_nr == -1 && vert_coords_prev == NULL) {
+    data.deform_weights = armature_deform_weights_ensure(
+        ob_target, me_target, vert_coords_len, defbase_len);
+    if (data.deform_weights != NULL &&
+        armature_deform_group_mats_create(
+            pchan_from_defbase, defbase_len, &group_mats, &group_factors)) {
+      data.group_mats = (const float(*)[4][4])group_mats;
+      data.group_factors = group_factors;
+    }
+  }
+
   if (em_target != NULL) {
     /* While this could cause an extra loop over mesh data, in most cases this will
      * have already been properly set. */
@@ -613,12 +895,20 @@ static void armature_deform_coords_impl(const Object *ob_arm,
     TaskParallelSettings settings;
     BLI_parallel_range_settings_defaults(&settings);
     settings.min_iter_per_thread = 32;
-    BLI_task_parallel_range(0, vert_coords_len, &data, armature_vert_task, &settings);
+    BLI_task_parallel_range(0,
+                            vert_coords_len,
+                            &data,
+                            group_mats ? armature_vert_task_weights : armature_vert_task,
+                            &settings);
   }
 
   if (pchan_from_defbase) {
     MEM_freeN(pchan_from_defbase);
   }
+  if (group_mats) {
+    MEM_freeN(group_mats);
+    MEM_freeN(group_factors);
+  }
 }
 
 void BKE_armature_deform_coords_with_gpencil_stroke(const Object *ob_arm,
@@ -0,0 +1,226 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2021 by Blender Foundation.
+ */
+#include "testing/testing.h"
+
+#include "BKE_armature.h"
+#include "BKE_customdata.h"
+#include "BKE_deform.h"
+#include "BKE_idtype.h"
+#include "BKE_mesh.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "DNA_armature_types.h"
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+#include "DNA_object_types.h"
+
+#include "BLI_listbase.h"
+#include "BLI_math.h"
+#include "BLI_rand.hh"
+#include "BLI_string.h"
+
+namespace blender::bke::tests {
+
+/* The last vertex group has no bone. */
+static const int TEST_BONES_NUM = 16;
+static const int TEST_GROUPS_NUM = TEST_BONES_NUM + 1;
+static const int TEST_WEIGHTS_PER_VERT = 4;
+
+struct ArmatureDeformTestContext {
+  bArmature armature;
+  Bone bones[TEST_BONES_NUM];
+  Object ob_armature;
+  Mesh mesh;
+  Object ob_mesh;
+  float (*coords)[3];
+  float (*deform_mats)[3][3];
+};
+
+static void test_armature_deform_init(ArmatureDeformTestContext *ctx,
+                                      RandomNumberGenerator *rng,
+                                      int32_t num_items)
+{
+  IDType_ID_AR.init_data(&ctx->armature.id);
+  strcpy(ctx->armature.id.name, "ARArmature");
+  IDType_ID_OB.init_data(&ctx->ob_armature.id);
+  ctx->ob_armature.type = OB_ARMATURE;
+  ctx->ob_armature.data = &ctx->armature;
+  ctx->ob_armature.pose = (bPose *)MEM_callocN(sizeof(bPose), __func__);
+  const float arm_eul[3] = {0.1f, 0.2f, 0.3f};
+  eul_to_mat4(ctx->ob_armature.obmat, arm_eul);
+
+  IDType_ID_ME.init_data(&ctx->mesh.id);
+  strcpy(ctx->mesh.id.name, "MEMesh");
+  IDType_ID_OB.init_data(&ctx->ob_mesh.id);
+  ctx->ob_mesh.type = OB_MESH;
+  ctx->ob_mesh.data = &ctx->mesh;
+  unit_m4(ctx->ob_mesh.obmat);
+  copy_v3_fl3(ctx->ob_mesh.obmat[3], 1.0f, 2.0f, 3.0f);
+
+  for (int i = 0; i < TEST_GROUPS_NUM; i++) {
+    bDeformGroup *dg = (bDeformGroup *)MEM_callocN(sizeof(bDeformGroup), __func__);
+    BLI_snprintf(dg->name, sizeof(dg->name), "Group%d", i);
+    BLI_addtail(&ctx->mesh.vertex_group_names, dg);
+
+    if (i < TEST_BONES_NUM) {
+      Bone *bone = &ctx->bones[i];
+      STRNCPY(bone->name, dg->name);
+      bone->segments = 1;
+      bone->length = 1.0f;
+
+      bPoseChannel *pchan = (bPoseChannel *)MEM_callocN(sizeof(bPoseChannel), __func__);
+      STRNCPY(pchan->name, dg->name);
+      pchan->bone = bone;
+      const float eul[3] = {rng->get_float(), rng->get_float(), rng->get_float()};
+      eul_to_mat4(pchan->chan_mat, eul);
+      copy_v3_fl3(pchan->chan_mat[3], rng->get_float(), rng->get_float(), rng->get_float());
+      BLI_addtail(&ctx->ob_armature.pose->chanbase, pchan);
+    }
+  }
+
+  /* Generate random input data between -5 and 5, with random weights. */
+  ctx->mesh.totvert = num_items;
+  CustomData_add_layer(&ctx->mesh.vdata, CD_MDEFORMVERT, CD_CALLOC, nullptr, num_items);
+  BKE_mesh_update_customdata_pointers(&ctx->mesh, false);
+
+  ctx->coords = (float(*)[3])MEM_malloc_arrayN(num_items, sizeof(float[3]), __func__);
+  ctx->deform_mats = (float(*)[3][3])MEM_malloc_arrayN(num_items, sizeof(float[3][3]), __func__);
+  for (int i = 0; i < num_items; i++) {
+    ctx->coords[i][0] = (rng->get_float() - 0.5f) * 10;
+    ctx->coords[i][1] = (rng->get_float() - 0.5f) * 10;
+    ctx->coords[i][2] = (rng->get_float() - 0.5f) * 10;
+    unit_m3(ctx->deform_mats[i]);
+
+    MDeformVert *dvert = &ctx->mesh.dvert[i];
+    switch (i % 16) {
+      case 0:
+        /* No weights. */
+        break;
+      case 1:
+        /* Only a group without bone. */
+        BKE_defvert_add_index_notest(dvert, TEST_BONES_NUM, 1.0f);
+        break;
+      case 2:
+        /* Only zero weights. */
+        BKE_defvert_add_index_notest(dvert, 0, 0.0f);
+        break;
+      default:
+        for (int j = 0; j < TEST_WEIGHTS_PER_VERT; j++) {
+          BKE_defvert_add_index_notest(
+              dvert, rng->get_int32(TEST_GROUPS_NUM), rng->get_float() * 0.5f);
+        }
+        break;
+    }
+  }
+}
+
+static void test_armature_deform(ArmatureDeformTestContext *ctx,
+                                 int32_t num_items,
+                                 int deformflag,
+                                 bool use_deform_mats)
+{
+  BKE_armature_deform_coords_with_mesh(&ctx->ob_armature,
+                                       &ctx->ob_mesh,
+                                       ctx->coords,
+                                       use_deform_mats ? ctx->deform_mats : nullptr,
+                                       num_items,
+                                       deformflag,
+                                       nullptr,
+                                       "",
+                                       nullptr);
+}
+
+static void test_armature_deform_free(ArmatureDeformTestContext *ctx)
+{
+  MEM_freeN(ctx->coords);
+  MEM_freeN(ctx->deform_mats);
+  IDType_ID_OB.free_data(&ctx->ob_mesh.id);
+  IDType_ID_ME.free_data(&ctx->mesh.id);
+  IDType_ID_OB.free_data(&ctx->ob_armature.id);
+  IDType_ID_AR.free_data(&ctx->armature.id);
+}
+
+/* Deforming evaluated meshes uses cached weights, compare with the generic evaluation. */
+static void test_armature_deform_weights_cache(int deformflag)
+{
+  const int32_t num_items = 1000;
+  ArmatureDeformTestContext ctx_generic = {{{nullptr}}};
+  ArmatureDeformTestContext ctx_cached = {{{nullptr}}};
+  RandomNumberGenerator rng_generic;
+  RandomNumberGenerator rng_cached;
+  test_armature_deform_init(&ctx_generic, &rng_generic, num_items);
+  test_armature_deform_init(&ctx_cached, &rng_cached, num_items);
+  ctx_cached.mesh.id.tag |= LIB_TAG_COPIED_ON_WRITE;
+
+  /* Deform twice to use the cache when it exists. */
+  for (int iter = 0; iter < 2; iter++) {
+    test_armature_deform(&ctx_generic, num_items, deformflag, true);
+    test_armature_deform(&ctx_cached, num_items, deformflag, true);
+  }
+
+  EXPECT_EQ(ctx_generic.mesh.runtime.armature_deform_weights, nullptr);
+  EXPECT_NE(ctx_cached.mesh.runtime.armature_deform_weights, nullptr);
+
+  for (int i = 0; i < num_items; i++) {
+    EXPECT_V3_NEAR(ctx_generic.coords[i], ctx_cached.coords[i], 1e-4f);
+    EXPECT_M3_NEAR(ctx_generic.deform_mats[i], ctx_cached.deform_mats[i], 1e-4f);
+  }
+
+  test_armature_deform_free(&ctx_generic);
+  test_armature_deform_free(&ctx_cached);
+}
+
+TEST(armature_deform, weights_cache)
+{
+  test_armature_deform_weights_cache(ARM_DEF_VGROUP);
+}
+
+TEST(armature_deform, weights_cache_envelope)
+{
+  test_armature_deform_weights_cache(ARM_DEF_VGROUP | ARM_DEF_ENVELOPE);
+}
+
+/* Performance of deforming a character mesh for a number of frames. */
+static void test_armature_deform_performance(bool is_evaluated)
+{
+  const int32_t num_items = 500000;
+  const int frames_num = 10;
+  ArmatureDeformTestContext ctx = {{{nullptr}}};
+  RandomNumberGenerator rng;
+  test_armature_deform_init(&ctx, &rng, num_items);
+  if (is_evaluated) {
+    ctx.mesh.id.tag |= LIB_TAG_COPIED_ON_WRITE;
+  }
+  for (int frame = 0; frame < frames_num; frame++) {
+    test_armature_deform(&ctx, num_items, ARM_DEF_VGROUP, false);
+  }
+  test_armature_deform_free(&ctx);
+}
+
+TEST(armature_deform_performance, performance_500000)
+{
+  test_armature_deform_performance(true);
+}
+
+TEST(armature_deform_performance, performance_no_cache_500000)
+{
+  test_armature_deform_performance(false);
+}
+
+}  // namespace blender::bke::tests
@@ -61,6 +61,8 @@
 
 #include "CLG_log.h"
 
+#include "atomic_ops.h"
+
 /* only for customdata_data_transfer_interp_normal_normals */
 #include "data_transfer_intern.h"
 
@@ -2064,6 +2066,9 @@ static CustomDataLayer *customData_add_layer__internal(CustomData *data,
                                                        void *layerdata,
                                                        int totelem,
                                                        const char *name);
+static void *customData_duplicate_referenced_layer_index(CustomData *data,
+                                                         const int layer_index,
+                                                         const int totelem);
 
 void CustomData_update_typemap(CustomData *data)
 {
@@ -2092,6 +2097,98 @@ static bool customdata_typemap_is_valid(const CustomData *data)
 }
 #endif
 
+/* -------------------------------------------------------------------- */
+/** \name Layer Sharing
+ *
+ * Layers copied with #CD_SHARE use the data of the source layer instead of a copy. Both layers
+ * then have #CD_FLAG_NOFREE set, the same as referenced layers, so code which makes referenced
+ * layers writable with #CustomData_duplicate_referenced_layer unshares them too. The data is
+ * freed along with the last layer using it.
+ *
+ * Only layers prepared with #CustomData_share_prepare are shared. Copies are made from other
+ * threads than the one owning the source, so the copy itself never modifies the source layer.
+ * \{ */
+
+typedef struct CustomDataSharingInfo {
+  int users;
+  int type;
+  int totelem;
+  void *data;
+} CustomDataSharingInfo;
+
+static bool customData_layer_can_share(const CustomDataLayer *layer)
+{
+  if (layer->data == NULL || (layer->flag & CD_FLAG_EXTERNAL)) {
+    return false;
+  }
+  /* Evaluation writes vertex normals into the vertex array in place. */
+  if (layer->type == CD_MVERT) {
+    return false;
+  }
+  /* Referenced layers are not owned by the source. */
+  return (layer->flag & CD_FLAG_NOFREE) == 0;
+}
+
+void CustomData_share_prepare(CustomData *data, CustomDataMask mask, int totelem)
+{
+  for (int i = 0; i < data->totlayer; i++) {
+    CustomDataLayer *layer = &data->layers[i];
+    if (!(mask & CD_TYPE_AS_MASK(layer->type)) || layer->sharing_info != NULL ||
+        !customData_layer_can_share(layer)) {
+      continue;
+    }
+    CustomDataSharingInfo *info = MEM_mallocN(sizeof(*info), __func__);
+    info->users = 1;
+    info->type = layer->type;
+    info->totelem = totelem;
+    info->data = layer->data;
+    layer->sharing_info = info;
+    layer->flag |= CD_FLAG_NOFREE;
+  }
+}
+
+static CustomDataSharingInfo *customData_layer_share(const CustomDataLayer *layer)
+{
+  CustomDataSharingInfo *info = layer->sharing_info;
+  atomic_add_and_fetch_int32(&info->users, 1);
+  return info;
+}
+
+static void customData_layer_unshare(CustomDataLayer *layer)
+{
+  CustomDataSharingInfo *info = layer->sharing_info;
+  layer->sharing_info = NULL;
+  if (atomic_sub_and_fetch_int32(&info->users, 1) != 0) {
+    return;
+  }
+  const LayerTypeInfo *typeInfo = layerType_getInfo(info->type);
+  if (typeInfo->free) {
+    typeInfo->free(info->data, info->totelem, typeInfo->size);
+  }
+  MEM_freeN(info->data);
+  MEM_freeN(info);
+}
+
+/* Make the layer the only owner of its data, which only needs a copy when other layers still use
+ * the data. */
+static bool customData_layer_take_ownership(CustomDataLayer *layer)
+{
+  CustomDataSharingInfo *info = layer->sharing_info;
+  if (info == NULL || info->data != layer->data) {
+    return false;
+  }
+  /* Other users might be released from other threads. */
+  if (atomic_add_and_fetch_int32(&info->users, 0) != 1) {
+    return false;
+  }
+  MEM_freeN(info);
+  layer->sharing_info = NULL;
+  layer->flag &= ~CD_FLAG_NOFREE;
+  return true;
+}
+
+/** \} */
+
 bool CustomData_merge(const struct CustomData *source,
                       struct CustomData *dest,
                       CustomDataMask mask,
@@ -2142,6 +2239,7 @@ bool CustomData_merge(const struct CustomData *source,
       case CD_ASSIGN:
       case CD_REFERENCE:
       case CD_DUPLICATE:
+      case CD_SHARE:
         data = layer->data;
         break;
       default:
@@ -2153,6 +2251,20 @@ bool CustomData_merge(const struct CustomData *source,
       newlayer = customData_add_layer__internal(
           dest, type, CD_REFERENCE, data, totelem, layer->name);
     }
+    else if (alloctype == CD_SHARE) {
+      if (layer->sharing_info != NULL && layer->sharing_info->data == data) {
+        /* The layer is known to not exist in the destination yet, see above. */
+        newlayer = customData_add_layer__internal(
+            dest, type, CD_REFERENCE, data, totelem, layer->name);
+        if (newlayer) {
+          newlayer->sharing_info = customData_layer_share(layer);
+        }
+      }
+      else {
+        newlayer = customData_add_layer__internal(
+            dest, type, CD_DUPLICATE, data, totelem, layer->name);
+      }
+    }
     else {
       newlayer = customData_add_layer__internal(dest, type, alloctype, data, totelem, layer->name);
     }
@@ -2179,6 +2291,10 @@ void CustomData_realloc(CustomData *data, int totelem)
   for (int i = 0; i < data->totlayer; i++) {
     CustomDataLayer *layer = &data->layers[i];
     const LayerTypeInfo *typeInfo;
+    if (layer->sharing_info != NULL) {
+      /* Shared layers are owned, unlike referenced ones. */
+      customData_duplicate_referenced_layer_index(data, i, layer->sharing_info->totelem);
+    }
     if (layer->flag & CD_FLAG_NOFREE) {
       continue;
     }
@@ -2206,7 +2322,10 @@ static void customData_free_layer__internal(CustomDataLayer *layer, int totelem)
 {
   const LayerTypeInfo *typeInfo;
 
-  if (!(layer->flag & CD_FLAG_NOFREE) && layer->data) {
+  if (layer->sharing_info != NULL) {
+    customData_layer_unshare(layer);
+  }
+  else if (!(layer->flag & CD_FLAG_NOFREE) && layer->data) {
     typeInfo = layerType_getInfo(layer->type);
 
     if (typeInfo->free) {
@@ -2580,6 +2699,7 @@ static CustomDataLayer *customData_add_layer__internal(CustomData *data,
   data->layers[index].type = type;
   data->layers[index].flag = flag;
   data->layers[index].data = newlayerdata;
+  data->layers[index].sharing_info = NULL;
 
   /* Set default name if none exists. Note we only call DATA_()  once
    * we know there is a default name, to avoid overhead of locale lookups
@@ -2759,6 +2879,10 @@ static void *customData_duplicate_referenced_layer_index(CustomData *data,
 
   CustomDataLayer *layer = &data->layers[layer_index];
 
+  if (customData_layer_take_ownership(layer)) {
+    return layer->data;
+  }
+
   if (layer->flag & CD_FLAG_NOFREE) {
     /* MEM_dupallocN won't work in case of complex layers, like e.g.
      * CD_MDEFORMVERT, which has pointers to allocated data...
@@ -2776,6 +2900,9 @@ static void *customData_duplicate_referenced_layer_index(CustomData *data,
       layer->data = MEM_dupallocN(layer->data);
     }
 
+    if (layer->sharing_info != NULL) {
+      customData_layer_unshare(layer);
+    }
     layer->flag &= ~CD_FLAG_NOFREE;
   }
 
@@ -5196,6 +5323,7 @@ void CustomData_blend_read(BlendDataReader *reader, CustomData *data, int count)
     }
 
     layer->flag &= ~CD_FLAG_NOFREE;
+    layer->sharing_info = NULL;
 
     if (CustomData_verify_versions(data, i)) {
       BLO_read_data_address(reader, &layer->data);
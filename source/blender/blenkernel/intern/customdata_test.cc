@@ -0,0 +1,161 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2021 by Blender Foundation.
+ */
+#include "testing/testing.h"
+
+#include "BKE_customdata.h"
+
+#include "DNA_customdata_types.h"
+
+namespace blender::bke::tests {
+
+static const int TEST_TOTELEM = 16;
+
+static void test_customdata_init(CustomData *data)
+{
+  CustomData_reset(data);
+  float *values = (float *)CustomData_add_layer(
+      data, CD_PROP_FLOAT, CD_CALLOC, nullptr, TEST_TOTELEM);
+  for (int i = 0; i < TEST_TOTELEM; i++) {
+    values[i] = (float)i;
+  }
+}
+
+static void test_customdata_init_shared(CustomData *data)
+{
+  test_customdata_init(data);
+  CustomData_share_prepare(data, CD_MASK_PROP_FLOAT, TEST_TOTELEM);
+}
+
+static void test_customdata_check_values(CustomData *data)
+{
+  const float *values = (const float *)CustomData_get_layer(data, CD_PROP_FLOAT);
+  ASSERT_NE(values, nullptr);
+  for (int i = 0; i < TEST_TOTELEM; i++) {
+    EXPECT_EQ(values[i], (float)i);
+  }
+}
+
+TEST(customdata, ShareLayers)
+{
+  CustomData source, copy;
+  test_customdata_init_shared(&source);
+  CustomData_copy(&source, &copy, CD_MASK_PROP_FLOAT, CD_SHARE, TEST_TOTELEM);
+
+  EXPECT_EQ(CustomData_get_layer(&source, CD_PROP_FLOAT),
+            CustomData_get_layer(&copy, CD_PROP_FLOAT));
+  EXPECT_TRUE(CustomData_is_referenced_layer(&source, CD_PROP_FLOAT));
+  EXPECT_TRUE(CustomData_is_referenced_layer(&copy, CD_PROP_FLOAT));
+
+  /* Data stays valid as long as any layer uses it. */
+  CustomData_free(&source, TEST_TOTELEM);
+  test_customdata_check_values(&copy);
+  CustomData_free(&copy, TEST_TOTELEM);
+}
+
+TEST(customdata, ShareLayersMakeWritable)
+{
+  CustomData source, copy;
+  test_customdata_init_shared(&source);
+  CustomData_copy(&source, &copy, CD_MASK_PROP_FLOAT, CD_SHARE, TEST_TOTELEM);
+
+  const void *source_values = CustomData_get_layer(&source, CD_PROP_FLOAT);
+
+  /* The first writer gets a copy. */
+  float *copy_values = (float *)CustomData_duplicate_referenced_layer(
+      &copy, CD_PROP_FLOAT, TEST_TOTELEM);
+  EXPECT_NE(copy_values, source_values);
+  EXPECT_FALSE(CustomData_is_referenced_layer(&copy, CD_PROP_FLOAT));
+  copy_values[0] = -1.0f;
+  test_customdata_check_values(&source);
+
+  /* The last user takes ownership without copying. */
+  EXPECT_EQ(CustomData_duplicate_referenced_layer(&source, CD_PROP_FLOAT, TEST_TOTELEM),
+            source_values);
+  EXPECT_FALSE(CustomData_is_referenced_layer(&source, CD_PROP_FLOAT));
+
+  CustomData_free(&source, TEST_TOTELEM);
+  CustomData_free(&copy, TEST_TOTELEM);
+}
+
+TEST(customdata, ShareLayersMultipleCopies)
+{
+  CustomData source, copy_a, copy_b;
+  test_customdata_init_shared(&source);
+  CustomData_copy(&source, &copy_a, CD_MASK_PROP_FLOAT, CD_SHARE, TEST_TOTELEM);
+  /* Copies of shared layers share the same data. */
+  CustomData_copy(&copy_a, &copy_b, CD_MASK_PROP_FLOAT, CD_SHARE, TEST_TOTELEM);
+
+  EXPECT_EQ(CustomData_get_layer(&source, CD_PROP_FLOAT),
+            CustomData_get_layer(&copy_b, CD_PROP_FLOAT));
+
+  CustomData_free(&copy_a, TEST_TOTELEM);
+  CustomData_free(&source, TEST_TOTELEM);
+  test_customdata_check_values(&copy_b);
+  CustomData_free(&copy_b, TEST_TOTELEM);
+}
+
+TEST(customdata, ShareLayersRealloc)
+{
+  CustomData source, copy;
+  test_customdata_init_shared(&source);
+  CustomData_copy(&source, &copy, CD_MASK_PROP_FLOAT, CD_SHARE, TEST_TOTELEM);
+
+  CustomData_realloc(&copy, TEST_TOTELEM * 2);
+  EXPECT_NE(CustomData_get_layer(&source, CD_PROP_FLOAT),
+            CustomData_get_layer(&copy, CD_PROP_FLOAT));
+  test_customdata_check_values(&copy);
+  test_customdata_check_values(&source);
+
+  CustomData_free(&source, TEST_TOTELEM);
+  CustomData_free(&copy, TEST_TOTELEM * 2);
+}
+
+/* Layers which are not prepared for sharing are copied, without modifying the source. */
+TEST(customdata, ShareLayersNotPrepared)
+{
+  CustomData source, copy;
+  test_customdata_init(&source);
+  CustomData_copy(&source, &copy, CD_MASK_PROP_FLOAT, CD_SHARE, TEST_TOTELEM);
+
+  EXPECT_NE(CustomData_get_layer(&source, CD_PROP_FLOAT),
+            CustomData_get_layer(&copy, CD_PROP_FLOAT));
+  EXPECT_FALSE(CustomData_is_referenced_layer(&source, CD_PROP_FLOAT));
+  EXPECT_FALSE(CustomData_is_referenced_layer(&copy, CD_PROP_FLOAT));
+  test_customdata_check_values(&copy);
+
+  CustomData_free(&source, TEST_TOTELEM);
+  CustomData_free(&copy, TEST_TOTELEM);
+}
+
+/* Vertices are written in place during evaluation, they are never shared. */
+TEST(customdata, ShareLayersVertices)
+{
+  CustomData source, copy;
+  CustomData_reset(&source);
+  CustomData_add_layer(&source, CD_MVERT, CD_CALLOC, nullptr, TEST_TOTELEM);
+  CustomData_share_prepare(&source, CD_MASK_MVERT, TEST_TOTELEM);
+  CustomData_copy(&source, &copy, CD_MASK_MVERT, CD_SHARE, TEST_TOTELEM);
+
+  EXPECT_NE(CustomData_get_layer(&source, CD_MVERT), CustomData_get_layer(&copy, CD_MVERT));
+  EXPECT_FALSE(CustomData_is_referenced_layer(&source, CD_MVERT));
+
+  CustomData_free(&source, TEST_TOTELEM);
+  CustomData_free(&copy, TEST_TOTELEM);
+}
+
+}  // namespace blender::bke::tests
@@ -37,6 +37,7 @@
 #include "BLI_easing.h"
 #include "BLI_ghash.h"
 #include "BLI_math.h"
+#include "BLI_simd.h"
 #include "BLI_sort_utils.h"
 
 #include "BKE_anim_data.h"
@@ -2281,6 +2282,338 @@ float calculate_fcurve(PathResolvedRNA *anim_rna,
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name F-Curve - Batch Evaluation
+ *
+ * Evaluates many F-Curves at the same frame, i.e. all curves of an action with thousands of
+ * channels. The keyframe segment of every curve is kept between evaluations, so that playback does
+ * not search the keyframes again, and the Bezier segments of all curves are solved together in
+ * groups of #FCURVE_BATCH_LANES, with SSE2 when available.
+ *
+ * Curves with modifiers or samples, and segments which are not simple Bezier or linear ones, are
+ * evaluated by the regular functions, giving the same results.
+ * \{ */
+
+/* Number of Bezier segments solved together, two SSE2 registers of doubles. */
+#define FCURVE_BATCH_LANES 4
+/* Precision of the Bezier parameter of the solved segments. */
+#define FCURVE_BATCH_NEWTON_EPS 1e-10
+#define FCURVE_BATCH_NEWTON_ITER_MAX 64
+/* Iterations done by all lanes between checks for convergence. */
+#define FCURVE_BATCH_NEWTON_ITER_BLOCK 4
+/* Same threshold as used by #fcurve_eval_keyframes_interpolate. */
+#define FCURVE_BATCH_KEY_THRESH 0.0001f
+
+typedef struct FCurveBezierLanes {
+  /* Coefficients of the cubic polynomials of time (relative to the evaluation time) and value,
+   * lowest degree first. */
+  double time_coeffs[4][FCURVE_BATCH_LANES];
+  double value_coeffs[4][FCURVE_BATCH_LANES];
+  /* Initial guess for the Bezier parameter. */
+  double guess[FCURVE_BATCH_LANES];
+  float *r_value[FCURVE_BATCH_LANES];
+  int lanes_num;
+} FCurveBezierLanes;
+
+typedef struct FCurveBatchEval {
+  FCurve **fcurves;
+  int fcurves_num;
+  /* Per F-Curve, index of the keyframe ending the segment used by the previous evaluation. */
+  int *segments;
+  FCurveBezierLanes bezier;
+} FCurveBatchEval;
+
+FCurveBatchEval *BKE_fcurve_batch_eval_create(FCurve **fcurves, const int fcurves_num)
+{
+  FCurveBatchEval *batch = MEM_callocN(sizeof(FCurveBatchEval), "FCurveBatchEval");
+  batch->fcurves = MEM_malloc_arrayN(fcurves_num, sizeof(FCurve *), __func__);
+  memcpy(batch->fcurves, fcurves, sizeof(FCurve *) * fcurves_num);
+  batch->fcurves_num = fcurves_num;
+  batch->segments = MEM_calloc_arrayN(fcurves_num, sizeof(int), __func__);
+  return batch;
+}
+
+void BKE_fcurve_batch_eval_destroy(FCurveBatchEval *batch)
+{
+  MEM_freeN(batch->fcurves);
+  MEM_freeN(batch->segments);
+  MEM_freeN(batch);
+}
+
+static bool fcurve_batch_use_keyframes(const FCurve *fcu)
+{
+  return fcu->bezt != NULL && fcu->totvert >= 2 && fcu->driver == NULL &&
+         BLI_listbase_is_empty(&fcu->modifiers);
+}
+
+/* Whether the evaluation time is inside the segment ending at keyframe `index`, and not on its
+ * keyframes, in which case the binary search of #fcurve_eval_keyframes_interpolate would find the
+ * same segment. */
+static bool fcurve_batch_segment_contains(const FCurve *fcu, const int index, const float evaltime)
+{
+  if (index < 1 || index >= fcu->totvert) {
+    return false;
+  }
+  return evaltime - fcu->bezt[index - 1].vec[1][0] > FCURVE_BATCH_KEY_THRESH &&
+         fcu->bezt[index].vec[1][0] - evaltime > FCURVE_BATCH_KEY_THRESH;
+}
+
+static bool fcurve_batch_segment_find(const FCurve *fcu, int *segment, const float evaltime)
+{
+  if (fcurve_batch_segment_contains(fcu, *segment, evaltime)) {
+    return true;
+  }
+  /* Playback mostly moves to the next segment. */
+  if (fcurve_batch_segment_contains(fcu, *segment + 1, evaltime)) {
+    *segment += 1;
+    return true;
+  }
+  bool exact;
+  const int index = BKE_fcurve_bezt_binarysearch_index_ex(
+      fcu->bezt, evaltime, fcu->totvert, FCURVE_BATCH_KEY_THRESH, &exact);
+  if (exact || !fcurve_batch_segment_contains(fcu, index, evaltime)) {
+    return false;
+  }
+  *segment = index;
+  return true;
+}
+
+#ifdef BLI_HAVE_SSE2
+
+BLI_INLINE __m128d fcurve_bezier_lanes_select(const __m128d mask, const __m128d a, const __m128d b)
+{
+  return _mm_or_pd(_mm_and_pd(mask, a), _mm_andnot_pd(mask, b));
+}
+
+/* Solve the lanes in two registers, see #fcurve_bezier_lanes_newton. */
+static void fcurve_bezier_lanes_newton_sse2(const FCurveBezierLanes *lanes,
+                                            double t_lanes[FCURVE_BATCH_LANES])
+{
+  const __m128d zero = _mm_setzero_pd();
+  const __m128d one = _mm_set1_pd(1.0);
+  const __m128d half = _mm_set1_pd(0.5);
+  const __m128d sign = _mm_set1_pd(-0.0);
+  const __m128d eps = _mm_set1_pd(FCURVE_BATCH_NEWTON_EPS);
+
+  __m128d c0[2], c1[2], c2[2], c3[2], dc2[2], dc3[2];
+  __m128d t[2], lo[2], hi[2], step[2];
+  for (int h = 0; h < 2; h++) {
+    c0[h] = _mm_loadu_pd(&lanes->time_coeffs[0][2 * h]);
+    c1[h] = _mm_loadu_pd(&lanes->time_coeffs[1][2 * h]);
+    c2[h] = _mm_loadu_pd(&lanes->time_coeffs[2][2 * h]);
+    c3[h] = _mm_loadu_pd(&lanes->time_coeffs[3][2 * h]);
+    dc2[h] = _mm_add_pd(c2[h], c2[h]);
+    dc3[h] = _mm_mul_pd(_mm_set1_pd(3.0), c3[h]);
+    t[h] = _mm_loadu_pd(&lanes->guess[2 * h]);
+    lo[h] = zero;
+    hi[h] = one;
+  }
+
+  for (int block = 0; block < FCURVE_BATCH_NEWTON_ITER_MAX / FCURVE_BATCH_NEWTON_ITER_BLOCK;
+       block++) {
+    for (int iter = 0; iter < FCURVE_BATCH_NEWTON_ITER_BLOCK; iter++) {
+      for (int h = 0; h < 2; h++) {
+        const __m128d x = _mm_add_pd(
+            _mm_mul_pd(_mm_add_pd(_mm_mul_pd(_mm_add_pd(_mm_mul_pd(c3[h], t[h]), c2[h]), t[h]),
+                                  c1[h]),
+                       t[h]),
+            c0[h]);
+        const __m128d dx = _mm_add_pd(
+            _mm_mul_pd(_mm_add_pd(_mm_mul_pd(dc3[h], t[h]), dc2[h]), t[h]), c1[h]);
+        const __m128d below = _mm_cmplt_pd(x, zero);
+        lo[h] = fcurve_bezier_lanes_select(below, t[h], lo[h]);
+        hi[h] = fcurve_bezier_lanes_select(below, hi[h], t[h]);
+        const __m128d dx_valid = _mm_cmpgt_pd(dx, zero);
+        const __m128d newton = _mm_sub_pd(
+            t[h], _mm_div_pd(x, fcurve_bezier_lanes_select(dx_valid, dx, one)));
+        const __m128d use_newton = _mm_and_pd(
+            dx_valid, _mm_and_pd(_mm_cmpge_pd(newton, lo[h]), _mm_cmple_pd(newton, hi[h])));
+        const __m128d t_next = fcurve_bezier_lanes_select(
+            use_newton, newton, _mm_mul_pd(half, _mm_add_pd(lo[h], hi[h])));
+        step[h] = _mm_andnot_pd(sign, _mm_sub_pd(t_next, t[h]));
+        t[h] = t_next;
+      }
+    }
+    if ((_mm_movemask_pd(_mm_cmplt_pd(step[0], eps)) &
+         _mm_movemask_pd(_mm_cmplt_pd(step[1], eps))) == 3) {
+      break;
+    }
+  }
+
+  _mm_storeu_pd(&t_lanes[0], t[0]);
+  _mm_storeu_pd(&t_lanes[2], t[1]);
+}
+
+#endif /* BLI_HAVE_SSE2 */
+
+/* Find the Bezier parameter where the time polynomial of each lane is zero. Newton iterations,
+ * falling back to bisection when a step leaves the bracket of the root. Time is monotonic on the
+ * segments, so the root is unique. */
+static void fcurve_bezier_lanes_newton(const FCurveBezierLanes *lanes,
+                                       double t[FCURVE_BATCH_LANES])
+{
+#ifdef BLI_HAVE_SSE2
+  fcurve_bezier_lanes_newton_sse2(lanes, t);
+#else
+  const double(*xc)[FCURVE_BATCH_LANES] = lanes->time_coeffs;
+  double lo[FCURVE_BATCH_LANES], hi[FCURVE_BATCH_LANES];
+
+  for (int i = 0; i < FCURVE_BATCH_LANES; i++) {
+    t[i] = lanes->guess[i];
+    lo[i] = 0.0;
+    hi[i] = 1.0;
+  }
+
+  for (int iter = 0; iter < FCURVE_BATCH_NEWTON_ITER_MAX; iter++) {
+    bool converged = true;
+    for (int i = 0; i < FCURVE_BATCH_LANES; i++) {
+      const double x = ((xc[3][i] * t[i] + xc[2][i]) * t[i] + xc[1][i]) * t[i] + xc[0][i];
+      const double dx = (3.0 * xc[3][i] * t[i] + 2.0 * xc[2][i]) * t[i] + xc[1][i];
+      lo[i] = (x < 0.0) ? t[i] : lo[i];
+      hi[i] = (x < 0.0) ? hi[i] : t[i];
+      const double newton = t[i] - x / ((dx > 0.0) ? dx : 1.0);
+      const bool use_newton = (dx > 0.0) && (newton >= lo[i]) && (newton <= hi[i]);
+      const double t_next = use_newton ? newton : 0.5 * (lo[i] + hi[i]);
+      converged &= fabs(t_next - t[i]) < FCURVE_BATCH_NEWTON_EPS;
+      t[i] = t_next;
+    }
+    if (converged) {
+      break;
+    }
+  }
+#endif
+}
+
+static void fcurve_bezier_lanes_solve(FCurveBezierLanes *lanes)
+{
+  double(*xc)[FCURVE_BATCH_LANES] = lanes->time_coeffs;
+  double(*yc)[FCURVE_BATCH_LANES] = lanes->value_coeffs;
+  double t[FCURVE_BATCH_LANES];
+
+  /* Unused lanes solve a trivial segment. */
+  for (int i = lanes->lanes_num; i < FCURVE_BATCH_LANES; i++) {
+    xc[0][i] = -0.5;
+    xc[1][i] = 1.0;
+    xc[2][i] = xc[3][i] = 0.0;
+    lanes->guess[i] = 0.5;
+  }
+
+  fcurve_bezier_lanes_newton(lanes, t);
+
+  for (int i = 0; i < lanes->lanes_num; i++) {
+    *lanes->r_value[i] = (float)(((yc[3][i] * t[i] + yc[2][i]) * t[i] + yc[1][i]) * t[i] +
+                                 yc[0][i]);
+  }
+  lanes->lanes_num = 0;
+}
+
+/* Queue the Bezier segment between the keyframes, the value is written when the lanes are full or
+ * by the final flush. Returns false if the segment is not supported. */
+static bool fcurve_bezier_lanes_add(FCurveBezierLanes *lanes,
+                                    const BezTriple *prevbezt,
+                                    const BezTriple *bezt,
+                                    const float evaltime,
+                                    float *r_value)
+{
+  float v1[2], v2[2], v3[2], v4[2];
+  copy_v2_v2(v1, prevbezt->vec[1]);
+  copy_v2_v2(v2, prevbezt->vec[2]);
+  copy_v2_v2(v3, bezt->vec[0]);
+  copy_v2_v2(v4, bezt->vec[1]);
+  if (fabsf(v1[1] - v4[1]) < FLT_EPSILON && fabsf(v2[1] - v3[1]) < FLT_EPSILON &&
+      fabsf(v3[1] - v4[1]) < FLT_EPSILON) {
+    *r_value = v1[1];
+    return true;
+  }
+  BKE_fcurve_correct_bezpart(v1, v2, v3, v4);
+  /* With handles pointing inside of the segment time is monotonic, otherwise the root found by
+   * #findzero is not necessarily the first one. */
+  if (v2[0] < v1[0] || v4[0] < v3[0]) {
+    return false;
+  }
+
+  const int i = lanes->lanes_num;
+  lanes->time_coeffs[0][i] = (double)v1[0] - evaltime;
+  lanes->time_coeffs[1][i] = 3.0 * ((double)v2[0] - v1[0]);
+  lanes->time_coeffs[2][i] = 3.0 * ((double)v1[0] - 2.0 * v2[0] + v3[0]);
+  lanes->time_coeffs[3][i] = (double)v4[0] - v1[0] + 3.0 * ((double)v2[0] - v3[0]);
+  lanes->value_coeffs[0][i] = v1[1];
+  lanes->value_coeffs[1][i] = 3.0 * ((double)v2[1] - v1[1]);
+  lanes->value_coeffs[2][i] = 3.0 * ((double)v1[1] - 2.0 * v2[1] + v3[1]);
+  lanes->value_coeffs[3][i] = (double)v4[1] - v1[1] + 3.0 * ((double)v2[1] - v3[1]);
+  lanes->guess[i] = ((double)evaltime - v1[0]) / ((double)v4[0] - v1[0]);
+  lanes->r_value[i] = r_value;
+  lanes->lanes_num++;
+
+  if (lanes->lanes_num == FCURVE_BATCH_LANES) {
+    fcurve_bezier_lanes_solve(lanes);
+  }
+  return true;
+}
+
+/* Evaluate the keyframes of the curve inside of the segment, returns false if the value is to be
+ * computed by #fcurve_eval_keyframes. */
+static bool fcurve_batch_eval_segment(FCurveBezierLanes *lanes,
+                                      const FCurve *fcu,
+                                      const int segment,
+                                      const float evaltime,
+                                      float *r_value)
+{
+  const BezTriple *prevbezt = &fcu->bezt[segment - 1];
+  const BezTriple *bezt = &fcu->bezt[segment];
+  const float duration = bezt->vec[1][0] - prevbezt->vec[1][0];
+
+  if ((prevbezt->ipo == BEZT_IPO_CONST) || (fcu->flag & FCURVE_DISCRETE_VALUES) ||
+      (duration == 0)) {
+    *r_value = prevbezt->vec[1][1];
+    return true;
+  }
+  switch (prevbezt->ipo) {
+    case BEZT_IPO_BEZ:
+      return fcurve_bezier_lanes_add(lanes, prevbezt, bezt, evaltime, r_value);
+    case BEZT_IPO_LIN:
+      *r_value = BLI_easing_linear_ease(evaltime - prevbezt->vec[1][0],
+                                        prevbezt->vec[1][1],
+                                        bezt->vec[1][1] - prevbezt->vec[1][1],
+                                        duration);
+      return true;
+  }
+  return false;
+}
+
+/**
+ * Evaluate all curves of the batch at the given frame, same as #evaluate_fcurve_only_curve.
+ * The curves must not be modified between evaluations of the batch.
+ */
+void BKE_fcurve_batch_evaluate(FCurveBatchEval *batch, const float evaltime, float *r_values)
+{
+  FCurveBezierLanes *lanes = &batch->bezier;
+  for (int i = 0; i < batch->fcurves_num; i++) {
+    FCurve *fcu = batch->fcurves[i];
+    if (!fcurve_batch_use_keyframes(fcu)) {
+      r_values[i] = evaluate_fcurve_only_curve(fcu, evaltime);
+      continue;
+    }
+    if (!fcurve_batch_segment_find(fcu, &batch->segments[i], evaltime) ||
+        !fcurve_batch_eval_segment(lanes, fcu, batch->segments[i], evaltime, &r_values[i])) {
+      r_values[i] = fcurve_eval_keyframes(fcu, fcu->bezt, evaltime);
+    }
+  }
+  if (lanes->lanes_num > 0) {
+    fcurve_bezier_lanes_solve(lanes);
+  }
+
+  /* Same rounding as #evaluate_fcurve_ex, once all values are known. */
+  for (int i = 0; i < batch->fcurves_num; i++) {
+    const FCurve *fcu = batch->fcurves[i];
+    if ((fcu->flag & FCURVE_INT_VALUES) && fcurve_batch_use_keyframes(fcu)) {
+      r_values[i] = floorf(r_values[i] + 0.5f);
+    }
+  }
+}
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name F-Curve - .blend file API
  * \{ */
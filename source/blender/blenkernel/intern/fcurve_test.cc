@@ -19,6 +19,10 @@
 
 #include "MEM_guardedalloc.h"
 
+#include "BLI_array.hh"
+#include "BLI_span.hh"
+#include "BLI_vector.hh"
+
 #include "BKE_fcurve.h"
 
 #include "ED_keyframing.h"
@@ -212,6 +216,122 @@ TEST(evaluate_fcurve, ExtrapolationBezierKeys)
   BKE_fcurve_free(fcu);
 }
 
+/* Bezier segments are solved differently by the batch evaluation, so the values differ by
+ * rounding errors. */
+static const float BATCH_EPSILON = 1e-5f;
+
+static FCurve *batch_test_fcurve(const int ipo)
+{
+  FCurve *fcu = BKE_fcurve_create();
+  insert_vert_fcurve(fcu, 1.0f, 7.0f, BEZT_KEYTYPE_KEYFRAME, INSERTKEY_NO_USERPREF);
+  insert_vert_fcurve(fcu, 2.0f, 13.0f, BEZT_KEYTYPE_KEYFRAME, INSERTKEY_NO_USERPREF);
+  insert_vert_fcurve(fcu, 5.0f, 2.0f, BEZT_KEYTYPE_KEYFRAME, INSERTKEY_NO_USERPREF);
+  insert_vert_fcurve(fcu, 8.0f, 9.5f, BEZT_KEYTYPE_KEYFRAME, INSERTKEY_NO_USERPREF);
+  for (int i = 0; i < fcu->totvert; i++) {
+    fcu->bezt[i].ipo = ipo;
+  }
+  return fcu;
+}
+
+static void batch_test_compare(FCurveBatchEval *batch, Span<FCurve *> fcurves, float evaltime)
+{
+  Array<float> values(fcurves.size());
+  BKE_fcurve_batch_evaluate(batch, evaltime, values.data());
+  for (const int i : fcurves.index_range()) {
+    EXPECT_NEAR(values[i], evaluate_fcurve(fcurves[i], evaltime), BATCH_EPSILON)
+        << "F-Curve " << i << " at frame " << evaltime;
+  }
+}
+
+TEST(evaluate_fcurve_batch, MatchesSingleCurve)
+{
+  Vector<FCurve *> fcurves;
+  fcurves.append(batch_test_fcurve(BEZT_IPO_BEZ));
+  fcurves.append(batch_test_fcurve(BEZT_IPO_LIN));
+  fcurves.append(batch_test_fcurve(BEZT_IPO_CONST));
+  /* Evaluated by the regular functions. */
+  fcurves.append(batch_test_fcurve(BEZT_IPO_BOUNCE));
+  FCurve *fcu_cycles = batch_test_fcurve(BEZT_IPO_BEZ);
+  add_fmodifier(&fcu_cycles->modifiers, FMODIFIER_TYPE_CYCLES, fcu_cycles);
+  fcurves.append(fcu_cycles);
+  /* Extrapolation is evaluated by the regular functions as well. */
+  FCurve *fcu_extrapolate = batch_test_fcurve(BEZT_IPO_BEZ);
+  fcu_extrapolate->extend = FCURVE_EXTRAPOLATE_LINEAR;
+  fcurves.append(fcu_extrapolate);
+  FCurve *fcu_int = batch_test_fcurve(BEZT_IPO_LIN);
+  fcu_int->flag |= FCURVE_INT_VALUES;
+  fcurves.append(fcu_int);
+  FCurve *fcu_discrete = batch_test_fcurve(BEZT_IPO_BEZ);
+  fcu_discrete->flag |= FCURVE_DISCRETE_VALUES;
+  fcurves.append(fcu_discrete);
+  /* Mixed interpolation. */
+  FCurve *fcu_mixed = batch_test_fcurve(BEZT_IPO_BEZ);
+  fcu_mixed->bezt[1].ipo = BEZT_IPO_LIN;
+  fcu_mixed->bezt[2].ipo = BEZT_IPO_ELASTIC;
+  fcurves.append(fcu_mixed);
+  fcurves.append(BKE_fcurve_create());
+
+  FCurveBatchEval *batch = BKE_fcurve_batch_eval_create(fcurves.data(), fcurves.size());
+
+  /* Playback, which moves on to the next segment. */
+  for (float frame = -2.0f; frame < 12.0f; frame += 0.1f) {
+    batch_test_compare(batch, fcurves, frame);
+  }
+  /* Backwards and jumping around, which needs to search for the segment. */
+  for (float frame = 12.0f; frame > -2.0f; frame -= 0.3f) {
+    batch_test_compare(batch, fcurves, frame);
+  }
+  for (const float frame : {7.5f, 1.5f, 4.2f, 6.0f, 1.1f, 7.9f}) {
+    batch_test_compare(batch, fcurves, frame);
+  }
+  /* On and next to keyframes. */
+  for (const float frame : {1.0f, 2.0f, 2.00008f, 4.99992f, 5.0f, 8.0f}) {
+    batch_test_compare(batch, fcurves, frame);
+  }
+
+  BKE_fcurve_batch_eval_destroy(batch);
+  for (FCurve *fcu : fcurves) {
+    BKE_fcurve_free(fcu);
+  }
+}
+
+TEST(evaluate_fcurve_batch, InterpolationBezier)
+{
+  /* Same curve as the InterpolationBezier test above, in more than one group of lanes. */
+  Vector<FCurve *> fcurves;
+  for (int i = 0; i < 7; i++) {
+    FCurve *fcu = BKE_fcurve_create();
+    insert_vert_fcurve(fcu, 1.0f, 7.0f, BEZT_KEYTYPE_KEYFRAME, INSERTKEY_NO_USERPREF);
+    insert_vert_fcurve(fcu, 2.0f, 13.0f, BEZT_KEYTYPE_KEYFRAME, INSERTKEY_NO_USERPREF);
+    fcu->bezt[0].vec[2][0] = 1.35148f;
+    fcu->bezt[0].vec[2][1] = 7.96806f;
+    fcu->bezt[1].vec[0][0] = 1.66667f;
+    fcu->bezt[1].vec[0][1] = 10.4136f;
+    fcurves.append(fcu);
+  }
+
+  FCurveBatchEval *batch = BKE_fcurve_batch_eval_create(fcurves.data(), fcurves.size());
+  Array<float> values(fcurves.size());
+
+  BKE_fcurve_batch_evaluate(batch, 1.25f, values.data());
+  for (const float value : values) {
+    EXPECT_NEAR(value, 7.945497f, BATCH_EPSILON);
+  }
+  BKE_fcurve_batch_evaluate(batch, 1.50f, values.data());
+  for (const float value : values) {
+    EXPECT_NEAR(value, 9.3495407f, BATCH_EPSILON);
+  }
+  BKE_fcurve_batch_evaluate(batch, 1.75f, values.data());
+  for (const float value : values) {
+    EXPECT_NEAR(value, 11.088551f, BATCH_EPSILON);
+  }
+
+  BKE_fcurve_batch_eval_destroy(batch);
+  for (FCurve *fcu : fcurves) {
+    BKE_fcurve_free(fcu);
+  }
+}
+
 TEST(fcurve_subdivide, BKE_fcurve_bezt_subdivide_handles)
 {
   FCurve *fcu = BKE_fcurve_create();
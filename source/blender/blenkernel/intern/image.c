@@ -4085,7 +4085,10 @@ static void image_create_multilayer(Image *ima, ImBuf *ibuf, int framenr)
     ima->rr = RE_MultilayerConvert(ibuf->userdata, colorspace, predivide, ibuf->x, ibuf->y);
   }
 
-  IMB_exr_close(ibuf->userdata);
+  /* The render result keeps handles that read passes on demand. */
+  if (ima->rr == NULL || ima->rr->exrhandle != ibuf->userdata) {
+    IMB_exr_close(ibuf->userdata);
+  }
 
   ibuf->userdata = NULL;
   if (ima->rr != NULL) {
@@ -4173,7 +4176,8 @@ static ImBuf *load_sequence_single(
   iuser_t.view = view_id;
   BKE_image_user_file_path(&iuser_t, ima, name);
 
-  flag = IB_rect | IB_multilayer | IB_metadata;
+  /* Passes of multilayer files are only read when first used, see #RE_pass_ensure_loaded. */
+  flag = IB_rect | IB_multilayer | IB_multilayer_on_demand | IB_metadata;
   flag |= imbuf_alpha_flags_for_image(ima);
 
   /* read ibuf */
@@ -4298,7 +4302,7 @@ static ImBuf *image_load_sequence_multilayer(Image *ima, ImageUser *iuser, int e
   if (ima->rr) {
     RenderPass *rpass = BKE_image_multilayer_index(ima->rr, iuser);
 
-    if (rpass) {
+    if (rpass && RE_pass_ensure_loaded(ima->rr, rpass)) {
       // printf("load from pass %s\n", rpass->name);
       /* since we free  render results, we copy the rect */
       ibuf = IMB_allocImBuf(ima->rr->rectx, ima->rr->recty, 32, 0);
@@ -4481,7 +4485,8 @@ static ImBuf *load_image_single(Image *ima,
   else {
     ImageUser iuser_t;
 
-    flag = IB_rect | IB_multilayer | IB_metadata;
+    /* Passes of multilayer files are only read when first used, see #RE_pass_ensure_loaded. */
+    flag = IB_rect | IB_multilayer | IB_multilayer_on_demand | IB_metadata;
     flag |= imbuf_alpha_flags_for_image(ima);
 
     /* get the correct filepath */
@@ -4627,7 +4632,7 @@ static ImBuf *image_get_ibuf_multilayer(Image *ima, ImageUser *iuser)
   if (ima->rr) {
     RenderPass *rpass = BKE_image_multilayer_index(ima->rr, iuser);
 
-    if (rpass) {
+    if (rpass && RE_pass_ensure_loaded(ima->rr, rpass)) {
       ibuf = IMB_allocImBuf(ima->rr->rectx, ima->rr->recty, 32, 0);
 
       image_init_after_load(ima, iuser, ibuf);
@@ -5198,6 +5203,7 @@ typedef struct ImagePoolItem {
   ImBuf *ibuf;
   int index;
   int entry;
+  bool use_tilecache;
 } ImagePoolItem;
 
 typedef struct ImagePool {
@@ -5229,14 +5235,15 @@ void BKE_image_pool_free(ImagePool *pool)
 }
 
 BLI_INLINE ImBuf *image_pool_find_item(
-    ImagePool *pool, Image *image, int entry, int index, bool *found)
+    ImagePool *pool, Image *image, int entry, int index, bool use_tilecache, bool *found)
 {
   ImagePoolItem *item;
 
   *found = false;
 
   for (item = pool->image_buffers.first; item; item = item->next) {
-    if (item->image == image && item->entry == entry && item->index == index) {
+    if (item->image == image && item->entry == entry && item->index == index &&
+        item->use_tilecache == use_tilecache) {
       *found = true;
       return item->ibuf;
     }
@@ -5245,7 +5252,45 @@ BLI_INLINE ImBuf *image_pool_find_item(
   return NULL;
 }
 
-ImBuf *BKE_image_pool_acquire_ibuf(Image *ima, ImageUser *iuser, ImagePool *pool)
+/**
+ * Open the tiled and mipmapped `.tx` version of an image file, when there is an up to date one.
+ * Pixels are not read, tiles are loaded by the tile cache when they are sampled.
+ */
+static ImBuf *image_load_tilecache_ibuf(Image *ima, ImageUser *iuser)
+{
+  char filepath[FILE_MAX], filepath_tx[FILE_MAX];
+
+  if (!ELEM(ima->source, IMA_SRC_FILE, IMA_SRC_TILED) || BKE_image_has_packedfile(ima) ||
+      BKE_image_is_multiview(ima)) {
+    return NULL;
+  }
+  /* Use buffers already loaded in full resolution, for example by the image editor. */
+  if (ima->cache != NULL) {
+    return NULL;
+  }
+
+  BKE_image_user_file_path(iuser, ima, filepath);
+  BLI_strncpy(filepath_tx, filepath, sizeof(filepath_tx));
+  if (!BLI_path_extension_replace(filepath_tx, sizeof(filepath_tx), ".tx") ||
+      !BLI_exists(filepath_tx) || BLI_file_older(filepath_tx, filepath)) {
+    return NULL;
+  }
+
+  const int flag = IB_rect | IB_tilecache | imbuf_alpha_flags_for_image(ima);
+  ImBuf *ibuf = IMB_loadiffname(filepath, flag, ima->colorspace_settings.name);
+  if (ibuf && !(ibuf->flags & IB_tilecache)) {
+    /* Not a tiled texture, the regular image cache is used instead. */
+    IMB_freeImBuf(ibuf);
+    return NULL;
+  }
+
+  return ibuf;
+}
+
+static ImBuf *image_pool_acquire_ibuf(Image *ima,
+                                      ImageUser *iuser,
+                                      ImagePool *pool,
+                                      const bool use_tilecache)
 {
   ImBuf *ibuf;
   int index, entry;
@@ -5262,14 +5307,14 @@ ImBuf *BKE_image_pool_acquire_ibuf(Image *ima, ImageUser *iuser, ImagePool *pool
 
   image_get_entry_and_index(ima, iuser, &entry, &index);
 
-  ibuf = image_pool_find_item(pool, ima, entry, index, &found);
+  ibuf = image_pool_find_item(pool, ima, entry, index, use_tilecache, &found);
   if (found) {
     return ibuf;
   }
 
   BLI_mutex_lock(image_mutex);
 
-  ibuf = image_pool_find_item(pool, ima, entry, index, &found);
+  ibuf = image_pool_find_item(pool, ima, entry, index, use_tilecache, &found);
 
   /* will also create item even in cases image buffer failed to load,
    * prevents trying to load the same buggy file multiple times
@@ -5277,12 +5322,16 @@ ImBuf *BKE_image_pool_acquire_ibuf(Image *ima, ImageUser *iuser, ImagePool *pool
   if (!found) {
     ImagePoolItem *item;
 
-    ibuf = image_acquire_ibuf(ima, iuser, NULL);
+    ibuf = use_tilecache ? image_load_tilecache_ibuf(ima, iuser) : NULL;
+    if (ibuf == NULL) {
+      ibuf = image_acquire_ibuf(ima, iuser, NULL);
+    }
 
     item = BLI_mempool_alloc(pool->memory_pool);
     item->image = ima;
     item->entry = entry;
     item->index = index;
+    item->use_tilecache = use_tilecache;
     item->ibuf = ibuf;
 
     BLI_addtail(&pool->image_buffers, item);
@@ -5293,6 +5342,23 @@ ImBuf *BKE_image_pool_acquire_ibuf(Image *ima, ImageUser *iuser, ImagePool *pool
   return ibuf;
 }
 
+ImBuf *BKE_image_pool_acquire_ibuf(Image *ima, ImageUser *iuser, ImagePool *pool)
+{
+  return image_pool_acquire_ibuf(ima, iuser, pool, false);
+}
+
+/**
+ * Same as #BKE_image_pool_acquire_ibuf, but images with a tiled `.tx` version are returned
+ * without pixel buffers, flagged with #IB_tilecache. Only the sampled tiles are loaded, so this
+ * is meant for texture sampling that reads pixels through #IMB_tiled_pixel_get.
+ *
+ * Without a pool the regular image buffer is returned.
+ */
+ImBuf *BKE_image_pool_acquire_ibuf_tilecache(Image *ima, ImageUser *iuser, ImagePool *pool)
+{
+  return image_pool_acquire_ibuf(ima, iuser, pool, true);
+}
+
 void BKE_image_pool_release_ibuf(Image *ima, ImBuf *ibuf, ImagePool *pool)
 {
   /* if pool wasn't actually used, use general release stuff,
@@ -54,6 +54,7 @@
 #include "BLI_session_uuid.h"
 #include "BLI_string.h"
 #include "BLI_string_utils.h"
+#include "BLI_trace.h"
 #include "BLI_utildefines.h"
 
 #include "BLT_translation.h"
@@ -1050,7 +1051,10 @@ struct Mesh *BKE_modifier_modify_mesh(ModifierData *md,
   if (mti->dependsOnNormals && mti->dependsOnNormals(md)) {
     modwrap_dependsOnNormals(me);
   }
-  return mti->modifyMesh(md, ctx, me);
+  BLI_trace_begin("modifier", md->name);
+  Mesh *result = mti->modifyMesh(md, ctx, me);
+  BLI_trace_end();
+  return result;
 }
 
 void BKE_modifier_deform_verts(ModifierData *md,
@@ -1065,7 +1069,9 @@ void BKE_modifier_deform_verts(ModifierData *md,
   if (me && mti->dependsOnNormals && mti->dependsOnNormals(md)) {
     modwrap_dependsOnNormals(me);
   }
+  BLI_trace_begin("modifier", md->name);
   mti->deformVerts(md, ctx, me, vertexCos, numVerts);
+  BLI_trace_end();
 }
 
 void BKE_modifier_deform_vertsEM(ModifierData *md,
@@ -1081,7 +1087,9 @@ void BKE_modifier_deform_vertsEM(ModifierData *md,
   if (me && mti->dependsOnNormals && mti->dependsOnNormals(md)) {
     BKE_mesh_calc_normals(me);
   }
+  BLI_trace_begin("modifier", md->name);
   mti->deformVertsEM(md, ctx, em, me, vertexCos, numVerts);
+  BLI_trace_end();
 }
 
 /* end modifier callback wrappers */
@@ -0,0 +1,77 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#pragma once
+
+/** \file
+ * \ingroup bli
+ *
+ * Recording of timed events per thread, written as a Chrome trace JSON file which can be viewed
+ * in `chrome://tracing` or Perfetto. Recording is disabled unless a trace file was set, and then
+ * only costs a check of #BLI_trace_is_enabled per event.
+ */
+
+#include "BLI_sys_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Start recording events to `filepath`. Threads write their events in batches while recording,
+ * the file is complete after #BLI_trace_exit. */
+void BLI_trace_init(const char *filepath);
+/* Write the remaining events and stop recording. Threads must not record events anymore. */
+void BLI_trace_exit(void);
+
+bool BLI_trace_is_enabled(void);
+
+/* Events of a thread are nested, every begin needs a matching end on the same thread.
+ * The category is expected to be a string literal, the name is copied. */
+void BLI_trace_begin(const char *category, const char *name);
+void BLI_trace_end(void);
+
+#ifdef __cplusplus
+}
+
+namespace blender {
+
+/* Records an event for the lifetime of the object. */
+class TraceScope {
+ private:
+  bool is_enabled_;
+
+ public:
+  TraceScope(const char *category, const char *name) : is_enabled_(BLI_trace_is_enabled())
+  {
+    if (is_enabled_) {
+      BLI_trace_begin(category, name);
+    }
+  }
+
+  ~TraceScope()
+  {
+    if (is_enabled_) {
+      BLI_trace_end();
+    }
+  }
+
+  TraceScope(const TraceScope &other) = delete;
+  TraceScope &operator=(const TraceScope &other) = delete;
+};
+
+}  // namespace blender
+
+#endif
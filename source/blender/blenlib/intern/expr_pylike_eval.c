@@ -29,14 +29,17 @@
  *  - Literals:
  *      floating point and decimal integer.
  *  - Constants:
- *      pi, True, False
+ *      pi, tau, e, True, False
  *  - Operators:
  *      +, -, *, /, ==, !=, <, <=, >, >=, and, or, not, ternary if
  *  - Functions:
  *      min, max, radians, degrees,
- *      abs, fabs, floor, ceil, trunc, int,
+ *      abs, fabs, floor, ceil, trunc, int, float, bool,
  *      sin, cos, tan, asin, acos, atan, atan2,
- *      exp, log, sqrt, pow, fmod
+ *      sinh, cosh, tanh, asinh, acosh, atanh,
+ *      exp, expm1, log, log2, log10, log1p, sqrt, pow, fmod, hypot, copysign,
+ *      lerp, clamp, smoothstep,
+ *      noise.noise((x, y, z))
  *
  * The implementation has no global state and can be used multi-threaded.
  */
@@ -55,6 +58,7 @@
 #include "BLI_alloca.h"
 #include "BLI_expr_pylike_eval.h"
 #include "BLI_math_base.h"
+#include "BLI_noise.h"
 #include "BLI_utildefines.h"
 
 #ifdef _MSC_VER
@@ -340,6 +344,16 @@ static double op_log2(double a, double b)
   return log(a) / log(b);
 }
 
+static double op_float(double arg)
+{
+  return arg;
+}
+
+static double op_bool(double arg)
+{
+  return arg ? 1.0 : 0.0;
+}
+
 static double op_lerp(double a, double b, double x)
 {
   return a * (1.0 - x) + b * x;
@@ -364,6 +378,13 @@ static double op_smoothstep(double a, double b, double x)
   return t * t * (3.0 - 2.0 * t);
 }
 
+/* Same as `mathutils.noise.noise(position)` of the Python driver namespace, which uses the
+ * original Perlin noise basis (#TEX_STDPERLIN) by default and computes in single precision. */
+static double op_noise(double x, double y, double z)
+{
+  return 2.0f * BLI_noise_generic_noise(1.0f, (float)x, (float)y, (float)z, false, 1) - 1.0f;
+}
+
 static double op_not(double a)
 {
   return a ? 0.0 : 1.0;
@@ -405,7 +426,13 @@ typedef struct BuiltinConstDef {
 } BuiltinConstDef;
 
 static BuiltinConstDef builtin_consts[] = {
-    {"pi", M_PI}, {"True", 1.0}, {"False", 0.0}, {NULL, 0.0}};
+    {"pi", M_PI},
+    {"tau", 2.0 * M_PI},
+    {"e", M_E},
+    {"True", 1.0},
+    {"False", 0.0},
+    {NULL, 0.0},
+};
 
 typedef struct BuiltinOpDef {
   const char *name;
@@ -430,6 +457,8 @@ static BuiltinOpDef builtin_ops[] = {
     {"trunc", OPCODE_FUNC1, trunc},
     {"round", OPCODE_FUNC1, round},
     {"int", OPCODE_FUNC1, trunc},
+    {"float", OPCODE_FUNC1, op_float},
+    {"bool", OPCODE_FUNC1, op_bool},
     {"sin", OPCODE_FUNC1, sin},
     {"cos", OPCODE_FUNC1, cos},
     {"tan", OPCODE_FUNC1, tan},
@@ -437,12 +466,24 @@ static BuiltinOpDef builtin_ops[] = {
     {"acos", OPCODE_FUNC1, acos},
     {"atan", OPCODE_FUNC1, atan},
     {"atan2", OPCODE_FUNC2, atan2},
+    {"sinh", OPCODE_FUNC1, sinh},
+    {"cosh", OPCODE_FUNC1, cosh},
+    {"tanh", OPCODE_FUNC1, tanh},
+    {"asinh", OPCODE_FUNC1, asinh},
+    {"acosh", OPCODE_FUNC1, acosh},
+    {"atanh", OPCODE_FUNC1, atanh},
     {"exp", OPCODE_FUNC1, exp},
+    {"expm1", OPCODE_FUNC1, expm1},
     {"log", OPCODE_FUNC1, log},
     {"log", OPCODE_FUNC2, op_log2},
+    {"log2", OPCODE_FUNC1, log2},
+    {"log10", OPCODE_FUNC1, log10},
+    {"log1p", OPCODE_FUNC1, log1p},
     {"sqrt", OPCODE_FUNC1, sqrt},
     {"pow", OPCODE_FUNC2, pow},
     {"fmod", OPCODE_FUNC2, fmod},
+    {"hypot", OPCODE_FUNC2, hypot},
+    {"copysign", OPCODE_FUNC2, copysign},
     {"lerp", OPCODE_FUNC3, op_lerp},
     {"clamp", OPCODE_FUNC1, op_clamp},
     {"clamp", OPCODE_FUNC3, op_clamp3},
@@ -792,6 +833,28 @@ static int parse_function_args(ExprParseState *state)
   }
 }
 
+/* Parse the `noise.noise((x, y, z))` call after the `noise` identifier. The position may be given
+ * as a tuple or list, other arguments of the Python function are not supported. */
+static bool parse_noise_function(ExprParseState *state)
+{
+  CHECK_ERROR(parse_next_token(state) && state->token == '.');
+  CHECK_ERROR(parse_next_token(state) && state->token == TOKEN_ID);
+  CHECK_ERROR(STREQ(state->tokenbuf, "noise"));
+  CHECK_ERROR(parse_next_token(state) && state->token == '(');
+  CHECK_ERROR(parse_next_token(state) && ELEM(state->token, '(', '['));
+
+  const short end_token = (state->token == '(') ? ')' : ']';
+
+  for (int i = 0; i < 3; i++) {
+    CHECK_ERROR(parse_next_token(state) && parse_expr(state));
+    CHECK_ERROR(state->token == ((i < 2) ? ',' : end_token));
+  }
+
+  CHECK_ERROR(parse_next_token(state) && state->token == ')' && parse_next_token(state));
+
+  return parse_add_func(state, OPCODE_FUNC3, 3, op_noise);
+}
+
 static bool parse_unary(ExprParseState *state)
 {
   int i;
@@ -852,6 +915,10 @@ static bool parse_unary(ExprParseState *state)
       }
 
       /* Specially supported functions. */
+      if (STREQ(state->tokenbuf, "noise")) {
+        return parse_noise_function(state);
+      }
+
       if (STREQ(state->tokenbuf, "min")) {
         int cnt = parse_function_args(state);
         CHECK_ERROR(cnt > 0);
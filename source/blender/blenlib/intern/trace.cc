@@ -0,0 +1,219 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/** \file
+ * \ingroup bli
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "BLI_fileops.h"
+#include "BLI_threads.h"
+#include "BLI_trace.h"
+#include "BLI_utildefines.h"
+#include "BLI_vector.hh"
+
+namespace blender {
+
+using Clock = std::chrono::steady_clock;
+
+/* Events buffered by a thread before it writes them to the file, so long sessions don't keep
+ * every event in memory until #BLI_trace_exit. */
+static constexpr int64_t TRACE_FLUSH_EVENTS = 16384;
+
+struct TraceEvent {
+  /* Chrome trace phase, 'B' or 'E'. */
+  char phase;
+  Clock::time_point time;
+  /* Only set for begin events. */
+  const char *category;
+  std::string name;
+};
+
+struct TraceThread {
+  int id;
+  bool is_main;
+  Vector<TraceEvent> events;
+};
+
+struct TraceSession {
+  Clock::time_point start_time;
+
+  /* Writing to the file and adding threads is protected by the mutex. */
+  std::mutex mutex;
+  FILE *file;
+  Vector<std::unique_ptr<TraceThread>> threads;
+};
+
+static TraceSession *trace_session = nullptr;
+/* Set while the session exists, checked without locking by every event. */
+static std::atomic<bool> trace_is_enabled = false;
+/* Threads may outlive a session, their data is only valid for the session it was created in. */
+static int trace_session_index = 0;
+
+static thread_local TraceThread *trace_thread = nullptr;
+static thread_local int trace_thread_session_index = 0;
+
+static void trace_write_string(FILE *file, const char *str)
+{
+  fputc('"', file);
+  for (const char *c = str; *c; c++) {
+    if (ELEM(*c, '"', '\\')) {
+      fputc('\\', file);
+      fputc(*c, file);
+    }
+    else if ((unsigned char)*c < 0x20) {
+      fprintf(file, "\\u%04x", (unsigned char)*c);
+    }
+    else {
+      fputc(*c, file);
+    }
+  }
+  fputc('"', file);
+}
+
+/* The file starts with the name of the first thread recording events, every following entry is
+ * written with a leading separator. */
+static void trace_write_thread_name(FILE *file, const TraceThread &thread, const bool is_first)
+{
+  fprintf(file,
+          "%s{\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"name\":\"thread_name\",\"args\":{\"name\":",
+          is_first ? "" : ",\n",
+          thread.id);
+  if (thread.is_main) {
+    trace_write_string(file, "Main");
+  }
+  else {
+    const std::string name = "Thread " + std::to_string(thread.id);
+    trace_write_string(file, name.c_str());
+  }
+  fprintf(file, "}}");
+}
+
+/* Write the buffered events of the thread and clear them, the session mutex must be held. */
+static void trace_write_events(const TraceSession &session, TraceThread &thread)
+{
+  FILE *file = session.file;
+  for (const TraceEvent &event : thread.events) {
+    const double time =
+        std::chrono::duration<double, std::micro>(event.time - session.start_time).count();
+    fprintf(file,
+            ",\n{\"ph\":\"%c\",\"pid\":1,\"tid\":%d,\"ts\":%.3f",
+            event.phase,
+            thread.id,
+            time);
+    if (event.phase == 'B') {
+      fprintf(file, ",\"cat\":");
+      trace_write_string(file, event.category);
+      fprintf(file, ",\"name\":");
+      trace_write_string(file, event.name.c_str());
+    }
+    fprintf(file, "}");
+  }
+  thread.events.clear();
+}
+
+static TraceThread &trace_thread_ensure()
+{
+  if (trace_thread_session_index != trace_session_index) {
+    std::lock_guard lock{trace_session->mutex};
+    std::unique_ptr<TraceThread> thread = std::make_unique<TraceThread>();
+    thread->id = trace_session->threads.size() + 1;
+    thread->is_main = BLI_thread_is_main();
+    thread->events.reserve(TRACE_FLUSH_EVENTS);
+    trace_write_thread_name(trace_session->file, *thread, trace_session->threads.is_empty());
+    trace_thread = thread.get();
+    trace_thread_session_index = trace_session_index;
+    trace_session->threads.append(std::move(thread));
+  }
+  return *trace_thread;
+}
+
+static void trace_add_event(TraceEvent &&event)
+{
+  TraceThread &thread = trace_thread_ensure();
+  thread.events.append(std::move(event));
+  if (thread.events.size() >= TRACE_FLUSH_EVENTS) {
+    std::lock_guard lock{trace_session->mutex};
+    trace_write_events(*trace_session, thread);
+    fflush(trace_session->file);
+  }
+}
+
+}  // namespace blender
+
+using namespace blender;
+
+void BLI_trace_init(const char *filepath)
+{
+  BLI_trace_exit();
+
+  FILE *file = BLI_fopen(filepath, "w");
+  if (file == nullptr) {
+    fprintf(stderr, "Could not write trace to '%s'\n", filepath);
+    return;
+  }
+  fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+
+  trace_session = new TraceSession();
+  trace_session->start_time = Clock::now();
+  trace_session->file = file;
+  trace_session_index++;
+  trace_is_enabled = true;
+}
+
+void BLI_trace_exit(void)
+{
+  if (trace_session == nullptr) {
+    return;
+  }
+  trace_is_enabled = false;
+
+  for (std::unique_ptr<TraceThread> &thread : trace_session->threads) {
+    trace_write_events(*trace_session, *thread);
+  }
+  fprintf(trace_session->file, "\n]}\n");
+  fclose(trace_session->file);
+
+  delete trace_session;
+  trace_session = nullptr;
+}
+
+bool BLI_trace_is_enabled(void)
+{
+  return trace_is_enabled;
+}
+
+void BLI_trace_begin(const char *category, const char *name)
+{
+  if (!trace_is_enabled) {
+    return;
+  }
+  trace_add_event({'B', Clock::now(), category, name});
+}
+
+void BLI_trace_end(void)
+{
+  if (!trace_is_enabled) {
+    return;
+  }
+  trace_add_event({'E', Clock::now(), nullptr, {}});
+}
@@ -6,6 +6,7 @@
 
 #include "BLI_expr_pylike_eval.h"
 #include "BLI_math.h"
+#include "BLI_noise.h"
 
 #define TRUE_VAL 1.0
 #define FALSE_VAL 0.0
@@ -112,6 +113,13 @@ TEST_PARSE_FAIL(Truncated8, "1 or")
 TEST_PARSE_FAIL(Truncated9, "sqrt(1")
 TEST_PARSE_FAIL(Truncated10, "fmod(1,")
 
+TEST_PARSE_FAIL(NoiseModule, "noise")
+TEST_PARSE_FAIL(NoiseBadFunc, "noise.random()")
+TEST_PARSE_FAIL(NoiseBadArgs1, "noise.noise(1, 2, 3)")
+TEST_PARSE_FAIL(NoiseBadArgs2, "noise.noise((1, 2))")
+TEST_PARSE_FAIL(NoiseBadArgs3, "noise.noise((1, 2, 3]")
+TEST_PARSE_FAIL(NoiseBadArgs4, "noise.noise((1, 2, 3), noise_basis='BLENDER')")
+
 /* Constant expression with working constant folding */
 #define TEST_CONST(name, str, value) \
   TEST(expr_pylike, Const_##name) \
@@ -143,6 +151,8 @@ TEST_CONST(TenE, "1.e+1", 10.0)
 TEST_CONST(Half, ".5", 0.5)
 
 TEST_CONST(Pi, "pi", M_PI)
+TEST_CONST(Tau, "tau", M_PI * 2.0)
+TEST_CONST(E, "e", M_E)
 TEST_CONST(True, "True", TRUE_VAL)
 TEST_CONST(False, "False", FALSE_VAL)
 
@@ -156,6 +166,20 @@ TEST_CONST(Pow, "pow(4, 0.5)", 2.0)
 TEST_EVAL(Pow, "pow(4, x)", 0.5, 2.0)
 
 TEST_CONST(Log2_1, "log(4, 2)", 2.0)
+TEST_CONST(Log2_2, "log2(8)", 3.0)
+TEST_CONST(Log10, "log10(100)", 2.0)
+TEST_EVAL(Log10, "log10(x)", 1000.0, 3.0)
+
+TEST_CONST(Hypot, "hypot(3, 4)", 5.0)
+TEST_EVAL(Hypot, "hypot(x, 4)", 3.0, 5.0)
+
+TEST_CONST(Copysign, "copysign(2, -1)", -2.0)
+TEST_CONST(Tanh, "tanh(0)", 0.0)
+
+TEST_CONST(Float, "float(True)", 1.0)
+TEST_CONST(Bool1, "bool(-0.5)", TRUE_VAL)
+TEST_CONST(Bool2, "bool(0)", FALSE_VAL)
+TEST_EVAL(Bool, "bool(x) + 1", 2.0, 2.0)
 
 TEST_CONST(Round1, "round(-0.5)", -1.0)
 TEST_CONST(Round2, "round(-0.4)", 0.0)
@@ -288,6 +312,28 @@ TEST(expr_pylike, Eval_Ternary1)
   BLI_expr_pylike_free(expr);
 }
 
+TEST(expr_pylike, Eval_Noise)
+{
+  ExprPyLike_Parsed *expr = parse_for_eval("noise.noise((x, 0.25, 1.5))", true);
+
+  for (int i = 0; i <= 10; i++) {
+    double x = i * 0.35;
+    double v = 2.0f * BLI_noise_generic_noise(1.0f, (float)x, 0.25f, 1.5f, false, 1) - 1.0f;
+
+    verify_eval_result(expr, x, v);
+  }
+
+  BLI_expr_pylike_free(expr);
+}
+
+TEST(expr_pylike, Const_Noise)
+{
+  const double value = 2.0f * BLI_noise_generic_noise(1.0f, 0.5f, 0.25f, 1.5f, false, 1) - 1.0f;
+
+  expr_pylike_const_test("noise.noise((0.5, 0.25, 1.5))", value, true);
+  expr_pylike_const_test("noise.noise([0.5, 0.25, 1.5]) * 1", value, true);
+}
+
 TEST(expr_pylike, MultipleArgs)
 {
   const char *names[3] = {"x", "y", "x"};
@@ -0,0 +1,103 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include <string>
+#include <thread>
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_fileops.h"
+#include "BLI_path_util.h"
+#include "BLI_trace.h"
+
+namespace blender::tests {
+
+static std::string trace_read_and_delete(const char *filepath)
+{
+  size_t size = 0;
+  char *mem = (char *)BLI_file_read_text_as_mem(filepath, 0, &size);
+  if (mem == nullptr) {
+    return "";
+  }
+  std::string text(mem, size);
+  MEM_freeN(mem);
+  BLI_delete(filepath, false, false);
+  return text;
+}
+
+static int count_occurrences(const std::string &text, const std::string &str)
+{
+  int count = 0;
+  for (size_t pos = text.find(str); pos != std::string::npos; pos = text.find(str, pos + 1)) {
+    count++;
+  }
+  return count;
+}
+
+TEST(trace, Disabled)
+{
+  EXPECT_FALSE(BLI_trace_is_enabled());
+  /* Does nothing without a session. */
+  BLI_trace_begin("test", "event");
+  BLI_trace_end();
+}
+
+TEST(trace, WriteEvents)
+{
+  char filepath[FILE_MAX];
+  BLI_join_dirfile(filepath, sizeof(filepath), ::testing::TempDir().c_str(), "trace.json");
+
+  BLI_trace_init(filepath);
+  EXPECT_TRUE(BLI_trace_is_enabled());
+  {
+    TraceScope outer("test", "outer");
+    TraceScope inner("test", "inner \"quoted\"");
+  }
+  std::thread thread([]() { TraceScope scope("test", "other thread"); });
+  thread.join();
+  BLI_trace_exit();
+  EXPECT_FALSE(BLI_trace_is_enabled());
+
+  const std::string text = trace_read_and_delete(filepath);
+  EXPECT_EQ(text.find("{\"displayTimeUnit\":\"ms\",\"traceEvents\":["), 0);
+  EXPECT_NE(text.find("\"name\":\"outer\""), std::string::npos);
+  EXPECT_NE(text.find("\"name\":\"inner \\\"quoted\\\"\""), std::string::npos);
+  EXPECT_NE(text.find("\"name\":\"other thread\""), std::string::npos);
+  EXPECT_EQ(count_occurrences(text, "\"ph\":\"B\""), 3);
+  EXPECT_EQ(count_occurrences(text, "\"ph\":\"E\""), 3);
+  /* Events of both threads are written with their own thread id. */
+  EXPECT_EQ(count_occurrences(text, "\"name\":\"thread_name\""), 2);
+}
+
+TEST(trace, WriteWhileRecording)
+{
+  char filepath[FILE_MAX];
+  BLI_join_dirfile(filepath, sizeof(filepath), ::testing::TempDir().c_str(), "trace.json");
+
+  /* More events than are buffered by a thread. */
+  const int events_num = 100000;
+  BLI_trace_init(filepath);
+  for (int i = 0; i < events_num; i++) {
+    TraceScope scope("test", "event");
+  }
+
+  /* Only the events which did not fill a batch are still buffered. */
+  size_t size = 0;
+  char *mem = (char *)BLI_file_read_text_as_mem(filepath, 0, &size);
+  ASSERT_NE(mem, nullptr);
+  const std::string text_recording(mem, size);
+  MEM_freeN(mem);
+  const int begin_written = count_occurrences(text_recording, "\"ph\":\"B\"");
+  EXPECT_GT(begin_written, events_num / 2);
+  EXPECT_LT(begin_written, events_num);
+
+  BLI_trace_exit();
+
+  const std::string text = trace_read_and_delete(filepath);
+  EXPECT_EQ(count_occurrences(text, "\"ph\":\"B\""), events_num);
+  EXPECT_EQ(count_occurrences(text, "\"ph\":\"E\""), events_num);
+  EXPECT_EQ(text.rfind("\n]}\n"), text.size() - 4);
+}
+
+}  // namespace blender::tests
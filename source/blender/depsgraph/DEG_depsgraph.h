@@ -164,6 +164,29 @@ void DEG_evaluate_on_framechange(Depsgraph *graph, float frame);
 /* Data changed recalculation entry point. */
 void DEG_evaluate_on_refresh(Depsgraph *graph);
 
+/* Multi-Frame Evaluation  ----------------------- */
+
+/* Evaluates a sequence of frames on several dependency graphs at the same time, each graph on its
+ * own thread. Frames are consumed in order, while the following ones are being evaluated.
+ *
+ * Only meant for exporters and bakers of scenes whose frames do not depend on each other: the
+ * original scene frame is not changed and frame change handlers are not run. */
+typedef struct DepsgraphFrameEvaluator DepsgraphFrameEvaluator;
+
+/* The graphs are owned by the caller. They must be built from the same data and evaluated once,
+ * so that the evaluated scene exists. */
+DepsgraphFrameEvaluator *DEG_frame_evaluator_new(Depsgraph **graphs,
+                                                 int graphs_num,
+                                                 const float *frames,
+                                                 int frames_num);
+
+/* Wait for the next frame to be evaluated and return the graph it was evaluated on, or NULL
+ * after the last frame. The graph is only to be used until the next call. */
+Depsgraph *DEG_frame_evaluator_next(DepsgraphFrameEvaluator *evaluator, float *r_frame);
+
+/* Frames which were not consumed yet are skipped. */
+void DEG_frame_evaluator_free(DepsgraphFrameEvaluator *evaluator);
+
 /* Editors Integration  -------------------------- */
 
 /* Mechanism to allow editors to be informed of depsgraph updates,
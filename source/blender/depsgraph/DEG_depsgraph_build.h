@@ -78,6 +78,11 @@ void DEG_graph_relations_update(struct Depsgraph *graph);
 /* Tag all relations in the database for update. */
 void DEG_relations_tag_update(struct Main *bmain);
 
+/* Tag relations of the given ID for update, for changes which do not affect other IDs, such as
+ * adding or removing a modifier or constraint. Allows graphs to only rebuild the nodes and
+ * relations around this ID instead of the whole graph. */
+void DEG_id_relations_tag_update(struct Main *bmain, struct ID *id);
+
 /* Add Dependencies  ----------------------------- */
 
 /* Handle for components to define their dependencies from callbacks.
@@ -35,6 +35,8 @@
 #include "BLI_utildefines.h"
 
 #include "BKE_action.h"
+#include "BKE_anim_data.h"
+#include "BKE_animsys.h"
 
 #include "intern/builder/deg_builder_cache.h"
 #include "intern/builder/deg_builder_remove_noop.h"
@@ -197,6 +199,75 @@ void deg_graph_build_flush_visibility(Depsgraph *graph)
   BLI_stack_free(stack);
 }
 
+/* Flush visibility of the components of the given ID nodes to the components they depend on.
+ * Components of other ID nodes keep visibility of a previous build, so it is only extended. */
+void deg_graph_build_flush_visibility(Span<IDNode *> id_nodes,
+                                      VectorSet<IDNode *> &r_changed_id_nodes)
+{
+  Vector<ComponentNode *> stack;
+  for (IDNode *id_node : id_nodes) {
+    for (ComponentNode *comp_node : id_node->components.values()) {
+      comp_node->affects_directly_visible |= id_node->is_directly_visible;
+      if (comp_node->affects_directly_visible) {
+        stack.append(comp_node);
+      }
+    }
+  }
+  while (!stack.is_empty()) {
+    ComponentNode *comp_node = stack.pop_last();
+    for (OperationNode *op_node : comp_node->operations) {
+      for (Relation *rel : op_node->inlinks) {
+        if (rel->from->type != NodeType::OPERATION) {
+          continue;
+        }
+        ComponentNode *comp_from = ((OperationNode *)rel->from)->owner;
+        if (!comp_from->affects_directly_visible) {
+          comp_from->affects_directly_visible = true;
+          r_changed_id_nodes.add(comp_from->owner);
+          stack.append(comp_from);
+        }
+      }
+    }
+  }
+}
+
+void deg_graph_build_finalize_id_node(Main *bmain, Depsgraph *graph, IDNode *id_node)
+{
+  ID *id_orig = id_node->id_orig;
+  id_node->finalize_build(graph);
+  int flag = 0;
+  /* Tag rebuild if special evaluation flags changed. */
+  if (id_node->eval_flags != id_node->previous_eval_flags) {
+    flag |= ID_RECALC_TRANSFORM | ID_RECALC_GEOMETRY;
+  }
+  /* Tag rebuild if the custom data mask changed. */
+  if (id_node->customdata_masks != id_node->previous_customdata_masks) {
+    flag |= ID_RECALC_GEOMETRY;
+  }
+  if (deg_copy_on_write_is_expanded(id_node->id_cow)) {
+    /* Resolved animation paths might point to data which was re-allocated by the builder (pose
+     * channels for example), resolve them again on the next evaluation. */
+    AnimData *adt = BKE_animdata_from_id(id_node->id_cow);
+    if (adt != nullptr) {
+      BKE_animsys_free_binding_cache(adt);
+    }
+  }
+  else {
+    flag |= ID_RECALC_COPY_ON_WRITE;
+    /* This means ID is being added to the dependency graph first
+     * time, which is similar to "ob-visible-change" */
+    if (GS(id_orig->name) == ID_OB) {
+      flag |= ID_RECALC_TRANSFORM | ID_RECALC_GEOMETRY;
+    }
+  }
+  /* Restore recalc flags from original ID, which could possibly contain recalc flags set by
+   * an operator and then were carried on by the undo system. */
+  flag |= id_orig->recalc;
+  if (flag != 0) {
+    graph_id_tag_update(bmain, graph, id_node->id_orig, flag, DEG_UPDATE_SOURCE_RELATIONS);
+  }
+}
+
 }  // namespace
 
 void deg_graph_build_finalize(Main *bmain, Depsgraph *graph)
@@ -208,32 +279,41 @@ void deg_graph_build_finalize(Main *bmain, Depsgraph *graph)
   /* Re-tag IDs for update if it was tagged before the relations
    * update tag. */
   for (IDNode *id_node : graph->id_nodes) {
-    ID *id_orig = id_node->id_orig;
+    deg_graph_build_finalize_id_node(bmain, graph, id_node);
+  }
+  graph->need_update_priorities = true;
+}
+
+void deg_graph_build_finalize(Main *bmain, Depsgraph *graph, Span<IDNode *> id_nodes)
+{
+  for (IDNode *id_node : id_nodes) {
     id_node->finalize_build(graph);
-    int flag = 0;
-    /* Tag rebuild if special evaluation flags changed. */
-    if (id_node->eval_flags != id_node->previous_eval_flags) {
-      flag |= ID_RECALC_TRANSFORM | ID_RECALC_GEOMETRY;
-    }
-    /* Tag rebuild if the custom data mask changed. */
-    if (id_node->customdata_masks != id_node->previous_customdata_masks) {
-      flag |= ID_RECALC_GEOMETRY;
-    }
-    if (!deg_copy_on_write_is_expanded(id_node->id_cow)) {
-      flag |= ID_RECALC_COPY_ON_WRITE;
-      /* This means ID is being added to the dependency graph first
-       * time, which is similar to "ob-visible-change" */
-      if (GS(id_orig->name) == ID_OB) {
-        flag |= ID_RECALC_TRANSFORM | ID_RECALC_GEOMETRY;
-      }
-    }
-    /* Restore recalc flags from original ID, which could possibly contain recalc flags set by
-     * an operator and then were carried on by the undo system. */
-    flag |= id_orig->recalc;
-    if (flag != 0) {
-      graph_id_tag_update(bmain, graph, id_node->id_orig, flag, DEG_UPDATE_SOURCE_RELATIONS);
+  }
+  graph->need_update_priorities = true;
+
+  VectorSet<IDNode *> visibility_changed_id_nodes;
+  deg_graph_build_flush_visibility(id_nodes, visibility_changed_id_nodes);
+
+  Vector<OperationNode *> operations;
+  for (IDNode *id_node : id_nodes) {
+    for (ComponentNode *comp_node : id_node->components.values()) {
+      operations.extend(comp_node->operations);
     }
   }
+  deg_graph_remove_unused_noops(graph, operations);
+
+  for (IDNode *id_node : id_nodes) {
+    deg_graph_build_finalize_id_node(bmain, graph, id_node);
+    graph_tag_id_for_visible_update(bmain, graph, id_node, false);
+  }
+  /* Other IDs only need to be evaluated for the components which became visible. */
+  for (IDNode *id_node : id_nodes) {
+    visibility_changed_id_nodes.remove(id_node);
+  }
+  for (IDNode *id_node : visibility_changed_id_nodes) {
+    id_node->finalize_build(graph);
+    graph_tag_id_for_visible_update(bmain, graph, id_node, false);
+  }
 }
 
 }  // namespace blender::deg
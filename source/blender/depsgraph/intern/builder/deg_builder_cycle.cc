@@ -60,7 +60,8 @@ struct CyclesSolverState {
   CyclesSolverState(Depsgraph *graph)
       : graph(graph),
         traversal_stack(BLI_stack_new(sizeof(StackEntry), "DEG detect cycles stack")),
-        num_cycles(0)
+        num_cycles(0),
+        scope_nodes(nullptr)
   {
     /* pass */
   }
@@ -74,6 +75,9 @@ struct CyclesSolverState {
   Depsgraph *graph;
   BLI_Stack *traversal_stack;
   int num_cycles;
+  /* When set, the traversal does not leave these nodes. Flags of all other nodes are left from a
+   * previous traversal. */
+  const Set<OperationNode *> *scope_nodes;
 };
 
 inline void set_node_visited_state(Node *node, eCyclicCheckVisitedState state)
@@ -96,6 +100,11 @@ inline int get_node_num_visited_children(Node *node)
   return node->custom_flags >> 2;
 }
 
+inline bool is_node_in_scope(const CyclesSolverState *state, OperationNode *node)
+{
+  return state->scope_nodes == nullptr || state->scope_nodes->contains(node);
+}
+
 void schedule_node_to_stack(CyclesSolverState *state, OperationNode *node)
 {
   StackEntry entry;
@@ -179,8 +188,15 @@ void solve_cycles(CyclesSolverState *state)
     const int num_visited = get_node_num_visited_children(node);
     for (int i = num_visited; i < node->outlinks.size(); i++) {
       Relation *rel = node->outlinks[i];
+      if (rel->flag & RELATION_FLAG_CYCLIC) {
+        /* Cycle is already solved. */
+        continue;
+      }
       if (rel->to->type == NodeType::OPERATION) {
         OperationNode *to = (OperationNode *)rel->to;
+        if (!is_node_in_scope(state, to)) {
+          continue;
+        }
         eCyclicCheckVisitedState to_state = get_node_visited_state(to);
         if (to_state == NODE_IN_STACK) {
           string cycle_str = "  " + to->full_identifier() + " depends on\n  " +
@@ -234,4 +250,39 @@ void deg_graph_detect_cycles(Depsgraph *graph)
   }
 }
 
+void deg_graph_detect_cycles(Depsgraph *graph, Span<OperationNode *> roots)
+{
+  /* Any new cycle goes through one of the roots, so all of its nodes depend on a root. Only those
+   * nodes are traversed, which avoids visiting everything which is evaluated after the roots. */
+  Set<OperationNode *> scope_nodes;
+  Vector<OperationNode *> queue;
+  for (OperationNode *node : roots) {
+    if (scope_nodes.add(node)) {
+      queue.append(node);
+    }
+  }
+  while (!queue.is_empty()) {
+    OperationNode *node = queue.pop_last();
+    node->custom_flags = 0;
+    for (Relation *rel : node->inlinks) {
+      if (rel->flag & RELATION_FLAG_CYCLIC || rel->from->type != NodeType::OPERATION) {
+        continue;
+      }
+      OperationNode *from = (OperationNode *)rel->from;
+      if (scope_nodes.add(from)) {
+        queue.append(from);
+      }
+    }
+  }
+
+  CyclesSolverState state(graph);
+  state.scope_nodes = &scope_nodes;
+  for (OperationNode *node : roots) {
+    if (get_node_visited_state(node) == NODE_NOT_VISITED) {
+      schedule_node_to_stack(&state, node);
+      solve_cycles(&state);
+    }
+  }
+}
+
 }  // namespace blender::deg
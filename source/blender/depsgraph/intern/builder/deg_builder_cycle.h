@@ -23,13 +23,19 @@
 
 #pragma once
 
+#include "BLI_span.hh"
+
 namespace blender {
 namespace deg {
 
 struct Depsgraph;
+struct OperationNode;
 
 /* Detect and solve dependency cycles. */
 void deg_graph_detect_cycles(Depsgraph *graph);
+/* Detect and solve dependency cycles reachable from the given operations only, keeping the
+ * cycles which were solved by a previous detection. */
+void deg_graph_detect_cycles(Depsgraph *graph, Span<OperationNode *> roots);
 
 }  // namespace deg
 }  // namespace blender
@@ -25,6 +25,8 @@
 
 #include "DNA_ID.h"
 
+#include "intern/depsgraph.h"
+
 namespace blender::deg {
 
 bool BuilderMap::checkIsBuilt(ID *id, int tag) const
@@ -34,20 +36,43 @@ bool BuilderMap::checkIsBuilt(ID *id, int tag) const
 
 void BuilderMap::tagBuild(ID *id, int tag)
 {
-  id_tags_.lookup_or_add(id, 0) |= tag;
+  id_tags_.lookup_or_add_cb(id, [&]() { return getInitialIDTag(id); }) |= tag;
 }
 
 bool BuilderMap::checkIsBuiltAndTag(ID *id, int tag)
 {
-  int &id_tag = id_tags_.lookup_or_add(id, 0);
+  int &id_tag = id_tags_.lookup_or_add_cb(id, [&]() { return getInitialIDTag(id); });
   const bool result = (id_tag & tag) == tag;
   id_tag |= tag;
   return result;
 }
 
+void BuilderMap::setGraphBuilt(const Depsgraph *graph)
+{
+  built_graph_ = graph;
+}
+
+void BuilderMap::tagNeedsBuild(ID *id)
+{
+  ids_to_build_.add(id);
+}
+
 int BuilderMap::getIDTag(ID *id) const
 {
-  return id_tags_.lookup_default(id, 0);
+  const int *id_tag = id_tags_.lookup_ptr(id);
+  if (id_tag != nullptr) {
+    return *id_tag;
+  }
+  return getInitialIDTag(id);
+}
+
+int BuilderMap::getInitialIDTag(ID *id) const
+{
+  if (built_graph_ != nullptr && !ids_to_build_.contains(id) &&
+      built_graph_->find_id_node(id) != nullptr) {
+    return TAG_COMPLETE;
+  }
+  return 0;
 }
 
 }  // namespace blender::deg
@@ -30,6 +30,8 @@ struct ID;
 namespace blender {
 namespace deg {
 
+struct Depsgraph;
+
 class BuilderMap {
  public:
   enum {
@@ -57,6 +59,11 @@ class BuilderMap {
    * handled otherwise and return false. */
   bool checkIsBuiltAndTag(ID *id, int tag = TAG_COMPLETE);
 
+  /* Consider IDs which have nodes in the graph as built, except for the ones tagged with
+   * #tagNeedsBuild. Used to build on top of a previous build of the graph. */
+  void setGraphBuilt(const Depsgraph *graph);
+  void tagNeedsBuild(ID *id);
+
   template<typename T> bool checkIsBuilt(T *datablock, int tag = TAG_COMPLETE) const
   {
     return checkIsBuilt(&datablock->id, tag);
@@ -72,8 +79,11 @@ class BuilderMap {
 
  protected:
   int getIDTag(ID *id) const;
+  int getInitialIDTag(ID *id) const;
 
   Map<ID *, int> id_tags_;
+  const Depsgraph *built_graph_ = nullptr;
+  Set<ID *> ids_to_build_;
 };
 
 }  // namespace deg
@@ -139,7 +139,8 @@ DepsgraphNodeBuilder::DepsgraphNodeBuilder(Main *bmain,
       view_layer_(nullptr),
       view_layer_index_(-1),
       collection_(nullptr),
-      is_parent_collection_visible_(true)
+      is_parent_collection_visible_(true),
+      is_partial_build_(false)
 {
 }
 
@@ -161,22 +162,24 @@ IDNode *DepsgraphNodeBuilder::add_id_node(ID *id)
   const ID_Type id_type = GS(id->name);
   IDNode *id_node = nullptr;
   ID *id_cow = nullptr;
-  IDComponentsMask previously_visible_components_mask = 0;
-  uint32_t previous_eval_flags = 0;
-  DEGCustomDataMeshMasks previous_customdata_masks;
   IDInfo *id_info = id_info_hash_.lookup_default(id->session_uuid, nullptr);
   if (id_info != nullptr) {
     id_cow = id_info->id_cow;
-    previously_visible_components_mask = id_info->previously_visible_components_mask;
-    previous_eval_flags = id_info->previous_eval_flags;
-    previous_customdata_masks = id_info->previous_customdata_masks;
     /* Tag ID info to not free the CoW ID pointer. */
     id_info->id_cow = nullptr;
   }
+  if (is_partial_build_ && graph_->find_id_node(id) == nullptr) {
+    /* IDs which are new to the graph are built, the other ones are kept as-is. */
+    built_map_.tagNeedsBuild(id);
+  }
   id_node = graph_->add_id_node(id, id_cow);
-  id_node->previously_visible_components_mask = previously_visible_components_mask;
-  id_node->previous_eval_flags = previous_eval_flags;
-  id_node->previous_customdata_masks = previous_customdata_masks;
+  /* NOTE: Nodes which are kept from the previous build on a partial rebuild have no info, their
+   * previous state is to be preserved. */
+  if (id_info != nullptr) {
+    id_node->previously_visible_components_mask = id_info->previously_visible_components_mask;
+    id_node->previous_eval_flags = id_info->previous_eval_flags;
+    id_node->previous_customdata_masks = id_info->previous_customdata_masks;
+  }
   /* NOTE: Zero number of components indicates that ID node was just created. */
   if (id_node->components.is_empty() && deg_copy_on_write_is_needed(id_type)) {
     ComponentNode *comp_cow = id_node->add_component(NodeType::COPY_ON_WRITE);
@@ -345,16 +348,7 @@ void DepsgraphNodeBuilder::begin_build()
   }
 
   for (OperationNode *op_node : graph_->entry_tags) {
-    ComponentNode *comp_node = op_node->owner;
-    IDNode *id_node = comp_node->owner;
-
-    SavedEntryTag entry_tag;
-    entry_tag.id_orig = id_node->id_orig;
-    entry_tag.component_type = comp_node->type;
-    entry_tag.opcode = op_node->opcode;
-    entry_tag.name = op_node->name;
-    entry_tag.name_tag = op_node->name_tag;
-    saved_entry_tags_.append(entry_tag);
+    save_entry_tag(op_node);
   }
 
   /* Make sure graph has no nodes left from previous state. */
@@ -363,6 +357,45 @@ void DepsgraphNodeBuilder::begin_build()
   graph_->entry_tags.clear();
 }
 
+void DepsgraphNodeBuilder::begin_build_objects(const Set<Object *> &objects)
+{
+  is_partial_build_ = true;
+  built_map_.setGraphBuilt(graph_);
+  for (Object *object : objects) {
+    built_map_.tagNeedsBuild(&object->id);
+    IDNode *id_node = graph_->find_id_node(&object->id);
+    for (ComponentNode *comp_node : id_node->components.values()) {
+      for (OperationNode *op_node : comp_node->operations) {
+        if (graph_->entry_tags.contains(op_node)) {
+          save_entry_tag(op_node);
+        }
+      }
+    }
+  }
+}
+
+void DepsgraphNodeBuilder::end_build_objects(Span<ID *> ids)
+{
+  tag_previously_tagged_nodes();
+  for (ID *id : ids) {
+    update_invalid_cow_pointers(graph_->find_id_node(id));
+  }
+}
+
+void DepsgraphNodeBuilder::save_entry_tag(const OperationNode *op_node)
+{
+  ComponentNode *comp_node = op_node->owner;
+  IDNode *id_node = comp_node->owner;
+
+  SavedEntryTag entry_tag;
+  entry_tag.id_orig = id_node->id_orig;
+  entry_tag.component_type = comp_node->type;
+  entry_tag.opcode = op_node->opcode;
+  entry_tag.name = op_node->name;
+  entry_tag.name_tag = op_node->name_tag;
+  saved_entry_tags_.append(entry_tag);
+}
+
 /* Util callbacks for `BKE_library_foreach_ID_link`, used to detect when a COW ID is using ID
  * pointers that are either:
  *  - COW ID pointers that do not exist anymore in current depsgraph.
@@ -439,42 +472,47 @@ static int foreach_id_cow_detect_need_for_update_callback(LibraryIDLinkCallbackD
 void DepsgraphNodeBuilder::update_invalid_cow_pointers()
 {
   for (const IDNode *id_node : graph_->id_nodes) {
-    if (id_node->previously_visible_components_mask == 0) {
-      /* Newly added node/ID, no need to check it. */
-      continue;
-    }
-    if (ELEM(id_node->id_cow, id_node->id_orig, nullptr)) {
-      /* Node/ID with no COW data, no need to check it. */
-      continue;
-    }
-    if ((id_node->id_cow->recalc & ID_RECALC_COPY_ON_WRITE) != 0) {
-      /* Node/ID already tagged for COW flush, no need to check it. */
-      continue;
-    }
-    if ((id_node->id_cow->flag & LIB_EMBEDDED_DATA) != 0) {
-      /* For now, we assume embedded data are managed by their owner IDs and do not need to be
-       * checked here.
-       *
-       * NOTE: This exception somewhat weak, and ideally should not be needed. Currently however,
-       * embedded data are handled as full local (private) data of their owner IDs in part of
-       * Blender (like read/write code, including undo/redo), while depsgraph generally treat them
-       * as regular independent IDs. This leads to inconsistencies that can lead to bad level
-       * memory accesses.
-       *
-       * E.g. when undoing creation/deletion of a collection directly child of a scene's master
-       * collection, the scene itself is re-read in place, but its master collection becomes a
-       * completely new different pointer, and the existing COW of the old master collection in the
-       * matching deg node is therefore pointing to fully invalid (freed) memory. */
-      continue;
-    }
-    BKE_library_foreach_ID_link(nullptr,
-                                id_node->id_cow,
-                                deg::foreach_id_cow_detect_need_for_update_callback,
-                                this,
-                                IDWALK_IGNORE_EMBEDDED_ID | IDWALK_READONLY);
+    update_invalid_cow_pointers(id_node);
   }
 }
 
+void DepsgraphNodeBuilder::update_invalid_cow_pointers(const IDNode *id_node)
+{
+  if (id_node->previously_visible_components_mask == 0) {
+    /* Newly added node/ID, no need to check it. */
+    return;
+  }
+  if (ELEM(id_node->id_cow, id_node->id_orig, nullptr)) {
+    /* Node/ID with no COW data, no need to check it. */
+    return;
+  }
+  if ((id_node->id_cow->recalc & ID_RECALC_COPY_ON_WRITE) != 0) {
+    /* Node/ID already tagged for COW flush, no need to check it. */
+    return;
+  }
+  if ((id_node->id_cow->flag & LIB_EMBEDDED_DATA) != 0) {
+    /* For now, we assume embedded data are managed by their owner IDs and do not need to be
+     * checked here.
+     *
+     * NOTE: This exception somewhat weak, and ideally should not be needed. Currently however,
+     * embedded data are handled as full local (private) data of their owner IDs in part of
+     * Blender (like read/write code, including undo/redo), while depsgraph generally treat them
+     * as regular independent IDs. This leads to inconsistencies that can lead to bad level
+     * memory accesses.
+     *
+     * E.g. when undoing creation/deletion of a collection directly child of a scene's master
+     * collection, the scene itself is re-read in place, but its master collection becomes a
+     * completely new different pointer, and the existing COW of the old master collection in the
+     * matching deg node is therefore pointing to fully invalid (freed) memory. */
+    return;
+  }
+  BKE_library_foreach_ID_link(nullptr,
+                              id_node->id_cow,
+                              deg::foreach_id_cow_detect_need_for_update_callback,
+                              this,
+                              IDWALK_IGNORE_EMBEDDED_ID | IDWALK_READONLY);
+}
+
 void DepsgraphNodeBuilder::tag_previously_tagged_nodes()
 {
   for (const SavedEntryTag &entry_tag : saved_entry_tags_) {
@@ -1185,6 +1223,17 @@ void DepsgraphNodeBuilder::build_driver_variables(ID *id, FCurve *fcurve)
   }
 }
 
+void DepsgraphNodeBuilder::build_driver_variables(ID *id)
+{
+  AnimData *adt = BKE_animdata_from_id(id);
+  if (adt == nullptr) {
+    return;
+  }
+  LISTBASE_FOREACH (FCurve *, fcurve, &adt->drivers) {
+    build_driver_variables(id, fcurve);
+  }
+}
+
 void DepsgraphNodeBuilder::build_driver_id_property(ID *id, const char *rna_path)
 {
   if (id == nullptr || rna_path == nullptr) {
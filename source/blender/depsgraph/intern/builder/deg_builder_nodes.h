@@ -101,6 +101,12 @@ class DepsgraphNodeBuilder : public DepsgraphBuilder {
   virtual void begin_build();
   virtual void end_build();
 
+  /* Build on top of the previous build of the graph, where only the nodes of the given objects
+   * are built again, after the caller removed their components. */
+  void begin_build_objects(const Set<Object *> &objects);
+  /* Same as #end_build, but only the copy-on-write pointers of the given IDs are checked. */
+  void end_build_objects(Span<ID *> ids);
+
   int foreach_id_cow_detect_need_for_update_callback(ID *id_cow_self, ID *id_pointer);
 
   IDNode *add_id_node(ID *id);
@@ -167,6 +173,11 @@ class DepsgraphNodeBuilder : public DepsgraphBuilder {
   virtual void build_view_layer(Scene *scene,
                                 ViewLayer *view_layer,
                                 eDepsNode_LinkedState_Type linked_state);
+  /* Build nodes of objects which are in the graph already but had all their components removed,
+   * see #begin_build_objects. */
+  virtual void build_view_layer_objects(Scene *scene,
+                                        ViewLayer *view_layer,
+                                        const Set<Object *> &objects);
   virtual void build_collection(LayerCollection *from_layer_collection, Collection *collection);
   virtual void build_object(int base_index,
                             Object *object,
@@ -204,6 +215,8 @@ class DepsgraphNodeBuilder : public DepsgraphBuilder {
   virtual void build_action(bAction *action);
   virtual void build_driver(ID *id, FCurve *fcurve, int driver_index);
   virtual void build_driver_variables(ID *id, FCurve *fcurve);
+  /* Build nodes for the variables of all drivers of an ID which is kept from a previous build. */
+  virtual void build_driver_variables(ID *id);
   virtual void build_driver_id_property(ID *id, const char *rna_path);
   virtual void build_parameters(ID *id);
   virtual void build_dimensions(Object *object);
@@ -278,8 +291,10 @@ class DepsgraphNodeBuilder : public DepsgraphBuilder {
                               bool is_reference,
                               void *user_data);
 
+  void save_entry_tag(const OperationNode *op_node);
   void tag_previously_tagged_nodes();
   void update_invalid_cow_pointers();
+  void update_invalid_cow_pointers(const IDNode *id_node);
 
   /* State which demotes currently built entities. */
   Scene *scene_;
@@ -299,6 +314,8 @@ class DepsgraphNodeBuilder : public DepsgraphBuilder {
   /* Set of IDs which were already build. Makes it easier to keep track of
    * what was already built and what was not. */
   BuilderMap built_map_;
+  /* Nodes are added to the graph of a previous build, see #begin_build_objects. */
+  bool is_partial_build_;
 };
 
 }  // namespace deg
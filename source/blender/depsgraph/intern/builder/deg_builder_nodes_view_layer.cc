@@ -176,4 +176,34 @@ void DepsgraphNodeBuilder::build_view_layer(Scene *scene,
   }
 }
 
+void DepsgraphNodeBuilder::build_view_layer_objects(Scene *scene,
+                                                    ViewLayer *view_layer,
+                                                    const Set<Object *> &objects)
+{
+  view_layer_index_ = 0;
+  scene_ = scene;
+  view_layer_ = view_layer;
+  /* Base index needs to match the one of the full build. */
+  int base_index = 0;
+  int64_t num_objects_left = objects.size();
+  LISTBASE_FOREACH (Base *, base, &view_layer->object_bases) {
+    if (num_objects_left == 0) {
+      break;
+    }
+    if (need_pull_base_into_graph(base)) {
+      if (objects.contains(base->object)) {
+        build_object(base_index, base->object, DEG_ID_LINKED_DIRECTLY, true);
+        num_objects_left--;
+      }
+      base_index++;
+    }
+  }
+  /* Objects which are only pulled into the graph by other IDs. */
+  for (Object *object : objects) {
+    if (!built_map_.checkIsBuilt(object)) {
+      build_object(-1, object, DEG_ID_LINKED_INDIRECTLY, false);
+    }
+  }
+}
+
 }  // namespace blender::deg
@@ -238,6 +238,54 @@ bool object_have_geometry_component(const Object *object)
   return ELEM(object->type, OB_MESH, OB_CURVE, OB_FONT, OB_SURF, OB_MBALL, OB_LATTICE, OB_GPENCIL);
 }
 
+/* Flags of the relations from copy-on-write operation of an ID of the given type to the
+ * operations of the component. */
+int get_copy_on_write_relation_flag(const ID_Type id_type, const ComponentNode *comp_node)
+{
+  int rel_flag = (RELATION_FLAG_NO_FLUSH | RELATION_FLAG_GODMODE);
+  if ((ELEM(id_type, ID_ME, ID_HA, ID_PT, ID_VO) && comp_node->type == NodeType::GEOMETRY) ||
+      (id_type == ID_CF && comp_node->type == NodeType::CACHE)) {
+    rel_flag &= ~RELATION_FLAG_NO_FLUSH;
+  }
+  /* TODO(sergey): Needs better solution for this. */
+  if (id_type == ID_SO) {
+    rel_flag &= ~RELATION_FLAG_NO_FLUSH;
+  }
+  /* Notes on exceptions:
+   * - Parameters component is where drivers are living. Changing any
+   *   of the (custom) properties in the original datablock (even the
+   *   ones which do not imply other component update) need to make
+   *   sure drivers are properly updated.
+   *   This way, for example, changing ID property will properly poke
+   *   all drivers to be updated.
+   *
+   * - View layers have cached array of bases in them, which is not
+   *   copied by copy-on-write, and not preserved. PROBABLY it is better
+   *   to preserve that cache in copy-on-write, but for the time being
+   *   we allow flush to layer collections component which will ensure
+   *   that cached array of bases exists and is up-to-date. */
+  if (ELEM(comp_node->type, NodeType::PARAMETERS, NodeType::LAYER_COLLECTIONS)) {
+    rel_flag &= ~RELATION_FLAG_NO_FLUSH;
+  }
+  return rel_flag;
+}
+
+/* Dangling operations, which do not depend on anything else in their component, are to be
+ * executed after copy-on-write. */
+bool operation_is_dangling(const OperationNode *op_node)
+{
+  for (Relation *rel_current : op_node->inlinks) {
+    if (rel_current->from->type != NodeType::OPERATION) {
+      continue;
+    }
+    OperationNode *op_node_from = (OperationNode *)rel_current->from;
+    if (op_node_from->owner == op_node->owner) {
+      return false;
+    }
+  }
+  return true;
+}
+
 }  // namespace
 
 /* **** General purpose functions **** */
@@ -245,7 +293,10 @@ bool object_have_geometry_component(const Object *object)
 DepsgraphRelationBuilder::DepsgraphRelationBuilder(Main *bmain,
                                                    Depsgraph *graph,
                                                    DepsgraphBuilderCache *cache)
-    : DepsgraphBuilder(bmain, graph, cache), scene_(nullptr), rna_node_query_(graph, this)
+    : DepsgraphBuilder(bmain, graph, cache),
+      scene_(nullptr),
+      check_existing_relations_(false),
+      rna_node_query_(graph, this)
 {
 }
 
@@ -329,6 +380,9 @@ void DepsgraphRelationBuilder::add_customdata_mask(Object *object,
       BLI_assert_msg(0, "ID should always be valid");
     }
     else {
+      if (check_existing_relations_) {
+        save_id_node_state(id_node);
+      }
       id_node->customdata_masks |= customdata_masks;
     }
   }
@@ -341,15 +395,35 @@ void DepsgraphRelationBuilder::add_special_eval_flag(ID *id, uint32_t flag)
     BLI_assert_msg(0, "ID should always be valid");
   }
   else {
+    if (check_existing_relations_) {
+      save_id_node_state(id_node);
+    }
     id_node->eval_flags |= flag;
   }
 }
 
+void DepsgraphRelationBuilder::save_id_node_state(IDNode *id_node)
+{
+  if (!changed_id_nodes_.add(id_node)) {
+    return;
+  }
+  id_node->previous_eval_flags = id_node->eval_flags;
+  id_node->previous_customdata_masks = id_node->customdata_masks;
+}
+
+Span<IDNode *> DepsgraphRelationBuilder::get_changed_id_nodes() const
+{
+  return changed_id_nodes_;
+}
+
 Relation *DepsgraphRelationBuilder::add_time_relation(TimeSourceNode *timesrc,
                                                       Node *node_to,
                                                       const char *description,
                                                       int flags)
 {
+  if (check_existing_relations_) {
+    flags |= RELATION_CHECK_BEFORE_ADD;
+  }
   if (timesrc && node_to) {
     return graph_->add_new_relation(timesrc, node_to, description, flags);
   }
@@ -371,6 +445,9 @@ Relation *DepsgraphRelationBuilder::add_operation_relation(OperationNode *node_f
                                                            const char *description,
                                                            int flags)
 {
+  if (check_existing_relations_) {
+    flags |= RELATION_CHECK_BEFORE_ADD;
+  }
   if (node_from && node_to) {
     return graph_->add_new_relation(node_from, node_to, description, flags);
   }
@@ -1638,6 +1715,7 @@ void DepsgraphRelationBuilder::build_driver_variables(ID *id, FCurve *fcu)
       if (target_id == nullptr) {
         continue;
       }
+      graph_->driver_target_users.lookup_or_add_default(target_id).add(id);
       build_id(target_id);
       build_driver_id_property(target_id, dtar->rna_path);
       /* Look up the proxy - matches dtar_id_ensure_proxy_from during evaluation. */
@@ -1648,6 +1726,7 @@ void DepsgraphRelationBuilder::build_driver_variables(ID *id, FCurve *fcu)
           /* Redirect the target to the proxy, like in evaluation. */
           object = object->proxy_from;
           target_id = &object->id;
+          graph_->driver_target_users.lookup_or_add_default(target_id).add(id);
           /* Prepare the redirected target. */
           build_id(target_id);
           build_driver_id_property(target_id, dtar->rna_path);
@@ -2846,6 +2925,26 @@ void DepsgraphRelationBuilder::build_copy_on_write_relations()
   }
 }
 
+void DepsgraphRelationBuilder::build_copy_on_write_relations(OperationNode *op_node)
+{
+  ComponentNode *comp_node = op_node->owner;
+  ID *id_orig = comp_node->owner->id_orig;
+  const ID_Type id_type = GS(id_orig->name);
+  if (!deg_copy_on_write_is_needed(id_type) || comp_node->type == NodeType::COPY_ON_WRITE ||
+      !comp_node->depends_on_cow()) {
+    return;
+  }
+  /* Same as for the operations of a new ID, see above. */
+  if (op_node != comp_node->get_entry_operation() && !operation_is_dangling(op_node)) {
+    return;
+  }
+  OperationKey copy_on_write_key(id_orig, NodeType::COPY_ON_WRITE, OperationCode::COPY_ON_WRITE);
+  OperationNode *op_cow = find_node(copy_on_write_key)->get_exit_operation();
+  Relation *rel = graph_->add_new_relation(
+      op_cow, op_node, "CoW Dependency", RELATION_CHECK_BEFORE_ADD);
+  rel->flag |= get_copy_on_write_relation_flag(id_type, comp_node);
+}
+
 /* Nested datablocks (node trees, shape keys) requires special relation to
  * ensure owner's datablock remapping happens after node tree itself is ready.
  *
@@ -2903,31 +3002,7 @@ void DepsgraphRelationBuilder::build_copy_on_write_relations(IDNode *id_node)
       /* Component explicitly requests to not add relation. */
       continue;
     }
-    int rel_flag = (RELATION_FLAG_NO_FLUSH | RELATION_FLAG_GODMODE);
-    if ((ELEM(id_type, ID_ME, ID_HA, ID_PT, ID_VO) && comp_node->type == NodeType::GEOMETRY) ||
-        (id_type == ID_CF && comp_node->type == NodeType::CACHE)) {
-      rel_flag &= ~RELATION_FLAG_NO_FLUSH;
-    }
-    /* TODO(sergey): Needs better solution for this. */
-    if (id_type == ID_SO) {
-      rel_flag &= ~RELATION_FLAG_NO_FLUSH;
-    }
-    /* Notes on exceptions:
-     * - Parameters component is where drivers are living. Changing any
-     *   of the (custom) properties in the original datablock (even the
-     *   ones which do not imply other component update) need to make
-     *   sure drivers are properly updated.
-     *   This way, for example, changing ID property will properly poke
-     *   all drivers to be updated.
-     *
-     * - View layers have cached array of bases in them, which is not
-     *   copied by copy-on-write, and not preserved. PROBABLY it is better
-     *   to preserve that cache in copy-on-write, but for the time being
-     *   we allow flush to layer collections component which will ensure
-     *   that cached array of bases exists and is up-to-date. */
-    if (ELEM(comp_node->type, NodeType::PARAMETERS, NodeType::LAYER_COLLECTIONS)) {
-      rel_flag &= ~RELATION_FLAG_NO_FLUSH;
-    }
+    const int rel_flag = get_copy_on_write_relation_flag(id_type, comp_node);
     /* All entry operations of each component should wait for a proper
      * copy of ID. */
     OperationNode *op_entry = comp_node->get_entry_operation();
@@ -2940,27 +3015,10 @@ void DepsgraphRelationBuilder::build_copy_on_write_relations(IDNode *id_node)
       if (op_node == op_entry) {
         continue;
       }
-      if (op_node->inlinks.is_empty()) {
+      if (operation_is_dangling(op_node)) {
         Relation *rel = graph_->add_new_relation(op_cow, op_node, "CoW Dependency");
         rel->flag |= rel_flag;
       }
-      else {
-        bool has_same_comp_dependency = false;
-        for (Relation *rel_current : op_node->inlinks) {
-          if (rel_current->from->type != NodeType::OPERATION) {
-            continue;
-          }
-          OperationNode *op_node_from = (OperationNode *)rel_current->from;
-          if (op_node_from->owner == op_node->owner) {
-            has_same_comp_dependency = true;
-            break;
-          }
-        }
-        if (!has_same_comp_dependency) {
-          Relation *rel = graph_->add_new_relation(op_cow, op_node, "CoW Dependency");
-          rel->flag |= rel_flag;
-        }
-      }
     }
     /* NOTE: We currently ignore implicit relations to an external
      * data-blocks for copy-on-write operations. This means, for example,
@@ -195,6 +195,9 @@ class DepsgraphRelationBuilder : public DepsgraphBuilder {
 
   void add_customdata_mask(Object *object, const DEGCustomDataMeshMasks &customdata_masks);
   void add_special_eval_flag(ID *id, uint32_t flag);
+  /* Remember evaluation state of the ID node before it is changed by relations which are built on
+   * top of a previous build. */
+  void save_id_node_state(IDNode *id_node);
 
   virtual void build_id(ID *id);
 
@@ -211,6 +214,9 @@ class DepsgraphRelationBuilder : public DepsgraphBuilder {
   virtual void build_view_layer(Scene *scene,
                                 ViewLayer *view_layer,
                                 eDepsNode_LinkedState_Type linked_state);
+  /* Build relations of the given IDs in a graph which has relations already, the relations which
+   * exist are not added again. All the other IDs of the graph are considered built. */
+  virtual void build_view_layer_ids(Scene *scene, Span<ID *> ids);
   virtual void build_collection(LayerCollection *from_layer_collection,
                                 Object *object,
                                 Collection *collection);
@@ -315,6 +321,8 @@ class DepsgraphRelationBuilder : public DepsgraphBuilder {
 
   virtual void build_copy_on_write_relations();
   virtual void build_copy_on_write_relations(IDNode *id_node);
+  /* Relations of an operation which was added to an ID which was built by a previous build. */
+  virtual void build_copy_on_write_relations(OperationNode *op_node);
   virtual void build_driver_relations();
   virtual void build_driver_relations(IDNode *id_node);
 
@@ -322,6 +330,10 @@ class DepsgraphRelationBuilder : public DepsgraphBuilder {
 
   Depsgraph *getGraph();
 
+  /* ID nodes which had their evaluation flags or custom data masks extended by relations built on
+   * top of a previous build. */
+  Span<IDNode *> get_changed_id_nodes() const;
+
  protected:
   TimeSourceNode *get_node(const TimeSourceKey &key) const;
   ComponentNode *get_node(const ComponentKey &key) const;
@@ -372,6 +384,9 @@ class DepsgraphRelationBuilder : public DepsgraphBuilder {
 
   /* State which demotes currently built entities. */
   Scene *scene_;
+  /* Relations are added on top of the ones of a previous build. */
+  bool check_existing_relations_;
+  VectorSet<IDNode *> changed_id_nodes_;
 
   BuilderMap built_map_;
   RNANodeQuery rna_node_query_;
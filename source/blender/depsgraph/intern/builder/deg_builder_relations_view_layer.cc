@@ -154,4 +154,17 @@ void DepsgraphRelationBuilder::build_view_layer(Scene *scene,
   }
 }
 
+void DepsgraphRelationBuilder::build_view_layer_ids(Scene *scene, Span<ID *> ids)
+{
+  scene_ = scene;
+  check_existing_relations_ = true;
+  built_map_.setGraphBuilt(graph_);
+  for (ID *id : ids) {
+    built_map_.tagNeedsBuild(id);
+  }
+  for (ID *id : ids) {
+    build_id(id);
+  }
+}
+
 }  // namespace blender::deg
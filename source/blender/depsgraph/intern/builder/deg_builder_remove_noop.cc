@@ -47,11 +47,16 @@ static inline bool is_unused_noop(OperationNode *op_node)
 }
 
 void deg_graph_remove_unused_noops(Depsgraph *graph)
+{
+  deg_graph_remove_unused_noops(graph, graph->operations);
+}
+
+void deg_graph_remove_unused_noops(Depsgraph *graph, Span<OperationNode *> operations)
 {
   int num_removed_relations = 0;
   deque<OperationNode *> queue;
 
-  for (OperationNode *node : graph->operations) {
+  for (OperationNode *node : operations) {
     if (is_unused_noop(node)) {
       queue.push_back(node);
     }
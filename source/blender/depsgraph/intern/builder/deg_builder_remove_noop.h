@@ -23,13 +23,19 @@
 
 #pragma once
 
+#include "BLI_span.hh"
+
 namespace blender {
 namespace deg {
 
 struct Depsgraph;
+struct OperationNode;
 
 /* Remove all no-op nodes that have zero outgoing relations. */
 void deg_graph_remove_unused_noops(Depsgraph *graph);
+/* Same as above, for the given operations and the no-op nodes which become unused when those are
+ * removed. */
+void deg_graph_remove_unused_noops(Depsgraph *graph, Span<OperationNode *> operations);
 
 }  // namespace deg
 }  // namespace blender
@@ -0,0 +1,434 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2021 Blender Foundation.
+ * All rights reserved.
+ */
+
+
+/** \file
+ * \ingroup depsgraph
+ */
+
+#include "pipeline_relations_update.h"
+
+#include <algorithm>
+#include <cstdio>
+
+#include "PIL_time.h"
+
+#include "BLI_listbase.h"
+#include "BLI_utildefines.h"
+
+#include "BKE_collision.h"
+#include "BKE_effect.h"
+#include "BKE_global.h"
+
+#include "DNA_modifier_types.h"
+#include "DNA_object_force_types.h"
+#include "DNA_object_types.h"
+#include "DNA_scene_types.h"
+
+#include "DEG_depsgraph.h"
+#include "DEG_depsgraph_build.h"
+#include "DEG_depsgraph_physics.h"
+
+#include "intern/builder/deg_builder.h"
+#include "intern/builder/deg_builder_cycle.h"
+#include "intern/builder/deg_builder_nodes.h"
+#include "intern/builder/deg_builder_relations.h"
+#include "intern/builder/deg_builder_transitive.h"
+#include "intern/depsgraph.h"
+#include "intern/depsgraph_relation.h"
+#include "intern/node/deg_node_component.h"
+#include "intern/node/deg_node_operation.h"
+
+namespace blender::deg {
+
+namespace {
+
+/* Physics is built from relations cached for the whole scene, so objects which take part in it
+ * always need a full rebuild. */
+bool object_has_physics(const Object *object)
+{
+  if (object->pd != nullptr && object->pd->forcefield != PFIELD_NULL) {
+    return true;
+  }
+  if (object->soft != nullptr || object->rigidbody_object != nullptr ||
+      object->rigidbody_constraint != nullptr) {
+    return true;
+  }
+  if (!BLI_listbase_is_empty(&object->particlesystem)) {
+    return true;
+  }
+  LISTBASE_FOREACH (const ModifierData *, md, &object->modifiers) {
+    if (ELEM(md->type,
+             eModifierType_Collision,
+             eModifierType_Cloth,
+             eModifierType_Fluid,
+             eModifierType_DynamicPaint,
+             eModifierType_Softbody,
+             eModifierType_Surface,
+             eModifierType_ParticleSystem)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/* Check whether the object is in any of the physics relations cached by the previous build, in
+ * which case it used to have physics. */
+bool object_in_physics_relations(const Depsgraph *graph, const Object *object)
+{
+  for (int i = 0; i < DEG_PHYSICS_RELATIONS_NUM; i++) {
+    const Map<const ID *, ListBase *> *relations = graph->physics_relations[i];
+    if (relations == nullptr) {
+      continue;
+    }
+    for (const ListBase *list : relations->values()) {
+      if (list == nullptr) {
+        continue;
+      }
+      if (i == DEG_PHYSICS_EFFECTOR) {
+        LISTBASE_FOREACH (const EffectorRelation *, relation, list) {
+          if (relation->ob == object) {
+            return true;
+          }
+        }
+      }
+      else {
+        LISTBASE_FOREACH (const CollisionRelation *, relation, list) {
+          if (relation->ob == object) {
+            return true;
+          }
+        }
+      }
+    }
+  }
+  return false;
+}
+
+ID *get_node_owner_id(const Node *node)
+{
+  if (node->type != NodeType::OPERATION) {
+    return nullptr;
+  }
+  const OperationNode *op_node = static_cast<const OperationNode *>(node);
+  return op_node->owner->owner->id_orig;
+}
+
+/* Identifiers which do not depend on pointers, to compare nodes of different graphs. */
+string get_operation_identifier(const OperationNode *op_node)
+{
+  return string(nodeTypeAsString(op_node->owner->type)) + "/" + op_node->full_identifier() +
+         "[" + to_string(op_node->name_tag) + "]";
+}
+
+string get_node_identifier(const Node *node)
+{
+  if (node->type == NodeType::OPERATION) {
+    return get_operation_identifier(static_cast<const OperationNode *>(node));
+  }
+  return node->identifier();
+}
+
+void collect_graph_identifiers(const Depsgraph *graph,
+                               Set<string> &r_operations,
+                               Set<string> &r_relations)
+{
+  for (const OperationNode *op_node : graph->operations) {
+    const string op_identifier = get_operation_identifier(op_node);
+    r_operations.add(op_identifier);
+    for (const Relation *rel : op_node->inlinks) {
+      r_relations.add(get_node_identifier(rel->from) + " -> " + op_identifier + " (" + rel->name +
+                      ")");
+    }
+  }
+}
+
+int print_missing_identifiers(const Set<string> &identifiers,
+                              const Set<string> &other_identifiers,
+                              const char *message)
+{
+  int num_missing = 0;
+  for (const string &identifier : identifiers) {
+    if (!other_identifiers.contains(identifier)) {
+      printf("%s: %s\n", message, identifier.c_str());
+      num_missing++;
+    }
+  }
+  return num_missing;
+}
+
+}  // namespace
+
+RelationsUpdateBuilderPipeline::RelationsUpdateBuilderPipeline(::Depsgraph *graph)
+    : AbstractBuilderPipeline(graph)
+{
+}
+
+bool RelationsUpdateBuilderPipeline::update()
+{
+  if (!collect_objects()) {
+    return false;
+  }
+
+  double start_time = 0.0;
+  if (G.debug & (G_DEBUG_DEPSGRAPH_BUILD | G_DEBUG_DEPSGRAPH_TIME)) {
+    start_time = PIL_check_seconds_timer();
+  }
+
+  build_step_sanity_check();
+  collect_driver_users();
+
+  unique_ptr<DepsgraphNodeBuilder> node_builder = construct_node_builder();
+  node_builder->begin_build_objects(objects_);
+  remove_object_nodes();
+  const int64_t num_id_nodes = deg_graph_->id_nodes.size();
+  const int64_t num_operations = deg_graph_->operations.size();
+  build_nodes(*node_builder);
+  restore_object_states();
+  /* IDs which are new to the graph have no relations yet. */
+  for (int64_t i = num_id_nodes; i < deg_graph_->id_nodes.size(); i++) {
+    relation_ids_.add(deg_graph_->id_nodes[i]->id_orig);
+  }
+  node_builder->end_build_objects(relation_ids_);
+  node_builder.reset();
+
+  /* Nodes which have all their components built by this update. */
+  Set<IDNode *> built_id_nodes;
+  for (const ObjectState &state : object_states_) {
+    built_id_nodes.add(state.id_node);
+  }
+  for (int64_t i = num_id_nodes; i < deg_graph_->id_nodes.size(); i++) {
+    built_id_nodes.add(deg_graph_->id_nodes[i]);
+  }
+
+  VectorSet<IDNode *> updated_id_nodes;
+  for (ID *id : relation_ids_) {
+    IDNode *id_node = deg_graph_->find_id_node(id);
+    /* Same as a full build of a graph which had this state already. */
+    id_node->previous_eval_flags = id_node->eval_flags;
+    id_node->previous_customdata_masks = id_node->customdata_masks;
+    updated_id_nodes.add(id_node);
+  }
+
+  {
+    unique_ptr<DepsgraphRelationBuilder> relation_builder = construct_relation_builder();
+    build_relations(*relation_builder);
+    for (IDNode *id_node : built_id_nodes) {
+      relation_builder->build_copy_on_write_relations(id_node);
+      relation_builder->build_driver_relations(id_node);
+    }
+    /* Operations which the node builder added to IDs kept from the previous build. */
+    for (int64_t i = num_operations; i < deg_graph_->operations.size(); i++) {
+      OperationNode *op_node = deg_graph_->operations[i];
+      if (!built_id_nodes.contains(op_node->owner->owner)) {
+        relation_builder->build_copy_on_write_relations(op_node);
+        updated_id_nodes.add(op_node->owner->owner);
+      }
+    }
+    for (IDNode *id_node : relation_builder->get_changed_id_nodes()) {
+      updated_id_nodes.add(id_node);
+    }
+  }
+
+  finalize_update(updated_id_nodes);
+
+  /* Everything the objects evaluate is new. */
+  for (const ObjectState &state : object_states_) {
+    state.id_node->tag_update(deg_graph_, DEG_UPDATE_SOURCE_RELATIONS);
+  }
+
+  if (G.debug & (G_DEBUG_DEPSGRAPH_BUILD | G_DEBUG_DEPSGRAPH_TIME)) {
+    printf("Depsgraph relations of %d objects updated in %f seconds.\n",
+           (int)objects_.size(),
+           PIL_check_seconds_timer() - start_time);
+  }
+
+  if (G.debug & G_DEBUG_DEPSGRAPH_VERIFY) {
+    return verify_update();
+  }
+  return true;
+}
+
+void RelationsUpdateBuilderPipeline::build_nodes(DepsgraphNodeBuilder &node_builder)
+{
+  node_builder.build_view_layer_objects(scene_, view_layer_, objects_);
+  for (ID *id : driver_user_ids_) {
+    node_builder.build_driver_variables(id);
+  }
+}
+
+void RelationsUpdateBuilderPipeline::build_relations(DepsgraphRelationBuilder &relation_builder)
+{
+  relation_builder.build_view_layer_ids(scene_, relation_ids_);
+}
+
+bool RelationsUpdateBuilderPipeline::collect_objects()
+{
+  if (deg_graph_->is_render_pipeline_depsgraph) {
+    return false;
+  }
+  for (ID *id : deg_graph_->relations_update_ids) {
+    if (GS(id->name) != ID_OB) {
+      return false;
+    }
+    IDNode *id_node = deg_graph_->find_id_node(id);
+    if (id_node == nullptr || id_node->linked_state == DEG_ID_LINKED_VIA_SET) {
+      return false;
+    }
+    Object *object = reinterpret_cast<Object *>(id);
+    if (object->proxy != nullptr || object->proxy_from != nullptr ||
+        object->proxy_group != nullptr) {
+      return false;
+    }
+    if (object_has_physics(object) || object_in_physics_relations(deg_graph_, object)) {
+      return false;
+    }
+    objects_.add(object);
+  }
+  return true;
+}
+
+void RelationsUpdateBuilderPipeline::collect_driver_users()
+{
+  for (Object *object : objects_) {
+    const Set<ID *> *users = deg_graph_->driver_target_users.lookup_ptr(&object->id);
+    if (users == nullptr) {
+      continue;
+    }
+    for (ID *id : *users) {
+      if (GS(id->name) == ID_OB && objects_.contains(reinterpret_cast<Object *>(id))) {
+        continue;
+      }
+      /* Users are not removed from the map until the next full build. */
+      if (deg_graph_->find_id_node(id) != nullptr) {
+        driver_user_ids_.add(id);
+        relation_ids_.add(id);
+      }
+    }
+  }
+}
+
+void RelationsUpdateBuilderPipeline::remove_object_nodes()
+{
+  Set<OperationNode *> removed_operations;
+  for (Object *object : objects_) {
+    IDNode *id_node = deg_graph_->find_id_node(&object->id);
+    relation_ids_.add(&object->id);
+    object_states_.append(
+        {id_node, id_node->linked_state, id_node->is_directly_visible, id_node->has_base});
+
+    for (ComponentNode *comp_node : id_node->components.values()) {
+      for (OperationNode *op_node : comp_node->operations) {
+        while (!op_node->inlinks.is_empty()) {
+          Relation *rel = op_node->inlinks.last();
+          if (ID *id = get_node_owner_id(rel->from)) {
+            relation_ids_.add(id);
+          }
+          rel->unlink();
+          delete rel;
+        }
+        while (!op_node->outlinks.is_empty()) {
+          Relation *rel = op_node->outlinks.last();
+          if (ID *id = get_node_owner_id(rel->to)) {
+            relation_ids_.add(id);
+          }
+          rel->unlink();
+          delete rel;
+        }
+        removed_operations.add(op_node);
+        deg_graph_->entry_tags.remove(op_node);
+      }
+    }
+    for (ComponentNode *comp_node : id_node->components.values()) {
+      delete comp_node;
+    }
+    id_node->components.clear();
+    id_node->eval_flags = 0;
+    id_node->customdata_masks = DEGCustomDataMeshMasks();
+    id_node->has_base = false;
+  }
+
+  /* Single pass over the operations, evaluation of the updated graph visits all of them anyway. */
+  Depsgraph::OperationNodes &operations = deg_graph_->operations;
+  OperationNode **new_end = std::remove_if(
+      operations.begin(), operations.end(), [&](OperationNode *op_node) {
+        return removed_operations.contains(op_node);
+      });
+  operations.resize(new_end - operations.begin());
+}
+
+void RelationsUpdateBuilderPipeline::finalize_update(Span<IDNode *> id_nodes)
+{
+  Vector<OperationNode *> operations;
+  for (IDNode *id_node : id_nodes) {
+    id_node->finalize_build(deg_graph_);
+    for (ComponentNode *comp_node : id_node->components.values()) {
+      operations.extend(comp_node->operations);
+    }
+  }
+  /* New relations are between operations of these IDs, so are the new cycles. */
+  deg_graph_detect_cycles(deg_graph_, operations);
+  if (G.debug_value == 799) {
+    deg_graph_transitive_reduction(deg_graph_);
+  }
+  deg_graph_->scene_cow = (Scene *)deg_graph_->get_cow_id(&deg_graph_->scene->id);
+  deg_graph_build_finalize(bmain_, deg_graph_, id_nodes);
+  /* Relations are up to date. */
+  deg_graph_->relations_update_ids.clear();
+}
+
+void RelationsUpdateBuilderPipeline::restore_object_states()
+{
+  /* The objects might still be used by IDs which were not rebuilt. */
+  for (const ObjectState &state : object_states_) {
+    IDNode *id_node = state.id_node;
+    id_node->linked_state = max(id_node->linked_state, state.linked_state);
+    id_node->is_directly_visible |= state.is_directly_visible;
+    id_node->has_base |= state.has_base;
+  }
+}
+
+/* Compare against a graph built from scratch, see #G_DEBUG_DEPSGRAPH_VERIFY. */
+bool RelationsUpdateBuilderPipeline::verify_update()
+{
+  ::Depsgraph *full_graph = DEG_graph_new(bmain_, scene_, view_layer_, deg_graph_->mode);
+  DEG_graph_build_from_view_layer(full_graph);
+
+  Set<string> operations, relations, full_operations, full_relations;
+  collect_graph_identifiers(deg_graph_, operations, relations);
+  collect_graph_identifiers(
+      reinterpret_cast<Depsgraph *>(full_graph), full_operations, full_relations);
+  DEG_graph_free(full_graph);
+
+  int num_differences = 0;
+  num_differences += print_missing_identifiers(
+      full_operations, operations, "Relations update is missing operation");
+  num_differences += print_missing_identifiers(
+      operations, full_operations, "Relations update has extra operation");
+  num_differences += print_missing_identifiers(
+      full_relations, relations, "Relations update is missing relation");
+  num_differences += print_missing_identifiers(
+      relations, full_relations, "Relations update has extra relation");
+  if (num_differences != 0) {
+    printf("Relations update differs from a full build, rebuilding the graph.\n");
+    return false;
+  }
+  return true;
+}
+
+}  // namespace blender::deg
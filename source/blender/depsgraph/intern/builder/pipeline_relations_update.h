@@ -0,0 +1,76 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2021 Blender Foundation.
+ * All rights reserved.
+ */
+
+
+/** \file
+ * \ingroup depsgraph
+ */
+
+#pragma once
+
+#include "pipeline.h"
+
+#include "intern/node/deg_node_id.h"
+
+struct ID;
+struct Object;
+
+namespace blender {
+namespace deg {
+
+/* Rebuilds nodes of the objects tagged with #DEG_id_relations_tag_update, and relations of these
+ * objects and of the IDs they are connected to. The rest of the graph is kept as-is. */
+class RelationsUpdateBuilderPipeline : public AbstractBuilderPipeline {
+ public:
+  RelationsUpdateBuilderPipeline(::Depsgraph *graph);
+
+  /* Returns false when the graph is to be built from scratch instead. */
+  bool update();
+
+ protected:
+  virtual void build_nodes(DepsgraphNodeBuilder &node_builder) override;
+  virtual void build_relations(DepsgraphRelationBuilder &relation_builder) override;
+
+ private:
+  struct ObjectState {
+    IDNode *id_node;
+    eDepsNode_LinkedState_Type linked_state;
+    bool is_directly_visible;
+    bool has_base;
+  };
+
+  bool collect_objects();
+  void collect_driver_users();
+  void remove_object_nodes();
+  void restore_object_states();
+  void finalize_update(Span<IDNode *> id_nodes);
+  bool verify_update();
+
+  Set<Object *> objects_;
+  Vector<ObjectState> object_states_;
+  /* IDs which are kept in the graph, but have drivers reading the objects. Their drivers might
+   * resolve to different data after the update. */
+  VectorSet<ID *> driver_user_ids_;
+  /* IDs to build relations for: the tagged objects, the IDs which had relations with them, the
+   * driver users and the IDs which were added by the node builder. */
+  VectorSet<ID *> relation_ids_;
+};
+
+}  // namespace deg
+}  // namespace blender
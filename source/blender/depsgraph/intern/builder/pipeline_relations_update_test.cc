@@ -0,0 +1,160 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/** \file
+ * \ingroup depsgraph
+ */
+
+#include "intern/builder/pipeline_relations_update.h"
+#include "intern/depsgraph_testing.hh"
+
+#include "MEM_guardedalloc.h"
+
+#include "BKE_anim_data.h"
+#include "BKE_constraint.h"
+#include "BKE_fcurve.h"
+#include "BKE_fcurve_driver.h"
+#include "BKE_object.h"
+
+#include "BLI_listbase.h"
+#include "BLI_math_vector.h"
+#include "BLI_string.h"
+
+#include "DEG_depsgraph_query.h"
+
+#include "DNA_anim_types.h"
+#include "DNA_constraint_types.h"
+#include "DNA_modifier_types.h"
+#include "DNA_object_types.h"
+
+namespace blender::deg::tests {
+
+/* Every relations update is compared against a full build of the graph, see
+ * #G_DEBUG_DEPSGRAPH_VERIFY, and reports failure when they differ. */
+class deg_builder_relations_update : public DepsgraphTest {
+ protected:
+  void SetUp() override
+  {
+    DepsgraphTest::SetUp();
+    G.debug |= G_DEBUG_DEPSGRAPH_VERIFY;
+  }
+
+  void TearDown() override
+  {
+    G.debug &= ~G_DEBUG_DEPSGRAPH_VERIFY;
+    DepsgraphTest::TearDown();
+  }
+
+  bool relations_update(Object *object)
+  {
+    DEG_id_relations_tag_update(bmain, &object->id);
+    RelationsUpdateBuilderPipeline builder(depsgraph);
+    return builder.update();
+  }
+};
+
+static ArrayModifierData *add_array_modifier(Object *object, Object *offset_object)
+{
+  ArrayModifierData *amd = (ArrayModifierData *)BKE_modifier_new(eModifierType_Array);
+  amd->offset_ob = offset_object;
+  amd->offset_type |= MOD_ARR_OFF_OBJ;
+  BLI_addtail(&object->modifiers, amd);
+  return amd;
+}
+
+/* Driver on the X location which reads the given property of the target object. */
+static void add_location_driver(Object *object, Object *target, const char *rna_path)
+{
+  AnimData *adt = BKE_animdata_ensure_id(&object->id);
+  FCurve *fcu = BKE_fcurve_create();
+  fcu->rna_path = BLI_strdup("location");
+  fcu->array_index = 0;
+  fcu->driver = static_cast<ChannelDriver *>(MEM_callocN(sizeof(ChannelDriver), __func__));
+  fcu->driver->type = DRIVER_TYPE_AVERAGE;
+  DriverVar *dvar = driver_add_new_variable(fcu->driver);
+  driver_change_variable_type(dvar, DVAR_TYPE_SINGLE_PROP);
+  dvar->targets[0].idtype = ID_OB;
+  dvar->targets[0].id = &target->id;
+  dvar->targets[0].rna_path = BLI_strdup(rna_path);
+  BLI_addtail(&adt->drivers, fcu);
+}
+
+TEST_F(deg_builder_relations_update, AddModifier)
+{
+  Object *object = BKE_object_add(bmain, view_layer, OB_MESH, "Mesh");
+  Object *offset_object = BKE_object_add(bmain, view_layer, OB_EMPTY, "Offset");
+  depsgraph_build();
+  depsgraph_evaluate();
+
+  add_array_modifier(object, offset_object);
+  EXPECT_TRUE(relations_update(object));
+  depsgraph_evaluate();
+}
+
+TEST_F(deg_builder_relations_update, RemoveModifier)
+{
+  Object *object = BKE_object_add(bmain, view_layer, OB_MESH, "Mesh");
+  Object *offset_object = BKE_object_add(bmain, view_layer, OB_EMPTY, "Offset");
+  ArrayModifierData *amd = add_array_modifier(object, offset_object);
+  depsgraph_build();
+  depsgraph_evaluate();
+
+  BLI_remlink(&object->modifiers, amd);
+  BKE_modifier_free(&amd->modifier);
+  EXPECT_TRUE(relations_update(object));
+  depsgraph_evaluate();
+}
+
+TEST_F(deg_builder_relations_update, AddConstraint)
+{
+  Object *object = BKE_object_add(bmain, view_layer, OB_EMPTY, "Empty");
+  Object *target = BKE_object_add(bmain, view_layer, OB_EMPTY, "Target");
+  const float target_location[3] = {1.0f, 2.0f, 3.0f};
+  copy_v3_v3(target->loc, target_location);
+  depsgraph_build();
+  depsgraph_evaluate();
+
+  bConstraint *con = BKE_constraint_add_for_object(
+      object, "Copy Location", CONSTRAINT_TYPE_LOCLIKE);
+  static_cast<bLocateLikeConstraint *>(con->data)->tar = target;
+  EXPECT_TRUE(relations_update(object));
+  depsgraph_evaluate();
+
+  const Object *object_eval = DEG_get_evaluated_object(depsgraph, object);
+  EXPECT_V3_NEAR(object_eval->obmat[3], target_location, 1e-6f);
+}
+
+/* The driver of another object only resolves once the modifier exists, the update needs to add
+ * its relations even though the object had none with the updated one before. */
+TEST_F(deg_builder_relations_update, DriverReadsAddedModifier)
+{
+  Object *object = BKE_object_add(bmain, view_layer, OB_MESH, "Mesh");
+  Object *offset_object = BKE_object_add(bmain, view_layer, OB_EMPTY, "Offset");
+  Object *driven_object = BKE_object_add(bmain, view_layer, OB_EMPTY, "Driven");
+  add_location_driver(driven_object, object, "modifiers[\"Array\"].count");
+  depsgraph_build();
+  depsgraph_evaluate();
+
+  ArrayModifierData *amd = add_array_modifier(object, offset_object);
+  amd->count = 3;
+  EXPECT_TRUE(relations_update(object));
+  depsgraph_evaluate();
+
+  const Object *driven_object_eval = DEG_get_evaluated_object(depsgraph, driven_object);
+  EXPECT_FLOAT_EQ(driven_object_eval->loc[0], 3.0f);
+}
+
+}  // namespace blender::deg::tests
@@ -62,6 +62,8 @@ namespace blender::deg {
 Depsgraph::Depsgraph(Main *bmain, Scene *scene, ViewLayer *view_layer, eEvaluationMode mode)
     : time_source(nullptr),
       need_update(true),
+      need_update_priorities(true),
+      priorities_age(0),
       need_visibility_update(true),
       need_visibility_time_update(false),
       bmain(bmain),
@@ -180,6 +182,7 @@ void Depsgraph::clear_id_nodes()
   id_nodes.clear();
   /* Clear physics relation caches. */
   clear_physics_relations(this);
+  driver_target_users.clear();
 }
 
 /* Add new relation between two nodes */
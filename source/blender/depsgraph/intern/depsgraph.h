@@ -108,6 +108,15 @@ struct Depsgraph {
   /* Indicates whether relations needs to be updated. */
   bool need_update;
 
+  /* Original IDs which had their relations tagged for update, only the nodes and relations around
+   * them are rebuilt on the next relations update. Not used when #need_update is set. */
+  Set<ID *> relations_update_ids;
+
+  /* Priorities of operations are to be calculated again, because relations changed. Otherwise
+   * they are only updated every few evaluations, following the measured evaluation times. */
+  bool need_update_priorities;
+  uint32_t priorities_age;
+
   /* Indicated whether IDs in this graph are to be tagged as if they first appear visible, with
    * an optional tag for their animation (time) update. */
   bool need_visibility_update;
@@ -175,6 +184,10 @@ struct Depsgraph {
    * created along with relations, for fast lookup during evaluation. */
   Map<const ID *, ListBase *> *physics_relations[DEG_PHYSICS_RELATIONS_NUM];
 
+  /* Original IDs with drivers which read the key ID, created along with relations. Allows partial
+   * relations updates to find the drivers which might resolve differently after the update. */
+  Map<const ID *, Set<ID *>> driver_target_users;
+
   MEM_CXX_CLASS_ALLOC_FUNCS("Depsgraph");
 };
 
@@ -50,6 +50,7 @@
 #include "builder/pipeline_all_objects.h"
 #include "builder/pipeline_compositor.h"
 #include "builder/pipeline_from_ids.h"
+#include "builder/pipeline_relations_update.h"
 #include "builder/pipeline_render.h"
 #include "builder/pipeline_view_layer.h"
 
@@ -306,8 +307,14 @@ void DEG_graph_relations_update(Depsgraph *graph)
 {
   deg::Depsgraph *deg_graph = (deg::Depsgraph *)graph;
   if (!deg_graph->need_update) {
-    /* Graph is up to date, nothing to do. */
-    return;
+    if (deg_graph->relations_update_ids.is_empty()) {
+      /* Graph is up to date, nothing to do. */
+      return;
+    }
+    deg::RelationsUpdateBuilderPipeline builder(graph);
+    if (builder.update()) {
+      return;
+    }
   }
   DEG_graph_build_from_view_layer(graph);
 }
@@ -320,3 +327,19 @@ void DEG_relations_tag_update(Main *bmain)
     DEG_graph_tag_relations_update(reinterpret_cast<Depsgraph *>(depsgraph));
   }
 }
+
+void DEG_id_relations_tag_update(Main *bmain, ID *id)
+{
+  DEG_GLOBAL_DEBUG_PRINTF(TAG, "%s: Tagging relations of %s for update.\n", __func__, id->name);
+  for (deg::Depsgraph *depsgraph : deg::get_all_registered_graphs(bmain)) {
+    if (depsgraph->need_update) {
+      /* Whole graph is rebuilt anyway. */
+      continue;
+    }
+    if (depsgraph->find_id_node(id) == nullptr) {
+      /* Nothing in this graph depends on the ID. */
+      continue;
+    }
+    depsgraph->relations_update_ids.add(id);
+  }
+}
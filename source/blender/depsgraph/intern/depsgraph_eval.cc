@@ -23,10 +23,15 @@
  * Evaluation engine entry-points for Depsgraph Engine.
  */
 
+#include <algorithm>
+
 #include "MEM_guardedalloc.h"
 
+#include "BLI_array.hh"
 #include "BLI_listbase.h"
+#include "BLI_threads.h"
 #include "BLI_utildefines.h"
+#include "BLI_vector.hh"
 
 #include "BKE_scene.h"
 
@@ -86,3 +91,145 @@ void DEG_evaluate_on_framechange(Depsgraph *graph, float frame)
   deg_graph->ctime = BKE_scene_frame_to_ctime(scene, frame);
   deg_flush_updates_and_refresh(deg_graph);
 }
+
+/* -------------------------------------------------------------------- */
+/** \name Multi-Frame Evaluation
+ * \{ */
+
+namespace {
+
+struct FrameEvaluatorThread {
+  DepsgraphFrameEvaluator *evaluator;
+  Depsgraph *graph;
+  /* Graph `i` evaluates frames `i`, `i + graphs_num`, and so on. */
+  int first_frame_index;
+  /* Index of the last frame which finished evaluating on the graph. */
+  int evaluated_frame_index;
+};
+
+}  // namespace
+
+struct DepsgraphFrameEvaluator {
+  blender::Vector<float> frames;
+  blender::Array<FrameEvaluatorThread> threads_data;
+  /* Index of the frame to be returned by the next call to #DEG_frame_evaluator_next. The frame
+   * before it is in use by the caller, so its graph can not be evaluated. */
+  int next_frame_index;
+  bool stop;
+
+  ListBase threads;
+  ThreadMutex mutex;
+  ThreadCondition condition;
+
+  MEM_CXX_CLASS_ALLOC_FUNCS("DepsgraphFrameEvaluator");
+};
+
+static void *frame_evaluator_thread_run(void *data)
+{
+  FrameEvaluatorThread *thread_data = static_cast<FrameEvaluatorThread *>(data);
+  DepsgraphFrameEvaluator *evaluator = thread_data->evaluator;
+  const int graphs_num = evaluator->threads_data.size();
+
+  BLI_mutex_lock(&evaluator->mutex);
+
+  for (int frame_index = thread_data->first_frame_index; frame_index < evaluator->frames.size();
+       frame_index += graphs_num) {
+    /* Wait for the caller to be done with the previous frame evaluated on this graph. */
+    const int previous_frame_index = frame_index - graphs_num;
+    while (!evaluator->stop && previous_frame_index >= 0 &&
+           previous_frame_index >= evaluator->next_frame_index - 1) {
+      BLI_condition_wait(&evaluator->condition, &evaluator->mutex);
+    }
+    if (evaluator->stop) {
+      break;
+    }
+    const float frame = evaluator->frames[frame_index];
+    BLI_mutex_unlock(&evaluator->mutex);
+
+    DEG_evaluate_on_framechange(thread_data->graph, frame);
+
+    BLI_mutex_lock(&evaluator->mutex);
+    thread_data->evaluated_frame_index = frame_index;
+    BLI_condition_notify_all(&evaluator->condition);
+  }
+
+  BLI_mutex_unlock(&evaluator->mutex);
+
+  return nullptr;
+}
+
+DepsgraphFrameEvaluator *DEG_frame_evaluator_new(Depsgraph **graphs,
+                                                 int graphs_num,
+                                                 const float *frames,
+                                                 int frames_num)
+{
+  BLI_assert(graphs_num > 0);
+
+  DepsgraphFrameEvaluator *evaluator = new DepsgraphFrameEvaluator();
+  evaluator->frames.extend(blender::Span<float>(frames, frames_num));
+  evaluator->next_frame_index = 0;
+  evaluator->stop = false;
+
+  /* Graphs without frames to evaluate are not needed. */
+  graphs_num = std::max(1, std::min(graphs_num, frames_num));
+  evaluator->threads_data.reinitialize(graphs_num);
+
+  BLI_mutex_init(&evaluator->mutex);
+  BLI_condition_init(&evaluator->condition);
+  BLI_threadpool_init(&evaluator->threads, frame_evaluator_thread_run, graphs_num);
+
+  for (int i = 0; i < graphs_num; i++) {
+    FrameEvaluatorThread &thread_data = evaluator->threads_data[i];
+    thread_data.evaluator = evaluator;
+    thread_data.graph = graphs[i];
+    thread_data.first_frame_index = i;
+    thread_data.evaluated_frame_index = -1;
+    BLI_threadpool_insert(&evaluator->threads, &thread_data);
+  }
+
+  return evaluator;
+}
+
+Depsgraph *DEG_frame_evaluator_next(DepsgraphFrameEvaluator *evaluator, float *r_frame)
+{
+  BLI_mutex_lock(&evaluator->mutex);
+
+  const int frame_index = evaluator->next_frame_index;
+  /* Release the graph of the previous frame. */
+  evaluator->next_frame_index++;
+  BLI_condition_notify_all(&evaluator->condition);
+
+  if (frame_index >= evaluator->frames.size()) {
+    BLI_mutex_unlock(&evaluator->mutex);
+    return nullptr;
+  }
+
+  const FrameEvaluatorThread &thread_data =
+      evaluator->threads_data[frame_index % evaluator->threads_data.size()];
+  while (thread_data.evaluated_frame_index != frame_index) {
+    BLI_condition_wait(&evaluator->condition, &evaluator->mutex);
+  }
+
+  BLI_mutex_unlock(&evaluator->mutex);
+
+  *r_frame = evaluator->frames[frame_index];
+  return thread_data.graph;
+}
+
+void DEG_frame_evaluator_free(DepsgraphFrameEvaluator *evaluator)
+{
+  BLI_mutex_lock(&evaluator->mutex);
+  evaluator->stop = true;
+  BLI_condition_notify_all(&evaluator->condition);
+  BLI_mutex_unlock(&evaluator->mutex);
+
+  /* Waits for frames which are still being evaluated. */
+  BLI_threadpool_end(&evaluator->threads);
+
+  BLI_condition_end(&evaluator->condition);
+  BLI_mutex_end(&evaluator->mutex);
+
+  delete evaluator;
+}
+
+/** \} */
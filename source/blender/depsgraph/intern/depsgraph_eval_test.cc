@@ -0,0 +1,122 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/** \file
+ * \ingroup depsgraph
+ */
+
+#include "intern/depsgraph_testing.hh"
+
+#include "BKE_action.h"
+#include "BKE_anim_data.h"
+#include "BKE_lib_id.h"
+#include "BKE_object.h"
+
+#include "BLI_vector.hh"
+
+#include "DEG_depsgraph_query.h"
+
+#include "DNA_action_types.h"
+#include "DNA_object_types.h"
+
+namespace blender::deg::tests {
+
+/* Evaluates frames on the graph of the fixture and a few more graphs of the same scene, with an
+ * empty moving from 0 on frame 1 to 9 on frame 10. */
+class deg_frame_evaluator : public DepsgraphTest {
+ protected:
+  Object *ob = nullptr;
+  Vector<::Depsgraph *> graphs;
+
+  void SetUp() override
+  {
+    DepsgraphTest::SetUp();
+    ob = BKE_object_add(bmain, view_layer, OB_EMPTY, "Empty");
+    bAction *act = BKE_action_add(bmain, "Action");
+    add_location_fcurve(act, 0.0f, 9.0f);
+    AnimData *adt = BKE_animdata_ensure_id(&ob->id);
+    adt->action = act;
+    id_us_plus(&act->id);
+
+    depsgraph_build();
+    depsgraph_evaluate();
+    graphs.append(depsgraph);
+    for (int i = 1; i < 3; i++) {
+      ::Depsgraph *graph = DEG_graph_new(bmain, scene, view_layer, DAG_EVAL_VIEWPORT);
+      DEG_graph_build_from_view_layer(graph);
+      DEG_evaluate_on_refresh(graph);
+      graphs.append(graph);
+    }
+  }
+
+  void TearDown() override
+  {
+    /* The graph of the fixture is freed by the fixture. */
+    for (::Depsgraph *graph : graphs.as_span().drop_front(1)) {
+      DEG_graph_free(graph);
+    }
+    DepsgraphTest::TearDown();
+  }
+};
+
+TEST_F(deg_frame_evaluator, FramesInOrder)
+{
+  const Vector<float> frames = {1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f, 8.0f, 9.0f, 10.0f};
+  DepsgraphFrameEvaluator *evaluator = DEG_frame_evaluator_new(
+      graphs.data(), graphs.size(), frames.data(), frames.size());
+
+  for (const float frame : frames) {
+    float graph_frame = 0.0f;
+    ::Depsgraph *graph = DEG_frame_evaluator_next(evaluator, &graph_frame);
+    ASSERT_NE(graph, nullptr);
+    EXPECT_EQ(graph_frame, frame);
+    EXPECT_EQ(DEG_get_ctime(graph), frame);
+    const Object *ob_eval = DEG_get_evaluated_object(graph, ob);
+    EXPECT_FLOAT_EQ(ob_eval->loc[0], frame - 1.0f);
+  }
+  float graph_frame = 0.0f;
+  EXPECT_EQ(DEG_frame_evaluator_next(evaluator, &graph_frame), nullptr);
+
+  DEG_frame_evaluator_free(evaluator);
+}
+
+/* Frames which are evaluated or waiting to be evaluated when the caller stops are discarded.
+ * The evaluated state allocates differently from frame to frame, so memory is compared after a
+ * complete run over all frames, with and without runs stopped early before it. */
+TEST_F(deg_frame_evaluator, StopEarly)
+{
+  const Vector<float> frames = {1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f, 8.0f, 9.0f, 10.0f};
+  auto run = [&](const int frames_used) {
+    DepsgraphFrameEvaluator *evaluator = DEG_frame_evaluator_new(
+        graphs.data(), graphs.size(), frames.data(), frames.size());
+    for (int i = 0; i < frames_used; i++) {
+      float graph_frame = 0.0f;
+      EXPECT_NE(DEG_frame_evaluator_next(evaluator, &graph_frame), nullptr);
+      EXPECT_EQ(graph_frame, frames[i]);
+    }
+    DEG_frame_evaluator_free(evaluator);
+  };
+
+  run(frames.size());
+  const uint blocks_in_use = MEM_get_memory_blocks_in_use();
+  for (const int frames_used : {0, 1, 4}) {
+    run(frames_used);
+    run(frames.size());
+    EXPECT_EQ(MEM_get_memory_blocks_in_use(), blocks_in_use);
+  }
+}
+
+}  // namespace blender::deg::tests
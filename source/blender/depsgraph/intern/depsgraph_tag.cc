@@ -522,62 +522,70 @@ void graph_tag_ids_for_visible_update(Depsgraph *graph)
    * to evaluation though) with `do_time=true`. This means early output checks should be aware of
    * this. */
   for (deg::IDNode *id_node : graph->id_nodes) {
-    const ID_Type id_type = GS(id_node->id_orig->name);
-    if (id_type == ID_OB) {
-      Object *object_orig = reinterpret_cast<Object *>(id_node->id_orig);
-      if (object_orig->proxy != nullptr) {
-        object_orig->proxy->proxy_from = object_orig;
-      }
-    }
+    graph_tag_id_for_visible_update(bmain, graph, id_node, do_time);
+  }
 
-    if (!id_node->visible_components_mask) {
-      /* ID has no components which affects anything visible.
-       * No need bother with it to tag or anything. */
-      continue;
-    }
-    int flag = 0;
-    if (!deg::deg_copy_on_write_is_expanded(id_node->id_cow)) {
-      flag |= ID_RECALC_COPY_ON_WRITE;
-      if (do_time) {
-        if (BKE_animdata_from_id(id_node->id_orig) != nullptr) {
-          flag |= ID_RECALC_ANIMATION;
-        }
-      }
+  graph->need_visibility_update = false;
+  graph->need_visibility_time_update = false;
+}
+
+void graph_tag_id_for_visible_update(Main *bmain,
+                                     Depsgraph *graph,
+                                     IDNode *id_node,
+                                     const bool do_time)
+{
+  const ID_Type id_type = GS(id_node->id_orig->name);
+  if (id_type == ID_OB) {
+    Object *object_orig = reinterpret_cast<Object *>(id_node->id_orig);
+    if (object_orig->proxy != nullptr) {
+      object_orig->proxy->proxy_from = object_orig;
     }
-    else {
-      if (id_node->visible_components_mask == id_node->previously_visible_components_mask) {
-        /* The ID was already visible and evaluated, all the subsequent
-         * updates and tags are to be done explicitly. */
-        continue;
+  }
+
+  if (!id_node->visible_components_mask) {
+    /* ID has no components which affects anything visible.
+     * No need bother with it to tag or anything. */
+    return;
+  }
+  int flag = 0;
+  if (!deg::deg_copy_on_write_is_expanded(id_node->id_cow)) {
+    flag |= ID_RECALC_COPY_ON_WRITE;
+    if (do_time) {
+      if (BKE_animdata_from_id(id_node->id_orig) != nullptr) {
+        flag |= ID_RECALC_ANIMATION;
       }
     }
-    /* We only tag components which needs an update. Tagging everything is
-     * not a good idea because that might reset particles cache (or any
-     * other type of cache).
-     *
-     * TODO(sergey): Need to generalize this somehow. */
-    if (id_type == ID_OB) {
-      flag |= ID_RECALC_TRANSFORM | ID_RECALC_GEOMETRY;
-    }
-    graph_id_tag_update(bmain, graph, id_node->id_orig, flag, DEG_UPDATE_SOURCE_VISIBILITY);
-    if (id_type == ID_SCE) {
-      /* Make sure collection properties are up to date. */
-      id_node->tag_update(graph, DEG_UPDATE_SOURCE_VISIBILITY);
+  }
+  else {
+    if (id_node->visible_components_mask == id_node->previously_visible_components_mask) {
+      /* The ID was already visible and evaluated, all the subsequent
+       * updates and tags are to be done explicitly. */
+      return;
     }
-    /* Now when ID is updated to the new visibility state, prevent it from
-     * being re-tagged again. Simplest way to do so is to pretend that it
-     * was already updated by the "previous" dependency graph.
-     *
-     * NOTE: Even if the on_visible_update() is called from the state when
-     * dependency graph is tagged for relations update, it will be fine:
-     * since dependency graph builder re-schedules entry tags, all the
-     * tags we request from here will be applied in the updated state of
-     * dependency graph. */
-    id_node->previously_visible_components_mask = id_node->visible_components_mask;
   }
-
-  graph->need_visibility_update = false;
-  graph->need_visibility_time_update = false;
+  /* We only tag components which needs an update. Tagging everything is
+   * not a good idea because that might reset particles cache (or any
+   * other type of cache).
+   *
+   * TODO(sergey): Need to generalize this somehow. */
+  if (id_type == ID_OB) {
+    flag |= ID_RECALC_TRANSFORM | ID_RECALC_GEOMETRY;
+  }
+  graph_id_tag_update(bmain, graph, id_node->id_orig, flag, DEG_UPDATE_SOURCE_VISIBILITY);
+  if (id_type == ID_SCE) {
+    /* Make sure collection properties are up to date. */
+    id_node->tag_update(graph, DEG_UPDATE_SOURCE_VISIBILITY);
+  }
+  /* Now when ID is updated to the new visibility state, prevent it from
+   * being re-tagged again. Simplest way to do so is to pretend that it
+   * was already updated by the "previous" dependency graph.
+   *
+   * NOTE: Even if the on_visible_update() is called from the state when
+   * dependency graph is tagged for relations update, it will be fine:
+   * since dependency graph builder re-schedules entry tags, all the
+   * tags we request from here will be applied in the updated state of
+   * dependency graph. */
+  id_node->previously_visible_components_mask = id_node->visible_components_mask;
 }
 
 NodeType geometry_tag_to_component(const ID *id)
@@ -30,6 +30,7 @@ namespace blender {
 namespace deg {
 
 struct Depsgraph;
+struct IDNode;
 
 /* Get type of a node which corresponds to a ID_RECALC_GEOMETRY tag. */
 NodeType geometry_tag_to_component(const ID *id);
@@ -45,5 +46,11 @@ void graph_id_tag_update(
  * Will do nothing if the graph is not tagged for visibility update. */
 void graph_tag_ids_for_visible_update(Depsgraph *graph);
 
+/* Tag given ID node of the graph for the visibility update, same as above. */
+void graph_tag_id_for_visible_update(Main *bmain,
+                                     Depsgraph *graph,
+                                     IDNode *id_node,
+                                     const bool do_time);
+
 }  // namespace deg
 }  // namespace blender
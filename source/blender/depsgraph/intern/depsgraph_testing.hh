@@ -0,0 +1,155 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/** \file
+ * \ingroup depsgraph
+ */
+
+#pragma once
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "BKE_appdir.h"
+#include "BKE_blender.h"
+#include "BKE_fcurve.h"
+#include "BKE_global.h"
+#include "BKE_idtype.h"
+#include "BKE_image.h"
+#include "BKE_main.h"
+#include "BKE_modifier.h"
+#include "BKE_node.h"
+#include "BKE_scene.h"
+
+#include "BLI_listbase.h"
+#include "BLI_string.h"
+#include "BLI_threads.h"
+
+#include "DEG_depsgraph.h"
+#include "DEG_depsgraph_build.h"
+
+#include "DNA_anim_types.h"
+#include "DNA_genfile.h"
+#include "DNA_scene_types.h"
+
+#include "IMB_imbuf.h"
+
+#include "RNA_define.h"
+
+#include "CLG_log.h"
+
+namespace blender::deg::tests {
+
+/* Animate the X location linearly from `value_start` on frame 1 to `value_end` on frame 10. */
+inline FCurve *add_location_fcurve(bAction *act, const float value_start, const float value_end)
+{
+  FCurve *fcu = BKE_fcurve_create();
+  fcu->rna_path = BLI_strdup("location");
+  fcu->array_index = 0;
+  fcu->totvert = 2;
+  fcu->bezt = static_cast<BezTriple *>(MEM_callocN(sizeof(BezTriple) * 2, __func__));
+  for (int i = 0; i < 2; i++) {
+    BezTriple *bezt = &fcu->bezt[i];
+    bezt->vec[1][0] = (i == 0) ? 1.0f : 10.0f;
+    bezt->vec[1][1] = (i == 0) ? value_start : value_end;
+    bezt->ipo = BEZT_IPO_LIN;
+    bezt->h1 = bezt->h2 = HD_AUTO_ANIM;
+  }
+  calchandles_fcurve(fcu);
+  BLI_addtail(&act->curves, fcu);
+  return fcu;
+}
+
+/* Test class for test cases that build and evaluate a dependency graph of a scene, which is
+ * created in an empty main database for every test.
+ *
+ * Usage:
+ *   using deg_my_feature = DepsgraphTest;
+ *   TEST_F(deg_my_feature, my_test) {
+ *     ... add data-blocks to `bmain` and `scene` ...
+ *     depsgraph_build();
+ *     DEG_evaluate_on_framechange(depsgraph, 1.0f);
+ *   }
+ */
+class DepsgraphTest : public ::testing::Test {
+ protected:
+  Main *bmain = nullptr;
+  Scene *scene = nullptr;
+  ViewLayer *view_layer = nullptr;
+  ::Depsgraph *depsgraph = nullptr;
+
+  /* Minimal initialization to build and evaluate a dependency graph, see main() in creator.c. */
+  static void SetUpTestSuite()
+  {
+    CLG_init();
+    BLI_threadapi_init();
+    DNA_sdna_current_init();
+    BKE_blender_globals_init();
+    BKE_idtype_init();
+    BKE_appdir_init();
+    IMB_init();
+    BKE_images_init();
+    BKE_modifier_init();
+    DEG_register_node_types();
+    RNA_init();
+    BKE_node_system_init();
+    G.background = true;
+  }
+
+  static void TearDownTestSuite()
+  {
+    BKE_blender_free();
+    RNA_exit();
+    DEG_free_node_types();
+    DNA_sdna_current_free();
+    BLI_threadapi_exit();
+    BKE_blender_atexit();
+    BKE_appdir_exit();
+    CLG_exit();
+  }
+
+  void SetUp() override
+  {
+    bmain = BKE_main_new();
+    scene = BKE_scene_add(bmain, "Scene");
+    view_layer = static_cast<ViewLayer *>(scene->view_layers.first);
+  }
+
+  void TearDown() override
+  {
+    if (depsgraph != nullptr) {
+      DEG_graph_free(depsgraph);
+    }
+    BKE_main_free(bmain);
+  }
+
+  void depsgraph_build()
+  {
+    depsgraph = DEG_graph_new(bmain, scene, view_layer, DAG_EVAL_VIEWPORT);
+    DEG_graph_build_from_view_layer(depsgraph);
+  }
+
+  /* Evaluate tagged updates and clear the recalc flags afterwards, like
+   * BKE_scene_graph_update_tagged() does. */
+  void depsgraph_evaluate()
+  {
+    DEG_evaluate_on_refresh(depsgraph);
+    DEG_ids_clear_recalc(depsgraph, false);
+  }
+};
+
+}  // namespace blender::deg::tests
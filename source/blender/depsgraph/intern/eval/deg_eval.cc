@@ -29,11 +29,16 @@
 
 #include "BLI_compiler_attrs.h"
 #include "BLI_gsqueue.h"
+#include "BLI_heap_simple.h"
 #include "BLI_task.h"
+#include "BLI_threads.h"
+#include "BLI_trace.h"
 #include "BLI_utildefines.h"
 
 #include "BKE_global.h"
+#include "BKE_mesh.h"
 
+#include "DNA_mesh_types.h"
 #include "DNA_node_types.h"
 #include "DNA_object_types.h"
 #include "DNA_scene_types.h"
@@ -69,11 +74,6 @@ void schedule_children(DepsgraphEvalState *state,
                        ScheduleFunction *schedule_function,
                        ScheduleFunctionArgs... schedule_function_args);
 
-void schedule_node_to_pool(OperationNode *node, const int UNUSED(thread_id), TaskPool *pool)
-{
-  BLI_task_pool_push(pool, deg_task_run_func, node, false, nullptr);
-}
-
 /* Denotes which part of dependency graph is being evaluated. */
 enum class EvaluationStage {
   /* Stage 1: Only  Copy-on-Write operations are to be evaluated, prior to anything else.
@@ -96,8 +96,53 @@ struct DepsgraphEvalState {
   bool do_stats;
   EvaluationStage stage;
   bool need_single_thread_pass;
+  /* Tasks of the pool run in other threads. Otherwise they run as soon as they are pushed, so a
+   * single task evaluates all ready operations instead of a nested task per operation. */
+  bool use_threads;
+
+  /* Operations which are ready to be evaluated by the task pool, ordered by their priority. */
+  HeapSimple *ready_operations;
+  SpinLock ready_operations_lock;
+  /* Ready operations without threads. The order does not change the time it takes to evaluate
+   * everything then, depth first is the most cache friendly. */
+  Vector<OperationNode *> ready_operations_stack;
 };
 
+/* Cost of an operation which was not timed yet. Makes the number of operations count when
+ * nothing was measured, so the longest chains are still started first. */
+const float default_operation_cost = 1e-6f;
+
+/* Operations are timed on one out of this many evaluations, and on every evaluation when
+ * gathering debug statistics. */
+const uint32_t eval_time_sample_interval = 8;
+
+void schedule_node_to_pool(OperationNode *node, const int UNUSED(thread_id), TaskPool *pool)
+{
+  DepsgraphEvalState *state = (DepsgraphEvalState *)BLI_task_pool_user_data(pool);
+  if (!state->use_threads) {
+    state->ready_operations_stack.append(node);
+    return;
+  }
+  BLI_spin_lock(&state->ready_operations_lock);
+  BLI_heapsimple_insert(state->ready_operations, -node->priority, node);
+  BLI_spin_unlock(&state->ready_operations_lock);
+  BLI_task_pool_push(pool, deg_task_run_func, nullptr, false, nullptr);
+}
+
+OperationNode *pop_ready_operation(DepsgraphEvalState *state)
+{
+  if (!state->use_threads) {
+    return state->ready_operations_stack.is_empty() ? nullptr :
+                                                      state->ready_operations_stack.pop_last();
+  }
+  BLI_spin_lock(&state->ready_operations_lock);
+  OperationNode *node = BLI_heapsimple_is_empty(state->ready_operations) ?
+                            nullptr :
+                            (OperationNode *)BLI_heapsimple_pop_min(state->ready_operations);
+  BLI_spin_unlock(&state->ready_operations_lock);
+  return node;
+}
+
 void evaluate_node(const DepsgraphEvalState *state, OperationNode *operation_node)
 {
   ::Depsgraph *depsgraph = reinterpret_cast<::Depsgraph *>(state->graph);
@@ -105,30 +150,101 @@ void evaluate_node(const DepsgraphEvalState *state, OperationNode *operation_nod
   /* Sanity checks. */
   BLI_assert_msg(!operation_node->is_noop(), "NOOP nodes should not actually be scheduled");
   /* Perform operation. */
+  const bool do_trace = BLI_trace_is_enabled();
+  if (do_trace) {
+    BLI_trace_begin("depsgraph", operation_node->full_identifier().c_str());
+  }
+  /* Only every few evaluations are timed for the priorities, the timer is not free and the
+   * average follows changes quickly enough. */
+  const bool do_time = state->do_stats ||
+                       (operation_node->eval_count++ % eval_time_sample_interval) == 0;
+  const double start_time = do_time ? PIL_check_seconds_timer() : 0.0;
+  operation_node->evaluate(depsgraph);
+  const double eval_time = do_time ? PIL_check_seconds_timer() - start_time : 0.0;
+  if (do_trace) {
+    BLI_trace_end();
+  }
+
+  if (!do_time) {
+    return;
+  }
   if (state->do_stats) {
-    const double start_time = PIL_check_seconds_timer();
-    operation_node->evaluate(depsgraph);
-    operation_node->stats.current_time += PIL_check_seconds_timer() - start_time;
+    operation_node->stats.current_time += eval_time;
+  }
+  /* Keep the average responsive to changes, like a modifier being enabled. */
+  if (operation_node->eval_time_average == 0.0f) {
+    operation_node->eval_time_average = eval_time;
   }
   else {
-    operation_node->evaluate(depsgraph);
+    operation_node->eval_time_average += (eval_time - operation_node->eval_time_average) * 0.25f;
   }
 }
 
-void deg_task_run_func(TaskPool *pool, void *taskdata)
+/* Operation which the current task evaluates next, instead of pushing it to the pool. This way
+ * chains of operations, like the bones of a limb, are evaluated by a single task instead of a
+ * task per operation. */
+struct TaskContinuation {
+  TaskPool *pool;
+  OperationNode *next_node;
+};
+
+void schedule_node_to_pool_or_continuation(OperationNode *node,
+                                           const int thread_id,
+                                           TaskContinuation *continuation)
+{
+  if (continuation->next_node == nullptr) {
+    continuation->next_node = node;
+    return;
+  }
+  /* Continue with the most expensive chain, other tasks pick up the remaining operations. */
+  if (node->priority > continuation->next_node->priority) {
+    std::swap(node, continuation->next_node);
+  }
+  schedule_node_to_pool(node, thread_id, continuation->pool);
+}
+
+/* Operations with a higher priority which are waiting in the pool are evaluated first. */
+bool can_continue_with_node(DepsgraphEvalState *state, const OperationNode *node)
+{
+  if (!state->use_threads) {
+    return true;
+  }
+  BLI_spin_lock(&state->ready_operations_lock);
+  const bool can_continue = BLI_heapsimple_is_empty(state->ready_operations) ||
+                            -BLI_heapsimple_top_value(state->ready_operations) <= node->priority;
+  BLI_spin_unlock(&state->ready_operations_lock);
+  return can_continue;
+}
+
+void deg_task_run_func(TaskPool *pool, void *UNUSED(taskdata))
 {
   void *userdata_v = BLI_task_pool_user_data(pool);
   DepsgraphEvalState *state = (DepsgraphEvalState *)userdata_v;
 
-  /* Evaluate node. */
-  OperationNode *operation_node = reinterpret_cast<OperationNode *>(taskdata);
-  evaluate_node(state, operation_node);
-
-  /* Schedule children. */
-  schedule_children(state, operation_node, schedule_node_to_pool, pool);
+  /* Every task evaluates the ready operations with the highest priority, which are not
+   * necessarily the ones which became ready when the task was pushed. Operations taken by other
+   * tasks leave nothing to do for some tasks. */
+  OperationNode *operation_node;
+  while ((operation_node = pop_ready_operation(state)) != nullptr) {
+    while (operation_node != nullptr) {
+      /* Evaluate node. */
+      evaluate_node(state, operation_node);
+
+      /* Schedule children, keeping one of them which became ready for this task. */
+      TaskContinuation continuation = {pool, nullptr};
+      schedule_children(
+          state, operation_node, schedule_node_to_pool_or_continuation, &continuation);
+
+      operation_node = continuation.next_node;
+      if (operation_node != nullptr && !can_continue_with_node(state, operation_node)) {
+        schedule_node_to_pool(operation_node, 0, pool);
+        break;
+      }
+    }
+  }
 }
 
-bool check_operation_node_visible(OperationNode *op_node)
+bool check_operation_node_visible(const OperationNode *op_node)
 {
   const ComponentNode *comp_node = op_node->owner;
   /* Special exception, copy on write component is to be always evaluated,
@@ -178,10 +294,65 @@ void calculate_pending_parents(Depsgraph *graph)
   }
 }
 
+bool is_evaluation_relation(const Relation *rel)
+{
+  return rel->from->type == NodeType::OPERATION && rel->to->type == NodeType::OPERATION &&
+         (rel->flag & RELATION_FLAG_CYCLIC) == 0;
+}
+
+}  // namespace
+
+/* Operations are visited from the end of the chains, once all the operations which depend on
+ * them are done. The whole graph is used regardless of what is tagged for update, so the
+ * priorities only need to be calculated again when relations or measured times change. */
+void deg_graph_calculate_priorities(Depsgraph *graph)
+{
+  Vector<OperationNode *> done_children_queue;
+
+  for (OperationNode *node : graph->operations) {
+    node->priority = 0.0f;
+    /* Number of children which did not get their priority yet. */
+    node->custom_flags = 0;
+    for (Relation *rel : node->outlinks) {
+      if (is_evaluation_relation(rel)) {
+        ++node->custom_flags;
+      }
+    }
+    if (node->custom_flags == 0) {
+      done_children_queue.append(node);
+    }
+  }
+
+  while (!done_children_queue.is_empty()) {
+    OperationNode *node = done_children_queue.pop_last();
+    node->priority += max(node->eval_time_average, default_operation_cost);
+    for (Relation *rel : node->inlinks) {
+      if (!is_evaluation_relation(rel)) {
+        continue;
+      }
+      OperationNode *parent = (OperationNode *)rel->from;
+      parent->priority = max(parent->priority, node->priority);
+      if (--parent->custom_flags == 0) {
+        done_children_queue.append(parent);
+      }
+    }
+  }
+}
+
+namespace {
+
 void initialize_execution(DepsgraphEvalState *state, Depsgraph *graph)
 {
   const bool do_stats = state->do_stats;
   calculate_pending_parents(graph);
+  /* Priorities only matter when operations are evaluated in parallel. Measured times change at
+   * most every few evaluations, see #evaluate_node. */
+  if (state->use_threads &&
+      (graph->need_update_priorities || ++graph->priorities_age >= eval_time_sample_interval)) {
+    deg_graph_calculate_priorities(graph);
+    graph->need_update_priorities = false;
+    graph->priorities_age = 0;
+  }
   /* Clear tags and other things which needs to be clear. */
   for (OperationNode *node : graph->operations) {
     if (do_stats) {
@@ -346,6 +517,29 @@ void depsgraph_ensure_view_layer(Depsgraph *graph)
   deg_update_copy_on_write_datablock(graph, scene_id_node);
 }
 
+/* Copy-on-write copies of meshes in the active depsgraph share geometry arrays with the original
+ * mesh. Setting that up modifies the original, so it is done here before the copies are made from
+ * the evaluation threads. */
+void prepare_copy_on_write_sharing(Depsgraph *graph)
+{
+  if (!graph->is_active) {
+    return;
+  }
+  for (IDNode *id_node : graph->id_nodes) {
+    if (id_node->id_type != ID_ME) {
+      continue;
+    }
+    ComponentNode *cow_comp = id_node->find_component(NodeType::COPY_ON_WRITE);
+    if (cow_comp == nullptr) {
+      continue;
+    }
+    OperationNode *cow_node = cow_comp->get_entry_operation();
+    if (cow_node->flag & DEPSOP_FLAG_NEEDS_UPDATE) {
+      BKE_mesh_share_prepare((Mesh *)id_node->id_orig);
+    }
+  }
+}
+
 }  // namespace
 
 static TaskPool *deg_evaluate_task_pool_create(DepsgraphEvalState *state)
@@ -357,6 +551,17 @@ static TaskPool *deg_evaluate_task_pool_create(DepsgraphEvalState *state)
   return BLI_task_pool_create_suspended(state, TASK_PRIORITY_HIGH);
 }
 
+static void deg_evaluate_graph_threaded(DepsgraphEvalState *state)
+{
+  TaskPool *task_pool = deg_evaluate_task_pool_create(state);
+  schedule_graph(state, schedule_node_to_pool, task_pool);
+  if (!state->use_threads) {
+    BLI_task_pool_push(task_pool, deg_task_run_func, nullptr, false, nullptr);
+  }
+  BLI_task_pool_work_and_wait(task_pool);
+  BLI_task_pool_free(task_pool);
+}
+
 /**
  * Evaluate all nodes tagged for updating,
  * \warning This is usually done as part of main loop, but may also be
@@ -374,6 +579,7 @@ void deg_evaluate_on_refresh(Depsgraph *graph)
   }
 
   graph->debug.begin_graph_evaluation();
+  TraceScope trace_scope("depsgraph", "Evaluate");
 
   graph->is_evaluating = true;
   depsgraph_ensure_view_layer(graph);
@@ -382,29 +588,31 @@ void deg_evaluate_on_refresh(Depsgraph *graph)
   state.graph = graph;
   state.do_stats = graph->debug.do_time_debug();
   state.need_single_thread_pass = false;
+  state.use_threads = (G.debug & G_DEBUG_DEPSGRAPH_NO_THREADS) == 0 &&
+                      BLI_task_scheduler_num_threads() > 1;
+  state.ready_operations = BLI_heapsimple_new();
+  BLI_spin_init(&state.ready_operations_lock);
   /* Prepare all nodes for evaluation. */
   initialize_execution(&state, graph);
+  prepare_copy_on_write_sharing(graph);
 
   /* Do actual evaluation now. */
   /* First, process all Copy-On-Write nodes. */
   state.stage = EvaluationStage::COPY_ON_WRITE;
-  TaskPool *task_pool = deg_evaluate_task_pool_create(&state);
-  schedule_graph(&state, schedule_node_to_pool, task_pool);
-  BLI_task_pool_work_and_wait(task_pool);
-  BLI_task_pool_free(task_pool);
+  deg_evaluate_graph_threaded(&state);
 
   /* After that, process all other nodes. */
   state.stage = EvaluationStage::THREADED_EVALUATION;
-  task_pool = deg_evaluate_task_pool_create(&state);
-  schedule_graph(&state, schedule_node_to_pool, task_pool);
-  BLI_task_pool_work_and_wait(task_pool);
-  BLI_task_pool_free(task_pool);
+  deg_evaluate_graph_threaded(&state);
 
   if (state.need_single_thread_pass) {
     state.stage = EvaluationStage::SINGLE_THREADED_WORKAROUND;
     evaluate_graph_single_threaded(&state);
   }
 
+  BLI_heapsimple_free(state.ready_operations, nullptr);
+  BLI_spin_end(&state.ready_operations_lock);
+
   /* Finalize statistics gathering. This is because we only gather single
    * operation timing here, without aggregating anything to avoid any extra
    * synchronization. */
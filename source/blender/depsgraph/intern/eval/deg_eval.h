@@ -39,5 +39,12 @@ struct Depsgraph;
  */
 void deg_evaluate_on_refresh(Depsgraph *graph);
 
+/**
+ * Give every operation the cost of the most expensive chain of operations it starts, using the
+ * evaluation times measured on previous updates. Threads evaluate the ready operations with the
+ * highest priority first.
+ */
+void deg_graph_calculate_priorities(Depsgraph *graph);
+
 }  // namespace deg
 }  // namespace blender
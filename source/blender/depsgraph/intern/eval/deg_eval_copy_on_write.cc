@@ -346,6 +346,18 @@ bool scene_copy_inplace_no_main(const Scene *scene, Scene *new_scene)
   return result;
 }
 
+/* Similar to id_copy_inplace_no_main() but the geometry arrays are shared with the original
+ * mesh instead of being copied. They are only copied when either side modifies them. */
+bool mesh_copy_inplace_no_main(const Mesh *mesh, Mesh *new_mesh)
+{
+  ID *newid = &new_mesh->id;
+  return (BKE_id_copy_ex(nullptr,
+                         &mesh->id,
+                         &newid,
+                         (LIB_ID_COPY_LOCALIZE | LIB_ID_CREATE_NO_ALLOCATE |
+                          LIB_ID_COPY_SET_COPIED_ON_WRITE | LIB_ID_COPY_CD_SHARE)) != nullptr);
+}
+
 /* For the given scene get view layer which corresponds to an original for the
  * scene's evaluated one. This depends on how the scene is pulled into the
  * dependency graph. */
@@ -811,6 +823,12 @@ void update_id_after_copy(const Depsgraph *depsgraph,
       scene_setup_view_layers_after_remap(depsgraph, id_node, reinterpret_cast<Scene *>(id_cow));
       break;
     }
+    case ID_AC: {
+      /* F-Curves were re-allocated, users of the action can be evaluated without being copied
+       * again. */
+      BKE_animsys_action_tag_copied((bAction *)id_cow);
+      break;
+    }
     default:
       break;
   }
@@ -863,8 +881,6 @@ ID *deg_expand_copy_on_write_datablock(const Depsgraph *depsgraph,
   }
   // BLI_assert(check_datablock_expanded(id_cow) == false);
   /* Copy data from original ID to a copied version. */
-  /* TODO(sergey): Avoid doing full ID copy somehow, make Mesh to reference
-   * original geometry arrays for until those are modified. */
   /* TODO(sergey): We do some trickery with temp bmain and extra ID pointer
    * just to be able to use existing API. Ideally we need to replace this with
    * in-place copy from existing datablock to a prepared memory.
@@ -888,8 +904,13 @@ ID *deg_expand_copy_on_write_datablock(const Depsgraph *depsgraph,
       break;
     }
     case ID_ME: {
-      /* TODO(sergey): Ideally we want to handle meshes in a special
-       * manner here to avoid initial copy of all the geometry arrays. */
+      /* Original data is only modified from the main thread, which is also the only one using
+       * the active depsgraph, so its copies can share the geometry arrays prepared for sharing
+       * before evaluation. Other dependency graphs (render, jobs) are evaluated while the
+       * original could be modified, so they do a full copy. */
+      if (depsgraph->is_active) {
+        done = mesh_copy_inplace_no_main((const Mesh *)id_orig, (Mesh *)id_cow);
+      }
       break;
     }
     default:
@@ -0,0 +1,64 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/** \file
+ * \ingroup depsgraph
+ */
+
+#include "intern/depsgraph_testing.hh"
+
+#include "BKE_action.h"
+#include "BKE_anim_data.h"
+#include "BKE_fcurve.h"
+#include "BKE_lib_id.h"
+#include "BKE_object.h"
+
+#include "DEG_depsgraph_query.h"
+
+#include "DNA_action_types.h"
+#include "DNA_anim_types.h"
+#include "DNA_object_types.h"
+
+namespace blender::deg::tests {
+
+using deg_eval_copy_on_write = DepsgraphTest;
+
+/* Editing keys only tags the action, the users of the action are not copied again. Their
+ * animation is still evaluated with the new F-Curves of the action on the next frame. */
+TEST_F(deg_eval_copy_on_write, ActionCopiedWithoutUsers)
+{
+  Object *ob = BKE_object_add(bmain, view_layer, OB_EMPTY, "Empty");
+  bAction *act = BKE_action_add(bmain, "Action");
+  FCurve *fcu = add_location_fcurve(act, 0.0f, 9.0f);
+  AnimData *adt = BKE_animdata_ensure_id(&ob->id);
+  adt->action = act;
+  id_us_plus(&act->id);
+
+  depsgraph_build();
+  DEG_evaluate_on_framechange(depsgraph, 2.0f);
+  const Object *ob_eval = DEG_get_evaluated_object(depsgraph, ob);
+  EXPECT_FLOAT_EQ(ob_eval->loc[0], 1.0f);
+
+  fcu->bezt[1].vec[1][1] = 90.0f;
+  calchandles_fcurve(fcu);
+  DEG_id_tag_update_ex(bmain, &act->id, ID_RECALC_COPY_ON_WRITE);
+  DEG_evaluate_on_refresh(depsgraph);
+
+  DEG_evaluate_on_framechange(depsgraph, 3.0f);
+  EXPECT_FLOAT_EQ(ob_eval->loc[0], 20.0f);
+}
+
+}  // namespace blender::deg::tests
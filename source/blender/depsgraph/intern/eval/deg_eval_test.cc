@@ -0,0 +1,153 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/** \file
+ * \ingroup depsgraph
+ */
+
+#include "intern/depsgraph_testing.hh"
+
+#include "BKE_global.h"
+
+#include "BLI_vector.hh"
+
+#include "intern/depsgraph.h"
+#include "intern/eval/deg_eval.h"
+#include "intern/node/deg_node_component.h"
+#include "intern/node/deg_node_id.h"
+#include "intern/node/deg_node_operation.h"
+
+namespace blender::deg::tests {
+
+/* Adds operations to the dependency graph of the scene, connected by the test. */
+class deg_eval : public DepsgraphTest {
+ protected:
+  Depsgraph *deg_graph = nullptr;
+  ComponentNode *component = nullptr;
+  Vector<OperationNode *> operations;
+  /* Operations added by the test, in the order they were evaluated. */
+  Vector<OperationNode *> evaluated;
+
+  void SetUp() override
+  {
+    DepsgraphTest::SetUp();
+    depsgraph_build();
+    depsgraph_evaluate();
+
+    deg_graph = reinterpret_cast<Depsgraph *>(depsgraph);
+    IDNode *id_node = deg_graph->find_id_node(&scene->id);
+    component = id_node->add_component(NodeType::PARAMETERS, "deg_eval_test");
+    component->affects_directly_visible = true;
+  }
+
+  OperationNode *add_operation(const char *name,
+                               const float eval_time_average = 0.0f,
+                               const int name_tag = -1)
+  {
+    const int64_t index = operations.size();
+    OperationNode *node = component->add_operation(
+        [this, index](::Depsgraph * /*depsgraph*/) { evaluated.append(operations[index]); },
+        OperationCode::PARAMETERS_EVAL,
+        name,
+        name_tag);
+    node->eval_time_average = eval_time_average;
+    deg_graph->operations.append(node);
+    operations.append(node);
+    return node;
+  }
+
+  void add_relation(OperationNode *from, OperationNode *to)
+  {
+    deg_graph->add_new_relation(from, to, "deg_eval_test");
+  }
+
+  /* Tag the operations and evaluate the graph, with or without threads. The operations are
+   * recorded without locking, so they are expected to depend on each other. */
+  void evaluate_operations(Span<OperationNode *> nodes, const bool use_threads)
+  {
+    evaluated.clear();
+    for (OperationNode *node : nodes) {
+      node->tag_update(deg_graph, DEG_UPDATE_SOURCE_USER_EDIT);
+    }
+    const int debug = G.debug;
+    SET_FLAG_FROM_TEST(G.debug, !use_threads, G_DEBUG_DEPSGRAPH_NO_THREADS);
+    deg_evaluate_on_refresh(deg_graph);
+    G.debug = debug;
+  }
+};
+
+TEST_F(deg_eval, CriticalPathFirst)
+{
+  /* A short and a long chain of operations without timings, the long chain goes first. */
+  OperationNode *root = add_operation("root");
+  OperationNode *a = add_operation("a");
+  OperationNode *b1 = add_operation("b1");
+  OperationNode *b2 = add_operation("b2");
+  OperationNode *b3 = add_operation("b3");
+  add_relation(root, a);
+  add_relation(root, b1);
+  add_relation(b1, b2);
+  add_relation(b2, b3);
+
+  deg_graph_calculate_priorities(deg_graph);
+  EXPECT_GT(root->priority, b1->priority);
+  EXPECT_GT(b1->priority, b2->priority);
+  EXPECT_GT(b2->priority, b3->priority);
+  EXPECT_GT(b1->priority, a->priority);
+  EXPECT_FLOAT_EQ(a->priority, b3->priority);
+}
+
+TEST_F(deg_eval, CriticalPathByTime)
+{
+  /* A single operation which took longer before goes ahead of a chain of quick ones. */
+  OperationNode *root = add_operation("root");
+  OperationNode *a1 = add_operation("a1", 1e-5f);
+  OperationNode *a2 = add_operation("a2", 1e-5f);
+  OperationNode *a3 = add_operation("a3", 1e-5f);
+  OperationNode *b = add_operation("b", 1e-3f);
+  add_relation(root, a1);
+  add_relation(a1, a2);
+  add_relation(a2, a3);
+  add_relation(root, b);
+
+  deg_graph_calculate_priorities(deg_graph);
+  EXPECT_GT(b->priority, a1->priority);
+  EXPECT_FLOAT_EQ(root->priority, b->priority + 1e-6f);
+  EXPECT_FLOAT_EQ(a1->priority, 3e-5f);
+}
+
+TEST_F(deg_eval, LinearChainEvaluatedOnce)
+{
+  /* Each operation of the chain continues with the next one in the same task. */
+  Vector<OperationNode *> chain;
+  for (int i = 0; i < 64; i++) {
+    chain.append(add_operation("chain", 0.0f, i));
+    if (i > 0) {
+      add_relation(chain[i - 1], chain[i]);
+    }
+  }
+
+  for (const bool use_threads : {false, true}) {
+    evaluate_operations(chain, use_threads);
+    EXPECT_EQ(evaluated.as_span(), chain.as_span());
+    for (const OperationNode *node : chain) {
+      EXPECT_EQ(node->num_links_pending, 0);
+      EXPECT_EQ(node->scheduled, true);
+    }
+  }
+}
+
+}  // namespace blender::deg::tests
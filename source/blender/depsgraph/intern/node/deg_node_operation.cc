@@ -209,7 +209,8 @@ const char *operationCodeAsString(OperationCode opcode)
   return "UNKNOWN";
 }
 
-OperationNode::OperationNode() : name_tag(-1), flag(0)
+OperationNode::OperationNode()
+    : eval_time_average(0.0f), eval_count(0), priority(0.0f), name_tag(-1), flag(0)
 {
 }
 
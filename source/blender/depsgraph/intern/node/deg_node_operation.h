@@ -265,6 +265,14 @@ struct OperationNode : public Node {
   uint32_t num_links_pending;
   bool scheduled;
 
+  /* Averaged time it takes to evaluate this operation, in seconds. */
+  float eval_time_average;
+  /* Number of evaluations, to only time some of them. */
+  uint32_t eval_count;
+  /* Cost of the most expensive chain of operations starting at this one. Ready operations with
+   * the highest priority are evaluated first, so that long chains are not left for the end. */
+  float priority;
+
   /* Identifier for the operation being performed. */
   OperationCode opcode;
   int name_tag;
@@ -34,6 +34,7 @@
 #include "BLI_array.hh"
 #include "BLI_math_bits.h"
 #include "BLI_task.h"
+#include "BLI_trace.h"
 #include "BLI_vector.hh"
 
 #include "BKE_editmesh.h"
@@ -434,6 +435,8 @@ static void extract_task_range_run(void *__restrict taskdata)
   const eMRIterType iter_type = data->iter_type;
   const bool is_mesh = data->mr->extract_type != MR_EXTRACT_BMESH;
 
+  TraceScope trace_scope("draw", "Extract Mesh Buffers");
+
   size_t userdata_chunk_size = data->extractors->data_size_total();
   void *userdata_chunk = MEM_callocN(userdata_chunk_size, __func__);
 
@@ -530,6 +533,8 @@ static void mesh_extract_render_data_node_exec(void *__restrict task_data)
   const eMRIterType iter_type = update_task_data->iter_type;
   const eMRDataType data_flag = update_task_data->data_flag;
 
+  TraceScope trace_scope("draw", "Update Mesh Render Data");
+
   mesh_render_data_update_normals(mr, data_flag);
   mesh_render_data_update_looptris(mr, iter_type, data_flag);
   mesh_render_data_update_loose_geom(mr, update_task_data->cache, iter_type, data_flag);
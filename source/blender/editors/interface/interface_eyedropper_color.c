@@ -161,7 +161,8 @@ static void eyedropper_exit(bContext *C, wmOperator *op)
 
 /* *** eyedropper_color_ helper functions *** */
 
-static bool eyedropper_cryptomatte_sample_renderlayer_fl(RenderLayer *render_layer,
+static bool eyedropper_cryptomatte_sample_renderlayer_fl(RenderResult *render_result,
+                                                         RenderLayer *render_layer,
                                                          const char *prefix,
                                                          const float fpos[2],
                                                          float r_col[3])
@@ -189,6 +190,9 @@ static bool eyedropper_cryptomatte_sample_renderlayer_fl(RenderLayer *render_lay
     if (STRPREFIX(render_pass->name, render_pass_name_prefix) &&
         !STREQLEN(render_pass->name, render_pass_name_prefix, sizeof(render_pass->name))) {
       BLI_assert(render_pass->channels == 4);
+      if (!RE_pass_ensure_loaded(render_result, render_pass)) {
+        return false;
+      }
       const int x = (int)(fpos[0] * render_pass->rectx);
       const int y = (int)(fpos[1] * render_pass->recty);
       const int offset = 4 * (y * render_pass->rectx + x);
@@ -215,7 +219,8 @@ static bool eyedropper_cryptomatte_sample_render_fl(const bNode *node,
     if (rr) {
       LISTBASE_FOREACH (ViewLayer *, view_layer, &scene->view_layers) {
         RenderLayer *render_layer = RE_GetRenderLayer(rr, view_layer->name);
-        success = eyedropper_cryptomatte_sample_renderlayer_fl(render_layer, prefix, fpos, r_col);
+        success = eyedropper_cryptomatte_sample_renderlayer_fl(
+            rr, render_layer, prefix, fpos, r_col);
         if (success) {
           break;
         }
@@ -241,7 +246,8 @@ static bool eyedropper_cryptomatte_sample_image_fl(const bNode *node,
     ImBuf *ibuf = BKE_image_acquire_ibuf(image, iuser, NULL);
     if (image->rr) {
       LISTBASE_FOREACH (RenderLayer *, render_layer, &image->rr->layers) {
-        success = eyedropper_cryptomatte_sample_renderlayer_fl(render_layer, prefix, fpos, r_col);
+        success = eyedropper_cryptomatte_sample_renderlayer_fl(
+            image->rr, render_layer, prefix, fpos, r_col);
         if (success) {
           break;
         }
@@ -148,6 +148,7 @@ static int wm_alembic_export_exec(bContext *C, wmOperator *op)
       .export_particles = RNA_boolean_get(op->ptr, "export_particles"),
       .export_custom_properties = RNA_boolean_get(op->ptr, "export_custom_properties"),
       .use_instancing = RNA_boolean_get(op->ptr, "use_instancing"),
+      .use_parallel_frames = RNA_boolean_get(op->ptr, "use_parallel_frames"),
       .packuv = RNA_boolean_get(op->ptr, "packuv"),
       .triangulate = RNA_boolean_get(op->ptr, "triangulate"),
       .quad_method = RNA_enum_get(op->ptr, "quad_method"),
@@ -202,6 +203,8 @@ static void ui_alembic_export_settings(uiLayout *layout, PointerRNA *imfptr)
   uiItemR(sub, imfptr, "sh_open", UI_ITEM_R_SLIDER, NULL, ICON_NONE);
   uiItemR(sub, imfptr, "sh_close", UI_ITEM_R_SLIDER, IFACE_("Close"), ICON_NONE);
 
+  uiItemR(col, imfptr, "use_parallel_frames", 0, NULL, ICON_NONE);
+
   uiItemS(col);
 
   uiItemR(col, imfptr, "flatten", 0, NULL, ICON_NONE);
@@ -426,6 +429,14 @@ void WM_OT_alembic_export(wmOperatorType *ot)
                   "Export data of duplicated objects as Alembic instances; speeds up the export "
                   "and can be disabled for compatibility with other software");
 
+  RNA_def_boolean(ot->srna,
+                  "use_parallel_frames",
+                  false,
+                  "Parallel Frames",
+                  "Evaluate several frames at the same time, using more memory. Only for scenes "
+                  "where frames do not depend on each other, like simulations do. Frame change "
+                  "handlers are not run");
+
   RNA_def_float(
       ot->srna,
       "global_scale",
@@ -41,6 +41,8 @@
 #include "DNA_space_types.h"
 #include "DNA_userdef_types.h"
 
+#include "BLT_translation.h"
+
 #include "BKE_context.h"
 #include "BKE_fcurve.h"
 #include "BKE_global.h"
@@ -2365,6 +2367,31 @@ static void draw_cache_view(const bContext *C)
   GPU_blend(GPU_BLEND_NONE);
 }
 
+/* Show how fast prefetching fills the cache, so it's clear whether it can keep up with playback.
+ * Drawn in region space. */
+static void draw_cache_view_fill_rate(const bContext *C)
+{
+  Scene *scene = CTX_data_scene(C);
+
+  if ((scene->ed->cache_flag & SEQ_CACHE_VIEW_ENABLE) == 0) {
+    return;
+  }
+
+  const float fill_rate = SEQ_prefetch_fill_rate_get(scene);
+  if (fill_rate <= 0.0f) {
+    return;
+  }
+
+  char str[64];
+  const size_t str_len = BLI_snprintf_rlen(
+      str, sizeof(str), TIP_("Prefetch: %.1f fps"), fill_rate);
+  const int fontid = BLF_default();
+  BLF_set_default();
+  UI_FontThemeColor(fontid, TH_TEXT_HI);
+  BLF_position(fontid, 1.5f * U.widget_unit, V2D_SCROLL_HANDLE_HEIGHT + U.widget_unit, 0.0f);
+  BLF_draw(fontid, str, str_len);
+}
+
 /* Draw sequencer timeline. */
 static void draw_overlap_frame_indicator(const struct Scene *scene, const View2D *v2d)
 {
@@ -2494,6 +2521,7 @@ void draw_timeline_seq_display(const bContext *C, ARegion *region)
       draw_overlap_frame_indicator(scene, v2d);
     }
     UI_view2d_view_restore(C);
+    draw_cache_view_fill_rate(C);
   }
 
   ED_time_scrub_draw_current_frame(region, scene, !(sseq->flag & SEQ_DRAWFRAMES), true);
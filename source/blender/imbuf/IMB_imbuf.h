@@ -123,6 +123,14 @@ struct ImBuf *IMB_testiffname(const char *filepath, int flags);
  */
 struct ImBuf *IMB_loadiffname(const char *filepath, int flags, char colorspace[IM_MAX_SPACE]);
 
+/**
+ *
+ * \attention Defined in readimage.c
+ */
+struct ImBuf *IMB_thumb_load_image(const char *filepath,
+                                   const size_t max_thumb_size,
+                                   char colorspace[IM_MAX_SPACE]);
+
 /**
  *
  * \attention Defined in allocimbuf.c
@@ -235,6 +243,14 @@ void IMB_blend_color_float(float dst[4],
                            const float src1[4],
                            const float src2[4],
                            IMB_BlendMode mode);
+/** Blend `totpixel` pixels, the same as the functions above for each of them. */
+void IMB_blend_color_byte_n(unsigned char *dst,
+                            const unsigned char *src1,
+                            const unsigned char *src2,
+                            int totpixel,
+                            IMB_BlendMode mode);
+void IMB_blend_color_float_n(
+    float *dst, const float *src1, const float *src2, int totpixel, IMB_BlendMode mode);
 
 void IMB_rect_crop(struct ImBuf *ibuf, const struct rcti *crop);
 
@@ -334,6 +350,14 @@ typedef enum eIMBInterpolationFilterMode {
   IMB_FILTER_BILINEAR,
 } eIMBInterpolationFilterMode;
 
+/** Reconstruction kernels of #IMB_scaleImBuf_filtered, from fastest to sharpest. */
+typedef enum eIMBScaleFilter {
+  IMB_SCALE_FILTER_BOX,
+  IMB_SCALE_FILTER_BILINEAR,
+  IMB_SCALE_FILTER_MITCHELL,
+  IMB_SCALE_FILTER_LANCZOS3,
+} eIMBScaleFilter;
+
 /* Defaults to BL_proxy within the directory of the animation. */
 void IMB_anim_set_index_dir(struct anim *anim, const char *dir);
 void IMB_anim_get_fname(struct anim *anim, char *file, int size);
@@ -443,6 +467,30 @@ void IMB_tile_cache_params(int totthread, int maxmem);
 unsigned int *IMB_gettile(struct ImBuf *ibuf, int tx, int ty, int thread);
 void IMB_tiles_to_rect(struct ImBuf *ibuf);
 
+/**
+ * Reads pixels of images loaded with #IB_tilecache and keeps the last used tile acquired, so
+ * that nearby pixels can be read without locking the tile cache. Every reader must be ended
+ * with #IMB_tile_reader_end before the images it read from are released.
+ */
+typedef struct ImTileReader {
+  struct ImBuf *ibuf;
+  void *tile;
+  const unsigned int *rect;
+  int tx, ty;
+} ImTileReader;
+
+void IMB_tile_reader_init(ImTileReader *reader);
+void IMB_tile_reader_end(ImTileReader *reader);
+void IMB_tiled_pixel_get(
+    ImTileReader *reader, struct ImBuf *ibuf, int x, int y, unsigned char r_col[4]);
+void IMB_tiled_rect_get(ImTileReader *reader,
+                        struct ImBuf *ibuf,
+                        int xmin,
+                        int ymin,
+                        int width,
+                        int height,
+                        unsigned char *r_rect);
+
 /**
  *
  * \attention Defined in filter.c
@@ -473,6 +521,15 @@ bool IMB_scalefastImBuf(struct ImBuf *ibuf, unsigned int newx, unsigned int newy
  */
 void IMB_scaleImBuf_threaded(struct ImBuf *ibuf, unsigned int newx, unsigned int newy);
 
+/**
+ *
+ * \attention Defined in scaling.c
+ */
+bool IMB_scaleImBuf_filtered(struct ImBuf *ibuf,
+                             unsigned int newx,
+                             unsigned int newy,
+                             const eIMBScaleFilter filter);
+
 /**
  *
  * \attention Defined in writeimage.c
@@ -172,6 +172,8 @@ typedef enum eImBufFlags {
   IB_thumbnail = 1 << 16,
   IB_multiview = 1 << 17,
   IB_halffloat = 1 << 18,
+  /** Multilayer files only get their layers listed, their passes are read from the file later. */
+  IB_multilayer_on_demand = 1 << 19,
 } eImBufFlags;
 
 /** \} */
@@ -73,6 +73,18 @@ void IMB_moviecache_cleanup(struct MovieCache *cache,
 void IMB_moviecache_get_cache_segments(
     struct MovieCache *cache, int proxy, int render_flags, int *r_totseg, int **r_points);
 
+/* Memory usage of all movie caches and of caches which manage their own buffers. */
+typedef struct MovieCacheStats {
+  char name[64];
+  int totitem;
+  size_t memory_in_use;
+} MovieCacheStats;
+
+void IMB_moviecache_external_add(const char *name, size_t size);
+void IMB_moviecache_external_remove(const char *name, size_t size);
+size_t IMB_moviecache_get_memory_in_use(void);
+int IMB_moviecache_get_stats(MovieCacheStats *r_stats, int max_stats);
+
 struct MovieCacheIter;
 struct MovieCacheIter *IMB_moviecacheIter_new(struct MovieCache *cache);
 void IMB_moviecacheIter_free(struct MovieCacheIter *iter);
@@ -62,6 +62,10 @@
 #  include <libavcodec/avcodec.h>
 #  include <libavformat/avformat.h>
 #  include <libswscale/swscale.h>
+
+#  include "BLI_threads.h"
+
+#  include "DNA_listBase.h"
 #endif
 
 /* more endianness... should move to a separate file... */
@@ -80,6 +84,11 @@
 
 #define MAXNUMSTREAMS 50
 
+/* Number of frames decoded ahead of the last requested one during sequential reads. */
+#define ANIM_DECODE_AHEAD_FRAMES 4
+/* Number of frames decoded ahead by all animations together. */
+#define ANIM_DECODE_AHEAD_FRAMES_TOTAL 16
+
 struct IDProperty;
 struct _AviMovie;
 struct anim_index;
@@ -135,6 +144,30 @@ struct anim {
   int64_t cur_pts;
   int64_t cur_key_frame_pts;
   AVPacket *cur_packet;
+
+  /* Decoding of the frames following the last requested one, see `anim_decode_ahead_*`.
+   * `decode_mutex` guards the decoder state above, `decode_ahead_mutex` the ring below. */
+  ThreadMutex decode_mutex;
+  ThreadMutex decode_ahead_mutex;
+  ThreadCondition decode_ahead_cond;
+  ListBase decode_ahead_threads;
+  struct ImBuf *decode_ahead_ibuf[ANIM_DECODE_AHEAD_FRAMES];
+  /* Frame number of `decode_ahead_ibuf[0]`. */
+  int decode_ahead_position;
+  int decode_ahead_len;
+  /* Incremented whenever the ring is flushed, so frames decoded for a stale position are
+   * dropped. */
+  int decode_ahead_generation;
+  int decode_ahead_last_position;
+  IMB_Timecode_Type decode_ahead_tc;
+  /* Sequential reads are decoded ahead. */
+  bool decode_ahead_running;
+  /* The decoding thread is running, it stops when there is nothing left to decode. */
+  bool decode_ahead_thread_active;
+  bool decode_ahead_stop;
+  bool decode_ahead_busy;
+  bool decode_ahead_hold;
+  bool decode_ahead_eof;
 #endif
 
   char index_dir[768];
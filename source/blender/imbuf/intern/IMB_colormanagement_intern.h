@@ -58,6 +58,13 @@ typedef struct ColorSpace {
     bool is_srgb;
     bool is_scene_linear;
   } info;
+
+  /* Byte to scene linear conversion baked into a table of 256 RGB triplets. NULL when the
+   * transform mixes channels. Computed only when needed. */
+  struct {
+    bool cached;
+    float *table;
+  } byte_to_scene_linear;
 } ColorSpace;
 
 typedef struct ColorManagedDisplay {
@@ -48,6 +48,26 @@ typedef struct ImFileType {
                         char colorspace[IM_MAX_SPACE]);
   /** Load an image from a file. */
   struct ImBuf *(*load_filepath)(const char *filepath, int flags, char colorspace[IM_MAX_SPACE]);
+  /**
+   * Load a reduced resolution version of an image from a file, with the larger side not much
+   * bigger than `max_thumb_size`. The size of the full image is returned in `r_width` and
+   * `r_height`. Optional, #IMB_thumb_load_image falls back to loading the full image.
+   */
+  struct ImBuf *(*load_filepath_thumbnail)(const char *filepath,
+                                           const int flags,
+                                           const size_t max_thumb_size,
+                                           char colorspace[IM_MAX_SPACE],
+                                           size_t *r_width,
+                                           size_t *r_height);
+  /**
+   * Same as `load`, but also given the path of the file, so multilayer files can be loaded with
+   * #IB_multilayer_on_demand to read their passes from the file later. Optional.
+   */
+  struct ImBuf *(*load_multilayer)(const unsigned char *mem,
+                                   size_t size,
+                                   const char *filepath,
+                                   int flags,
+                                   char colorspace[IM_MAX_SPACE]);
   /** Save to a file (or memory if #IB_mem is set in `flags` and the format supports it). */
   bool (*save)(struct ImBuf *ibuf, const char *filepath, int flags);
   void (*load_tile)(struct ImBuf *ibuf,
@@ -120,6 +140,12 @@ bool imb_save_jp2(struct ImBuf *ibuf, const char *filepath, int flags);
 /* jpeg */
 bool imb_is_a_jpeg(const unsigned char *mem, const size_t size);
 bool imb_savejpeg(struct ImBuf *ibuf, const char *filepath, int flags);
+struct ImBuf *imb_thumbnail_jpeg(const char *filepath,
+                                 const int flags,
+                                 const size_t max_thumb_size,
+                                 char colorspace[IM_MAX_SPACE],
+                                 size_t *r_width,
+                                 size_t *r_height);
 struct ImBuf *imb_load_jpeg(const unsigned char *buffer,
                             size_t size,
                             int flags,
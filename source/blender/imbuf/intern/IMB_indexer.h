@@ -112,6 +112,7 @@ void IMB_indexer_close(struct anim_index *idx);
 void IMB_free_indices(struct anim *anim);
 
 struct anim *IMB_anim_open_proxy(struct anim *anim, IMB_Proxy_Size preview_size);
+/* Opens the index on first use, movies need `decode_mutex` held for this. */
 struct anim_index *IMB_anim_open_index(struct anim *anim, IMB_Timecode_Type tc);
 
 int IMB_proxy_size_to_array_index(IMB_Proxy_Size pr_size);
@@ -60,6 +60,8 @@
 
 #include "MEM_guardedalloc.h"
 
+#include "atomic_ops.h"
+
 #ifdef WITH_AVI
 #  include "AVI_avi.h"
 #endif
@@ -202,6 +204,7 @@ static void free_anim_avi(struct anim *anim)
 
 #ifdef WITH_FFMPEG
 static void free_anim_ffmpeg(struct anim *anim);
+static void anim_decode_ahead_end(struct anim *anim);
 #endif
 
 void IMB_free_anim(struct anim *anim)
@@ -211,6 +214,10 @@ void IMB_free_anim(struct anim *anim)
     return;
   }
 
+#ifdef WITH_FFMPEG
+  anim_decode_ahead_end(anim);
+#endif
+
   free_anim_movie(anim);
 
 #ifdef WITH_AVI
@@ -223,6 +230,12 @@ void IMB_free_anim(struct anim *anim)
   IMB_free_indices(anim);
   IMB_metadata_free(anim->metadata);
 
+#ifdef WITH_FFMPEG
+  BLI_mutex_end(&anim->decode_mutex);
+  BLI_mutex_end(&anim->decode_ahead_mutex);
+  BLI_condition_end(&anim->decode_ahead_cond);
+#endif
+
   MEM_freeN(anim);
 }
 
@@ -241,6 +254,11 @@ void IMB_close_anim_proxies(struct anim *anim)
     return;
   }
 
+#ifdef WITH_FFMPEG
+  /* The decode-ahead thread reads the indices. */
+  anim_decode_ahead_end(anim);
+#endif
+
   IMB_free_indices(anim);
 }
 
@@ -302,6 +320,13 @@ struct anim *IMB_open_anim(const char *name,
     BLI_strncpy(anim->name, name, sizeof(anim->name));
     anim->ib_flags = ib_flags;
     anim->streamindex = streamindex;
+
+#ifdef WITH_FFMPEG
+    BLI_mutex_init(&anim->decode_mutex);
+    BLI_mutex_init(&anim->decode_ahead_mutex);
+    BLI_condition_init(&anim->decode_ahead_cond);
+    anim->decode_ahead_last_position = -2;
+#endif
   }
   return anim;
 }
@@ -1453,6 +1478,222 @@ static void free_anim_ffmpeg(struct anim *anim)
   anim->duration_in_frames = 0;
 }
 
+/* -------------------------------------------------------------------- */
+/** \name FFmpeg Decode-Ahead
+ *
+ * Once frames are requested sequentially (playback, rendering) a thread keeps decoding the
+ * frames following the last requested one into a small ring, so decoding of the next frame
+ * overlaps with whatever the caller does with the current one. Any other request flushes the
+ * ring, is decoded directly and sequential decoding resumes from there, which keeps scrubbing
+ * and playback after a seek cheap without proxies.
+ *
+ * The thread only runs while there is something to decode and is started again by the next
+ * request, so animations which are not read from do not keep a thread around. Frames in the
+ * rings of all animations together are limited to #ANIM_DECODE_AHEAD_FRAMES_TOTAL, they are not
+ * known to the memory cache limiter.
+ *
+ * The decoder itself is only ever used with `decode_mutex` held.
+ * \{ */
+
+/* Frames held by the rings of all animations. */
+static int anim_decode_ahead_frames_total = 0;
+
+static bool anim_decode_ahead_reserve_frame(void)
+{
+  if (atomic_add_and_fetch_int32(&anim_decode_ahead_frames_total, 1) <=
+      ANIM_DECODE_AHEAD_FRAMES_TOTAL) {
+    return true;
+  }
+  atomic_sub_and_fetch_int32(&anim_decode_ahead_frames_total, 1);
+  return false;
+}
+
+static void anim_decode_ahead_release_frame(void)
+{
+  atomic_sub_and_fetch_int32(&anim_decode_ahead_frames_total, 1);
+}
+
+/* Must be called with `decode_ahead_mutex` held. */
+static void anim_decode_ahead_flush(struct anim *anim)
+{
+  for (int i = 0; i < anim->decode_ahead_len; i++) {
+    IMB_freeImBuf(anim->decode_ahead_ibuf[i]);
+    anim->decode_ahead_ibuf[i] = NULL;
+    anim_decode_ahead_release_frame();
+  }
+  anim->decode_ahead_len = 0;
+  anim->decode_ahead_eof = false;
+  anim->decode_ahead_generation++;
+}
+
+/* Must be called with `decode_ahead_mutex` held, ownership of the frame goes to the caller. */
+static ImBuf *anim_decode_ahead_pop(struct anim *anim)
+{
+  ImBuf *ibuf = anim->decode_ahead_ibuf[0];
+
+  anim->decode_ahead_len--;
+  memmove(&anim->decode_ahead_ibuf[0],
+          &anim->decode_ahead_ibuf[1],
+          sizeof(*anim->decode_ahead_ibuf) * anim->decode_ahead_len);
+  anim->decode_ahead_ibuf[anim->decode_ahead_len] = NULL;
+  anim->decode_ahead_position++;
+  anim_decode_ahead_release_frame();
+
+  return ibuf;
+}
+
+/* Must be called with `decode_ahead_mutex` held. */
+static bool anim_decode_ahead_has_work(const struct anim *anim)
+{
+  return !anim->decode_ahead_stop && !anim->decode_ahead_hold && !anim->decode_ahead_eof &&
+         anim->decode_ahead_len < ANIM_DECODE_AHEAD_FRAMES;
+}
+
+static void *anim_decode_ahead_thread(void *anim_v)
+{
+  struct anim *anim = anim_v;
+
+  BLI_mutex_lock(&anim->decode_ahead_mutex);
+  while (anim_decode_ahead_has_work(anim)) {
+    if (!anim_decode_ahead_reserve_frame()) {
+      /* Rings of other animations hold all the frames, try again on the next request. */
+      break;
+    }
+
+    const int position = anim->decode_ahead_position + anim->decode_ahead_len;
+    const IMB_Timecode_Type tc = anim->decode_ahead_tc;
+    const int generation = anim->decode_ahead_generation;
+    anim->decode_ahead_busy = true;
+    BLI_mutex_unlock(&anim->decode_ahead_mutex);
+
+    ImBuf *ibuf = NULL;
+    BLI_mutex_lock(&anim->decode_mutex);
+    if (position < anim->duration_in_frames) {
+      ibuf = ffmpeg_fetchibuf(anim, position, tc);
+    }
+    BLI_mutex_unlock(&anim->decode_mutex);
+
+    BLI_mutex_lock(&anim->decode_ahead_mutex);
+    anim->decode_ahead_busy = false;
+    if (generation != anim->decode_ahead_generation) {
+      /* The caller moved elsewhere in the meantime. */
+      IMB_freeImBuf(ibuf);
+      anim_decode_ahead_release_frame();
+    }
+    else if (ibuf == NULL) {
+      anim->decode_ahead_eof = true;
+      anim_decode_ahead_release_frame();
+    }
+    else {
+      anim->decode_ahead_ibuf[anim->decode_ahead_len++] = ibuf;
+    }
+    BLI_condition_notify_all(&anim->decode_ahead_cond);
+  }
+  anim->decode_ahead_thread_active = false;
+  BLI_condition_notify_all(&anim->decode_ahead_cond);
+  BLI_mutex_unlock(&anim->decode_ahead_mutex);
+
+  return NULL;
+}
+
+/* Must be called with `decode_ahead_mutex` held. Starts the thread if it stopped while there is
+ * something to decode again. */
+static void anim_decode_ahead_wake(struct anim *anim)
+{
+  if (anim->decode_ahead_thread_active || !anim_decode_ahead_has_work(anim)) {
+    return;
+  }
+  /* The previous thread is done with the mutex, joining it does not block. */
+  BLI_threadpool_end(&anim->decode_ahead_threads);
+  anim->decode_ahead_thread_active = true;
+  BLI_threadpool_init(&anim->decode_ahead_threads, anim_decode_ahead_thread, 1);
+  BLI_threadpool_insert(&anim->decode_ahead_threads, anim);
+}
+
+static void anim_decode_ahead_end(struct anim *anim)
+{
+  if (!anim->decode_ahead_running) {
+    return;
+  }
+
+  BLI_mutex_lock(&anim->decode_ahead_mutex);
+  anim->decode_ahead_stop = true;
+  BLI_mutex_unlock(&anim->decode_ahead_mutex);
+
+  BLI_threadpool_end(&anim->decode_ahead_threads);
+
+  BLI_mutex_lock(&anim->decode_ahead_mutex);
+  anim_decode_ahead_flush(anim);
+  anim->decode_ahead_running = false;
+  anim->decode_ahead_thread_active = false;
+  anim->decode_ahead_stop = false;
+  anim->decode_ahead_hold = false;
+  anim->decode_ahead_last_position = -2;
+  BLI_mutex_unlock(&anim->decode_ahead_mutex);
+}
+
+static ImBuf *ffmpeg_fetchibuf_decode_ahead(struct anim *anim, int position, IMB_Timecode_Type tc)
+{
+  ImBuf *ibuf = NULL;
+
+  BLI_mutex_lock(&anim->decode_ahead_mutex);
+  if (anim->decode_ahead_running) {
+    if (tc != anim->decode_ahead_tc || position < anim->decode_ahead_position ||
+        position > anim->decode_ahead_position + anim->decode_ahead_len) {
+      /* Not reachable from the ring: hold the thread off the decoder until the requested frame
+       * is decoded here, then continue after it. */
+      anim_decode_ahead_flush(anim);
+      anim->decode_ahead_hold = true;
+    }
+    else {
+      /* Frames skipped over by the caller. */
+      while (anim->decode_ahead_position < position) {
+        IMB_freeImBuf(anim_decode_ahead_pop(anim));
+      }
+      /* The requested frame may be decoding right now. */
+      while (anim->decode_ahead_len == 0 && anim->decode_ahead_busy) {
+        BLI_condition_wait(&anim->decode_ahead_cond, &anim->decode_ahead_mutex);
+      }
+      if (anim->decode_ahead_len > 0) {
+        ibuf = anim_decode_ahead_pop(anim);
+        anim_decode_ahead_wake(anim);
+      }
+      else {
+        anim->decode_ahead_hold = true;
+      }
+    }
+  }
+  const bool is_sequential = (position == anim->decode_ahead_last_position + 1);
+  anim->decode_ahead_last_position = position;
+  BLI_mutex_unlock(&anim->decode_ahead_mutex);
+
+  if (ibuf != NULL) {
+    return ibuf;
+  }
+
+  BLI_mutex_lock(&anim->decode_mutex);
+  ibuf = ffmpeg_fetchibuf(anim, position, tc);
+  BLI_mutex_unlock(&anim->decode_mutex);
+
+  BLI_mutex_lock(&anim->decode_ahead_mutex);
+  if (anim->decode_ahead_running || (is_sequential && ibuf != NULL)) {
+    anim->decode_ahead_running = true;
+    anim->decode_ahead_position = position + 1;
+    anim->decode_ahead_tc = tc;
+    anim->decode_ahead_hold = false;
+    if (ibuf != NULL) {
+      /* The end might have been reached by an earlier request. */
+      anim->decode_ahead_eof = false;
+    }
+    anim_decode_ahead_wake(anim);
+  }
+  BLI_mutex_unlock(&anim->decode_ahead_mutex);
+
+  return ibuf;
+}
+
+/** \} */
+
 #endif
 
 /* Try next picture to read */
@@ -1602,10 +1843,8 @@ struct ImBuf *IMB_anim_absolute(struct anim *anim,
 #endif
 #ifdef WITH_FFMPEG
     case ANIM_FFMPEG:
-      ibuf = ffmpeg_fetchibuf(anim, position, tc);
-      if (ibuf) {
-        anim->cur_position = position;
-      }
+      /* The decoder position is owned by the decode-ahead thread. */
+      ibuf = ffmpeg_fetchibuf_decode_ahead(anim, position, tc);
       filter_y = 0; /* done internally */
       break;
 #endif
@@ -1615,7 +1854,7 @@ struct ImBuf *IMB_anim_absolute(struct anim *anim,
     if (filter_y) {
       IMB_filtery(ibuf);
     }
-    BLI_snprintf(ibuf->name, sizeof(ibuf->name), "%s.%04d", anim->name, anim->cur_position + 1);
+    BLI_snprintf(ibuf->name, sizeof(ibuf->name), "%s.%04d", anim->name, position + 1);
   }
   return ibuf;
 }
@@ -1629,7 +1868,14 @@ int IMB_anim_get_duration(struct anim *anim, IMB_Timecode_Type tc)
     return anim->duration_in_frames;
   }
 
+#ifdef WITH_FFMPEG
+  /* The decode-ahead thread opens indices too, while holding the decoder lock. */
+  BLI_mutex_lock(&anim->decode_mutex);
+#endif
   idx = IMB_anim_open_index(anim, tc);
+#ifdef WITH_FFMPEG
+  BLI_mutex_unlock(&anim->decode_mutex);
+#endif
   if (!idx) {
     return anim->duration_in_frames;
   }
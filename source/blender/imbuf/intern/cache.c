@@ -22,6 +22,7 @@
 
 #include "BLI_ghash.h"
 #include "BLI_listbase.h"
+#include "BLI_math_base.h"
 #include "BLI_memarena.h"
 #include "BLI_threads.h"
 #include "BLI_utildefines.h"
@@ -47,6 +48,10 @@
 
 #define IB_THREAD_CACHE_SIZE 100
 
+/* Memory limit in megabytes when no render configured the cache, so that sampling huge textures
+ * outside of rendering (modifiers, painting, ..) keeps a bounded number of tiles loaded. */
+#define IB_TILE_CACHE_DEFAULT_MAXMEM 512
+
 typedef struct ImGlobalTile {
   struct ImGlobalTile *next, *prev;
 
@@ -174,6 +179,9 @@ void imb_tile_cache_tile_free(ImBuf *ibuf, int tx, int ty)
     BLI_ghash_remove(GLOBAL_CACHE.tilehash, gtile, NULL, NULL);
     BLI_remlink(&GLOBAL_CACHE.tiles, gtile);
     BLI_addtail(&GLOBAL_CACHE.unused, gtile);
+
+    /* The caller frees the pixels. */
+    GLOBAL_CACHE.totmem -= sizeof(unsigned int) * ibuf->tilex * ibuf->tiley;
   }
 
   BLI_mutex_unlock(&GLOBAL_CACHE.mutex);
@@ -215,7 +223,7 @@ void imb_tile_cache_init(void)
 
   /* initialize for one thread, for places that access textures
    * outside of rendering (displace modifier, painting, ..) */
-  IMB_tile_cache_params(0, 0);
+  IMB_tile_cache_params(0, IB_TILE_CACHE_DEFAULT_MAXMEM);
 
   GLOBAL_CACHE.initialized = 1;
 }
@@ -491,3 +499,91 @@ void IMB_tiles_to_rect(ImBuf *ibuf)
 }
 
 /** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Tile Sampling
+ *
+ * Pixel access for tiled images that works from any thread, without a thread index. Tiles are
+ * acquired through the global cache and only the tiles containing the sampled pixels are read
+ * from disk.
+ * \{ */
+
+static ImGlobalTile *imb_tile_acquire(ImBuf *ibuf, int tx, int ty)
+{
+  return imb_global_cache_get_tile(ibuf, tx, ty, NULL);
+}
+
+static void imb_tile_release(ImGlobalTile *gtile)
+{
+  BLI_mutex_lock(&GLOBAL_CACHE.mutex);
+  gtile->refcount--;
+  BLI_mutex_unlock(&GLOBAL_CACHE.mutex);
+}
+
+void IMB_tile_reader_init(ImTileReader *reader)
+{
+  memset(reader, 0, sizeof(*reader));
+}
+
+/**
+ * Release the tile the reader keeps acquired, the reader can be used again afterwards.
+ */
+void IMB_tile_reader_end(ImTileReader *reader)
+{
+  if (reader->tile) {
+    imb_tile_release(reader->tile);
+  }
+  IMB_tile_reader_init(reader);
+}
+
+/**
+ * Get a byte pixel of an image loaded with #IB_tilecache, coordinates are clamped to the image.
+ * The cache is only locked when the pixel lies in another tile than the previous one.
+ */
+void IMB_tiled_pixel_get(
+    ImTileReader *reader, ImBuf *ibuf, int x, int y, unsigned char r_col[4])
+{
+  BLI_assert(ibuf->flags & IB_tilecache);
+
+  x = clamp_i(x, 0, ibuf->x - 1);
+  y = clamp_i(y, 0, ibuf->y - 1);
+
+  const int tx = x / ibuf->tilex;
+  const int ty = y / ibuf->tiley;
+
+  if (reader->ibuf != ibuf || reader->tx != tx || reader->ty != ty) {
+    if (reader->tile) {
+      imb_tile_release(reader->tile);
+    }
+    reader->tile = imb_tile_acquire(ibuf, tx, ty);
+    reader->rect = ibuf->tiles[ibuf->xtiles * ty + tx];
+    reader->ibuf = ibuf;
+    reader->tx = tx;
+    reader->ty = ty;
+  }
+
+  const int offset = (y - ty * ibuf->tiley) * ibuf->tilex + (x - tx * ibuf->tilex);
+  memcpy(r_col, reader->rect + offset, sizeof(unsigned int));
+}
+
+/**
+ * Get a block of byte pixels of an image loaded with #IB_tilecache, coordinates are clamped to
+ * the image. Pixels are read row by row, so the cache is locked whenever a row crosses into
+ * another tile.
+ */
+void IMB_tiled_rect_get(ImTileReader *reader,
+                        ImBuf *ibuf,
+                        int xmin,
+                        int ymin,
+                        int width,
+                        int height,
+                        unsigned char *r_rect)
+{
+  for (int j = 0; j < height; j++) {
+    for (int i = 0; i < width; i++) {
+      IMB_tiled_pixel_get(reader, ibuf, xmin + i, ymin + j, r_rect + ((size_t)j * width + i) * 4);
+    }
+  }
+}
+
+/** \} */
@@ -43,6 +43,7 @@
 #include "MEM_guardedalloc.h"
 
 #include "BLI_blenlib.h"
+#include "BLI_ghash.h"
 #include "BLI_math.h"
 #include "BLI_math_color.h"
 #include "BLI_rect.h"
@@ -67,6 +68,9 @@
 
 #define DISPLAY_BUFFER_CHANNELS 4
 
+/* Amount of pixels converted to display space at once by a thread. */
+#define DISPLAY_BUFFER_BLOCK_PIXELS 16384
+
 /* ** list of all supported color spaces, displays and views */
 static char global_role_data[MAX_COLORSPACE_NAME];
 static char global_role_scene_linear[MAX_COLORSPACE_NAME];
@@ -102,6 +106,8 @@ static pthread_mutex_t processor_lock = BLI_MUTEX_INITIALIZER;
 
 typedef struct ColormanageProcessor {
   OCIO_ConstCPUProcessorRcPtr *cpu_processor;
+  /* Entry of the CPU processor cache owning `cpu_processor`. */
+  struct CPUProcessorCacheEntry *cpu_processor_entry;
   CurveMapping *curve_mapping;
   bool is_data_result;
 } ColormanageProcessor;
@@ -126,6 +132,137 @@ static struct global_color_picking_state {
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name CPU Processor Cache
+ *
+ * Creating an OCIO CPU processor is expensive compared to applying it, and the same transforms
+ * are requested over and over by display buffer updates, sequencer strips and compositor nodes.
+ * Processors are kept until the configuration is freed. Once there are too many of them, the
+ * ones which are not used by any #ColormanageProcessor are evicted.
+ * \{ */
+
+#define CPU_PROCESSOR_CACHE_MAX_SIZE 64
+
+typedef struct CPUProcessorCacheEntry {
+  char *key;
+  OCIO_ConstCPUProcessorRcPtr *cpu_processor;
+  int users;
+  /* Removed from the cache while still in use, freed by the last release. */
+  bool is_detached;
+} CPUProcessorCacheEntry;
+
+/* Protected by processor_lock. */
+static GHash *cpu_processor_cache = NULL;
+
+static void cpu_processor_cache_entry_free(void *entry_v)
+{
+  CPUProcessorCacheEntry *entry = (CPUProcessorCacheEntry *)entry_v;
+
+  OCIO_cpuProcessorRelease(entry->cpu_processor);
+  MEM_freeN(entry->key);
+  MEM_freeN(entry);
+}
+
+static void cpu_processor_cache_evict_unused(void)
+{
+  GHashIterator gh_iter;
+  BLI_ghashIterator_init(&gh_iter, cpu_processor_cache);
+  while (!BLI_ghashIterator_done(&gh_iter)) {
+    CPUProcessorCacheEntry *entry = BLI_ghashIterator_getValue(&gh_iter);
+    BLI_ghashIterator_step(&gh_iter);
+
+    if (entry->users == 0) {
+      BLI_ghash_remove(cpu_processor_cache, entry->key, NULL, cpu_processor_cache_entry_free);
+    }
+  }
+}
+
+/* Cached processor for the given key, or NULL if there is none yet. */
+static CPUProcessorCacheEntry *cpu_processor_cache_acquire(const char *key)
+{
+  CPUProcessorCacheEntry *entry = NULL;
+
+  BLI_mutex_lock(&processor_lock);
+  if (cpu_processor_cache != NULL) {
+    entry = BLI_ghash_lookup(cpu_processor_cache, key);
+    if (entry != NULL) {
+      entry->users++;
+    }
+  }
+  BLI_mutex_unlock(&processor_lock);
+
+  return entry;
+}
+
+/* Add newly created processor to the cache, the cache takes ownership of it. In case another
+ * thread created the same processor in the meantime, that one is used instead. */
+static CPUProcessorCacheEntry *cpu_processor_cache_add(const char *key,
+                                                       OCIO_ConstCPUProcessorRcPtr *cpu_processor)
+{
+  BLI_mutex_lock(&processor_lock);
+
+  if (cpu_processor_cache == NULL) {
+    cpu_processor_cache = BLI_ghash_str_new(__func__);
+  }
+
+  CPUProcessorCacheEntry *entry = BLI_ghash_lookup(cpu_processor_cache, key);
+  if (entry != NULL) {
+    OCIO_cpuProcessorRelease(cpu_processor);
+  }
+  else {
+    if (BLI_ghash_len(cpu_processor_cache) >= CPU_PROCESSOR_CACHE_MAX_SIZE) {
+      cpu_processor_cache_evict_unused();
+    }
+
+    entry = MEM_callocN(sizeof(CPUProcessorCacheEntry), __func__);
+    entry->key = BLI_strdup(key);
+    entry->cpu_processor = cpu_processor;
+    BLI_ghash_insert(cpu_processor_cache, entry->key, entry);
+  }
+  entry->users++;
+
+  BLI_mutex_unlock(&processor_lock);
+
+  return entry;
+}
+
+static void cpu_processor_cache_release(CPUProcessorCacheEntry *entry)
+{
+  BLI_mutex_lock(&processor_lock);
+  BLI_assert(entry->users > 0);
+  entry->users--;
+  const bool do_free = entry->is_detached && entry->users == 0;
+  BLI_mutex_unlock(&processor_lock);
+
+  if (do_free) {
+    cpu_processor_cache_entry_free(entry);
+  }
+}
+
+/* Processors which are still in use are detached from the cache and freed by their last
+ * release. */
+static void cpu_processor_cache_free(void)
+{
+  BLI_mutex_lock(&processor_lock);
+  if (cpu_processor_cache != NULL) {
+    GHashIterator gh_iter;
+    GHASH_ITER (gh_iter, cpu_processor_cache) {
+      CPUProcessorCacheEntry *entry = BLI_ghashIterator_getValue(&gh_iter);
+      if (entry->users == 0) {
+        cpu_processor_cache_entry_free(entry);
+      }
+      else {
+        entry->is_detached = true;
+      }
+    }
+    BLI_ghash_free(cpu_processor_cache, NULL, NULL);
+    cpu_processor_cache = NULL;
+  }
+  BLI_mutex_unlock(&processor_lock);
+}
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name Color Managed Cache
  * \{ */
@@ -600,6 +737,7 @@ static void colormanage_free_config(void)
     if (colorspace->from_scene_linear) {
       OCIO_cpuProcessorRelease((OCIO_ConstCPUProcessorRcPtr *)colorspace->from_scene_linear);
     }
+    MEM_SAFE_FREE(colorspace->byte_to_scene_linear.table);
 
     /* free color space itself */
     MEM_freeN(colorspace);
@@ -639,6 +777,8 @@ static void colormanage_free_config(void)
   BLI_freelistN(&global_looks);
   global_tot_looks = 0;
 
+  cpu_processor_cache_free();
+
   OCIO_exit();
 }
 
@@ -979,6 +1119,126 @@ static OCIO_ConstCPUProcessorRcPtr *display_to_scene_linear_processor(ColorManag
   return (OCIO_ConstCPUProcessorRcPtr *)display->to_scene_linear;
 }
 
+/* Byte values only have 256 levels, so when the transform acts on every channel independently
+ * (which is the case for most of the transfer functions used for byte images) the conversion to
+ * scene linear can be baked into a table which is exact. */
+static float *colorspace_byte_to_scene_linear_table_create(ColorSpace *colorspace)
+{
+  OCIO_ConstCPUProcessorRcPtr *cpu_processor = colorspace_to_scene_linear_cpu_processor(
+      colorspace);
+
+  if (cpu_processor == NULL) {
+    return NULL;
+  }
+
+  float *table = MEM_mallocN(sizeof(float[3]) * 256, __func__);
+  for (int i = 0; i < 256; i++) {
+    float *pixel = &table[i * 3];
+    pixel[0] = pixel[1] = pixel[2] = i * (1.0f / 255.0f);
+    OCIO_cpuProcessorApplyRGB(cpu_processor, pixel);
+  }
+
+  /* Check channels are not mixed. */
+  const int samples[] = {0, 13, 64, 128, 191, 255};
+  for (int r = 0; r < ARRAY_SIZE(samples); r++) {
+    for (int g = 0; g < ARRAY_SIZE(samples); g++) {
+      for (int b = 0; b < ARRAY_SIZE(samples); b++) {
+        const int rgb[3] = {samples[r], samples[g], samples[b]};
+        float pixel[3];
+        for (int c = 0; c < 3; c++) {
+          pixel[c] = rgb[c] * (1.0f / 255.0f);
+        }
+        OCIO_cpuProcessorApplyRGB(cpu_processor, pixel);
+
+        for (int c = 0; c < 3; c++) {
+          const float expected = table[rgb[c] * 3 + c];
+          if (fabsf(pixel[c] - expected) > 1e-5f * max_ff(1.0f, fabsf(expected))) {
+            MEM_freeN(table);
+            return NULL;
+          }
+        }
+      }
+    }
+  }
+
+  return table;
+}
+
+static const float *colorspace_byte_to_scene_linear_table(ColorSpace *colorspace)
+{
+  if (!colorspace->byte_to_scene_linear.cached) {
+    float *table = colorspace_byte_to_scene_linear_table_create(colorspace);
+
+    BLI_mutex_lock(&processor_lock);
+    if (!colorspace->byte_to_scene_linear.cached) {
+      colorspace->byte_to_scene_linear.table = table;
+      colorspace->byte_to_scene_linear.cached = true;
+    }
+    else {
+      MEM_SAFE_FREE(table);
+    }
+    BLI_mutex_unlock(&processor_lock);
+  }
+
+  return colorspace->byte_to_scene_linear.table;
+}
+
+/* Convert byte pixels to straight alpha scene linear float pixels using the table. */
+static void colorspace_byte_to_scene_linear_apply(const float *table,
+                                                  float *float_buffer,
+                                                  const unsigned char *byte_buffer,
+                                                  size_t num_pixels,
+                                                  int channels)
+{
+  if (channels == 4) {
+    for (size_t i = 0; i < num_pixels; i++, float_buffer += 4, byte_buffer += 4) {
+      float_buffer[0] = table[byte_buffer[0] * 3 + 0];
+      float_buffer[1] = table[byte_buffer[1] * 3 + 1];
+      float_buffer[2] = table[byte_buffer[2] * 3 + 2];
+      float_buffer[3] = byte_buffer[3] * (1.0f / 255.0f);
+    }
+  }
+  else {
+    BLI_assert(channels == 3);
+    for (size_t i = 0; i < num_pixels; i++, float_buffer += 3, byte_buffer += 3) {
+      float_buffer[0] = table[byte_buffer[0] * 3 + 0];
+      float_buffer[1] = table[byte_buffer[1] * 3 + 1];
+      float_buffer[2] = table[byte_buffer[2] * 3 + 2];
+    }
+  }
+}
+
+/* Equivalent of #IMB_colormanagement_transform to scene linear, using the pre-cached processor
+ * of the color space. */
+static void colorspace_to_scene_linear_apply(
+    ColorSpace *colorspace, float *buffer, int width, int height, int channels, bool predivide)
+{
+  OCIO_ConstCPUProcessorRcPtr *cpu_processor = colorspace_to_scene_linear_cpu_processor(
+      colorspace);
+
+  if (cpu_processor == NULL || channels < 3) {
+    return;
+  }
+
+  OCIO_PackedImageDesc *img = OCIO_createOCIO_PackedImageDesc(
+      buffer,
+      width,
+      height,
+      channels,
+      sizeof(float),
+      (size_t)channels * sizeof(float),
+      (size_t)channels * sizeof(float) * width);
+
+  if (predivide) {
+    OCIO_cpuProcessorApply_predivide(cpu_processor, img);
+  }
+  else {
+    OCIO_cpuProcessorApply(cpu_processor, img);
+  }
+
+  OCIO_PackedImageDescRelease(img);
+}
+
 void IMB_colormanagement_init_default_view_settings(
     ColorManagedViewSettings *view_settings, const ColorManagedDisplaySettings *display_settings)
 {
@@ -1434,8 +1694,8 @@ typedef struct DisplayBufferThread {
   bool is_data;
   bool predivide;
 
-  const char *byte_colorspace;
-  const char *float_colorspace;
+  ColorSpace *byte_colorspace;
+  ColorSpace *float_colorspace;
 } DisplayBufferThread;
 
 typedef struct DisplayBufferInitData {
@@ -1449,8 +1709,8 @@ typedef struct DisplayBufferInitData {
 
   int width;
 
-  const char *byte_colorspace;
-  const char *float_colorspace;
+  ColorSpace *byte_colorspace;
+  ColorSpace *float_colorspace;
 } DisplayBufferInitData;
 
 static void display_buffer_init_handle(void *handle_v,
@@ -1519,33 +1779,43 @@ static void display_buffer_apply_get_linear_buffer(DisplayBufferThread *handle,
 
   if (!handle->buffer) {
     unsigned char *byte_buffer = handle->byte_buffer;
-
-    const char *from_colorspace = handle->byte_colorspace;
-    const char *to_colorspace = global_role_scene_linear;
-
-    float *fp;
-    unsigned char *cp;
-    const size_t i_last = ((size_t)width) * height;
-    size_t i;
-
-    /* first convert byte buffer to float, keep in image space */
-    for (i = 0, fp = linear_buffer, cp = byte_buffer; i != i_last;
-         i++, fp += channels, cp += channels) {
-      if (channels == 3) {
-        rgb_uchar_to_float(fp, cp);
-      }
-      else if (channels == 4) {
-        rgba_uchar_to_float(fp, cp);
-      }
-      else {
-        BLI_assert_msg(0, "Buffers of 3 or 4 channels are only supported here");
-      }
+    ColorSpace *from_colorspace = handle->byte_colorspace;
+    const bool do_transform = !is_data && !is_data_display && from_colorspace &&
+                              !STREQ(from_colorspace->name, global_role_scene_linear);
+    const float *table = (do_transform && ELEM(channels, 3, 4)) ?
+                             colorspace_byte_to_scene_linear_table(from_colorspace) :
+                             NULL;
+
+    if (table) {
+      /* Conversion to float and to scene linear space in one go. */
+      colorspace_byte_to_scene_linear_apply(
+          table, linear_buffer, byte_buffer, ((size_t)width) * height, channels);
     }
+    else {
+      float *fp;
+      unsigned char *cp;
+      const size_t i_last = ((size_t)width) * height;
+      size_t i;
+
+      /* first convert byte buffer to float, keep in image space */
+      for (i = 0, fp = linear_buffer, cp = byte_buffer; i != i_last;
+           i++, fp += channels, cp += channels) {
+        if (channels == 3) {
+          rgb_uchar_to_float(fp, cp);
+        }
+        else if (channels == 4) {
+          rgba_uchar_to_float(fp, cp);
+        }
+        else {
+          BLI_assert_msg(0, "Buffers of 3 or 4 channels are only supported here");
+        }
+      }
 
-    if (!is_data && !is_data_display) {
-      /* convert float buffer to scene linear space */
-      IMB_colormanagement_transform(
-          linear_buffer, width, height, channels, from_colorspace, to_colorspace, false);
+      if (do_transform) {
+        /* convert float buffer to scene linear space */
+        colorspace_to_scene_linear_apply(
+            from_colorspace, linear_buffer, width, height, channels, false);
+      }
     }
 
     *is_straight_alpha = true;
@@ -1557,14 +1827,14 @@ static void display_buffer_apply_get_linear_buffer(DisplayBufferThread *handle,
      * Need to convert float buffer to linear space before applying display transform
      */
 
-    const char *from_colorspace = handle->float_colorspace;
-    const char *to_colorspace = global_role_scene_linear;
+    ColorSpace *from_colorspace = handle->float_colorspace;
 
     memcpy(linear_buffer, handle->buffer, buffer_size * sizeof(float));
 
-    if (!is_data && !is_data_display) {
-      IMB_colormanagement_transform(
-          linear_buffer, width, height, channels, from_colorspace, to_colorspace, predivide);
+    if (!is_data && !is_data_display &&
+        !STREQ(from_colorspace->name, global_role_scene_linear)) {
+      colorspace_to_scene_linear_apply(
+          from_colorspace, linear_buffer, width, height, channels, predivide);
     }
 
     *is_straight_alpha = false;
@@ -1582,9 +1852,10 @@ static void display_buffer_apply_get_linear_buffer(DisplayBufferThread *handle,
   }
 }
 
-static void *do_display_buffer_apply_thread(void *handle_v)
+/* Run all steps of the conversion on a few lines at a time, so the intermediate buffer stays in
+ * CPU cache rather than streaming whole image through memory for every step. */
+static void display_buffer_apply_lines(DisplayBufferThread *handle, float *linear_buffer)
 {
-  DisplayBufferThread *handle = (DisplayBufferThread *)handle_v;
   ColormanageProcessor *cm_processor = handle->cm_processor;
   float *display_buffer = handle->display_buffer;
   unsigned char *display_buffer_byte = handle->display_buffer_byte;
@@ -1593,8 +1864,66 @@ static void *do_display_buffer_apply_thread(void *handle_v)
   int height = handle->tot_line;
   float dither = handle->dither;
   bool is_data = handle->is_data;
+  bool is_straight_alpha;
+
+  display_buffer_apply_get_linear_buffer(handle, height, linear_buffer, &is_straight_alpha);
+
+  bool predivide = handle->predivide && (is_straight_alpha == false);
+
+  if (is_data) {
+    /* special case for data buffers - no color space conversions,
+     * only generate byte buffers
+     */
+  }
+  else {
+    /* apply processor */
+    IMB_colormanagement_processor_apply(
+        cm_processor, linear_buffer, width, height, channels, predivide);
+  }
+
+  /* copy result to output buffers */
+  if (display_buffer_byte) {
+    /* do conversion */
+    IMB_buffer_byte_from_float(display_buffer_byte,
+                               linear_buffer,
+                               channels,
+                               dither,
+                               IB_PROFILE_SRGB,
+                               IB_PROFILE_SRGB,
+                               predivide,
+                               width,
+                               height,
+                               width,
+                               width);
+  }
+
+  if (display_buffer) {
+    memcpy(display_buffer, linear_buffer, ((size_t)width) * height * channels * sizeof(float));
+
+    if (is_straight_alpha && channels == 4) {
+      const size_t i_last = ((size_t)width) * height;
+      size_t i;
+      float *fp;
+
+      for (i = 0, fp = display_buffer; i != i_last; i++, fp += channels) {
+        straight_to_premul_v4(fp);
+      }
+    }
+  }
+}
+
+static void *do_display_buffer_apply_thread(void *handle_v)
+{
+  DisplayBufferThread *handle = (DisplayBufferThread *)handle_v;
+  ColormanageProcessor *cm_processor = handle->cm_processor;
+  float *display_buffer = handle->display_buffer;
+  int channels = handle->channels;
+  int width = handle->width;
+  int height = handle->tot_line;
 
   if (cm_processor == NULL) {
+    unsigned char *display_buffer_byte = handle->display_buffer_byte;
+
     if (display_buffer_byte && display_buffer_byte != handle->byte_buffer) {
       IMB_buffer_byte_from_byte(display_buffer_byte,
                                 handle->byte_buffer,
@@ -1620,53 +1949,31 @@ static void *do_display_buffer_apply_thread(void *handle_v)
     }
   }
   else {
-    bool is_straight_alpha;
-    float *linear_buffer = MEM_mallocN(((size_t)channels) * width * height * sizeof(float),
+    const int block_height = min_ii(height, max_ii(1, DISPLAY_BUFFER_BLOCK_PIXELS / width));
+    float *linear_buffer = MEM_mallocN(((size_t)channels) * width * block_height * sizeof(float),
                                        "color conversion linear buffer");
 
-    display_buffer_apply_get_linear_buffer(handle, height, linear_buffer, &is_straight_alpha);
-
-    bool predivide = handle->predivide && (is_straight_alpha == false);
-
-    if (is_data) {
-      /* special case for data buffers - no color space conversions,
-       * only generate byte buffers
-       */
-    }
-    else {
-      /* apply processor */
-      IMB_colormanagement_processor_apply(
-          cm_processor, linear_buffer, width, height, channels, predivide);
-    }
-
-    /* copy result to output buffers */
-    if (display_buffer_byte) {
-      /* do conversion */
-      IMB_buffer_byte_from_float(display_buffer_byte,
-                                 linear_buffer,
-                                 channels,
-                                 dither,
-                                 IB_PROFILE_SRGB,
-                                 IB_PROFILE_SRGB,
-                                 predivide,
-                                 width,
-                                 height,
-                                 width,
-                                 width);
-    }
-
-    if (display_buffer) {
-      memcpy(display_buffer, linear_buffer, ((size_t)width) * height * channels * sizeof(float));
-
-      if (is_straight_alpha && channels == 4) {
-        const size_t i_last = ((size_t)width) * height;
-        size_t i;
-        float *fp;
+    for (int y = 0; y < height; y += block_height) {
+      const size_t offset = ((size_t)channels) * width * y;
+      DisplayBufferThread block = *handle;
 
-        for (i = 0, fp = display_buffer; i != i_last; i++, fp += channels) {
-          straight_to_premul_v4(fp);
-        }
+      block.start_line = handle->start_line + y;
+      block.tot_line = min_ii(block_height, height - y);
+      if (handle->buffer) {
+        block.buffer = handle->buffer + offset;
+      }
+      if (handle->byte_buffer) {
+        block.byte_buffer = handle->byte_buffer + offset;
+      }
+      if (handle->display_buffer) {
+        block.display_buffer = handle->display_buffer + offset;
+      }
+      if (handle->display_buffer_byte) {
+        block.display_buffer_byte = handle->display_buffer_byte +
+                                    ((size_t)DISPLAY_BUFFER_CHANNELS) * width * y;
       }
+
+      display_buffer_apply_lines(&block, linear_buffer);
     }
 
     MEM_freeN(linear_buffer);
@@ -1692,22 +1999,17 @@ static void display_buffer_apply_threaded(ImBuf *ibuf,
   init_data.display_buffer_byte = display_buffer_byte;
 
   if (ibuf->rect_colorspace != NULL) {
-    init_data.byte_colorspace = ibuf->rect_colorspace->name;
+    init_data.byte_colorspace = ibuf->rect_colorspace;
   }
   else {
     /* happens for viewer images, which are not so simple to determine where to
      * set image buffer's color spaces
      */
-    init_data.byte_colorspace = global_role_default_byte;
+    init_data.byte_colorspace = colormanage_colorspace_get_named(global_role_default_byte);
   }
 
-  if (ibuf->float_colorspace != NULL) {
-    /* sequencer stores float buffers in non-linear space */
-    init_data.float_colorspace = ibuf->float_colorspace->name;
-  }
-  else {
-    init_data.float_colorspace = NULL;
-  }
+  /* sequencer stores float buffers in non-linear space */
+  init_data.float_colorspace = ibuf->float_colorspace;
 
   IMB_processor_apply_threaded(ibuf->y,
                                sizeof(DisplayBufferThread),
@@ -2035,6 +2337,24 @@ void IMB_colormanagement_transform_from_byte(float *float_buffer,
   IMB_colormanagement_transform(
       float_buffer, width, height, channels, from_colorspace, to_colorspace, true);
 }
+typedef struct ByteToSceneLinearData {
+  const float *table;
+  float *float_buffer;
+  const unsigned char *byte_buffer;
+  int width;
+} ByteToSceneLinearData;
+
+static void byte_to_scene_linear_scanline(void *custom_data, int scanline)
+{
+  ByteToSceneLinearData *data = (ByteToSceneLinearData *)custom_data;
+  const size_t offset = ((size_t)scanline) * data->width * 4;
+  float *float_buffer = data->float_buffer + offset;
+
+  colorspace_byte_to_scene_linear_apply(
+      data->table, float_buffer, data->byte_buffer + offset, data->width, 4);
+  IMB_premultiply_rect_float(float_buffer, 4, data->width, 1);
+}
+
 void IMB_colormanagement_transform_from_byte_threaded(float *float_buffer,
                                                       unsigned char *byte_buffer,
                                                       int width,
@@ -2064,6 +2384,15 @@ void IMB_colormanagement_transform_from_byte_threaded(float *float_buffer,
     IMB_premultiply_rect_float(float_buffer, 4, width, height);
     return;
   }
+  if (channels == 4 && STREQ(to_colorspace, global_role_scene_linear)) {
+    ColorSpace *colorspace = colormanage_colorspace_get_named(from_colorspace);
+    const float *table = colorspace ? colorspace_byte_to_scene_linear_table(colorspace) : NULL;
+    if (table) {
+      ByteToSceneLinearData data = {table, float_buffer, byte_buffer, width};
+      IMB_processor_apply_threaded_scanlines(height, byte_to_scene_linear_scanline, &data);
+      return;
+    }
+  }
   cm_processor = IMB_colormanagement_colorspace_processor_new(from_colorspace, to_colorspace);
   processor_transform_apply_threaded(
       byte_buffer, float_buffer, width, height, channels, cm_processor, false, true);
@@ -3767,13 +4096,32 @@ ColormanageProcessor *IMB_colormanagement_display_processor_new(
     cm_processor->is_data_result = display_space->is_data;
   }
 
-  cm_processor->cpu_processor = create_display_buffer_processor(
-      applied_view_settings->look,
-      applied_view_settings->view_transform,
-      display_settings->display_device,
-      applied_view_settings->exposure,
-      applied_view_settings->gamma,
-      global_role_scene_linear);
+  char *key = BLI_sprintfN("display\n%s\n%s\n%s\n%.9g\n%.9g\n%s",
+                           applied_view_settings->look,
+                           applied_view_settings->view_transform,
+                           display_settings->display_device,
+                           applied_view_settings->exposure,
+                           applied_view_settings->gamma,
+                           global_role_scene_linear);
+  CPUProcessorCacheEntry *entry = cpu_processor_cache_acquire(key);
+  if (entry == NULL) {
+    OCIO_ConstCPUProcessorRcPtr *cpu_processor = create_display_buffer_processor(
+        applied_view_settings->look,
+        applied_view_settings->view_transform,
+        display_settings->display_device,
+        applied_view_settings->exposure,
+        applied_view_settings->gamma,
+        global_role_scene_linear);
+    if (cpu_processor != NULL) {
+      entry = cpu_processor_cache_add(key, cpu_processor);
+    }
+  }
+  MEM_freeN(key);
+
+  if (entry != NULL) {
+    cm_processor->cpu_processor_entry = entry;
+    cm_processor->cpu_processor = entry->cpu_processor;
+  }
 
   if (applied_view_settings->flag & COLORMANAGE_VIEW_USE_CURVES) {
     cm_processor->curve_mapping = BKE_curvemapping_copy(applied_view_settings->curve_mapping);
@@ -3794,12 +4142,22 @@ ColormanageProcessor *IMB_colormanagement_colorspace_processor_new(const char *f
   color_space = colormanage_colorspace_get_named(to_colorspace);
   cm_processor->is_data_result = color_space->is_data;
 
-  OCIO_ConstProcessorRcPtr *processor = create_colorspace_transform_processor(from_colorspace,
-                                                                              to_colorspace);
-  if (processor != NULL) {
-    cm_processor->cpu_processor = OCIO_processorGetCPUProcessor(processor);
+  char *key = BLI_sprintfN("colorspace\n%s\n%s", from_colorspace, to_colorspace);
+  CPUProcessorCacheEntry *entry = cpu_processor_cache_acquire(key);
+  if (entry == NULL) {
+    OCIO_ConstProcessorRcPtr *processor = create_colorspace_transform_processor(from_colorspace,
+                                                                                to_colorspace);
+    if (processor != NULL) {
+      entry = cpu_processor_cache_add(key, OCIO_processorGetCPUProcessor(processor));
+    }
+    OCIO_processorRelease(processor);
+  }
+  MEM_freeN(key);
+
+  if (entry != NULL) {
+    cm_processor->cpu_processor_entry = entry;
+    cm_processor->cpu_processor = entry->cpu_processor;
   }
-  OCIO_processorRelease(processor);
 
   return cm_processor;
 }
@@ -3925,8 +4283,8 @@ void IMB_colormanagement_processor_free(ColormanageProcessor *cm_processor)
   if (cm_processor->curve_mapping) {
     BKE_curvemapping_free(cm_processor->curve_mapping);
   }
-  if (cm_processor->cpu_processor) {
-    OCIO_cpuProcessorRelease(cm_processor->cpu_processor);
+  if (cm_processor->cpu_processor_entry) {
+    cpu_processor_cache_release(cm_processor->cpu_processor_entry);
   }
 
   MEM_freeN(cm_processor);
@@ -0,0 +1,212 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "imbuf_testing.hh"
+
+#include "IMB_imbuf.h"
+#include "IMB_imbuf_types.h"
+
+extern "C" {
+#include "IMB_filetype.h"
+}
+
+#include "BLI_fileops.h"
+#include "BLI_math_base.h"
+#include "BLI_path_util.h"
+#include "BLI_utildefines.h"
+
+#include "MEM_guardedalloc.h"
+
+#include <cstdlib>
+#include <cstring>
+
+namespace blender::imbuf::tests {
+
+using imbuf_encode = ImBufTest;
+
+static ImBuf *create_test_image(int width, int height, int planes)
+{
+  ImBuf *ibuf = IMB_allocImBuf(width, height, planes, IB_rect);
+  unsigned char *rect = (unsigned char *)ibuf->rect;
+  for (int y = 0; y < height; y++) {
+    for (int x = 0; x < width; x++) {
+      unsigned char *pixel = rect + ((size_t)y * width + x) * 4;
+      /* Smooth gradients, so lossy formats can be compared against the source. */
+      pixel[0] = (unsigned char)(x * 255 / width);
+      pixel[1] = (unsigned char)(y * 255 / height);
+      pixel[2] = (unsigned char)((x + y) * 127 / (width + height));
+      pixel[3] = (planes == 32) ? (unsigned char)(255 - (x * 64 / width)) : 255;
+    }
+  }
+  return ibuf;
+}
+
+/* Returns the largest difference between matching channels of both images. */
+static int max_channel_difference(const ImBuf *a, const ImBuf *b, int channels)
+{
+  const unsigned char *rect_a = (const unsigned char *)a->rect;
+  const unsigned char *rect_b = (const unsigned char *)b->rect;
+  int max_diff = 0;
+  for (size_t i = 0; i < (size_t)a->x * a->y; i++) {
+    for (int c = 0; c < channels; c++) {
+      max_diff = max_ii(max_diff, abs(rect_a[i * 4 + c] - rect_b[i * 4 + c]));
+    }
+  }
+  return max_diff;
+}
+
+static void test_png_roundtrip(int width, int height, int planes)
+{
+  ImBuf *ibuf = create_test_image(width, height, planes);
+  ibuf->foptions.quality = 90;
+
+  EXPECT_TRUE(imb_savepng(ibuf, "", IB_mem));
+  ASSERT_NE(ibuf->encodedbuffer, nullptr);
+  EXPECT_TRUE(imb_is_a_png(ibuf->encodedbuffer, ibuf->encodedsize));
+
+  /* A non-empty color-space skips the color management lookup. */
+  char colorspace[IM_MAX_SPACE] = "sRGB";
+  ImBuf *result = imb_loadpng(ibuf->encodedbuffer, ibuf->encodedsize, IB_rect, colorspace);
+  ASSERT_NE(result, nullptr);
+  EXPECT_EQ(result->x, width);
+  EXPECT_EQ(result->y, height);
+  EXPECT_EQ(max_channel_difference(ibuf, result, planes == 32 ? 4 : 3), 0);
+
+  IMB_freeImBuf(result);
+  IMB_freeImBuf(ibuf);
+}
+
+TEST_F(imbuf_encode, PNGSmall)
+{
+  test_png_roundtrip(61, 37, 32);
+  test_png_roundtrip(61, 37, 24);
+}
+
+TEST_F(imbuf_encode, PNGStrips)
+{
+  /* Large enough to be deflated in several strips. */
+  test_png_roundtrip(1021, 677, 32);
+  test_png_roundtrip(1021, 677, 24);
+}
+
+static ImBuf *create_test_image_float(int width, int height, int planes)
+{
+  ImBuf *ibuf = IMB_allocImBuf(width, height, planes, IB_rectfloat);
+  for (int y = 0; y < height; y++) {
+    for (int x = 0; x < width; x++) {
+      float *pixel = ibuf->rect_float + ((size_t)y * width + x) * 4;
+      /* Finer steps than 8 bits can store, so both bytes of every channel are used. */
+      pixel[0] = (float)x / width;
+      pixel[1] = (float)y / height;
+      pixel[2] = (float)(x * y) / (width * height);
+      pixel[3] = (planes == 32) ? 1.0f - (float)x / (4 * width) : 1.0f;
+    }
+  }
+  return ibuf;
+}
+
+static ImBuf *encode_decode_png(ImBuf *ibuf)
+{
+  EXPECT_TRUE(imb_savepng(ibuf, "", IB_mem));
+  EXPECT_NE(ibuf->encodedbuffer, nullptr);
+  if (ibuf->encodedbuffer == nullptr) {
+    return nullptr;
+  }
+
+  char colorspace[IM_MAX_SPACE] = "sRGB";
+  return imb_loadpng(ibuf->encodedbuffer, ibuf->encodedsize, IB_rect, colorspace);
+}
+
+/* Encode a float image in 16 bit with the strip encoder, and compare the result against bands
+ * of rows small enough to be encoded by libpng directly. */
+static void test_png16_roundtrip(int width, int height, int planes)
+{
+  ImBuf *ibuf = create_test_image_float(width, height, planes);
+  ibuf->foptions.quality = 90;
+  ibuf->foptions.flag |= PNG_16BIT;
+  /* Store values as they are, without conversion to sRGB. */
+  ibuf->colormanage_flag |= IMB_COLORMANAGE_IS_DATA;
+
+  ImBuf *result = encode_decode_png(ibuf);
+  ASSERT_NE(result, nullptr);
+  ASSERT_NE(result->rect_float, nullptr);
+  EXPECT_EQ(result->x, width);
+  EXPECT_EQ(result->y, height);
+
+  /* Bands below the size at which strips are used. */
+  const size_t row_bytes = (size_t)width * (planes / 8) * 2 + 1;
+  const int band_height = (int)((512 * 1024) / row_bytes);
+  ASSERT_LT(band_height, height);
+
+  for (int band_y = 0; band_y < height; band_y += band_height) {
+    const int rows = min_ii(band_height, height - band_y);
+    ImBuf *band = IMB_allocImBuf(width, rows, planes, IB_rectfloat);
+    memcpy(band->rect_float,
+           ibuf->rect_float + (size_t)band_y * width * 4,
+           sizeof(float[4]) * width * rows);
+    band->foptions = ibuf->foptions;
+    band->colormanage_flag = ibuf->colormanage_flag;
+
+    ImBuf *band_result = encode_decode_png(band);
+    ASSERT_NE(band_result, nullptr);
+    ASSERT_NE(band_result->rect_float, nullptr);
+    EXPECT_EQ(memcmp(band_result->rect_float,
+                     result->rect_float + (size_t)band_y * width * 4,
+                     sizeof(float[4]) * width * rows),
+              0);
+
+    IMB_freeImBuf(band_result);
+    IMB_freeImBuf(band);
+  }
+
+  IMB_freeImBuf(result);
+  IMB_freeImBuf(ibuf);
+}
+
+TEST_F(imbuf_encode, PNG16Strips)
+{
+  /* Just large enough to be deflated in a few strips. */
+  test_png16_roundtrip(307, 301, 32);
+  test_png16_roundtrip(307, 301, 24);
+}
+
+static void test_jpeg_roundtrip(int width, int height)
+{
+  ImBuf *ibuf = create_test_image(width, height, 24);
+  ibuf->foptions.quality = 95;
+
+  char filepath[FILE_MAX];
+  BLI_join_dirfile(filepath, sizeof(filepath), ::testing::TempDir().c_str(), "imbuf_test.jpg");
+  EXPECT_TRUE(imb_savejpeg(ibuf, filepath, IB_rect));
+
+  size_t size = 0;
+  unsigned char *mem = (unsigned char *)BLI_file_read_binary_as_mem(filepath, 0, &size);
+  ASSERT_NE(mem, nullptr);
+  BLI_delete(filepath, false, false);
+
+  char colorspace[IM_MAX_SPACE] = "sRGB";
+  ImBuf *result = imb_load_jpeg(mem, size, IB_rect, colorspace);
+  ASSERT_NE(result, nullptr);
+  EXPECT_EQ(result->x, width);
+  EXPECT_EQ(result->y, height);
+  EXPECT_LE(max_channel_difference(ibuf, result, 3), 8);
+
+  IMB_freeImBuf(result);
+  MEM_freeN(mem);
+  IMB_freeImBuf(ibuf);
+}
+
+TEST_F(imbuf_encode, JPEGSmall)
+{
+  test_jpeg_roundtrip(61, 37);
+}
+
+TEST_F(imbuf_encode, JPEGStrips)
+{
+  /* Large enough to be encoded in several strips, with a height that is not a multiple of the
+   * MCU size. */
+  test_jpeg_roundtrip(1283, 1021);
+}
+
+}  // namespace blender::imbuf::tests
@@ -0,0 +1,33 @@
+/* Apache License, Version 2.0 */
+
+#pragma once
+
+#include "testing/testing.h"
+
+#include "IMB_allocimbuf.h"
+
+namespace blender::imbuf::tests {
+
+/* Test class for test cases that create image buffers. Reference counting of buffers relies on
+ * locks that are normally initialized by #IMB_init.
+ *
+ * Usage:
+ *   using imbuf_my_feature = ImBufTest;
+ *   TEST_F(imbuf_my_feature, my_test) {
+ *     ...
+ *   }
+ */
+class ImBufTest : public ::testing::Test {
+ protected:
+  static void SetUpTestSuite()
+  {
+    imb_refcounter_lock_init();
+  }
+
+  static void TearDownTestSuite()
+  {
+    imb_refcounter_lock_exit();
+  }
+};
+
+}  // namespace blender::imbuf::tests
@@ -1246,7 +1246,7 @@ static void index_rebuild_fallback(FallbackIndexBuilderContext *context,
 
         struct ImBuf *s_ibuf = IMB_dupImBuf(tmp_ibuf);
 
-        IMB_scalefastImBuf(s_ibuf, x, y);
+        IMB_scaleImBuf_filtered(s_ibuf, x, y, IMB_SCALE_FILTER_BOX);
 
         IMB_convert_rgba_to_abgr(s_ibuf);
 
@@ -1420,7 +1420,8 @@ void IMB_anim_set_index_dir(struct anim *anim, const char *dir)
   }
   BLI_strncpy(anim->index_dir, dir, sizeof(anim->index_dir));
 
-  IMB_free_indices(anim);
+  /* Also stops the decode-ahead thread, which reads the indices. */
+  IMB_close_anim_proxies(anim);
 }
 
 struct anim *IMB_anim_open_proxy(struct anim *anim, IMB_Proxy_Size preview_size)
@@ -1478,7 +1479,14 @@ struct anim_index *IMB_anim_open_index(struct anim *anim, IMB_Timecode_Type tc)
 
 int IMB_anim_index_get_frame_index(struct anim *anim, IMB_Timecode_Type tc, int position)
 {
+#ifdef WITH_FFMPEG
+  /* The decode-ahead thread opens indices too, while holding the decoder lock. */
+  BLI_mutex_lock(&anim->decode_mutex);
+#endif
   struct anim_index *idx = IMB_anim_open_index(anim, tc);
+#ifdef WITH_FFMPEG
+  BLI_mutex_unlock(&anim->decode_mutex);
+#endif
 
   if (!idx) {
     return position;
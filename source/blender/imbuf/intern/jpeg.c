@@ -28,7 +28,9 @@
 #include "MEM_guardedalloc.h"
 
 #include "BLI_fileops.h"
+#include "BLI_math_base.h"
 #include "BLI_string.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 
 #include "BKE_idprop.h"
@@ -54,7 +56,11 @@ static void skip_input_data(j_decompress_ptr cinfo, long num_bytes);
 static void term_source(j_decompress_ptr cinfo);
 static void memory_source(j_decompress_ptr cinfo, const unsigned char *buffer, size_t size);
 static boolean handle_app1(j_decompress_ptr cinfo);
-static ImBuf *ibJpegImageFromCinfo(struct jpeg_decompress_struct *cinfo, int flags);
+static ImBuf *ibJpegImageFromCinfo(struct jpeg_decompress_struct *cinfo,
+                                   int flags,
+                                   int max_size,
+                                   size_t *r_width,
+                                   size_t *r_height);
 
 static const uchar jpeg_default_quality = 75;
 static uchar ibuf_quality;
@@ -261,7 +267,16 @@ static boolean handle_app1(j_decompress_ptr cinfo)
   return true;
 }
 
-static ImBuf *ibJpegImageFromCinfo(struct jpeg_decompress_struct *cinfo, int flags)
+/**
+ * \param max_size: When non-zero, let the decoder scale the image down by a power of two in the
+ * DCT domain, as long as the larger side stays at least this size.
+ * \param r_width, r_height: Optional, the size of the full image.
+ */
+static ImBuf *ibJpegImageFromCinfo(struct jpeg_decompress_struct *cinfo,
+                                   int flags,
+                                   int max_size,
+                                   size_t *r_width,
+                                   size_t *r_height)
 {
   JSAMPARRAY row_pointer;
   JSAMPLE *buffer = NULL;
@@ -283,12 +298,35 @@ static ImBuf *ibJpegImageFromCinfo(struct jpeg_decompress_struct *cinfo, int fla
     y = cinfo->image_height;
     depth = cinfo->num_components;
 
+    if (r_width) {
+      *r_width = x;
+    }
+    if (r_height) {
+      *r_height = y;
+    }
+
     if (cinfo->jpeg_color_space == JCS_YCCK) {
       cinfo->out_color_space = JCS_CMYK;
     }
 
+    if (max_size > 0) {
+      /* Decoding at 1/2, 1/4 or 1/8 of the size skips most of the inverse DCT work. */
+      const int size = max_ii(x, y);
+      int scale = 1;
+      while (scale < 8 && size / (scale * 2) >= max_size) {
+        scale *= 2;
+      }
+      cinfo->scale_num = 1;
+      cinfo->scale_denom = scale;
+      cinfo->dct_method = JDCT_IFAST;
+    }
+
     jpeg_start_decompress(cinfo);
 
+    /* Smaller than the image when scaling. */
+    x = cinfo->output_width;
+    y = cinfo->output_height;
+
     if (flags & IB_test) {
       jpeg_abort_decompress(cinfo);
       ibuf = IMB_allocImBuf(x, y, 8 * depth, 0);
@@ -464,22 +502,57 @@ ImBuf *imb_load_jpeg(const unsigned char *buffer,
   jpeg_create_decompress(cinfo);
   memory_source(cinfo, buffer, size);
 
-  ibuf = ibJpegImageFromCinfo(cinfo, flags);
+  ibuf = ibJpegImageFromCinfo(cinfo, flags, 0, NULL, NULL);
 
   return ibuf;
 }
 
-static void write_jpeg(struct jpeg_compress_struct *cinfo, struct ImBuf *ibuf)
+struct ImBuf *imb_thumbnail_jpeg(const char *filepath,
+                                 const int flags,
+                                 const size_t max_thumb_size,
+                                 char colorspace[IM_MAX_SPACE],
+                                 size_t *r_width,
+                                 size_t *r_height)
+{
+  struct jpeg_decompress_struct _cinfo, *cinfo = &_cinfo;
+  struct my_error_mgr jerr;
+  FILE *infile;
+
+  if ((infile = BLI_fopen(filepath, "rb")) == NULL) {
+    fprintf(stderr, "can't open %s\n", filepath);
+    return NULL;
+  }
+
+  colorspace_set_default_role(colorspace, IM_MAX_SPACE, COLOR_ROLE_DEFAULT_BYTE);
+
+  cinfo->err = jpeg_std_error(&jerr.pub);
+  jerr.pub.error_exit = jpeg_error;
+
+  /* Establish the setjmp return context for my_error_exit to use. */
+  if (setjmp(jerr.setjmp_buffer)) {
+    /* If we get here, the JPEG code has signaled an error.
+     * We need to clean up the JPEG object, close the input file, and return.
+     */
+    jpeg_destroy_decompress(cinfo);
+    fclose(infile);
+    return NULL;
+  }
+
+  jpeg_create_decompress(cinfo);
+  jpeg_stdio_src(cinfo, infile);
+
+  ImBuf *ibuf = ibJpegImageFromCinfo(cinfo, flags, (int)max_thumb_size, r_width, r_height);
+
+  fclose(infile);
+
+  return ibuf;
+}
+
+static void write_jpeg_markers(struct jpeg_compress_struct *cinfo, struct ImBuf *ibuf)
 {
-  JSAMPLE *buffer = NULL;
-  JSAMPROW row_pointer[1];
-  uchar *rect;
-  int x, y;
   char neogeo[128];
   struct NeoGeo_Word *neogeo_word;
 
-  jpeg_start_compress(cinfo, true);
-
   strcpy(neogeo, "NeoGeo");
   neogeo_word = (struct NeoGeo_Word *)(neogeo + 6);
   memset(neogeo_word, 0, sizeof(*neogeo_word));
@@ -530,10 +603,23 @@ static void write_jpeg(struct jpeg_compress_struct *cinfo, struct ImBuf *ibuf)
     }
   }
 
+}
+
+/* Write rows in JPEG order, which is from the top of the image down. */
+static void write_jpeg_rows(struct jpeg_compress_struct *cinfo,
+                            struct ImBuf *ibuf,
+                            int row_start,
+                            int row_end)
+{
+  JSAMPLE *buffer = NULL;
+  JSAMPROW row_pointer[1];
+  uchar *rect;
+  int x, y;
+
   row_pointer[0] = MEM_mallocN(sizeof(JSAMPLE) * cinfo->input_components * cinfo->image_width,
                                "jpeg row_pointer");
 
-  for (y = ibuf->y - 1; y >= 0; y--) {
+  for (y = ibuf->y - 1 - row_start; y >= ibuf->y - row_end; y--) {
     rect = (uchar *)(ibuf->rect + y * ibuf->x);
     buffer = row_pointer[0];
 
@@ -564,10 +650,17 @@ static void write_jpeg(struct jpeg_compress_struct *cinfo, struct ImBuf *ibuf)
     jpeg_write_scanlines(cinfo, row_pointer, 1);
   }
 
-  jpeg_finish_compress(cinfo);
   MEM_freeN(row_pointer[0]);
 }
 
+static void write_jpeg(struct jpeg_compress_struct *cinfo, struct ImBuf *ibuf)
+{
+  jpeg_start_compress(cinfo, true);
+  write_jpeg_markers(cinfo, ibuf);
+  write_jpeg_rows(cinfo, ibuf, 0, ibuf->y);
+  jpeg_finish_compress(cinfo);
+}
+
 static int init_jpeg(FILE *outfile, struct jpeg_compress_struct *cinfo, struct ImBuf *ibuf)
 {
   int quality;
@@ -581,7 +674,9 @@ static int init_jpeg(FILE *outfile, struct jpeg_compress_struct *cinfo, struct I
   }
 
   jpeg_create_compress(cinfo);
-  jpeg_stdio_dest(cinfo, outfile);
+  if (outfile) {
+    jpeg_stdio_dest(cinfo, outfile);
+  }
 
   cinfo->image_width = ibuf->x;
   cinfo->image_height = ibuf->y;
@@ -623,6 +718,213 @@ static int init_jpeg(FILE *outfile, struct jpeg_compress_struct *cinfo, struct I
   return 0;
 }
 
+/* -------------------------------------------------------------------- */
+/** \name Multi-Threaded Encoding
+ *
+ * Large images are split in strips of whole MCU rows, which are encoded in parallel by separate
+ * compressors with identical tables and a restart marker after every MCU row. The entropy coded
+ * data of the strips is then joined with restart markers, renumbered to form one baseline scan.
+ * \{ */
+
+#if JPEG_LIB_VERSION >= 80 || defined(MEM_SRCDST_SUPPORTED)
+#  define USE_JPEG_STRIP_ENCODING
+#endif
+
+#ifdef USE_JPEG_STRIP_ENCODING
+
+/* Number of pixels encoded by one task. */
+#  define JPEG_ENCODE_STRIP_PIXELS (512 * 1024)
+
+typedef struct JpegEncodeStrip {
+  /* Allocated by libjpeg, to be freed with free(). */
+  unsigned char *buffer;
+  unsigned long size;
+  bool ok;
+} JpegEncodeStrip;
+
+typedef struct JpegEncodeData {
+  struct ImBuf *ibuf;
+  int rows_per_strip;
+  int totstrip;
+  JpegEncodeStrip *strips;
+} JpegEncodeData;
+
+static void jpeg_encode_strip_cb(void *__restrict userdata,
+                                 const int index,
+                                 const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const JpegEncodeData *data = userdata;
+  JpegEncodeStrip *strip = &data->strips[index];
+  struct ImBuf *ibuf = data->ibuf;
+  const int row_start = index * data->rows_per_strip;
+  const int row_end = min_ii(row_start + data->rows_per_strip, ibuf->y);
+  struct jpeg_compress_struct _cinfo, *cinfo = &_cinfo;
+  struct my_error_mgr jerr;
+
+  cinfo->err = jpeg_std_error(&jerr.pub);
+  jerr.pub.error_exit = jpeg_error;
+
+  if (setjmp(jerr.setjmp_buffer)) {
+    /* The compressor was destroyed by the error handler, the buffer is freed by the caller. */
+    return;
+  }
+
+  init_jpeg(NULL, cinfo, ibuf);
+  jpeg_mem_dest(cinfo, &strip->buffer, &strip->size);
+
+  /* Strips must share Huffman tables, and restart at every MCU row to be joined. */
+  cinfo->image_height = row_end - row_start;
+  cinfo->optimize_coding = false;
+  cinfo->restart_in_rows = 1;
+
+  jpeg_start_compress(cinfo, true);
+  if (index == 0) {
+    write_jpeg_markers(cinfo, ibuf);
+  }
+  write_jpeg_rows(cinfo, ibuf, row_start, row_end);
+  jpeg_finish_compress(cinfo);
+  jpeg_destroy_compress(cinfo);
+
+  strip->ok = true;
+}
+
+/* Offset of the entropy coded data following the start of scan header, zero if not found. */
+static size_t jpeg_scan_data_offset(const unsigned char *data, size_t size, size_t *r_sof_offset)
+{
+  size_t offset = 2;
+
+  if (size < 4 || data[0] != 0xFF || data[1] != 0xD8) {
+    return 0;
+  }
+
+  while (offset + 4 <= size && data[offset] == 0xFF) {
+    const unsigned char marker = data[offset + 1];
+    const size_t length = ((size_t)data[offset + 2] << 8) | data[offset + 3];
+
+    if (ELEM(marker, 0xC0, 0xC1)) {
+      *r_sof_offset = offset;
+    }
+    if (marker == 0xDA) {
+      return offset + 2 + length;
+    }
+    offset += 2 + length;
+  }
+
+  return 0;
+}
+
+/* Renumber restart markers in entropy coded data, continuing from r_restart. */
+static void jpeg_renumber_restart_markers(unsigned char *data, size_t size, int *r_restart)
+{
+  for (size_t i = 0; i + 1 < size; i++) {
+    if (data[i] == 0xFF) {
+      if (data[i + 1] >= 0xD0 && data[i + 1] <= 0xD7) {
+        data[i + 1] = 0xD0 + ((*r_restart)++ & 7);
+      }
+      i++;
+    }
+  }
+}
+
+static bool jpeg_write_strips(FILE *outfile, const JpegEncodeData *data, int height)
+{
+  size_t sof_offset = 0;
+  int restart = 0;
+
+  for (int i = 0; i < data->totstrip; i++) {
+    JpegEncodeStrip *strip = &data->strips[i];
+    const size_t scan_offset = jpeg_scan_data_offset(strip->buffer, strip->size, &sof_offset);
+
+    if (scan_offset == 0 || sof_offset == 0 || strip->size < scan_offset + 2) {
+      return false;
+    }
+
+    /* Leave out the end of image marker. */
+    const size_t scan_end = strip->size - 2;
+
+    if (i == 0) {
+      jpeg_renumber_restart_markers(strip->buffer + scan_offset, scan_end - scan_offset, &restart);
+
+      /* Header of the first strip, with the height of the full image. */
+      strip->buffer[sof_offset + 5] = (unsigned char)(height >> 8);
+      strip->buffer[sof_offset + 6] = (unsigned char)height;
+
+      if (fwrite(strip->buffer, 1, scan_end, outfile) != scan_end) {
+        return false;
+      }
+    }
+    else {
+      /* The marker joining both strips comes before the markers inside this strip. */
+      const unsigned char marker[2] = {0xFF, 0xD0 + (restart++ & 7)};
+      const size_t scan_size = scan_end - scan_offset;
+      jpeg_renumber_restart_markers(strip->buffer + scan_offset, scan_size, &restart);
+
+      if (fwrite(marker, 1, 2, outfile) != 2 ||
+          fwrite(strip->buffer + scan_offset, 1, scan_size, outfile) != scan_size) {
+        return false;
+      }
+    }
+  }
+
+  const unsigned char eoi[2] = {0xFF, 0xD9};
+  return fwrite(eoi, 1, 2, outfile) == 2;
+}
+
+static bool jpeg_encode_use_strips(const struct ImBuf *ibuf)
+{
+  return (size_t)ibuf->x * ibuf->y >= 2 * JPEG_ENCODE_STRIP_PIXELS;
+}
+
+static bool save_jpeg_strips(FILE *outfile, struct ImBuf *ibuf)
+{
+  struct jpeg_compress_struct _cinfo, *cinfo = &_cinfo;
+  struct my_error_mgr jerr;
+  JpegEncodeData data = {NULL};
+  int mcu_height = DCTSIZE;
+
+  /* Strips start on MCU boundaries, so look up the sampling factors used by the encoder. */
+  cinfo->err = jpeg_std_error(&jerr.pub);
+  jerr.pub.error_exit = jpeg_error;
+  if (setjmp(jerr.setjmp_buffer)) {
+    return false;
+  }
+  init_jpeg(NULL, cinfo, ibuf);
+  for (int i = 0; i < cinfo->num_components; i++) {
+    mcu_height = max_ii(mcu_height, cinfo->comp_info[i].v_samp_factor * DCTSIZE);
+  }
+  jpeg_destroy_compress(cinfo);
+
+  data.ibuf = ibuf;
+  data.rows_per_strip = max_ii(1, JPEG_ENCODE_STRIP_PIXELS / (ibuf->x * mcu_height)) *
+                        mcu_height;
+  data.totstrip = divide_ceil_u(ibuf->y, data.rows_per_strip);
+  data.strips = MEM_callocN(sizeof(JpegEncodeStrip) * data.totstrip, "jpeg strips");
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  BLI_task_parallel_range(0, data.totstrip, &data, jpeg_encode_strip_cb, &settings);
+
+  bool ok = true;
+  for (int i = 0; i < data.totstrip; i++) {
+    ok &= data.strips[i].ok;
+  }
+
+  ok = ok && jpeg_write_strips(outfile, &data, ibuf->y);
+
+  for (int i = 0; i < data.totstrip; i++) {
+    if (data.strips[i].buffer) {
+      free(data.strips[i].buffer);
+    }
+  }
+  MEM_freeN(data.strips);
+
+  return ok;
+}
+
+#endif /* USE_JPEG_STRIP_ENCODING */
+
+/** \} */
+
 static bool save_stdjpeg(const char *name, struct ImBuf *ibuf)
 {
   FILE *outfile;
@@ -633,6 +935,17 @@ static bool save_stdjpeg(const char *name, struct ImBuf *ibuf)
     return 0;
   }
 
+#ifdef USE_JPEG_STRIP_ENCODING
+  if (jpeg_encode_use_strips(ibuf)) {
+    const bool ok = save_jpeg_strips(outfile, ibuf);
+    fclose(outfile);
+    if (!ok) {
+      remove(name);
+    }
+    return ok;
+  }
+#endif
+
   cinfo->err = jpeg_std_error(&jerr.pub);
   jerr.pub.error_exit = jpeg_error;
 
@@ -30,11 +30,18 @@
 #include "MEM_guardedalloc.h"
 
 #include "BLI_ghash.h"
+#include "BLI_linklist.h"
+#include "BLI_listbase.h"
+#include "BLI_math_base.h"
 #include "BLI_mempool.h"
 #include "BLI_string.h"
 #include "BLI_threads.h"
 #include "BLI_utildefines.h"
 
+#include "PIL_time.h"
+
+#include "atomic_ops.h"
+
 #include "IMB_moviecache.h"
 
 #include "IMB_imbuf.h"
@@ -53,10 +60,45 @@
 static MEM_CacheLimiterC *limitor = NULL;
 static pthread_mutex_t limitor_lock = BLI_MUTEX_INITIALIZER;
 
+/* All existing caches, for statistics. Protected by limitor_lock. */
+static ListBase caches = {NULL, NULL};
+
+/* Caches which manage their own buffers, such as the sequencer cache. They are not part of the
+ * limiter, but keep their own memory usage plus the one of movie caches under the limit.
+ * Protected by limitor_lock, total is also read atomically. */
+#define MOVIECACHE_EXTERNAL_MAX 4
+static MovieCacheStats external_stats[MOVIECACHE_EXTERNAL_MAX];
+static int external_stats_len = 0;
+static size_t external_memory_in_use = 0;
+
+/* Memory of all buffers stored in movie caches, updated atomically. */
+static size_t moviecache_memory_in_use = 0;
+
+/* Running average of decode time per byte of cached buffers, used to weight priorities.
+ * Protected by limitor_lock. */
+static double average_cost_per_byte = 0.0;
+
+/* Number of independently locked parts of the cache index, must be a power of two. */
+#define MOVIECACHE_SHARDS_BITS 3
+#define MOVIECACHE_SHARDS (1 << MOVIECACHE_SHARDS_BITS)
+
+/* Part of the cache index, lookups only take its read lock so they never block each other.
+ * Keys and items are allocated from pools of the shard they are stored in. */
+typedef struct MovieCacheShard {
+  GHash *hash;
+  ThreadRWMutex lock;
+
+  struct BLI_mempool *keys_pool;
+  struct BLI_mempool *items_pool;
+  struct BLI_mempool *userkeys_pool;
+} MovieCacheShard;
+
 typedef struct MovieCache {
+  struct MovieCache *next, *prev;
+
   char name[64];
 
-  GHash *hash;
+  MovieCacheShard shards[MOVIECACHE_SHARDS];
   GHashHashFP hashfp;
   GHashCmpFP cmpfp;
   MovieCacheGetKeyDataFP getdatafp;
@@ -65,30 +107,48 @@ typedef struct MovieCache {
   MovieCacheGetItemPriorityFP getitempriorityfp;
   MovieCachePriorityDeleterFP prioritydeleterfp;
 
-  struct BLI_mempool *keys_pool;
-  struct BLI_mempool *items_pool;
-  struct BLI_mempool *userkeys_pool;
-
   int keysize;
 
+  /* Protected by limitor_lock. */
   void *last_userkey;
 
+  /* Time of the last lookup which did not find a buffer, to estimate the decode cost of the
+   * buffer put into the cache next. Protected by limitor_lock. */
+  double miss_time;
+
+  /* Statistics, updated atomically. */
+  int32_t totitem;
+  size_t memory_in_use;
+
   int totseg, *points, proxy, render_flags; /* for visual statistics optimization */
   int pad;
 } MovieCache;
 
 typedef struct MovieCacheKey {
   MovieCache *cache_owner;
+  MovieCacheShard *shard;
   void *userkey;
 } MovieCacheKey;
 
 typedef struct MovieCacheItem {
   MovieCache *cache_owner;
+  MovieCacheShard *shard;
+  /* Written under both limitor_lock and the shard write lock, read under either of them. */
   ImBuf *ibuf;
   MEM_CacheLimiterHandleC *c_handle;
   void *priority_data;
+  /* Time in seconds it took to produce the buffer, zero when unknown. */
+  float cost;
+  /* Size accounted in the cache statistics. */
+  size_t stats_size;
+  /* Value of access_clock when the item was last put or found, updated atomically. */
+  uint64_t last_access;
 } MovieCacheItem;
 
+/* Logical clock of cache accesses, to free least recently used buffers first without
+ * reordering the limiter queue on lookups. */
+static uint64_t access_clock = 0;
+
 static unsigned int moviecache_hashhash(const void *keyv)
 {
   const MovieCacheKey *key = keyv;
@@ -104,56 +164,115 @@ static bool moviecache_hashcmp(const void *av, const void *bv)
   return a->cache_owner->cmpfp(a->userkey, b->userkey);
 }
 
+static MovieCacheShard *moviecache_shard_get(MovieCache *cache, const void *userkey)
+{
+  /* Use the high bits of a multiplicative hash, the low bits select buckets inside the shard. */
+  const unsigned int hash = cache->hashfp(userkey) * 2654435761u;
+  return &cache->shards[hash >> (32 - MOVIECACHE_SHARDS_BITS)];
+}
+
 static void moviecache_keyfree(void *val)
 {
   MovieCacheKey *key = val;
 
-  BLI_mempool_free(key->cache_owner->userkeys_pool, key->userkey);
+  BLI_mempool_free(key->shard->userkeys_pool, key->userkey);
 
-  BLI_mempool_free(key->cache_owner->keys_pool, key);
+  BLI_mempool_free(key->shard->keys_pool, key);
 }
 
-static void moviecache_valfree(void *val)
+static void moviecache_stats_add(MovieCache *cache, MovieCacheItem *item)
+{
+  BLI_assert(item->ibuf != NULL);
+  atomic_add_and_fetch_int32(&cache->totitem, 1);
+  atomic_add_and_fetch_z(&cache->memory_in_use, item->stats_size);
+  atomic_add_and_fetch_z(&moviecache_memory_in_use, item->stats_size);
+}
+
+static void moviecache_stats_remove(MovieCache *cache, MovieCacheItem *item)
+{
+  atomic_sub_and_fetch_int32(&cache->totitem, 1);
+  atomic_sub_and_fetch_z(&cache->memory_in_use, item->stats_size);
+  atomic_sub_and_fetch_z(&moviecache_memory_in_use, item->stats_size);
+}
+
+/* Free an item which is no longer in the index. Must be called without the shard lock held,
+ * since the limiter lock is taken first when buffers are destroyed. */
+static void moviecache_item_free(MovieCacheItem *item)
 {
-  MovieCacheItem *item = (MovieCacheItem *)val;
   MovieCache *cache = item->cache_owner;
+  MovieCacheShard *shard = item->shard;
+  ImBuf *ibuf;
 
   PRINT("%s: cache '%s' free item %p buffer %p\n", __func__, cache->name, item, item->ibuf);
 
-  if (item->ibuf) {
+  /* The buffer might be destroyed by the limiter concurrently. */
+  BLI_mutex_lock(&limitor_lock);
+  ibuf = item->ibuf;
+  if (ibuf) {
     MEM_CacheLimiter_unmanage(item->c_handle);
-    IMB_freeImBuf(item->ibuf);
+    moviecache_stats_remove(cache, item);
+    item->ibuf = NULL;
+    item->c_handle = NULL;
   }
+  BLI_mutex_unlock(&limitor_lock);
+
+  if (ibuf) {
+    IMB_freeImBuf(ibuf);
+  }
+
+  if (item->priority_data && cache->prioritydeleterfp) {
+    cache->prioritydeleterfp(item->priority_data);
+  }
+
+  BLI_rw_mutex_lock(&shard->lock, THREAD_LOCK_WRITE);
+  BLI_mempool_free(shard->items_pool, item);
+  BLI_rw_mutex_unlock(&shard->lock);
+}
+
+/* Free an item whose buffer has been destroyed, the shard write lock is to be held. */
+static void moviecache_unused_item_free(void *val)
+{
+  MovieCacheItem *item = (MovieCacheItem *)val;
+  MovieCache *cache = item->cache_owner;
+
+  BLI_assert(item->ibuf == NULL);
 
   if (item->priority_data && cache->prioritydeleterfp) {
     cache->prioritydeleterfp(item->priority_data);
   }
 
-  BLI_mempool_free(item->cache_owner->items_pool, item);
+  BLI_mempool_free(item->shard->items_pool, item);
 }
 
 static void check_unused_keys(MovieCache *cache)
 {
-  GHashIterator gh_iter;
+  for (int i = 0; i < MOVIECACHE_SHARDS; i++) {
+    MovieCacheShard *shard = &cache->shards[i];
+    GHashIterator gh_iter;
 
-  BLI_ghashIterator_init(&gh_iter, cache->hash);
+    BLI_rw_mutex_lock(&shard->lock, THREAD_LOCK_WRITE);
 
-  while (!BLI_ghashIterator_done(&gh_iter)) {
-    const MovieCacheKey *key = BLI_ghashIterator_getKey(&gh_iter);
-    const MovieCacheItem *item = BLI_ghashIterator_getValue(&gh_iter);
-    bool remove;
+    BLI_ghashIterator_init(&gh_iter, shard->hash);
 
-    BLI_ghashIterator_step(&gh_iter);
+    while (!BLI_ghashIterator_done(&gh_iter)) {
+      const MovieCacheKey *key = BLI_ghashIterator_getKey(&gh_iter);
+      const MovieCacheItem *item = BLI_ghashIterator_getValue(&gh_iter);
+      bool remove;
 
-    remove = !item->ibuf;
+      BLI_ghashIterator_step(&gh_iter);
 
-    if (remove) {
-      PRINT("%s: cache '%s' remove item %p without buffer\n", __func__, cache->name, item);
-    }
+      remove = !item->ibuf;
 
-    if (remove) {
-      BLI_ghash_remove(cache->hash, key, moviecache_keyfree, moviecache_valfree);
+      if (remove) {
+        PRINT("%s: cache '%s' remove item %p without buffer\n", __func__, cache->name, item);
+      }
+
+      if (remove) {
+        BLI_ghash_remove(shard->hash, key, moviecache_keyfree, moviecache_unused_item_free);
+      }
     }
+
+    BLI_rw_mutex_unlock(&shard->lock);
   }
 }
 
@@ -164,19 +283,25 @@ static int compare_int(const void *av, const void *bv)
   return *a - *b;
 }
 
+/* Called by the limiter with limitor_lock held. */
 static void IMB_moviecache_destructor(void *p)
 {
   MovieCacheItem *item = (MovieCacheItem *)p;
 
   if (item && item->ibuf) {
     MovieCache *cache = item->cache_owner;
+    ImBuf *ibuf = item->ibuf;
 
     PRINT("%s: cache '%s' destroy item %p buffer %p\n", __func__, cache->name, item, item->ibuf);
 
-    IMB_freeImBuf(item->ibuf);
-
+    /* Lookups reference the buffer under the shard read lock. */
+    BLI_rw_mutex_lock(&item->shard->lock, THREAD_LOCK_WRITE);
     item->ibuf = NULL;
     item->c_handle = NULL;
+    BLI_rw_mutex_unlock(&item->shard->lock);
+
+    IMB_freeImBuf(ibuf);
+    moviecache_stats_remove(cache, item);
 
     /* force cached segments to be updated */
     MEM_SAFE_FREE(cache->points);
@@ -204,20 +329,61 @@ static size_t get_item_size(void *p)
   return size;
 }
 
-static int get_item_priority(void *item_v, int default_priority)
+/* Weight the age of an item by the cost of recreating it: buffers which are cheap to decode
+ * compared to their size are freed earlier than equally old buffers which are expensive. */
+static int get_item_cost_weighted_priority(MovieCacheItem *item, int default_priority)
+{
+  if (item->cost <= 0.0f || average_cost_per_byte <= 0.0) {
+    return default_priority;
+  }
+
+  const double cost_per_byte = item->cost / (double)get_item_size(item);
+  double weight = cost_per_byte / average_cost_per_byte;
+  CLAMP(weight, 0.25, 4.0);
+
+  return (int)(default_priority / weight);
+}
+
+static void update_average_cost(MovieCacheItem *item)
+{
+  if (item->cost <= 0.0f) {
+    return;
+  }
+
+  const double cost_per_byte = item->cost / (double)get_item_size(item);
+
+  if (average_cost_per_byte == 0.0) {
+    average_cost_per_byte = cost_per_byte;
+  }
+  else {
+    average_cost_per_byte = average_cost_per_byte * 0.9 + cost_per_byte * 0.1;
+  }
+}
+
+/* Lookups don't reorder the limiter queue, so the age is measured from the last access. */
+static int get_item_lru_priority(MovieCacheItem *item)
+{
+  const uint64_t age = atomic_add_and_fetch_uint64(&access_clock, 0) -
+                       atomic_add_and_fetch_uint64(&item->last_access, 0);
+  return -(int)min_zz(age, INT_MAX);
+}
+
+static int get_item_priority(void *item_v, int UNUSED(default_priority))
 {
   MovieCacheItem *item = (MovieCacheItem *)item_v;
   MovieCache *cache = item->cache_owner;
   int priority;
 
   if (!cache->getitempriorityfp) {
+    priority = get_item_cost_weighted_priority(item, get_item_lru_priority(item));
+
     PRINT("%s: cache '%s' item %p use default priority %d\n",
           __func__,
           cache->name,
           item,
-          default_priority);
+          priority);
 
-    return default_priority;
+    return priority;
   }
 
   priority = cache->getitempriorityfp(cache->last_userkey, item->priority_data);
@@ -269,17 +435,26 @@ MovieCache *IMB_moviecache_create(const char *name,
 
   BLI_strncpy(cache->name, name, sizeof(cache->name));
 
-  cache->keys_pool = BLI_mempool_create(sizeof(MovieCacheKey), 0, 64, BLI_MEMPOOL_NOP);
-  cache->items_pool = BLI_mempool_create(sizeof(MovieCacheItem), 0, 64, BLI_MEMPOOL_NOP);
-  cache->userkeys_pool = BLI_mempool_create(keysize, 0, 64, BLI_MEMPOOL_NOP);
-  cache->hash = BLI_ghash_new(
-      moviecache_hashhash, moviecache_hashcmp, "MovieClip ImBuf cache hash");
+  for (int i = 0; i < MOVIECACHE_SHARDS; i++) {
+    MovieCacheShard *shard = &cache->shards[i];
+
+    shard->keys_pool = BLI_mempool_create(sizeof(MovieCacheKey), 0, 64, BLI_MEMPOOL_NOP);
+    shard->items_pool = BLI_mempool_create(sizeof(MovieCacheItem), 0, 64, BLI_MEMPOOL_NOP);
+    shard->userkeys_pool = BLI_mempool_create(keysize, 0, 64, BLI_MEMPOOL_NOP);
+    shard->hash = BLI_ghash_new(
+        moviecache_hashhash, moviecache_hashcmp, "MovieClip ImBuf cache hash");
+    BLI_rw_mutex_init(&shard->lock);
+  }
 
   cache->keysize = keysize;
   cache->hashfp = hashfp;
   cache->cmpfp = cmpfp;
   cache->proxy = -1;
 
+  BLI_mutex_lock(&limitor_lock);
+  BLI_addtail(&caches, cache);
+  BLI_mutex_unlock(&limitor_lock);
+
   return cache;
 }
 
@@ -300,53 +475,79 @@ void IMB_moviecache_set_priority_callback(struct MovieCache *cache,
   cache->prioritydeleterfp = prioritydeleterfp;
 }
 
-static void do_moviecache_put(MovieCache *cache, void *userkey, ImBuf *ibuf, bool need_lock)
+static void do_moviecache_put(MovieCache *cache, void *userkey, ImBuf *ibuf)
 {
+  MovieCacheShard *shard = moviecache_shard_get(cache, userkey);
   MovieCacheKey *key;
-  MovieCacheItem *item;
+  MovieCacheItem *item, *item_old = NULL;
 
   if (!limitor) {
     IMB_moviecache_init();
   }
 
+  /* Items without a buffer are removed as unused keys, they would never leave the statistics. */
+  BLI_assert(ibuf != NULL);
   IMB_refImBuf(ibuf);
 
-  key = BLI_mempool_alloc(cache->keys_pool);
+  BLI_rw_mutex_lock(&shard->lock, THREAD_LOCK_WRITE);
+  key = BLI_mempool_alloc(shard->keys_pool);
+  key->userkey = BLI_mempool_alloc(shard->userkeys_pool);
+  item = BLI_mempool_alloc(shard->items_pool);
+  BLI_rw_mutex_unlock(&shard->lock);
+
   key->cache_owner = cache;
-  key->userkey = BLI_mempool_alloc(cache->userkeys_pool);
+  key->shard = shard;
   memcpy(key->userkey, userkey, cache->keysize);
 
-  item = BLI_mempool_alloc(cache->items_pool);
-
   PRINT("%s: cache '%s' put %p, item %p\n", __func__, cache->name, ibuf, item);
 
   item->ibuf = ibuf;
   item->cache_owner = cache;
+  item->shard = shard;
   item->c_handle = NULL;
   item->priority_data = NULL;
+  item->cost = 0.0f;
+  item->last_access = atomic_add_and_fetch_uint64(&access_clock, 1);
 
   if (cache->getprioritydatafp) {
     item->priority_data = cache->getprioritydatafp(userkey);
   }
 
-  BLI_ghash_reinsert(cache->hash, key, item, moviecache_keyfree, moviecache_valfree);
+  /* Enforce limits before the item is visible to lookups, the limiter might destroy its buffer
+   * right after it is unlocked, which leaves an unused key to be removed later. */
+  BLI_mutex_lock(&limitor_lock);
 
-  if (cache->last_userkey) {
-    memcpy(cache->last_userkey, userkey, cache->keysize);
+  if (cache->miss_time != 0.0) {
+    item->cost = (float)(PIL_check_seconds_timer() - cache->miss_time);
+    cache->miss_time = 0.0;
   }
 
-  if (need_lock) {
-    BLI_mutex_lock(&limitor_lock);
+  if (cache->last_userkey) {
+    memcpy(cache->last_userkey, userkey, cache->keysize);
   }
 
   item->c_handle = MEM_CacheLimiter_insert(limitor, item);
+  item->stats_size = get_item_size(item);
+  moviecache_stats_add(cache, item);
+  update_average_cost(item);
 
   MEM_CacheLimiter_ref(item->c_handle);
   MEM_CacheLimiter_enforce_limits(limitor);
   MEM_CacheLimiter_unref(item->c_handle);
 
-  if (need_lock) {
-    BLI_mutex_unlock(&limitor_lock);
+  BLI_mutex_unlock(&limitor_lock);
+
+  BLI_rw_mutex_lock(&shard->lock, THREAD_LOCK_WRITE);
+  void **key_p, **item_p;
+  if (BLI_ghash_ensure_p_ex(shard->hash, key, &key_p, &item_p)) {
+    item_old = *item_p;
+    moviecache_keyfree(key);
+  }
+  *item_p = item;
+  BLI_rw_mutex_unlock(&shard->lock);
+
+  if (item_old) {
+    moviecache_item_free(item_old);
   }
 
   /* cache limiter can't remove unused keys which points to destroyed values */
@@ -357,83 +558,107 @@ static void do_moviecache_put(MovieCache *cache, void *userkey, ImBuf *ibuf, boo
 
 void IMB_moviecache_put(MovieCache *cache, void *userkey, ImBuf *ibuf)
 {
-  do_moviecache_put(cache, userkey, ibuf, true);
+  do_moviecache_put(cache, userkey, ibuf);
 }
 
 bool IMB_moviecache_put_if_possible(MovieCache *cache, void *userkey, ImBuf *ibuf)
 {
-  size_t mem_in_use, mem_limit, elem_size;
-  bool result = false;
-
-  elem_size = get_size_in_memory(ibuf);
-  mem_limit = MEM_CacheLimiter_get_maximum();
-
-  BLI_mutex_lock(&limitor_lock);
-  mem_in_use = MEM_CacheLimiter_get_memory_in_use(limitor);
+  const size_t elem_size = get_size_in_memory(ibuf);
+  const size_t mem_limit = MEM_CacheLimiter_get_maximum();
 
-  if (mem_in_use + elem_size <= mem_limit) {
-    do_moviecache_put(cache, userkey, ibuf, false);
-    result = true;
+  if (atomic_add_and_fetch_z(&moviecache_memory_in_use, 0) + elem_size > mem_limit) {
+    return false;
   }
 
-  BLI_mutex_unlock(&limitor_lock);
-
-  return result;
+  do_moviecache_put(cache, userkey, ibuf);
+  return true;
 }
 
 void IMB_moviecache_remove(MovieCache *cache, void *userkey)
 {
+  MovieCacheShard *shard = moviecache_shard_get(cache, userkey);
   MovieCacheKey key;
+  MovieCacheItem *item;
+
   key.cache_owner = cache;
   key.userkey = userkey;
-  BLI_ghash_remove(cache->hash, &key, moviecache_keyfree, moviecache_valfree);
+
+  BLI_rw_mutex_lock(&shard->lock, THREAD_LOCK_WRITE);
+  item = BLI_ghash_popkey(shard->hash, &key, moviecache_keyfree);
+  BLI_rw_mutex_unlock(&shard->lock);
+
+  if (item) {
+    moviecache_item_free(item);
+  }
 }
 
 ImBuf *IMB_moviecache_get(MovieCache *cache, void *userkey)
 {
+  MovieCacheShard *shard = moviecache_shard_get(cache, userkey);
   MovieCacheKey key;
   MovieCacheItem *item;
+  ImBuf *ibuf = NULL;
 
   key.cache_owner = cache;
   key.userkey = userkey;
-  item = (MovieCacheItem *)BLI_ghash_lookup(cache->hash, &key);
-
-  if (item) {
-    if (item->ibuf) {
-      BLI_mutex_lock(&limitor_lock);
-      MEM_CacheLimiter_touch(item->c_handle);
-      BLI_mutex_unlock(&limitor_lock);
 
-      IMB_refImBuf(item->ibuf);
+  BLI_rw_mutex_lock(&shard->lock, THREAD_LOCK_READ);
+  item = (MovieCacheItem *)BLI_ghash_lookup(shard->hash, &key);
+  if (item && item->ibuf) {
+    ibuf = item->ibuf;
+    IMB_refImBuf(ibuf);
+    item->last_access = atomic_add_and_fetch_uint64(&access_clock, 1);
+  }
+  BLI_rw_mutex_unlock(&shard->lock);
 
-      return item->ibuf;
-    }
+  if (ibuf == NULL) {
+    const double miss_time = PIL_check_seconds_timer();
+    BLI_mutex_lock(&limitor_lock);
+    cache->miss_time = miss_time;
+    BLI_mutex_unlock(&limitor_lock);
   }
 
-  return NULL;
+  return ibuf;
 }
 
 bool IMB_moviecache_has_frame(MovieCache *cache, void *userkey)
 {
+  MovieCacheShard *shard = moviecache_shard_get(cache, userkey);
   MovieCacheKey key;
-  MovieCacheItem *item;
+  bool has_frame;
 
   key.cache_owner = cache;
   key.userkey = userkey;
-  item = (MovieCacheItem *)BLI_ghash_lookup(cache->hash, &key);
 
-  return item != NULL;
+  BLI_rw_mutex_lock(&shard->lock, THREAD_LOCK_READ);
+  has_frame = BLI_ghash_haskey(shard->hash, &key);
+  BLI_rw_mutex_unlock(&shard->lock);
+
+  return has_frame;
 }
 
 void IMB_moviecache_free(MovieCache *cache)
 {
   PRINT("%s: cache '%s' free\n", __func__, cache->name);
 
-  BLI_ghash_free(cache->hash, moviecache_keyfree, moviecache_valfree);
+  BLI_mutex_lock(&limitor_lock);
+  BLI_remlink(&caches, cache);
+  BLI_mutex_unlock(&limitor_lock);
+
+  for (int i = 0; i < MOVIECACHE_SHARDS; i++) {
+    MovieCacheShard *shard = &cache->shards[i];
+    GHashIterator gh_iter;
 
-  BLI_mempool_destroy(cache->keys_pool);
-  BLI_mempool_destroy(cache->items_pool);
-  BLI_mempool_destroy(cache->userkeys_pool);
+    GHASH_ITER (gh_iter, shard->hash) {
+      moviecache_item_free(BLI_ghashIterator_getValue(&gh_iter));
+    }
+    BLI_ghash_free(shard->hash, NULL, NULL);
+
+    BLI_mempool_destroy(shard->keys_pool);
+    BLI_mempool_destroy(shard->items_pool);
+    BLI_mempool_destroy(shard->userkeys_pool);
+    BLI_rw_mutex_end(&shard->lock);
+  }
 
   if (cache->points) {
     MEM_freeN(cache->points);
@@ -450,23 +675,36 @@ void IMB_moviecache_cleanup(MovieCache *cache,
                             bool(cleanup_check_cb)(ImBuf *ibuf, void *userkey, void *userdata),
                             void *userdata)
 {
-  GHashIterator gh_iter;
-
   check_unused_keys(cache);
 
-  BLI_ghashIterator_init(&gh_iter, cache->hash);
+  for (int i = 0; i < MOVIECACHE_SHARDS; i++) {
+    MovieCacheShard *shard = &cache->shards[i];
+    LinkNode *items_free = NULL;
+    GHashIterator gh_iter;
+
+    BLI_rw_mutex_lock(&shard->lock, THREAD_LOCK_WRITE);
+
+    BLI_ghashIterator_init(&gh_iter, shard->hash);
 
-  while (!BLI_ghashIterator_done(&gh_iter)) {
-    MovieCacheKey *key = BLI_ghashIterator_getKey(&gh_iter);
-    MovieCacheItem *item = BLI_ghashIterator_getValue(&gh_iter);
+    while (!BLI_ghashIterator_done(&gh_iter)) {
+      MovieCacheKey *key = BLI_ghashIterator_getKey(&gh_iter);
+      MovieCacheItem *item = BLI_ghashIterator_getValue(&gh_iter);
 
-    BLI_ghashIterator_step(&gh_iter);
+      BLI_ghashIterator_step(&gh_iter);
 
-    if (cleanup_check_cb(item->ibuf, key->userkey, userdata)) {
-      PRINT("%s: cache '%s' remove item %p\n", __func__, cache->name, item);
+      if (cleanup_check_cb(item->ibuf, key->userkey, userdata)) {
+        PRINT("%s: cache '%s' remove item %p\n", __func__, cache->name, item);
 
-      BLI_ghash_remove(cache->hash, key, moviecache_keyfree, moviecache_valfree);
+        BLI_linklist_prepend(&items_free, BLI_ghash_popkey(shard->hash, key, moviecache_keyfree));
+      }
     }
+
+    BLI_rw_mutex_unlock(&shard->lock);
+
+    for (LinkNode *link = items_free; link; link = link->next) {
+      moviecache_item_free(link->link);
+    }
+    BLI_linklist_free(items_free, NULL);
   }
 }
 
@@ -490,24 +728,34 @@ void IMB_moviecache_get_cache_segments(
     *r_points = cache->points;
   }
   else {
-    int totframe = BLI_ghash_len(cache->hash);
+    int totframe = 0;
+    for (int i = 0; i < MOVIECACHE_SHARDS; i++) {
+      totframe += BLI_ghash_len(cache->shards[i].hash);
+    }
+
     int *frames = MEM_callocN(totframe * sizeof(int), "movieclip cache frames");
     int a, totseg = 0;
     GHashIterator gh_iter;
 
     a = 0;
-    GHASH_ITER (gh_iter, cache->hash) {
-      MovieCacheKey *key = BLI_ghashIterator_getKey(&gh_iter);
-      MovieCacheItem *item = BLI_ghashIterator_getValue(&gh_iter);
-      int framenr, curproxy, curflags;
+    for (int i = 0; i < MOVIECACHE_SHARDS; i++) {
+      MovieCacheShard *shard = &cache->shards[i];
+
+      BLI_rw_mutex_lock(&shard->lock, THREAD_LOCK_READ);
+      GHASH_ITER (gh_iter, shard->hash) {
+        MovieCacheKey *key = BLI_ghashIterator_getKey(&gh_iter);
+        MovieCacheItem *item = BLI_ghashIterator_getValue(&gh_iter);
+        int framenr, curproxy, curflags;
 
-      if (item->ibuf) {
-        cache->getdatafp(key->userkey, &framenr, &curproxy, &curflags);
+        if (item->ibuf && a < totframe) {
+          cache->getdatafp(key->userkey, &framenr, &curproxy, &curflags);
 
-        if (curproxy == proxy && curflags == render_flags) {
-          frames[a++] = framenr;
+          if (curproxy == proxy && curflags == render_flags) {
+            frames[a++] = framenr;
+          }
         }
       }
+      BLI_rw_mutex_unlock(&shard->lock);
     }
 
     qsort(frames, totframe, sizeof(int), compare_int);
@@ -557,39 +805,168 @@ void IMB_moviecache_get_cache_segments(
   }
 }
 
+/* -------------------------------------------------------------------- */
+/** \name Shared Memory Budget
+ *
+ * All movie caches share one memory limiter. Caches which manage their own buffers report their
+ * memory usage here and free their own buffers until the total of all caches is under the limit.
+ * The limiter does not count them, so they never make movie caches give up their buffers.
+ * \{ */
+
+static MovieCacheStats *external_stats_ensure(const char *name)
+{
+  for (int i = 0; i < external_stats_len; i++) {
+    if (STREQ(external_stats[i].name, name)) {
+      return &external_stats[i];
+    }
+  }
+
+  BLI_assert(external_stats_len < MOVIECACHE_EXTERNAL_MAX);
+  MovieCacheStats *stats = &external_stats[external_stats_len++];
+  BLI_strncpy(stats->name, name, sizeof(stats->name));
+  stats->totitem = 0;
+  stats->memory_in_use = 0;
+  return stats;
+}
+
+void IMB_moviecache_external_add(const char *name, size_t size)
+{
+  BLI_mutex_lock(&limitor_lock);
+
+  MovieCacheStats *stats = external_stats_ensure(name);
+  stats->totitem++;
+  stats->memory_in_use += size;
+  atomic_add_and_fetch_z(&external_memory_in_use, size);
+
+  BLI_mutex_unlock(&limitor_lock);
+}
+
+void IMB_moviecache_external_remove(const char *name, size_t size)
+{
+  BLI_mutex_lock(&limitor_lock);
+
+  MovieCacheStats *stats = external_stats_ensure(name);
+  BLI_assert(stats->totitem > 0 && stats->memory_in_use >= size);
+  stats->totitem--;
+  stats->memory_in_use -= size;
+  atomic_sub_and_fetch_z(&external_memory_in_use, size);
+
+  BLI_mutex_unlock(&limitor_lock);
+}
+
+/* Cheap estimate which doesn't iterate the limiter queue, buffer sizes are taken when they are
+ * put into the cache. */
+size_t IMB_moviecache_get_memory_in_use(void)
+{
+  return atomic_add_and_fetch_z(&moviecache_memory_in_use, 0) +
+         atomic_add_and_fetch_z(&external_memory_in_use, 0);
+}
+
+static void stats_accumulate(MovieCacheStats *r_stats,
+                             int *r_len,
+                             int max_stats,
+                             const char *name,
+                             int totitem,
+                             size_t memory_in_use)
+{
+  for (int i = 0; i < *r_len; i++) {
+    if (STREQ(r_stats[i].name, name)) {
+      r_stats[i].totitem += totitem;
+      r_stats[i].memory_in_use += memory_in_use;
+      return;
+    }
+  }
+
+  if (*r_len < max_stats) {
+    MovieCacheStats *stats = &r_stats[(*r_len)++];
+    BLI_strncpy(stats->name, name, sizeof(stats->name));
+    stats->totitem = totitem;
+    stats->memory_in_use = memory_in_use;
+  }
+}
+
+int IMB_moviecache_get_stats(MovieCacheStats *r_stats, int max_stats)
+{
+  int len = 0;
+
+  BLI_mutex_lock(&limitor_lock);
+
+  LISTBASE_FOREACH (MovieCache *, cache, &caches) {
+    stats_accumulate(r_stats,
+                     &len,
+                     max_stats,
+                     cache->name,
+                     cache->totitem,
+                     cache->memory_in_use);
+  }
+
+  for (int i = 0; i < external_stats_len; i++) {
+    const MovieCacheStats *stats = &external_stats[i];
+    stats_accumulate(r_stats, &len, max_stats, stats->name, stats->totitem, stats->memory_in_use);
+  }
+
+  BLI_mutex_unlock(&limitor_lock);
+
+  return len;
+}
+
+/** \} */
+
+/* Iteration is not protected against concurrent modification of the cache, callers are
+ * expected to hold the lock of the cache owner. */
+typedef struct MovieCacheIter {
+  MovieCache *cache;
+  int shard;
+  GHashIterator gh_iter;
+} MovieCacheIter;
+
+static void moviecache_iter_skip_empty_shards(MovieCacheIter *iter)
+{
+  while (BLI_ghashIterator_done(&iter->gh_iter) && iter->shard < MOVIECACHE_SHARDS - 1) {
+    iter->shard++;
+    BLI_ghashIterator_init(&iter->gh_iter, iter->cache->shards[iter->shard].hash);
+  }
+}
+
 struct MovieCacheIter *IMB_moviecacheIter_new(MovieCache *cache)
 {
-  GHashIterator *iter;
+  MovieCacheIter *iter;
 
   check_unused_keys(cache);
-  iter = BLI_ghashIterator_new(cache->hash);
 
-  return (struct MovieCacheIter *)iter;
+  iter = MEM_mallocN(sizeof(MovieCacheIter), "MovieCacheIter");
+  iter->cache = cache;
+  iter->shard = 0;
+  BLI_ghashIterator_init(&iter->gh_iter, cache->shards[0].hash);
+  moviecache_iter_skip_empty_shards(iter);
+
+  return iter;
 }
 
 void IMB_moviecacheIter_free(struct MovieCacheIter *iter)
 {
-  BLI_ghashIterator_free((GHashIterator *)iter);
+  MEM_freeN(iter);
 }
 
 bool IMB_moviecacheIter_done(struct MovieCacheIter *iter)
 {
-  return BLI_ghashIterator_done((GHashIterator *)iter);
+  return BLI_ghashIterator_done(&iter->gh_iter);
 }
 
 void IMB_moviecacheIter_step(struct MovieCacheIter *iter)
 {
-  BLI_ghashIterator_step((GHashIterator *)iter);
+  BLI_ghashIterator_step(&iter->gh_iter);
+  moviecache_iter_skip_empty_shards(iter);
 }
 
 ImBuf *IMB_moviecacheIter_getImBuf(struct MovieCacheIter *iter)
 {
-  MovieCacheItem *item = BLI_ghashIterator_getValue((GHashIterator *)iter);
+  MovieCacheItem *item = BLI_ghashIterator_getValue(&iter->gh_iter);
   return item->ibuf;
 }
 
 void *IMB_moviecacheIter_getUserKey(struct MovieCacheIter *iter)
 {
-  MovieCacheKey *key = BLI_ghashIterator_getKey((GHashIterator *)iter);
+  MovieCacheKey *key = BLI_ghashIterator_getKey(&iter->gh_iter);
   return key->userkey;
 }
@@ -31,6 +31,7 @@
 #include <set>
 #include <stdexcept>
 #include <string>
+#include <vector>
 
 #include <Iex.h>
 #include <ImathBox.h>
@@ -42,6 +43,7 @@
 #include <ImfInputFile.h>
 #include <ImfOutputFile.h>
 #include <ImfPixelType.h>
+#include <ImfPreviewImage.h>
 #include <ImfStandardAttributes.h>
 #include <ImfStringAttribute.h>
 #include <ImfVersion.h>
@@ -55,6 +57,7 @@
 #include <ImfOutputPart.h>
 #include <ImfPartHelper.h>
 #include <ImfPartType.h>
+#include <ImfTiledInputPart.h>
 #include <ImfTiledOutputPart.h>
 
 #include "DNA_scene_types.h" /* For OpenEXR compression constants */
@@ -78,6 +81,7 @@ _CRTIMP void __cdecl _invalid_parameter_noinfo(void)
 }
 #include "BLI_blenlib.h"
 #include "BLI_math_color.h"
+#include "BLI_task.h"
 #include "BLI_threads.h"
 
 #include "BKE_idprop.h"
@@ -102,6 +106,7 @@ static bool exr_has_multiview(MultiPartInputFile &file);
 static bool exr_has_multipart_file(MultiPartInputFile &file);
 static bool exr_has_alpha(MultiPartInputFile &file);
 static bool exr_has_zbuffer(MultiPartInputFile &file);
+static bool imb_exr_is_multi(MultiPartInputFile &file);
 static void exr_printf(const char *__restrict fmt, ...);
 static void imb_exr_type_by_channels(ChannelList &channels,
                                      StringVector &views,
@@ -646,6 +651,22 @@ struct ExrHandle {
   ListBase layers;   /* hierarchical, pointing in end to ExrChannel */
 
   int num_half_channels; /* used during filr save, allows faster temporary buffers allocation */
+
+  /** Pass buffers are only allocated and read when requested, see #IMB_exr_read_pass. The file
+   * is not kept open in between, every read opens it again. */
+  bool read_on_demand;
+  /** Cached #imb_exr_is_multi, the input file may not be open anymore. */
+  bool is_multi;
+
+  /** Where the input is read from, so parts can be read concurrently, each from its own stream.
+   * The memory is only valid while loading the image. */
+  char read_filepath[FILE_MAX];
+  const unsigned char *read_mem;
+  size_t read_mem_size;
+  /** Size and modification time of the file when opened, to not read passes from a file which
+   * was overwritten since. */
+  int64_t read_file_size;
+  int64_t read_file_mtime;
 };
 
 /* flattened out channel */
@@ -983,6 +1004,8 @@ int IMB_exr_begin_read(void *handle, const char *filename, int *width, int *heig
     }
 
     if (data->ifile) {
+      BLI_strncpy(data->read_filepath, filename, sizeof(data->read_filepath));
+
       Box2i dw = data->ifile->header(0).dataWindow();
       data->width = *width = dw.max.x - dw.min.x + 1;
       data->height = *height = dw.max.y - dw.min.y + 1;
@@ -1205,13 +1228,96 @@ void IMB_exrtile_write_channels(
   }
 }
 
-void IMB_exr_read_channels(void *handle)
+static bool imb_exr_pass_has_channel(const ExrPass *pass, const ExrChannel *echan)
 {
-  ExrHandle *data = (ExrHandle *)handle;
-  int numparts = data->ifile->parts();
+  for (int a = 0; a < pass->totchan; a++) {
+    if (pass->chan[a] == echan) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/* New stream for the input of the handle, NULL when the input is not known. */
+static IStream *imb_exr_read_stream_open(const ExrHandle *data)
+{
+  if (data->read_mem) {
+    return new IMemStream((unsigned char *)data->read_mem, data->read_mem_size);
+  }
+  if (data->read_filepath[0]) {
+    return new IFileStream(data->read_filepath);
+  }
+  return nullptr;
+}
+
+/* Parts are independent in the file, so they are decoded concurrently. Reads from a single
+ * stream are serialized by OpenEXR, so then every part is read from its own stream. */
+struct ExrReadPart {
+  int part_number;
+  FrameBuffer frameBuffer;
+  Box2i dw;
+  bool ok;
+};
+
+struct ExrReadParts {
+  const ExrHandle *data;
+  /* File to read from when not using a stream per part. */
+  MultiPartInputFile *file;
+  bool use_part_streams;
+  std::vector<ExrReadPart> parts;
+};
+
+static void imb_exr_read_part(MultiPartInputFile &file, ExrReadPart &part)
+{
+  InputPart in(file, part.part_number);
+  in.setFrameBuffer(part.frameBuffer);
+  exr_printf("readPixels:readPixels[%d]: min.y: %d, max.y: %d\n",
+             part.part_number,
+             part.dw.min.y,
+             part.dw.max.y);
+  in.readPixels(part.dw.min.y, part.dw.max.y);
+}
+
+static void imb_exr_read_part_cb(void *__restrict userdata,
+                                 const int i,
+                                 const TaskParallelTLS *__restrict /*tls*/)
+{
+  ExrReadParts &read = *(ExrReadParts *)userdata;
+  ExrReadPart &part = read.parts[i];
+  IStream *stream = nullptr;
+  MultiPartInputFile *file = nullptr;
+
+  try {
+    if (read.use_part_streams) {
+      stream = imb_exr_read_stream_open(read.data);
+      file = new MultiPartInputFile(*stream);
+      imb_exr_read_part(*file, part);
+    }
+    else {
+      imb_exr_read_part(*read.file, part);
+    }
+  }
+  catch (const std::exception &exc) {
+    std::cerr << "OpenEXR-readPixels: ERROR: " << exc.what() << std::endl;
+    part.ok = false;
+  }
+
+  delete file;
+  delete stream;
+}
+
+/**
+ * Read the channels which have a buffer set from \a file, optionally only the channels of
+ * \a only_pass. Parts without any channel to read are skipped entirely.
+ */
+static bool imb_exr_read_channels_ex(ExrHandle *data,
+                                     MultiPartInputFile &file,
+                                     const ExrPass *only_pass)
+{
+  int numparts = file.parts();
 
   /* Check if EXR was saved with previous versions of blender which flipped images. */
-  const StringAttribute *ta = data->ifile->header(0).findTypedAttribute<StringAttribute>(
+  const StringAttribute *ta = file.header(0).findTypedAttribute<StringAttribute>(
       "BlenderMultiChannel");
 
   /* 'previous multilayer attribute, flipped. */
@@ -1225,20 +1331,29 @@ void IMB_exr_read_channels(void *handle)
       "name",
       "internal_name");
 
+  ExrReadParts read;
+  read.data = data;
+  read.file = &file;
+  read.parts.reserve(numparts);
+
   for (int i = 0; i < numparts; i++) {
     /* Read part header. */
-    InputPart in(*data->ifile, i);
-    Header header = in.header();
-    Box2i dw = header.dataWindow();
+    ExrReadPart part;
+    part.part_number = i;
+    part.dw = file.header(i).dataWindow();
+    part.ok = true;
+    const Box2i &dw = part.dw;
 
     /* Insert all matching channel into frame-buffer. */
-    FrameBuffer frameBuffer;
     ExrChannel *echan;
 
     for (echan = (ExrChannel *)data->channels.first; echan; echan = echan->next) {
       if (echan->m->part_number != i) {
         continue;
       }
+      if (only_pass && !imb_exr_pass_has_channel(only_pass, echan)) {
+        continue;
+      }
 
       exr_printf("%d %-6s %-22s \"%s\"\n",
                  echan->m->part_number,
@@ -1263,25 +1378,41 @@ void IMB_exr_read_channels(void *handle)
           rect -= echan->xstride * (dw.min.x + dw.min.y * data->width);
         }
 
-        frameBuffer.insert(echan->m->internal_name,
-                           Slice(Imf::FLOAT, (char *)rect, xstride, ystride));
+        part.frameBuffer.insert(echan->m->internal_name,
+                                Slice(Imf::FLOAT, (char *)rect, xstride, ystride));
       }
-      else {
+      else if (!data->read_on_demand) {
         printf("warning, channel with no rect set %s\n", echan->m->internal_name.c_str());
       }
     }
 
-    /* Read pixels. */
-    try {
-      in.setFrameBuffer(frameBuffer);
-      exr_printf("readPixels:readPixels[%d]: min.y: %d, max.y: %d\n", i, dw.min.y, dw.max.y);
-      in.readPixels(dw.min.y, dw.max.y);
+    if (part.frameBuffer.begin() != part.frameBuffer.end()) {
+      read.parts.push_back(part);
     }
-    catch (const std::exception &exc) {
-      std::cerr << "OpenEXR-readPixels: ERROR: " << exc.what() << std::endl;
-      break;
+  }
+
+  /* Read pixels. */
+  read.use_part_streams = read.parts.size() > 1 &&
+                          (data->read_mem != nullptr || data->read_filepath[0] != '\0');
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = read.use_part_streams;
+  settings.min_iter_per_thread = 1;
+  BLI_task_parallel_range(0, (int)read.parts.size(), &read, imb_exr_read_part_cb, &settings);
+
+  for (const ExrReadPart &part : read.parts) {
+    if (!part.ok) {
+      return false;
     }
   }
+  return true;
+}
+
+void IMB_exr_read_channels(void *handle)
+{
+  ExrHandle *data = (ExrHandle *)handle;
+  imb_exr_read_channels_ex(data, *data->ifile, nullptr);
 }
 
 void IMB_exr_multilayer_convert(void *handle,
@@ -1524,21 +1655,67 @@ static ExrPass *imb_exr_get_pass(ListBase *lb, char *passname)
   return pass;
 }
 
+/**
+ * Interleave the channels of a pass in its buffer, the channels point into `pass->rect` or are
+ * cleared when it's not allocated.
+ */
+static void imb_exr_pass_assign_channels(ExrPass *pass, int width)
+{
+  char lookup[256];
+  memset(lookup, 0, sizeof(lookup));
+
+  /* we can have RGB(A), XYZ(W), UVA */
+  const bool use_lookup = ELEM(pass->totchan, 3, 4);
+  if (use_lookup) {
+    if (pass->chan[0]->chan_id == 'B' || pass->chan[1]->chan_id == 'B' ||
+        pass->chan[2]->chan_id == 'B') {
+      lookup[(unsigned int)'R'] = 0;
+      lookup[(unsigned int)'G'] = 1;
+      lookup[(unsigned int)'B'] = 2;
+      lookup[(unsigned int)'A'] = 3;
+    }
+    else if (pass->chan[0]->chan_id == 'Y' || pass->chan[1]->chan_id == 'Y' ||
+             pass->chan[2]->chan_id == 'Y') {
+      lookup[(unsigned int)'X'] = 0;
+      lookup[(unsigned int)'Y'] = 1;
+      lookup[(unsigned int)'Z'] = 2;
+      lookup[(unsigned int)'W'] = 3;
+    }
+    else {
+      lookup[(unsigned int)'U'] = 0;
+      lookup[(unsigned int)'V'] = 1;
+      lookup[(unsigned int)'A'] = 2;
+    }
+  }
+
+  for (int a = 0; a < pass->totchan; a++) {
+    ExrChannel *echan = pass->chan[a];
+    /* Unknown channel layouts are stored in file order. */
+    const int offset = use_lookup ? lookup[(unsigned int)echan->chan_id] : a;
+    echan->rect = pass->rect ? pass->rect + offset : nullptr;
+    echan->xstride = pass->totchan;
+    echan->ystride = width * pass->totchan;
+    pass->chan_id[offset] = echan->chan_id;
+  }
+}
+
 /* creates channels, makes a hierarchy and assigns memory to channels */
 static ExrHandle *imb_exr_begin_read_mem(IStream &file_stream,
                                          MultiPartInputFile &file,
                                          int width,
-                                         int height)
+                                         int height,
+                                         const bool read_on_demand)
 {
   ExrLayer *lay;
   ExrPass *pass;
   ExrChannel *echan;
   ExrHandle *data = (ExrHandle *)IMB_exr_get_handle();
-  int a;
   char layname[EXR_TOT_MAXNAME], passname[EXR_TOT_MAXNAME];
 
   data->ifile_stream = &file_stream;
   data->ifile = &file;
+  data->read_on_demand = read_on_demand;
+  data->is_multi = imb_exr_is_multi(file);
 
   data->width = width;
   data->height = height;
@@ -1599,59 +1776,11 @@ static ExrHandle *imb_exr_begin_read_mem(IStream &file_stream,
   for (lay = (ExrLayer *)data->layers.first; lay; lay = lay->next) {
     for (pass = (ExrPass *)lay->passes.first; pass; pass = pass->next) {
       if (pass->totchan) {
-        pass->rect = (float *)MEM_callocN(width * height * pass->totchan * sizeof(float),
-                                          "pass rect");
-        if (pass->totchan == 1) {
-          echan = pass->chan[0];
-          echan->rect = pass->rect;
-          echan->xstride = 1;
-          echan->ystride = width;
-          pass->chan_id[0] = echan->chan_id;
-        }
-        else {
-          char lookup[256];
-
-          memset(lookup, 0, sizeof(lookup));
-
-          /* we can have RGB(A), XYZ(W), UVA */
-          if (ELEM(pass->totchan, 3, 4)) {
-            if (pass->chan[0]->chan_id == 'B' || pass->chan[1]->chan_id == 'B' ||
-                pass->chan[2]->chan_id == 'B') {
-              lookup[(unsigned int)'R'] = 0;
-              lookup[(unsigned int)'G'] = 1;
-              lookup[(unsigned int)'B'] = 2;
-              lookup[(unsigned int)'A'] = 3;
-            }
-            else if (pass->chan[0]->chan_id == 'Y' || pass->chan[1]->chan_id == 'Y' ||
-                     pass->chan[2]->chan_id == 'Y') {
-              lookup[(unsigned int)'X'] = 0;
-              lookup[(unsigned int)'Y'] = 1;
-              lookup[(unsigned int)'Z'] = 2;
-              lookup[(unsigned int)'W'] = 3;
-            }
-            else {
-              lookup[(unsigned int)'U'] = 0;
-              lookup[(unsigned int)'V'] = 1;
-              lookup[(unsigned int)'A'] = 2;
-            }
-            for (a = 0; a < pass->totchan; a++) {
-              echan = pass->chan[a];
-              echan->rect = pass->rect + lookup[(unsigned int)echan->chan_id];
-              echan->xstride = pass->totchan;
-              echan->ystride = width * pass->totchan;
-              pass->chan_id[(unsigned int)lookup[(unsigned int)echan->chan_id]] = echan->chan_id;
-            }
-          }
-          else { /* unknown */
-            for (a = 0; a < pass->totchan; a++) {
-              echan = pass->chan[a];
-              echan->rect = pass->rect + a;
-              echan->xstride = pass->totchan;
-              echan->ystride = width * pass->totchan;
-              pass->chan_id[a] = echan->chan_id;
-            }
-          }
+        if (!read_on_demand) {
+          pass->rect = (float *)MEM_callocN(width * height * pass->totchan * sizeof(float),
+                                            "pass rect");
         }
+        imb_exr_pass_assign_channels(pass, width);
       }
     }
   }
@@ -1891,13 +2020,34 @@ static bool imb_exr_is_multi(MultiPartInputFile &file)
 bool IMB_exr_has_multilayer(void *handle)
 {
   ExrHandle *data = (ExrHandle *)handle;
-  return imb_exr_is_multi(*data->ifile);
+  return data->is_multi;
 }
 
-struct ImBuf *imb_load_openexr(const unsigned char *mem,
-                               size_t size,
-                               int flags,
-                               char colorspace[IM_MAX_SPACE])
+static void openexr_metadata_read(const Header &header, struct ImBuf *ibuf)
+{
+  Header::ConstIterator iter;
+
+  IMB_metadata_ensure(&ibuf->metadata);
+  for (iter = header.begin(); iter != header.end(); iter++) {
+    const StringAttribute *attr = header.findTypedAttribute<StringAttribute>(iter.name());
+
+    /* not all attributes are string attributes so we might get some NULLs here */
+    if (attr) {
+      IMB_metadata_set_field(ibuf->metadata, iter.name(), attr->value().c_str());
+      ibuf->flags |= IB_metadata;
+    }
+  }
+}
+
+/**
+ * With a file path and #IB_multilayer_on_demand, multilayer files only get their layers and
+ * passes listed, their pixels are read from the file later with #IMB_exr_read_pass.
+ */
+static struct ImBuf *imb_load_openexr_ex(const unsigned char *mem,
+                                         size_t size,
+                                         const char *filepath,
+                                         int flags,
+                                         char colorspace[IM_MAX_SPACE])
 {
   struct ImBuf *ibuf = nullptr;
   IMemStream *membuf = nullptr;
@@ -1949,28 +2099,36 @@ struct ImBuf *imb_load_openexr(const unsigned char *mem,
       if (!(flags & IB_test)) {
 
         if (flags & IB_metadata) {
-          const Header &header = file->header(0);
-          Header::ConstIterator iter;
-
-          IMB_metadata_ensure(&ibuf->metadata);
-          for (iter = header.begin(); iter != header.end(); iter++) {
-            const StringAttribute *attr = file->header(0).findTypedAttribute<StringAttribute>(
-                iter.name());
-
-            /* not all attributes are string attributes so we might get some NULLs here */
-            if (attr) {
-              IMB_metadata_set_field(ibuf->metadata, iter.name(), attr->value().c_str());
-              ibuf->flags |= IB_metadata;
-            }
-          }
+          openexr_metadata_read(file->header(0), ibuf);
         }
 
         /* Only enters with IB_multilayer flag set. */
         if (is_multi && ((flags & IB_thumbnail) == 0)) {
+          BLI_stat_t st;
+          const bool read_on_demand = filepath != nullptr &&
+                                      (flags & IB_multilayer_on_demand) &&
+                                      BLI_stat(filepath, &st) == 0;
+
           /* constructs channels for reading, allocates memory in channels */
-          ExrHandle *handle = imb_exr_begin_read_mem(*membuf, *file, width, height);
+          ExrHandle *handle = imb_exr_begin_read_mem(
+              *membuf, *file, width, height, read_on_demand);
           if (handle) {
-            IMB_exr_read_channels(handle);
+            if (read_on_demand) {
+              BLI_strncpy(handle->read_filepath, filepath, sizeof(handle->read_filepath));
+              handle->read_file_size = (int64_t)st.st_size;
+              handle->read_file_mtime = (int64_t)st.st_mtime;
+              /* Don't keep the memory, passes are read from the file. */
+              delete handle->ifile;
+              delete handle->ifile_stream;
+              handle->ifile = nullptr;
+              handle->ifile_stream = nullptr;
+            }
+            else {
+              handle->read_mem = mem;
+              handle->read_mem_size = size;
+              IMB_exr_read_channels(handle);
+              handle->read_mem = nullptr;
+            }
             ibuf->userdata = handle; /* potential danger, the caller has to check for this! */
           }
         }
@@ -2092,6 +2250,188 @@ struct ImBuf *imb_load_openexr(const unsigned char *mem,
   }
 }
 
+struct ImBuf *imb_load_openexr(const unsigned char *mem,
+                               size_t size,
+                               int flags,
+                               char colorspace[IM_MAX_SPACE])
+{
+  return imb_load_openexr_ex(mem, size, nullptr, flags, colorspace);
+}
+
+struct ImBuf *imb_load_multilayer_openexr(const unsigned char *mem,
+                                          size_t size,
+                                          const char *filepath,
+                                          int flags,
+                                          char colorspace[IM_MAX_SPACE])
+{
+  return imb_load_openexr_ex(mem, size, filepath, flags, colorspace);
+}
+
+/**
+ * Thumbnails use the preview image stored in the header when there is one, or else the smallest
+ * mipmap level of tiled files that is still large enough. Other files return NULL, to be loaded in
+ * full resolution.
+ */
+struct ImBuf *imb_load_filepath_thumbnail_openexr(const char *filepath,
+                                                  const int /*flags*/,
+                                                  const size_t max_thumb_size,
+                                                  char colorspace[],
+                                                  size_t *r_width,
+                                                  size_t *r_height)
+{
+  ImBuf *ibuf = nullptr;
+
+  /* OpenExr uses exceptions for error-handling. */
+  try {
+    IFileStream stream(filepath);
+    /* Only reads the headers. */
+    MultiPartInputFile file(stream);
+    const Header &header = file.header(0);
+    const Box2i dw = header.dataWindow();
+
+    *r_width = dw.max.x - dw.min.x + 1;
+    *r_height = dw.max.y - dw.min.y + 1;
+
+    if (header.hasPreviewImage()) {
+      const PreviewImage &preview = header.previewImage();
+      ibuf = IMB_allocFromBuffer(
+          (const unsigned int *)preview.pixels(), nullptr, preview.width(), preview.height(), 4);
+      if (ibuf) {
+        /* Preview images are stored top to bottom. */
+        IMB_flipy(ibuf);
+      }
+      colorspace_set_default_role(colorspace, IM_MAX_SPACE, COLOR_ROLE_DEFAULT_BYTE);
+      return ibuf;
+    }
+
+    const char *rgb_channels[3];
+    if (!header.hasTileDescription() || header.tileDescription().mode != MIPMAP_LEVELS ||
+        imb_exr_is_multi(file) || exr_has_rgb(file, rgb_channels) != 3) {
+      return nullptr;
+    }
+
+    TiledInputPart in(file, 0);
+    int level = 0;
+    while (level + 1 < in.numLevels() &&
+           std::max(in.levelWidth(level + 1), in.levelHeight(level + 1)) >= (int)max_thumb_size) {
+      level++;
+    }
+    if (level == 0) {
+      return nullptr;
+    }
+
+    const Box2i level_dw = in.dataWindowForLevel(level);
+    const int width = in.levelWidth(level);
+    const int height = in.levelHeight(level);
+
+    ibuf = IMB_allocImBuf(width, height, 32, IB_rectfloat);
+    if (ibuf == nullptr) {
+      return nullptr;
+    }
+
+    /* Read y-flipped, same as #imb_load_openexr. */
+    const size_t xstride = sizeof(float[4]);
+    const size_t ystride = -xstride * width;
+    float *first = ibuf->rect_float - 4 * (level_dw.min.x - level_dw.min.y * width);
+    first += 4 * (height - 1) * width;
+
+    FrameBuffer frameBuffer;
+    for (int i = 0; i < 3; i++) {
+      frameBuffer.insert(exr_rgba_channelname(file, rgb_channels[i]),
+                         Slice(Imf::FLOAT, (char *)(first + i), xstride, ystride));
+    }
+    frameBuffer.insert(exr_rgba_channelname(file, "A"),
+                       Slice(Imf::FLOAT, (char *)(first + 3), xstride, ystride, 1, 1, 1.0f));
+
+    in.setFrameBuffer(frameBuffer);
+    in.readTiles(0, in.numXTiles(level) - 1, 0, in.numYTiles(level) - 1, level);
+
+    ibuf->flags |= exr_is_half_float(file) ? IB_halffloat : 0;
+    colorspace_set_default_role(colorspace, IM_MAX_SPACE, COLOR_ROLE_DEFAULT_FLOAT);
+    return ibuf;
+  }
+  catch (const std::exception &exc) {
+    std::cerr << exc.what() << std::endl;
+    if (ibuf) {
+      IMB_freeImBuf(ibuf);
+    }
+    return nullptr;
+  }
+}
+
+bool IMB_exr_reads_on_demand(void *handle)
+{
+  ExrHandle *data = (ExrHandle *)handle;
+  return data->read_on_demand;
+}
+
+/**
+ * Read a single pass of a file loaded with #IB_multilayer_on_demand, only decoding the parts
+ * that contain its channels. The caller owns the returned buffer, NULL is returned on failure.
+ *
+ * The file is opened for every read, so it is not kept locked. Passes are not read from files
+ * which were changed since loading, they would not match the layers and passes of the handle.
+ */
+float *IMB_exr_read_pass(void *handle,
+                         const char *layname,
+                         const char *passname,
+                         const char *viewname)
+{
+  ExrHandle *data = (ExrHandle *)handle;
+  ExrLayer *lay = (ExrLayer *)BLI_findstring(&data->layers, layname, offsetof(ExrLayer, name));
+
+  if (lay == nullptr || !data->read_on_demand) {
+    return nullptr;
+  }
+
+  BLI_stat_t st;
+  if (BLI_stat(data->read_filepath, &st) != 0 || (int64_t)st.st_size != data->read_file_size ||
+      (int64_t)st.st_mtime != data->read_file_mtime) {
+    std::cerr << "OpenEXR: " << data->read_filepath << " changed on disk, not reading pass "
+              << passname << std::endl;
+    return nullptr;
+  }
+
+  LISTBASE_FOREACH (ExrPass *, pass, &lay->passes) {
+    if (!STREQ(pass->internal_name, passname) || !STREQ(pass->view, viewname) ||
+        pass->totchan == 0) {
+      continue;
+    }
+
+    float *rect = (float *)MEM_callocN(
+        sizeof(float) * data->width * data->height * pass->totchan, "pass rect");
+    pass->rect = rect;
+    imb_exr_pass_assign_channels(pass, data->width);
+
+    IStream *stream = nullptr;
+    MultiPartInputFile *file = nullptr;
+    bool ok;
+    try {
+      stream = new IFileStream(data->read_filepath);
+      file = new MultiPartInputFile(*stream);
+      ok = imb_exr_read_channels_ex(data, *file, pass);
+    }
+    catch (const std::exception &exc) {
+      std::cerr << exc.what() << std::endl;
+      ok = false;
+    }
+    delete file;
+    delete stream;
+
+    /* Ownership goes to the caller, don't keep pointers into the buffer. */
+    pass->rect = nullptr;
+    imb_exr_pass_assign_channels(pass, data->width);
+
+    if (!ok) {
+      MEM_freeN(rect);
+      return nullptr;
+    }
+    return rect;
+  }
+
+  return nullptr;
+}
+
 void imb_initopenexr(void)
 {
   int num_threads = BLI_system_thread_count();
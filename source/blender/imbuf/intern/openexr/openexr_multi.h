@@ -37,6 +37,7 @@
 extern "C" {
 #endif
 
+struct ImBuf;
 struct StampData;
 
 void *IMB_exr_get_handle(void);
@@ -95,6 +96,12 @@ void IMB_exr_add_view(void *handle, const char *name);
 
 bool IMB_exr_has_multilayer(void *handle);
 
+bool IMB_exr_reads_on_demand(void *handle);
+float *IMB_exr_read_pass(void *handle,
+                         const char *layname,
+                         const char *passname,
+                         const char *viewname);
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif
@@ -128,3 +128,15 @@ bool IMB_exr_has_multilayer(void * /*handle*/)
 {
   return false;
 }
+
+bool IMB_exr_reads_on_demand(void * /*handle*/)
+{
+  return false;
+}
+float *IMB_exr_read_pass(void * /*handle*/,
+                         const char * /*layname*/,
+                         const char * /*passname*/,
+                         const char * /*viewname*/)
+{
+  return nullptr;
+}
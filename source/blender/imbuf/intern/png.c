@@ -24,9 +24,12 @@
  */
 
 #include "png.h"
+#include <zlib.h>
 
+#include "BLI_endian_switch.h"
 #include "BLI_fileops.h"
 #include "BLI_math.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 
 #include "BKE_global.h"
@@ -123,121 +126,356 @@ BLI_INLINE unsigned short ftoshort(float val)
   return unit_float_to_ushort_clamp(val);
 }
 
-bool imb_savepng(struct ImBuf *ibuf, const char *filepath, int flags)
-{
-  png_structp png_ptr;
-  png_infop info_ptr;
-
-  unsigned char *pixels = NULL;
-  unsigned char *from, *to;
-  unsigned short *pixels16 = NULL, *to16;
-  float *from_float, from_straight[4];
-  png_bytepp row_pointers = NULL;
-  int i, bytesperpixel, color_type = PNG_COLOR_TYPE_GRAY;
-  FILE *fp = NULL;
+/* -------------------------------------------------------------------- */
+/** \name Multi-Threaded Encoding
+ *
+ * Large images are filtered and deflated without libpng, in strips of rows compressed in
+ * parallel. Every strip is a raw deflate stream ending on a byte boundary and primed with the
+ * end of the previous strip as dictionary, so their concatenation is one regular zlib stream
+ * which is written as IDAT chunks.
+ * \{ */
+
+/* Uncompressed size of a strip, large enough for the dictionary to not matter much. */
+#define PNG_ENCODE_STRIP_SIZE (256 * 1024)
+#define PNG_ENCODE_WINDOW_SIZE (32 * 1024)
+
+typedef struct PNGEncodeStrip {
+  /* Deflated data, preceded by room for the zlib header and followed by room for the
+   * checksum. */
+  unsigned char *buffer;
+  size_t buffer_size;
+  size_t size;
+  uLong adler;
+  bool ok;
+} PNGEncodeStrip;
+
+typedef struct PNGEncodeData {
+  /* Rows in PNG order, top to bottom. */
+  png_bytepp row_pointers;
+  const unsigned char *zero_row;
+  size_t row_bytes;
+  /* Distance in bytes to the corresponding byte of the previous pixel. */
+  int filter_bpp;
+  int compression;
 
-  bool is_16bit = (ibuf->foptions.flag & PNG_16BIT) != 0;
-  bool has_float = (ibuf->rect_float != NULL);
-  int channels_in_float = ibuf->channels ? ibuf->channels : 4;
+  /* Filter type byte followed by the filtered row, for every row. */
+  unsigned char *filtered;
+  size_t filtered_size;
 
-  float (*chanel_colormanage_cb)(float);
-  size_t num_bytes;
+  int rows_per_strip;
+  int totstrip;
+  PNGEncodeStrip *strips;
+} PNGEncodeData;
 
-  /* use the jpeg quality setting for compression */
-  int compression;
-  compression = (int)(((float)(ibuf->foptions.quality) / 11.1111f));
-  compression = compression < 0 ? 0 : (compression > 9 ? 9 : compression);
+BLI_INLINE unsigned char png_paeth_predictor(int a, int b, int c)
+{
+  const int p = a + b - c;
+  const int pa = abs(p - a);
+  const int pb = abs(p - b);
+  const int pc = abs(p - c);
 
-  if (ibuf->float_colorspace || (ibuf->colormanage_flag & IMB_COLORMANAGE_IS_DATA)) {
-    /* float buffer was managed already, no need in color space conversion */
-    chanel_colormanage_cb = channel_colormanage_noop;
+  if (pa <= pb && pa <= pc) {
+    return (unsigned char)a;
   }
-  else {
-    /* standard linear-to-srgb conversion if float buffer wasn't managed */
-    chanel_colormanage_cb = linearrgb_to_srgb;
+  if (pb <= pc) {
+    return (unsigned char)b;
   }
+  return (unsigned char)c;
+}
 
-  /* for prints */
-  if (flags & IB_mem) {
-    filepath = "<memory>";
-  }
+static void png_filter_row(int filter,
+                           const unsigned char *row,
+                           const unsigned char *prev,
+                           size_t row_bytes,
+                           int bpp,
+                           unsigned char *r_filtered)
+{
+  size_t i;
 
-  bytesperpixel = (ibuf->planes + 7) >> 3;
-  if ((bytesperpixel > 4) || (bytesperpixel == 2)) {
-    printf(
-        "imb_savepng: Unsupported bytes per pixel: %d for file: '%s'\n", bytesperpixel, filepath);
-    return 0;
+  switch (filter) {
+    case PNG_FILTER_VALUE_NONE:
+      memcpy(r_filtered, row, row_bytes);
+      break;
+    case PNG_FILTER_VALUE_SUB:
+      for (i = 0; i < bpp; i++) {
+        r_filtered[i] = row[i];
+      }
+      for (; i < row_bytes; i++) {
+        r_filtered[i] = row[i] - row[i - bpp];
+      }
+      break;
+    case PNG_FILTER_VALUE_UP:
+      for (i = 0; i < row_bytes; i++) {
+        r_filtered[i] = row[i] - prev[i];
+      }
+      break;
+    case PNG_FILTER_VALUE_AVG:
+      for (i = 0; i < bpp; i++) {
+        r_filtered[i] = row[i] - (prev[i] >> 1);
+      }
+      for (; i < row_bytes; i++) {
+        r_filtered[i] = row[i] - ((row[i - bpp] + prev[i]) >> 1);
+      }
+      break;
+    case PNG_FILTER_VALUE_PAETH:
+      for (i = 0; i < bpp; i++) {
+        r_filtered[i] = row[i] - prev[i];
+      }
+      for (; i < row_bytes; i++) {
+        r_filtered[i] = row[i] - png_paeth_predictor(row[i - bpp], prev[i], prev[i - bpp]);
+      }
+      break;
   }
+}
 
-  png_ptr = png_create_write_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
-  if (png_ptr == NULL) {
-    printf("imb_savepng: Cannot png_create_write_struct for file: '%s'\n", filepath);
-    return 0;
+static size_t png_filter_cost(const unsigned char *filtered, size_t row_bytes)
+{
+  size_t cost = 0;
+  for (size_t i = 0; i < row_bytes; i++) {
+    cost += abs((signed char)filtered[i]);
   }
+  return cost;
+}
 
-  info_ptr = png_create_info_struct(png_ptr);
-  if (info_ptr == NULL) {
-    png_destroy_write_struct(&png_ptr, (png_infopp)NULL);
-    printf("imb_savepng: Cannot png_create_info_struct for file: '%s'\n", filepath);
-    return 0;
+/* Scratch buffer for filter candidates, allocated once per thread. */
+typedef struct PNGEncodeFilterTLS {
+  unsigned char *candidate;
+} PNGEncodeFilterTLS;
+
+/* Same heuristic as libpng: the filter giving the minimum sum of absolute differences. */
+static void png_encode_filter_row_cb(void *__restrict userdata,
+                                     const int y,
+                                     const TaskParallelTLS *__restrict tls)
+{
+  const PNGEncodeData *data = userdata;
+  PNGEncodeFilterTLS *filter_tls = tls->userdata_chunk;
+  const unsigned char *row = data->row_pointers[y];
+  const unsigned char *prev = (y > 0) ? data->row_pointers[y - 1] : data->zero_row;
+  unsigned char *r_filtered = data->filtered + (size_t)y * (data->row_bytes + 1);
+
+  if (data->compression == 0) {
+    r_filtered[0] = PNG_FILTER_VALUE_NONE;
+    memcpy(r_filtered + 1, row, data->row_bytes);
+    return;
   }
 
-  /* copy image data */
-  num_bytes = ((size_t)ibuf->x) * ibuf->y * bytesperpixel;
-  if (is_16bit) {
-    pixels16 = MEM_mallocN(num_bytes * sizeof(unsigned short), "png 16bit pixels");
+  if (filter_tls->candidate == NULL) {
+    filter_tls->candidate = MEM_mallocN(data->row_bytes, __func__);
   }
-  else {
-    pixels = MEM_mallocN(num_bytes * sizeof(unsigned char), "png 8bit pixels");
+  unsigned char *candidate = filter_tls->candidate;
+  size_t best_cost = SIZE_MAX;
+
+  for (int filter = PNG_FILTER_VALUE_NONE; filter <= PNG_FILTER_VALUE_PAETH; filter++) {
+    png_filter_row(filter, row, prev, data->row_bytes, data->filter_bpp, candidate);
+    const size_t cost = png_filter_cost(candidate, data->row_bytes);
+    if (cost < best_cost) {
+      best_cost = cost;
+      r_filtered[0] = (unsigned char)filter;
+      memcpy(r_filtered + 1, candidate, data->row_bytes);
+    }
   }
-  if (pixels == NULL && pixels16 == NULL) {
-    printf(
-        "imb_savepng: Cannot allocate pixels array of %dx%d, %d bytes per pixel for file: "
-        "'%s'\n",
-        ibuf->x,
-        ibuf->y,
-        bytesperpixel,
-        filepath);
+}
+
+static void png_encode_filter_row_free(const void *__restrict UNUSED(userdata),
+                                       void *__restrict tls_v)
+{
+  PNGEncodeFilterTLS *filter_tls = tls_v;
+  MEM_SAFE_FREE(filter_tls->candidate);
+}
+
+static void png_encode_deflate_strip_cb(void *__restrict userdata,
+                                        const int index,
+                                        const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const PNGEncodeData *data = userdata;
+  PNGEncodeStrip *strip = &data->strips[index];
+  const bool is_last = (index == data->totstrip - 1);
+  const size_t strip_bytes = (size_t)data->rows_per_strip * (data->row_bytes + 1);
+  const size_t offset = (size_t)index * strip_bytes;
+  const size_t size = min_zz(strip_bytes, data->filtered_size - offset);
+  z_stream stream = {NULL};
+
+  strip->ok = false;
+  strip->adler = adler32(adler32(0L, Z_NULL, 0), data->filtered + offset, size);
+
+  if (deflateInit2(&stream, data->compression, Z_DEFLATED, -MAX_WBITS, 8, Z_FILTERED) != Z_OK) {
+    return;
   }
 
-  /* allocate memory for an array of row-pointers */
-  row_pointers = (png_bytepp)MEM_mallocN(ibuf->y * sizeof(png_bytep), "row_pointers");
-  if (row_pointers == NULL) {
-    printf("imb_savepng: Cannot allocate row-pointers array for file '%s'\n", filepath);
+  if (index > 0) {
+    const size_t dictionary_size = min_zz(offset, PNG_ENCODE_WINDOW_SIZE);
+    deflateSetDictionary(&stream, data->filtered + offset - dictionary_size, dictionary_size);
   }
 
-  if ((pixels == NULL && pixels16 == NULL) || (row_pointers == NULL) ||
-      setjmp(png_jmpbuf(png_ptr))) {
-    /* On error jump here, and free any resources. */
-    png_destroy_write_struct(&png_ptr, &info_ptr);
-    if (pixels) {
-      MEM_freeN(pixels);
+  /* Room for the sync flush marker, zlib header and checksum. */
+  strip->buffer_size = deflateBound(&stream, size) + 16;
+  strip->buffer = MEM_mallocN(strip->buffer_size, __func__);
+
+  stream.next_in = data->filtered + offset;
+  stream.avail_in = size;
+  stream.next_out = strip->buffer + 2;
+  stream.avail_out = strip->buffer_size - 6;
+
+  while (true) {
+    const int ret = deflate(&stream, is_last ? Z_FINISH : Z_SYNC_FLUSH);
+    if (ret == Z_STREAM_ERROR) {
+      break;
     }
-    if (pixels16) {
-      MEM_freeN(pixels16);
+    if (is_last ? (ret == Z_STREAM_END) : (stream.avail_in == 0 && stream.avail_out != 0)) {
+      strip->size = stream.total_out;
+      strip->ok = true;
+      break;
     }
-    if (row_pointers) {
-      MEM_freeN(row_pointers);
+    if (stream.avail_out == 0) {
+      strip->buffer_size *= 2;
+      strip->buffer = MEM_reallocN(strip->buffer, strip->buffer_size);
+      stream.next_out = strip->buffer + 2 + stream.total_out;
+      stream.avail_out = strip->buffer_size - 6 - stream.total_out;
     }
-    if (fp) {
-      fflush(fp);
-      fclose(fp);
+  }
+
+  deflateEnd(&stream);
+}
+
+static bool png_encode_use_parallel(const ImBuf *ibuf, int bytesperpixel, bool is_16bit)
+{
+  const size_t row_bytes = (size_t)ibuf->x * bytesperpixel * (is_16bit ? 2 : 1) + 1;
+  return row_bytes * ibuf->y > 2 * PNG_ENCODE_STRIP_SIZE;
+}
+
+/* Write filtered and compressed image data of rows in PNG byte order, returns false when
+ * compression failed. */
+static bool png_encode_image_parallel(png_structp png_ptr,
+                                      png_bytepp row_pointers,
+                                      int width,
+                                      int height,
+                                      int bytesperpixel,
+                                      bool is_16bit,
+                                      int compression)
+{
+  PNGEncodeData data = {NULL};
+  const int filter_bpp = bytesperpixel * (is_16bit ? 2 : 1);
+
+  data.row_pointers = row_pointers;
+  data.row_bytes = (size_t)width * filter_bpp;
+  data.filter_bpp = filter_bpp;
+  data.compression = compression;
+  data.filtered_size = (data.row_bytes + 1) * height;
+  data.filtered = MEM_mallocN(data.filtered_size, "png filtered rows");
+  data.zero_row = MEM_callocN(data.row_bytes, "png zero row");
+  data.rows_per_strip = max_ii(1, PNG_ENCODE_STRIP_SIZE / (data.row_bytes + 1));
+  data.totstrip = divide_ceil_u(height, data.rows_per_strip);
+  data.strips = MEM_callocN(sizeof(PNGEncodeStrip) * data.totstrip, "png strips");
+
+  PNGEncodeFilterTLS filter_tls = {NULL};
+  TaskParallelSettings filter_settings;
+  BLI_parallel_range_settings_defaults(&filter_settings);
+  filter_settings.userdata_chunk = &filter_tls;
+  filter_settings.userdata_chunk_size = sizeof(filter_tls);
+  filter_settings.func_free = png_encode_filter_row_free;
+  BLI_task_parallel_range(0, height, &data, png_encode_filter_row_cb, &filter_settings);
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  BLI_task_parallel_range(0, data.totstrip, &data, png_encode_deflate_strip_cb, &settings);
+
+  bool ok = true;
+  for (int i = 0; i < data.totstrip; i++) {
+    ok &= data.strips[i].ok;
+  }
+
+  if (ok) {
+    /* Zlib header for a 32KB window, with the level hint used by zlib itself. */
+    const int level_hint = (compression < 2) ? 0 :
+                           (compression < 6) ? 1 :
+                           (compression == 6) ? 2 : 3;
+    unsigned char header[2] = {0x78, (unsigned char)(level_hint << 6)};
+    header[1] += 31 - ((header[0] << 8) | header[1]) % 31;
+
+    uLong adler = data.strips[0].adler;
+    for (int i = 1; i < data.totstrip; i++) {
+      const size_t strip_bytes = (size_t)data.rows_per_strip * (data.row_bytes + 1);
+      const size_t size = min_zz(strip_bytes, data.filtered_size - i * strip_bytes);
+      adler = adler32_combine(adler, data.strips[i].adler, size);
     }
-    return 0;
+
+    for (int i = 0; i < data.totstrip; i++) {
+      PNGEncodeStrip *strip = &data.strips[i];
+      unsigned char *chunk = strip->buffer + 2;
+      size_t chunk_size = strip->size;
+
+      if (i == 0) {
+        chunk -= 2;
+        chunk_size += 2;
+        memcpy(chunk, header, 2);
+      }
+      if (i == data.totstrip - 1) {
+        unsigned char *tail = strip->buffer + 2 + strip->size;
+        tail[0] = (unsigned char)(adler >> 24);
+        tail[1] = (unsigned char)(adler >> 16);
+        tail[2] = (unsigned char)(adler >> 8);
+        tail[3] = (unsigned char)adler;
+        chunk_size += 4;
+      }
+
+      png_write_chunk(png_ptr, (png_const_bytep) "IDAT", chunk, chunk_size);
+    }
+
+    png_write_chunk(png_ptr, (png_const_bytep) "IEND", NULL, 0);
+  }
+
+  for (int i = 0; i < data.totstrip; i++) {
+    MEM_SAFE_FREE(data.strips[i].buffer);
   }
+  MEM_freeN(data.strips);
+  MEM_freeN((void *)data.zero_row);
+  MEM_freeN(data.filtered);
+
+  return ok;
+}
 
-  from = (unsigned char *)ibuf->rect;
-  to = pixels;
-  from_float = ibuf->rect_float;
-  to16 = pixels16;
+/** \} */
+
+typedef struct PNGConvertData {
+  ImBuf *ibuf;
+  unsigned char *pixels;
+  unsigned short *pixels16;
+  int bytesperpixel;
+  bool is_16bit;
+  bool has_float;
+  int channels_in_float;
+  float (*chanel_colormanage_cb)(float);
+  /* Store 16 bit values in PNG byte order, for encoding without libpng. */
+  bool use_big_endian;
+} PNGConvertData;
+
+static void png_convert_row_cb(void *__restrict userdata,
+                               const int y,
+                               const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const PNGConvertData *data = userdata;
+  const ImBuf *ibuf = data->ibuf;
+  const int bytesperpixel = data->bytesperpixel;
+  const bool is_16bit = data->is_16bit;
+  const bool has_float = data->has_float;
+  const int channels_in_float = data->channels_in_float;
+  float (*chanel_colormanage_cb)(float) = data->chanel_colormanage_cb;
+  const size_t offset = (size_t)y * ibuf->x;
+
+  const unsigned char *from = ibuf->rect ? (unsigned char *)(ibuf->rect + offset) : NULL;
+  const float *from_float = ibuf->rect_float ? ibuf->rect_float + offset * channels_in_float :
+                                               NULL;
+  unsigned char *to = data->pixels ? data->pixels + offset * bytesperpixel : NULL;
+  unsigned short *to16 = data->pixels16 ? data->pixels16 + offset * bytesperpixel : NULL;
+  float from_straight[4];
+  int i;
 
   switch (bytesperpixel) {
     case 4:
-      color_type = PNG_COLOR_TYPE_RGBA;
       if (is_16bit) {
         if (has_float) {
           if (channels_in_float == 4) {
-            for (i = ibuf->x * ibuf->y; i > 0; i--) {
+            for (i = ibuf->x; i > 0; i--) {
               premul_to_straight_v4_v4(from_straight, from_float);
               to16[0] = ftoshort(chanel_colormanage_cb(from_straight[0]));
               to16[1] = ftoshort(chanel_colormanage_cb(from_straight[1]));
@@ -248,7 +486,7 @@ bool imb_savepng(struct ImBuf *ibuf, const char *filepath, int flags)
             }
           }
           else if (channels_in_float == 3) {
-            for (i = ibuf->x * ibuf->y; i > 0; i--) {
+            for (i = ibuf->x; i > 0; i--) {
               to16[0] = ftoshort(chanel_colormanage_cb(from_float[0]));
               to16[1] = ftoshort(chanel_colormanage_cb(from_float[1]));
               to16[2] = ftoshort(chanel_colormanage_cb(from_float[2]));
@@ -258,7 +496,7 @@ bool imb_savepng(struct ImBuf *ibuf, const char *filepath, int flags)
             }
           }
           else {
-            for (i = ibuf->x * ibuf->y; i > 0; i--) {
+            for (i = ibuf->x; i > 0; i--) {
               to16[0] = ftoshort(chanel_colormanage_cb(from_float[0]));
               to16[2] = to16[1] = to16[0];
               to16[3] = 65535;
@@ -268,7 +506,7 @@ bool imb_savepng(struct ImBuf *ibuf, const char *filepath, int flags)
           }
         }
         else {
-          for (i = ibuf->x * ibuf->y; i > 0; i--) {
+          for (i = ibuf->x; i > 0; i--) {
             to16[0] = UPSAMPLE_8_TO_16(from[0]);
             to16[1] = UPSAMPLE_8_TO_16(from[1]);
             to16[2] = UPSAMPLE_8_TO_16(from[2]);
@@ -279,7 +517,7 @@ bool imb_savepng(struct ImBuf *ibuf, const char *filepath, int flags)
         }
       }
       else {
-        for (i = ibuf->x * ibuf->y; i > 0; i--) {
+        for (i = ibuf->x; i > 0; i--) {
           to[0] = from[0];
           to[1] = from[1];
           to[2] = from[2];
@@ -290,11 +528,10 @@ bool imb_savepng(struct ImBuf *ibuf, const char *filepath, int flags)
       }
       break;
     case 3:
-      color_type = PNG_COLOR_TYPE_RGB;
       if (is_16bit) {
         if (has_float) {
           if (channels_in_float == 4) {
-            for (i = ibuf->x * ibuf->y; i > 0; i--) {
+            for (i = ibuf->x; i > 0; i--) {
               premul_to_straight_v4_v4(from_straight, from_float);
               to16[0] = ftoshort(chanel_colormanage_cb(from_straight[0]));
               to16[1] = ftoshort(chanel_colormanage_cb(from_straight[1]));
@@ -304,7 +541,7 @@ bool imb_savepng(struct ImBuf *ibuf, const char *filepath, int flags)
             }
           }
           else if (channels_in_float == 3) {
-            for (i = ibuf->x * ibuf->y; i > 0; i--) {
+            for (i = ibuf->x; i > 0; i--) {
               to16[0] = ftoshort(chanel_colormanage_cb(from_float[0]));
               to16[1] = ftoshort(chanel_colormanage_cb(from_float[1]));
               to16[2] = ftoshort(chanel_colormanage_cb(from_float[2]));
@@ -313,7 +550,7 @@ bool imb_savepng(struct ImBuf *ibuf, const char *filepath, int flags)
             }
           }
           else {
-            for (i = ibuf->x * ibuf->y; i > 0; i--) {
+            for (i = ibuf->x; i > 0; i--) {
               to16[0] = ftoshort(chanel_colormanage_cb(from_float[0]));
               to16[2] = to16[1] = to16[0];
               to16 += 3;
@@ -322,7 +559,7 @@ bool imb_savepng(struct ImBuf *ibuf, const char *filepath, int flags)
           }
         }
         else {
-          for (i = ibuf->x * ibuf->y; i > 0; i--) {
+          for (i = ibuf->x; i > 0; i--) {
             to16[0] = UPSAMPLE_8_TO_16(from[0]);
             to16[1] = UPSAMPLE_8_TO_16(from[1]);
             to16[2] = UPSAMPLE_8_TO_16(from[2]);
@@ -332,7 +569,7 @@ bool imb_savepng(struct ImBuf *ibuf, const char *filepath, int flags)
         }
       }
       else {
-        for (i = ibuf->x * ibuf->y; i > 0; i--) {
+        for (i = ibuf->x; i > 0; i--) {
           to[0] = from[0];
           to[1] = from[1];
           to[2] = from[2];
@@ -342,12 +579,11 @@ bool imb_savepng(struct ImBuf *ibuf, const char *filepath, int flags)
       }
       break;
     case 1:
-      color_type = PNG_COLOR_TYPE_GRAY;
       if (is_16bit) {
         if (has_float) {
           float rgb[3];
           if (channels_in_float == 4) {
-            for (i = ibuf->x * ibuf->y; i > 0; i--) {
+            for (i = ibuf->x; i > 0; i--) {
               premul_to_straight_v4_v4(from_straight, from_float);
               rgb[0] = chanel_colormanage_cb(from_straight[0]);
               rgb[1] = chanel_colormanage_cb(from_straight[1]);
@@ -358,7 +594,7 @@ bool imb_savepng(struct ImBuf *ibuf, const char *filepath, int flags)
             }
           }
           else if (channels_in_float == 3) {
-            for (i = ibuf->x * ibuf->y; i > 0; i--) {
+            for (i = ibuf->x; i > 0; i--) {
               rgb[0] = chanel_colormanage_cb(from_float[0]);
               rgb[1] = chanel_colormanage_cb(from_float[1]);
               rgb[2] = chanel_colormanage_cb(from_float[2]);
@@ -368,7 +604,7 @@ bool imb_savepng(struct ImBuf *ibuf, const char *filepath, int flags)
             }
           }
           else {
-            for (i = ibuf->x * ibuf->y; i > 0; i--) {
+            for (i = ibuf->x; i > 0; i--) {
               to16[0] = ftoshort(chanel_colormanage_cb(from_float[0]));
               to16++;
               from_float++;
@@ -376,7 +612,7 @@ bool imb_savepng(struct ImBuf *ibuf, const char *filepath, int flags)
           }
         }
         else {
-          for (i = ibuf->x * ibuf->y; i > 0; i--) {
+          for (i = ibuf->x; i > 0; i--) {
             to16[0] = UPSAMPLE_8_TO_16(from[0]);
             to16++;
             from += 4;
@@ -384,7 +620,7 @@ bool imb_savepng(struct ImBuf *ibuf, const char *filepath, int flags)
         }
       }
       else {
-        for (i = ibuf->x * ibuf->y; i > 0; i--) {
+        for (i = ibuf->x; i > 0; i--) {
           to[0] = from[0];
           to++;
           from += 4;
@@ -393,6 +629,146 @@ bool imb_savepng(struct ImBuf *ibuf, const char *filepath, int flags)
       break;
   }
 
+#ifdef __LITTLE_ENDIAN__
+  if (is_16bit && data->use_big_endian) {
+    BLI_endian_switch_uint16_array(data->pixels16 + offset * bytesperpixel,
+                                   ibuf->x * bytesperpixel);
+  }
+#endif
+}
+
+bool imb_savepng(struct ImBuf *ibuf, const char *filepath, int flags)
+{
+  png_structp png_ptr;
+  png_infop info_ptr;
+
+  unsigned char *pixels = NULL;
+  unsigned short *pixels16 = NULL;
+  png_bytepp row_pointers = NULL;
+  int i, bytesperpixel, color_type = PNG_COLOR_TYPE_GRAY;
+  FILE *fp = NULL;
+
+  bool is_16bit = (ibuf->foptions.flag & PNG_16BIT) != 0;
+  bool has_float = (ibuf->rect_float != NULL);
+  int channels_in_float = ibuf->channels ? ibuf->channels : 4;
+
+  float (*chanel_colormanage_cb)(float);
+  size_t num_bytes;
+
+  /* use the jpeg quality setting for compression */
+  int compression;
+  compression = (int)(((float)(ibuf->foptions.quality) / 11.1111f));
+  compression = compression < 0 ? 0 : (compression > 9 ? 9 : compression);
+
+  if (ibuf->float_colorspace || (ibuf->colormanage_flag & IMB_COLORMANAGE_IS_DATA)) {
+    /* float buffer was managed already, no need in color space conversion */
+    chanel_colormanage_cb = channel_colormanage_noop;
+  }
+  else {
+    /* standard linear-to-srgb conversion if float buffer wasn't managed */
+    chanel_colormanage_cb = linearrgb_to_srgb;
+  }
+
+  /* for prints */
+  if (flags & IB_mem) {
+    filepath = "<memory>";
+  }
+
+  bytesperpixel = (ibuf->planes + 7) >> 3;
+  if ((bytesperpixel > 4) || (bytesperpixel == 2)) {
+    printf(
+        "imb_savepng: Unsupported bytes per pixel: %d for file: '%s'\n", bytesperpixel, filepath);
+    return 0;
+  }
+
+  png_ptr = png_create_write_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
+  if (png_ptr == NULL) {
+    printf("imb_savepng: Cannot png_create_write_struct for file: '%s'\n", filepath);
+    return 0;
+  }
+
+  info_ptr = png_create_info_struct(png_ptr);
+  if (info_ptr == NULL) {
+    png_destroy_write_struct(&png_ptr, (png_infopp)NULL);
+    printf("imb_savepng: Cannot png_create_info_struct for file: '%s'\n", filepath);
+    return 0;
+  }
+
+  const bool use_parallel_encode = png_encode_use_parallel(ibuf, bytesperpixel, is_16bit);
+
+  /* copy image data */
+  num_bytes = ((size_t)ibuf->x) * ibuf->y * bytesperpixel;
+  if (is_16bit) {
+    pixels16 = MEM_mallocN(num_bytes * sizeof(unsigned short), "png 16bit pixels");
+  }
+  else {
+    pixels = MEM_mallocN(num_bytes * sizeof(unsigned char), "png 8bit pixels");
+  }
+  if (pixels == NULL && pixels16 == NULL) {
+    printf(
+        "imb_savepng: Cannot allocate pixels array of %dx%d, %d bytes per pixel for file: "
+        "'%s'\n",
+        ibuf->x,
+        ibuf->y,
+        bytesperpixel,
+        filepath);
+  }
+
+  /* allocate memory for an array of row-pointers */
+  row_pointers = (png_bytepp)MEM_mallocN(ibuf->y * sizeof(png_bytep), "row_pointers");
+  if (row_pointers == NULL) {
+    printf("imb_savepng: Cannot allocate row-pointers array for file '%s'\n", filepath);
+  }
+
+  if ((pixels == NULL && pixels16 == NULL) || (row_pointers == NULL) ||
+      setjmp(png_jmpbuf(png_ptr))) {
+    /* On error jump here, and free any resources. */
+    png_destroy_write_struct(&png_ptr, &info_ptr);
+    if (pixels) {
+      MEM_freeN(pixels);
+    }
+    if (pixels16) {
+      MEM_freeN(pixels16);
+    }
+    if (row_pointers) {
+      MEM_freeN(row_pointers);
+    }
+    if (fp) {
+      fflush(fp);
+      fclose(fp);
+    }
+    return 0;
+  }
+
+  switch (bytesperpixel) {
+    case 4:
+      color_type = PNG_COLOR_TYPE_RGBA;
+      break;
+    case 3:
+      color_type = PNG_COLOR_TYPE_RGB;
+      break;
+    case 1:
+      color_type = PNG_COLOR_TYPE_GRAY;
+      break;
+  }
+
+  PNGConvertData convert_data = {
+      .ibuf = ibuf,
+      .pixels = pixels,
+      .pixels16 = pixels16,
+      .bytesperpixel = bytesperpixel,
+      .is_16bit = is_16bit,
+      .has_float = has_float,
+      .channels_in_float = channels_in_float,
+      .chanel_colormanage_cb = chanel_colormanage_cb,
+      .use_big_endian = use_parallel_encode,
+  };
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (num_bytes > PNG_ENCODE_STRIP_SIZE);
+  BLI_task_parallel_range(0, ibuf->y, &convert_data, png_convert_row_cb, &settings);
+
   if (flags & IB_mem) {
     /* create image in memory */
     imb_addencodedbufferImBuf(ibuf);
@@ -478,7 +854,9 @@ bool imb_savepng(struct ImBuf *ibuf, const char *filepath, int flags)
   png_write_info(png_ptr, info_ptr);
 
 #ifdef __LITTLE_ENDIAN__
-  png_set_swap(png_ptr);
+  if (!use_parallel_encode) {
+    png_set_swap(png_ptr);
+  }
 #endif
 
   /* set the individual row-pointers to point at the correct offsets */
@@ -496,11 +874,24 @@ bool imb_savepng(struct ImBuf *ibuf, const char *filepath, int flags)
     }
   }
 
-  /* write out the entire image data in one call */
-  png_write_image(png_ptr, row_pointers);
+  if (use_parallel_encode) {
+    if (!png_encode_image_parallel(png_ptr,
+                                   row_pointers,
+                                   ibuf->x,
+                                   ibuf->y,
+                                   bytesperpixel,
+                                   is_16bit,
+                                   compression)) {
+      png_error(png_ptr, "Cannot compress image data");
+    }
+  }
+  else {
+    /* write out the entire image data in one call */
+    png_write_image(png_ptr, row_pointers);
 
-  /* write the additional chunks to the PNG file (not really needed) */
-  png_write_end(png_ptr, info_ptr);
+    /* write the additional chunks to the PNG file (not really needed) */
+    png_write_end(png_ptr, info_ptr);
+  }
 
   /* clean up */
   if (pixels) {
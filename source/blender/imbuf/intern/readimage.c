@@ -39,6 +39,8 @@
 #include "IMB_filetype.h"
 #include "IMB_imbuf.h"
 #include "IMB_imbuf_types.h"
+#include "IMB_metadata.h"
+#include "IMB_thumbs.h"
 #include "imbuf.h"
 
 #include "IMB_colormanagement.h"
@@ -96,11 +98,13 @@ static void imb_handle_alpha(ImBuf *ibuf,
   colormanage_imbuf_make_linear(ibuf, effective_colorspace);
 }
 
-ImBuf *IMB_ibImageFromMemory(const unsigned char *mem,
-                             size_t size,
-                             int flags,
-                             char colorspace[IM_MAX_SPACE],
-                             const char *descr)
+/* The file path is optional, it's only used for #IB_multilayer_on_demand. */
+static ImBuf *imb_ibImageFromMemory_ex(const unsigned char *mem,
+                                       size_t size,
+                                       const char *filepath,
+                                       int flags,
+                                       char colorspace[IM_MAX_SPACE],
+                                       const char *descr)
 {
   ImBuf *ibuf;
   const ImFileType *type;
@@ -116,7 +120,14 @@ ImBuf *IMB_ibImageFromMemory(const unsigned char *mem,
   }
 
   for (type = IMB_FILE_TYPES; type < IMB_FILE_TYPES_LAST; type++) {
-    if (type->load) {
+    if (filepath && (flags & IB_multilayer_on_demand) && type->load_multilayer) {
+      ibuf = type->load_multilayer(mem, size, filepath, flags, effective_colorspace);
+      if (ibuf) {
+        imb_handle_alpha(ibuf, flags, colorspace, effective_colorspace);
+        return ibuf;
+      }
+    }
+    else if (type->load) {
       ibuf = type->load(mem, size, flags, effective_colorspace);
       if (ibuf) {
         imb_handle_alpha(ibuf, flags, colorspace, effective_colorspace);
@@ -132,6 +143,15 @@ ImBuf *IMB_ibImageFromMemory(const unsigned char *mem,
   return NULL;
 }
 
+ImBuf *IMB_ibImageFromMemory(const unsigned char *mem,
+                             size_t size,
+                             int flags,
+                             char colorspace[IM_MAX_SPACE],
+                             const char *descr)
+{
+  return imb_ibImageFromMemory_ex(mem, size, NULL, flags, colorspace, descr);
+}
+
 static ImBuf *IMB_ibImageFromFile(const char *filepath,
                                   int flags,
                                   char colorspace[IM_MAX_SPACE],
@@ -195,7 +215,7 @@ ImBuf *IMB_loadifffile(
 
   mem = BLI_mmap_get_pointer(mmap_file);
 
-  ibuf = IMB_ibImageFromMemory(mem, size, flags, colorspace, descr);
+  ibuf = imb_ibImageFromMemory_ex(mem, size, filepath, flags, colorspace, descr);
 
   imb_mmap_lock();
   BLI_mmap_free(mmap_file);
@@ -251,6 +271,66 @@ ImBuf *IMB_loadiffname(const char *filepath, int flags, char colorspace[IM_MAX_S
   return ibuf;
 }
 
+/**
+ * Load an image for creating a thumbnail, using reduced resolution decoding when the file type
+ * supports it. The size of the full image is stored in the "Thumb::Image::Width" and
+ * "Thumb::Image::Height" metadata fields.
+ */
+ImBuf *IMB_thumb_load_image(const char *filepath,
+                            const size_t max_thumb_size,
+                            char colorspace[IM_MAX_SPACE])
+{
+  const ImFileType *type = IMB_file_type_from_ftype(IMB_ispic_type(filepath));
+  if (type == NULL) {
+    return NULL;
+  }
+
+  ImBuf *ibuf = NULL;
+  const int flags = IB_rect | IB_metadata;
+  /* Size of the full image. */
+  size_t width = 0;
+  size_t height = 0;
+
+  if (type->load_filepath_thumbnail) {
+    char effective_colorspace[IM_MAX_SPACE] = "";
+    if (colorspace) {
+      BLI_strncpy(effective_colorspace, colorspace, sizeof(effective_colorspace));
+    }
+
+    ibuf = type->load_filepath_thumbnail(
+        filepath, flags, max_thumb_size, effective_colorspace, &width, &height);
+    if (ibuf) {
+      imb_handle_alpha(ibuf, flags, colorspace, effective_colorspace);
+    }
+  }
+
+  if (ibuf == NULL) {
+    /* Skip big files that have to be decoded in full resolution. */
+    const size_t file_size = BLI_file_size(filepath);
+    if (file_size != -1 && file_size > THUMB_SIZE_MAX) {
+      return NULL;
+    }
+
+    ibuf = IMB_loadiffname(filepath, flags, colorspace);
+    if (ibuf) {
+      width = ibuf->x;
+      height = ibuf->y;
+    }
+  }
+
+  if (ibuf && width > 0 && height > 0) {
+    char cwidth[40];
+    char cheight[40];
+    BLI_snprintf(cwidth, sizeof(cwidth), "%zu", width);
+    BLI_snprintf(cheight, sizeof(cheight), "%zu", height);
+    IMB_metadata_ensure(&ibuf->metadata);
+    IMB_metadata_set_field(ibuf->metadata, "Thumb::Image::Width", cwidth);
+    IMB_metadata_set_field(ibuf->metadata, "Thumb::Image::Height", cheight);
+  }
+
+  return ibuf;
+}
+
 ImBuf *IMB_testiffname(const char *filepath, int flags)
 {
   ImBuf *ibuf;
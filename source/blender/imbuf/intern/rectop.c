@@ -23,12 +23,14 @@
  */
 
 #include <stdlib.h>
+#include <string.h>
 
 #include "BLI_math_base.h"
 #include "BLI_math_color.h"
 #include "BLI_math_color_blend.h"
 #include "BLI_math_vector.h"
 #include "BLI_rect.h"
+#include "BLI_simd.h"
 #include "BLI_utildefines.h"
 
 #include "IMB_imbuf.h"
@@ -213,6 +215,342 @@ void IMB_blend_color_float(float dst[4],
   }
 }
 
+/* -------------------------------------------------------------------- */
+/** \name Blend Spans
+ *
+ * Blend whole runs of pixels, with the same result as calling #IMB_blend_color_byte or
+ * #IMB_blend_color_float for every pixel. The mode is resolved once per span, and the most used
+ * modes are blended several channels at a time.
+ * \{ */
+
+typedef void (*IMB_blend_func)(unsigned char *dst,
+                               const unsigned char *src1,
+                               const unsigned char *src2);
+typedef void (*IMB_blend_func_float)(float *dst, const float *src1, const float *src2);
+
+/* Returns NULL for modes that copy `src1`, like #IMB_blend_color_byte does. */
+static IMB_blend_func blend_func_byte_get(IMB_BlendMode mode)
+{
+  switch (mode) {
+    case IMB_BLEND_MIX:
+      return blend_color_mix_byte;
+    case IMB_BLEND_ADD:
+      return blend_color_add_byte;
+    case IMB_BLEND_SUB:
+      return blend_color_sub_byte;
+    case IMB_BLEND_MUL:
+      return blend_color_mul_byte;
+    case IMB_BLEND_LIGHTEN:
+      return blend_color_lighten_byte;
+    case IMB_BLEND_DARKEN:
+      return blend_color_darken_byte;
+    case IMB_BLEND_ERASE_ALPHA:
+      return blend_color_erase_alpha_byte;
+    case IMB_BLEND_ADD_ALPHA:
+      return blend_color_add_alpha_byte;
+    case IMB_BLEND_OVERLAY:
+      return blend_color_overlay_byte;
+    case IMB_BLEND_HARDLIGHT:
+      return blend_color_hardlight_byte;
+    case IMB_BLEND_COLORBURN:
+      return blend_color_burn_byte;
+    case IMB_BLEND_LINEARBURN:
+      return blend_color_linearburn_byte;
+    case IMB_BLEND_COLORDODGE:
+      return blend_color_dodge_byte;
+    case IMB_BLEND_SCREEN:
+      return blend_color_screen_byte;
+    case IMB_BLEND_SOFTLIGHT:
+      return blend_color_softlight_byte;
+    case IMB_BLEND_PINLIGHT:
+      return blend_color_pinlight_byte;
+    case IMB_BLEND_LINEARLIGHT:
+      return blend_color_linearlight_byte;
+    case IMB_BLEND_VIVIDLIGHT:
+      return blend_color_vividlight_byte;
+    case IMB_BLEND_DIFFERENCE:
+      return blend_color_difference_byte;
+    case IMB_BLEND_EXCLUSION:
+      return blend_color_exclusion_byte;
+    case IMB_BLEND_COLOR:
+      return blend_color_color_byte;
+    case IMB_BLEND_HUE:
+      return blend_color_hue_byte;
+    case IMB_BLEND_SATURATION:
+      return blend_color_saturation_byte;
+    case IMB_BLEND_LUMINOSITY:
+      return blend_color_luminosity_byte;
+    default:
+      return NULL;
+  }
+}
+
+/* Returns NULL for modes that copy `src1`, like #IMB_blend_color_float does. */
+static IMB_blend_func_float blend_func_float_get(IMB_BlendMode mode)
+{
+  switch (mode) {
+    case IMB_BLEND_MIX:
+      return blend_color_mix_float;
+    case IMB_BLEND_ADD:
+      return blend_color_add_float;
+    case IMB_BLEND_SUB:
+      return blend_color_sub_float;
+    case IMB_BLEND_MUL:
+      return blend_color_mul_float;
+    case IMB_BLEND_LIGHTEN:
+      return blend_color_lighten_float;
+    case IMB_BLEND_DARKEN:
+      return blend_color_darken_float;
+    case IMB_BLEND_ERASE_ALPHA:
+      return blend_color_erase_alpha_float;
+    case IMB_BLEND_ADD_ALPHA:
+      return blend_color_add_alpha_float;
+    case IMB_BLEND_OVERLAY:
+      return blend_color_overlay_float;
+    case IMB_BLEND_HARDLIGHT:
+      return blend_color_hardlight_float;
+    case IMB_BLEND_COLORBURN:
+      return blend_color_burn_float;
+    case IMB_BLEND_LINEARBURN:
+      return blend_color_linearburn_float;
+    case IMB_BLEND_COLORDODGE:
+      return blend_color_dodge_float;
+    case IMB_BLEND_SCREEN:
+      return blend_color_screen_float;
+    case IMB_BLEND_SOFTLIGHT:
+      return blend_color_softlight_float;
+    case IMB_BLEND_PINLIGHT:
+      return blend_color_pinlight_float;
+    case IMB_BLEND_LINEARLIGHT:
+      return blend_color_linearlight_float;
+    case IMB_BLEND_VIVIDLIGHT:
+      return blend_color_vividlight_float;
+    case IMB_BLEND_DIFFERENCE:
+      return blend_color_difference_float;
+    case IMB_BLEND_EXCLUSION:
+      return blend_color_exclusion_float;
+    case IMB_BLEND_COLOR:
+      return blend_color_color_float;
+    case IMB_BLEND_HUE:
+      return blend_color_hue_float;
+    case IMB_BLEND_SATURATION:
+      return blend_color_saturation_float;
+    case IMB_BLEND_LUMINOSITY:
+      return blend_color_luminosity_float;
+    default:
+      return NULL;
+  }
+}
+
+#ifdef BLI_HAVE_SSE2
+
+/* Same as #divide_round_i by 255 for every 16 bit lane, for values up to 255 * 255. */
+BLI_INLINE __m128i blend_div255_round_epu16(__m128i x)
+{
+  x = _mm_add_epi16(x, _mm_set1_epi16(127));
+  x = _mm_add_epi16(x, _mm_add_epi16(_mm_srli_epi16(x, 8), _mm_set1_epi16(1)));
+  return _mm_srli_epi16(x, 8);
+}
+
+/* Broadcast the alpha of both pixels stored in 16 bit lanes to all their channels. */
+BLI_INLINE __m128i blend_alpha_epu16(__m128i x)
+{
+  x = _mm_shufflelo_epi16(x, _MM_SHUFFLE(3, 3, 3, 3));
+  return _mm_shufflehi_epi16(x, _MM_SHUFFLE(3, 3, 3, 3));
+}
+
+/* Blend two straight alpha pixels stored in 16 bit lanes. For add and subtract only the
+ * weighted `s2` is returned, it is saturated against `s1` after packing. */
+BLI_INLINE __m128i blend_byte_pair_sse2(__m128i s1, __m128i s2, IMB_BlendMode mode)
+{
+  const __m128i t = blend_alpha_epu16(s2);
+  const __m128i mt = _mm_sub_epi16(_mm_set1_epi16(255), t);
+
+  switch (mode) {
+    case IMB_BLEND_ADD:
+    case IMB_BLEND_SUB:
+      return blend_div255_round_epu16(_mm_mullo_epi16(s2, t));
+    case IMB_BLEND_LIGHTEN:
+      s2 = _mm_max_epi16(s1, s2);
+      break;
+    case IMB_BLEND_DARKEN:
+      s2 = _mm_min_epi16(s1, s2);
+      break;
+    default:
+      break;
+  }
+
+  return blend_div255_round_epu16(_mm_add_epi16(_mm_mullo_epi16(mt, s1), _mm_mullo_epi16(t, s2)));
+}
+
+/* Blend groups of four pixels, returns the number of pixels done. */
+static int blend_span_byte_sse2(unsigned char *dst,
+                                const unsigned char *src1,
+                                const unsigned char *src2,
+                                int totpixel,
+                                IMB_BlendMode mode)
+{
+  if (!ELEM(mode,
+            IMB_BLEND_MIX,
+            IMB_BLEND_ADD,
+            IMB_BLEND_SUB,
+            IMB_BLEND_LIGHTEN,
+            IMB_BLEND_DARKEN)) {
+    return 0;
+  }
+
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i alpha_mask = _mm_set1_epi32((int)0xff000000);
+  int i = 0;
+
+  for (; i + 4 <= totpixel; i += 4) {
+    const __m128i s1 = _mm_loadu_si128((const __m128i *)(src1 + i * 4));
+    const __m128i s2 = _mm_loadu_si128((const __m128i *)(src2 + i * 4));
+
+    if (mode == IMB_BLEND_MIX) {
+      /* Over an opaque background the straight alpha mix is a plain weighted sum. */
+      const __m128i opaque = _mm_cmpeq_epi8(_mm_and_si128(s1, alpha_mask), alpha_mask);
+      if (_mm_movemask_epi8(opaque) != 0xffff) {
+        for (int j = i; j < i + 4; j++) {
+          blend_color_mix_byte(dst + j * 4, src1 + j * 4, src2 + j * 4);
+        }
+        continue;
+      }
+    }
+
+    const __m128i lo = blend_byte_pair_sse2(
+        _mm_unpacklo_epi8(s1, zero), _mm_unpacklo_epi8(s2, zero), mode);
+    const __m128i hi = blend_byte_pair_sse2(
+        _mm_unpackhi_epi8(s1, zero), _mm_unpackhi_epi8(s2, zero), mode);
+    __m128i result = _mm_packus_epi16(lo, hi);
+
+    if (mode == IMB_BLEND_ADD) {
+      result = _mm_adds_epu8(s1, result);
+    }
+    else if (mode == IMB_BLEND_SUB) {
+      result = _mm_subs_epu8(s1, result);
+    }
+
+    /* Alpha is kept from `src1`, for mix it is opaque in both. */
+    result = _mm_or_si128(_mm_andnot_si128(alpha_mask, result), _mm_and_si128(alpha_mask, s1));
+    _mm_storeu_si128((__m128i *)(dst + i * 4), result);
+  }
+
+  return i;
+}
+
+/* Blend one premultiplied pixel at a time, returns the number of pixels done. */
+static int blend_span_float_sse2(
+    float *dst, const float *src1, const float *src2, int totpixel, IMB_BlendMode mode)
+{
+  if (!ELEM(mode,
+            IMB_BLEND_MIX,
+            IMB_BLEND_ADD,
+            IMB_BLEND_SUB,
+            IMB_BLEND_MUL,
+            IMB_BLEND_LIGHTEN,
+            IMB_BLEND_DARKEN)) {
+    return 0;
+  }
+
+  const __m128 one = _mm_set1_ps(1.0f);
+  const __m128 rgb_mask = _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1));
+
+  for (int i = 0; i < totpixel; i++, dst += 4, src1 += 4, src2 += 4) {
+    const __m128 s1 = _mm_loadu_ps(src1);
+
+    if (src2[3] == 0.0f) {
+      _mm_storeu_ps(dst, s1);
+      continue;
+    }
+
+    const __m128 s2 = _mm_loadu_ps(src2);
+    const __m128 a1 = _mm_shuffle_ps(s1, s1, _MM_SHUFFLE(3, 3, 3, 3));
+    const __m128 t = _mm_shuffle_ps(s2, s2, _MM_SHUFFLE(3, 3, 3, 3));
+    const __m128 mt = _mm_sub_ps(one, t);
+    __m128 result;
+
+    switch (mode) {
+      case IMB_BLEND_MIX:
+        /* Alpha follows the same formula. */
+        _mm_storeu_ps(dst, _mm_add_ps(_mm_mul_ps(mt, s1), s2));
+        continue;
+      case IMB_BLEND_ADD:
+        result = _mm_add_ps(s1, _mm_mul_ps(s2, a1));
+        break;
+      case IMB_BLEND_SUB:
+        result = _mm_max_ps(_mm_sub_ps(s1, _mm_mul_ps(s2, a1)), _mm_setzero_ps());
+        break;
+      case IMB_BLEND_MUL:
+        result = _mm_add_ps(_mm_mul_ps(mt, s1), _mm_mul_ps(_mm_mul_ps(s1, s2), a1));
+        break;
+      case IMB_BLEND_LIGHTEN:
+        result = _mm_max_ps(s1, _mm_mul_ps(s2, _mm_div_ps(a1, t)));
+        result = _mm_add_ps(_mm_mul_ps(mt, s1), _mm_mul_ps(t, result));
+        break;
+      default: /* #IMB_BLEND_DARKEN */
+        result = _mm_min_ps(s1, _mm_mul_ps(s2, _mm_div_ps(a1, t)));
+        result = _mm_add_ps(_mm_mul_ps(mt, s1), _mm_mul_ps(t, result));
+        break;
+    }
+
+    _mm_storeu_ps(dst, _mm_or_ps(_mm_and_ps(rgb_mask, result), _mm_andnot_ps(rgb_mask, s1)));
+  }
+
+  return totpixel;
+}
+
+#endif /* BLI_HAVE_SSE2 */
+
+void IMB_blend_color_byte_n(unsigned char *dst,
+                            const unsigned char *src1,
+                            const unsigned char *src2,
+                            int totpixel,
+                            IMB_BlendMode mode)
+{
+  IMB_blend_func func = blend_func_byte_get(mode);
+  int i = 0;
+
+  if (func == NULL) {
+    if (dst != src1) {
+      memcpy(dst, src1, sizeof(unsigned char[4]) * totpixel);
+    }
+    return;
+  }
+
+#ifdef BLI_HAVE_SSE2
+  i = blend_span_byte_sse2(dst, src1, src2, totpixel, mode);
+#endif
+
+  for (; i < totpixel; i++) {
+    func(dst + i * 4, src1 + i * 4, src2 + i * 4);
+  }
+}
+
+void IMB_blend_color_float_n(
+    float *dst, const float *src1, const float *src2, int totpixel, IMB_BlendMode mode)
+{
+  IMB_blend_func_float func = blend_func_float_get(mode);
+  int i = 0;
+
+  if (func == NULL) {
+    if (dst != src1) {
+      memcpy(dst, src1, sizeof(float[4]) * totpixel);
+    }
+    return;
+  }
+
+#ifdef BLI_HAVE_SSE2
+  i = blend_span_float_sse2(dst, src1, src2, totpixel, mode);
+#endif
+
+  for (; i < totpixel; i++) {
+    func(dst + i * 4, src1 + i * 4, src2 + i * 4);
+  }
+}
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name Crop
  * \{ */
@@ -510,10 +848,84 @@ void IMB_rectcpy(ImBuf *dbuf,
                 false);
 }
 
-typedef void (*IMB_blend_func)(unsigned char *dst,
-                               const unsigned char *src1,
-                               const unsigned char *src2);
-typedef void (*IMB_blend_func_float)(float *dst, const float *src1, const float *src2);
+/**
+ * Mask of a painted pixel, false when the pixel is not to be blended. With a destination mask
+ * the mask is accumulated into it, and only pixels that increase it are blended.
+ */
+BLI_INLINE bool rectblend_paint_mask(unsigned short *dmr,
+                                     const unsigned short cmr,
+                                     const unsigned short *tmr,
+                                     const float mask_max,
+                                     const bool accumulate,
+                                     float *r_mask)
+{
+  float mask = mask_max * cmr;
+
+  if (tmr) {
+    mask *= (*tmr / 65535.0f);
+  }
+
+  if (dmr == NULL) {
+    *r_mask = min_ff(mask, 65535.0);
+    return *r_mask > 0.0f;
+  }
+
+  if (mask == 0.0f) {
+    return false;
+  }
+
+  if (accumulate) {
+    mask = *dmr + mask;
+  }
+  else {
+    mask = *dmr + mask - (*dmr * (cmr / 65535.0f));
+  }
+
+  mask = min_ff(mask, 65535.0);
+
+  if (!(mask > *dmr)) {
+    return false;
+  }
+
+  *dmr = mask;
+  *r_mask = mask;
+  return true;
+}
+
+/* Blend the pending run of masked source pixels ending before `x`. */
+static void rectblend_run_flush_byte(unsigned int *drect,
+                                     const unsigned int *orect,
+                                     const unsigned char *mask_row,
+                                     const int x,
+                                     const IMB_BlendMode mode,
+                                     int *run_start)
+{
+  if (*run_start != -1) {
+    IMB_blend_color_byte_n((unsigned char *)(drect + *run_start),
+                           (const unsigned char *)(orect + *run_start),
+                           mask_row + *run_start * 4,
+                           x - *run_start,
+                           mode);
+    *run_start = -1;
+  }
+}
+
+static void rectblend_run_flush_float(float *drectf,
+                                      const float *orectf,
+                                      const float *mask_rowf,
+                                      const int x,
+                                      const IMB_BlendMode mode,
+                                      int *run_start)
+{
+  if (*run_start != -1) {
+    IMB_blend_color_float_n(drectf + *run_start * 4,
+                            orectf + *run_start * 4,
+                            mask_rowf + *run_start * 4,
+                            x - *run_start,
+                            mode);
+    *run_start = -1;
+  }
+}
 
 void IMB_rectblend(ImBuf *dbuf,
                    const ImBuf *obuf,
@@ -533,14 +945,12 @@ void IMB_rectblend(ImBuf *dbuf,
                    IMB_BlendMode mode,
                    bool accumulate)
 {
-  unsigned int *drect = NULL, *orect = NULL, *srect = NULL, *dr, * or, *sr;
-  float *drectf = NULL, *orectf = NULL, *srectf = NULL, *drf, *orf, *srf;
-  const unsigned short *cmaskrect = curvemask, *cmr;
-  unsigned short *dmaskrect = dmask, *dmr;
-  const unsigned short *texmaskrect = texmask, *tmr;
+  unsigned int *drect = NULL, *orect = NULL, *srect = NULL, *dr, *sr;
+  float *drectf = NULL, *orectf = NULL, *srectf = NULL, *drf, *srf;
+  const unsigned short *cmaskrect = curvemask;
+  unsigned short *dmaskrect = dmask;
+  const unsigned short *texmaskrect = texmask;
   int do_float, do_char, srcskip, destskip, origskip, x;
-  IMB_blend_func func = NULL;
-  IMB_blend_func_float func_float = NULL;
 
   if (dbuf == NULL || obuf == NULL) {
     return;
@@ -671,209 +1081,86 @@ void IMB_rectblend(ImBuf *dbuf,
     }
   }
   else {
-    switch (mode) {
-      case IMB_BLEND_MIX:
-      case IMB_BLEND_INTERPOLATE:
-        func = blend_color_mix_byte;
-        func_float = blend_color_mix_float;
-        break;
-      case IMB_BLEND_ADD:
-        func = blend_color_add_byte;
-        func_float = blend_color_add_float;
-        break;
-      case IMB_BLEND_SUB:
-        func = blend_color_sub_byte;
-        func_float = blend_color_sub_float;
-        break;
-      case IMB_BLEND_MUL:
-        func = blend_color_mul_byte;
-        func_float = blend_color_mul_float;
-        break;
-      case IMB_BLEND_LIGHTEN:
-        func = blend_color_lighten_byte;
-        func_float = blend_color_lighten_float;
-        break;
-      case IMB_BLEND_DARKEN:
-        func = blend_color_darken_byte;
-        func_float = blend_color_darken_float;
-        break;
-      case IMB_BLEND_ERASE_ALPHA:
-        func = blend_color_erase_alpha_byte;
-        func_float = blend_color_erase_alpha_float;
-        break;
-      case IMB_BLEND_ADD_ALPHA:
-        func = blend_color_add_alpha_byte;
-        func_float = blend_color_add_alpha_float;
-        break;
-      case IMB_BLEND_OVERLAY:
-        func = blend_color_overlay_byte;
-        func_float = blend_color_overlay_float;
-        break;
-      case IMB_BLEND_HARDLIGHT:
-        func = blend_color_hardlight_byte;
-        func_float = blend_color_hardlight_float;
-        break;
-      case IMB_BLEND_COLORBURN:
-        func = blend_color_burn_byte;
-        func_float = blend_color_burn_float;
-        break;
-      case IMB_BLEND_LINEARBURN:
-        func = blend_color_linearburn_byte;
-        func_float = blend_color_linearburn_float;
-        break;
-      case IMB_BLEND_COLORDODGE:
-        func = blend_color_dodge_byte;
-        func_float = blend_color_dodge_float;
-        break;
-      case IMB_BLEND_SCREEN:
-        func = blend_color_screen_byte;
-        func_float = blend_color_screen_float;
-        break;
-      case IMB_BLEND_SOFTLIGHT:
-        func = blend_color_softlight_byte;
-        func_float = blend_color_softlight_float;
-        break;
-      case IMB_BLEND_PINLIGHT:
-        func = blend_color_pinlight_byte;
-        func_float = blend_color_pinlight_float;
-        break;
-      case IMB_BLEND_LINEARLIGHT:
-        func = blend_color_linearlight_byte;
-        func_float = blend_color_linearlight_float;
-        break;
-      case IMB_BLEND_VIVIDLIGHT:
-        func = blend_color_vividlight_byte;
-        func_float = blend_color_vividlight_float;
-        break;
-      case IMB_BLEND_DIFFERENCE:
-        func = blend_color_difference_byte;
-        func_float = blend_color_difference_float;
-        break;
-      case IMB_BLEND_EXCLUSION:
-        func = blend_color_exclusion_byte;
-        func_float = blend_color_exclusion_float;
-        break;
-      case IMB_BLEND_COLOR:
-        func = blend_color_color_byte;
-        func_float = blend_color_color_float;
-        break;
-      case IMB_BLEND_HUE:
-        func = blend_color_hue_byte;
-        func_float = blend_color_hue_float;
-        break;
-      case IMB_BLEND_SATURATION:
-        func = blend_color_saturation_byte;
-        func_float = blend_color_saturation_float;
-        break;
-      case IMB_BLEND_LUMINOSITY:
-        func = blend_color_luminosity_byte;
-        func_float = blend_color_luminosity_float;
-        break;
-      default:
-        break;
+    /* Interpolation only differs from mix in how the mask is applied. */
+    const IMB_BlendMode blend_mode = (mode == IMB_BLEND_INTERPOLATE) ? IMB_BLEND_MIX : mode;
+    /* Masked source pixels of a row, blended in runs like unmasked pixels. */
+    unsigned char *mask_row = NULL;
+    float *mask_rowf = NULL;
+
+    if (cmaskrect && mode != IMB_BLEND_INTERPOLATE) {
+      if (do_char) {
+        mask_row = MEM_mallocN(sizeof(unsigned char[4]) * width, __func__);
+      }
+      if (do_float) {
+        mask_rowf = MEM_mallocN(sizeof(float[4]) * width, __func__);
+      }
     }
 
     /* blend */
     for (; height > 0; height--) {
       if (do_char) {
-        dr = drect;
-        or = orect;
-        sr = srect;
-
         if (cmaskrect) {
           /* mask accumulation for painting */
-          cmr = cmaskrect;
-          tmr = texmaskrect;
-
-          /* destination mask present, do max alpha masking */
-          if (dmaskrect) {
-            dmr = dmaskrect;
-            for (x = width; x > 0; x--, dr++, or ++, sr++, dmr++, cmr++) {
-              unsigned char *src = (unsigned char *)sr;
-              float mask_lim = mask_max * (*cmr);
-
-              if (texmaskrect) {
-                mask_lim *= ((*tmr++) / 65535.0f);
-              }
-
-              if (src[3] && mask_lim) {
-                float mask;
-
-                if (accumulate) {
-                  mask = *dmr + mask_lim;
-                }
-                else {
-                  mask = *dmr + mask_lim - (*dmr * (*cmr / 65535.0f));
-                }
-
-                mask = min_ff(mask, 65535.0);
-
-                if (mask > *dmr) {
-                  unsigned char mask_src[4];
-
-                  *dmr = mask;
-
-                  mask_src[0] = src[0];
-                  mask_src[1] = src[1];
-                  mask_src[2] = src[2];
-
-                  if (mode == IMB_BLEND_INTERPOLATE) {
-                    mask_src[3] = src[3];
-                    blend_color_interpolate_byte(
-                        (unsigned char *)dr, (unsigned char *) or, mask_src, mask / 65535.0f);
-                  }
-                  else {
-                    mask_src[3] = divide_round_i(src[3] * mask, 65535);
-                    func((unsigned char *)dr, (unsigned char *) or, mask_src);
-                  }
-                }
-              }
+          int run_start = -1;
+
+          for (x = 0; x < width; x++) {
+            const unsigned char *src = (const unsigned char *)(srect + x);
+            float mask;
+
+            if (!(src[3] && rectblend_paint_mask(dmaskrect ? dmaskrect + x : NULL,
+                                                 cmaskrect[x],
+                                                 texmaskrect ? texmaskrect + x : NULL,
+                                                 mask_max,
+                                                 accumulate,
+                                                 &mask))) {
+              rectblend_run_flush_byte(drect, orect, mask_row, x, blend_mode, &run_start);
+              continue;
             }
-            dmaskrect += origskip;
-          }
-          /* no destination mask buffer, do regular blend with masktexture if present */
-          else {
-            for (x = width; x > 0; x--, dr++, or ++, sr++, cmr++) {
-              unsigned char *src = (unsigned char *)sr;
-              float mask = (float)mask_max * ((float)(*cmr));
-
-              if (texmaskrect) {
-                mask *= ((float)(*tmr++) / 65535.0f);
-              }
 
-              mask = min_ff(mask, 65535.0);
-
-              if (src[3] && (mask > 0.0f)) {
-                unsigned char mask_src[4];
-
-                mask_src[0] = src[0];
-                mask_src[1] = src[1];
-                mask_src[2] = src[2];
-
-                if (mode == IMB_BLEND_INTERPOLATE) {
-                  mask_src[3] = src[3];
-                  blend_color_interpolate_byte(
-                      (unsigned char *)dr, (unsigned char *) or, mask_src, mask / 65535.0f);
-                }
-                else {
-                  mask_src[3] = divide_round_i(src[3] * mask, 65535);
-                  func((unsigned char *)dr, (unsigned char *) or, mask_src);
-                }
+            if (mode == IMB_BLEND_INTERPOLATE) {
+              blend_color_interpolate_byte((unsigned char *)(drect + x),
+                                           (unsigned char *)(orect + x),
+                                           src,
+                                           mask / 65535.0f);
+            }
+            else {
+              unsigned char *mask_src = mask_row + x * 4;
+              mask_src[0] = src[0];
+              mask_src[1] = src[1];
+              mask_src[2] = src[2];
+              mask_src[3] = divide_round_i(src[3] * mask, 65535);
+              if (run_start == -1) {
+                run_start = x;
               }
             }
           }
+          rectblend_run_flush_byte(drect, orect, mask_row, width, blend_mode, &run_start);
 
+          if (dmaskrect) {
+            dmaskrect += origskip;
+          }
           cmaskrect += srcskip;
           if (texmaskrect) {
             texmaskrect += srcskip;
           }
         }
         else {
-          /* regular blending */
-          for (x = width; x > 0; x--, dr++, or ++, sr++) {
-            if (((unsigned char *)sr)[3]) {
-              func((unsigned char *)dr, (unsigned char *) or, (unsigned char *)sr);
+          /* regular blending, in runs of pixels that are not fully transparent */
+          for (x = 0; x < width;) {
+            if (((unsigned char *)(srect + x))[3] == 0) {
+              x++;
+              continue;
+            }
+            int run = 1;
+            while (x + run < width && ((unsigned char *)(srect + x + run))[3]) {
+              run++;
             }
+            IMB_blend_color_byte_n((unsigned char *)(drect + x),
+                                   (unsigned char *)(orect + x),
+                                   (unsigned char *)(srect + x),
+                                   run,
+                                   blend_mode);
+            x += run;
           }
         }
 
@@ -883,88 +1170,58 @@ void IMB_rectblend(ImBuf *dbuf,
       }
 
       if (do_float) {
-        drf = drectf;
-        orf = orectf;
-        srf = srectf;
-
         if (cmaskrect) {
           /* mask accumulation for painting */
-          cmr = cmaskrect;
-          tmr = texmaskrect;
-
-          /* destination mask present, do max alpha masking */
-          if (dmaskrect) {
-            dmr = dmaskrect;
-            for (x = width; x > 0; x--, drf += 4, orf += 4, srf += 4, dmr++, cmr++) {
-              float mask_lim = mask_max * (*cmr);
-
-              if (texmaskrect) {
-                mask_lim *= ((*tmr++) / 65535.0f);
-              }
-
-              if (srf[3] && mask_lim) {
-                float mask;
-
-                if (accumulate) {
-                  mask = min_ff(*dmr + mask_lim, 65535.0);
-                }
-                else {
-                  mask = *dmr + mask_lim - (*dmr * (*cmr / 65535.0f));
-                }
-
-                mask = min_ff(mask, 65535.0);
-
-                if (mask > *dmr) {
-                  *dmr = mask;
-
-                  if (mode == IMB_BLEND_INTERPOLATE) {
-                    blend_color_interpolate_float(drf, orf, srf, mask / 65535.0f);
-                  }
-                  else {
-                    float mask_srf[4];
-                    mul_v4_v4fl(mask_srf, srf, mask / 65535.0f);
-                    func_float(drf, orf, mask_srf);
-                  }
-                }
-              }
+          int run_start = -1;
+
+          for (x = 0; x < width; x++) {
+            const float *src = srectf + x * 4;
+            float mask;
+
+            if (!(src[3] && rectblend_paint_mask(dmaskrect ? dmaskrect + x : NULL,
+                                                 cmaskrect[x],
+                                                 texmaskrect ? texmaskrect + x : NULL,
+                                                 mask_max,
+                                                 accumulate,
+                                                 &mask))) {
+              rectblend_run_flush_float(drectf, orectf, mask_rowf, x, blend_mode, &run_start);
+              continue;
             }
-            dmaskrect += origskip;
-          }
-          /* no destination mask buffer, do regular blend with masktexture if present */
-          else {
-            for (x = width; x > 0; x--, drf += 4, orf += 4, srf += 4, cmr++) {
-              float mask = (float)mask_max * ((float)(*cmr));
 
-              if (texmaskrect) {
-                mask *= ((float)(*tmr++) / 65535.0f);
-              }
-
-              mask = min_ff(mask, 65535.0);
-
-              if (srf[3] && (mask > 0.0f)) {
-                if (mode == IMB_BLEND_INTERPOLATE) {
-                  blend_color_interpolate_float(drf, orf, srf, mask / 65535.0f);
-                }
-                else {
-                  float mask_srf[4];
-                  mul_v4_v4fl(mask_srf, srf, mask / 65535.0f);
-                  func_float(drf, orf, mask_srf);
-                }
+            if (mode == IMB_BLEND_INTERPOLATE) {
+              blend_color_interpolate_float(drectf + x * 4, orectf + x * 4, src, mask / 65535.0f);
+            }
+            else {
+              mul_v4_v4fl(mask_rowf + x * 4, src, mask / 65535.0f);
+              if (run_start == -1) {
+                run_start = x;
               }
             }
           }
+          rectblend_run_flush_float(drectf, orectf, mask_rowf, width, blend_mode, &run_start);
 
+          if (dmaskrect) {
+            dmaskrect += origskip;
+          }
           cmaskrect += srcskip;
           if (texmaskrect) {
             texmaskrect += srcskip;
           }
         }
         else {
-          /* regular blending */
-          for (x = width; x > 0; x--, drf += 4, orf += 4, srf += 4) {
-            if (srf[3] != 0) {
-              func_float(drf, orf, srf);
+          /* regular blending, in runs of pixels that are not fully transparent */
+          for (x = 0; x < width;) {
+            if (srectf[x * 4 + 3] == 0) {
+              x++;
+              continue;
             }
+            int run = 1;
+            while (x + run < width && srectf[(x + run) * 4 + 3] != 0) {
+              run++;
+            }
+            IMB_blend_color_float_n(
+                drectf + x * 4, orectf + x * 4, srectf + x * 4, run, blend_mode);
+            x += run;
           }
         }
 
@@ -973,6 +1230,9 @@ void IMB_rectblend(ImBuf *dbuf,
         srectf += srcskip * 4;
       }
     }
+
+    MEM_SAFE_FREE(mask_row);
+    MEM_SAFE_FREE(mask_rowf);
   }
 }
 
@@ -0,0 +1,229 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "imbuf_testing.hh"
+
+#include "IMB_imbuf.h"
+#include "IMB_imbuf_types.h"
+
+#include "BLI_math_base.h"
+#include "BLI_rand.h"
+#include "BLI_utildefines.h"
+
+#include <cstring>
+
+namespace blender::imbuf::tests {
+
+using imbuf_rectop = ImBufTest;
+
+/* Not a multiple of the number of pixels blended at once. */
+static const int num_test_pixels = 37;
+
+/* Random colors, with runs of opaque and fully transparent pixels. */
+static void fill_random_byte(unsigned char *rect, int totpixel, unsigned int seed)
+{
+  RNG *rng = BLI_rng_new(seed);
+  for (int i = 0; i < totpixel; i++) {
+    for (int c = 0; c < 4; c++) {
+      rect[i * 4 + c] = (unsigned char)BLI_rng_get_int(rng);
+    }
+    if (i < 12) {
+      rect[i * 4 + 3] = 255;
+    }
+    else if (i % 5 == 0) {
+      rect[i * 4 + 3] = 0;
+    }
+  }
+  BLI_rng_free(rng);
+}
+
+static void fill_random_float(float *rect, int totpixel, unsigned int seed)
+{
+  RNG *rng = BLI_rng_new(seed);
+  for (int i = 0; i < totpixel; i++) {
+    float alpha = BLI_rng_get_float(rng);
+    if (i < 12) {
+      alpha = 1.0f;
+    }
+    else if (i % 5 == 0) {
+      alpha = 0.0f;
+    }
+    /* Premultiplied. */
+    for (int c = 0; c < 3; c++) {
+      rect[i * 4 + c] = BLI_rng_get_float(rng) * alpha;
+    }
+    rect[i * 4 + 3] = alpha;
+  }
+  BLI_rng_free(rng);
+}
+
+static void test_blend_byte_n(IMB_BlendMode mode)
+{
+  unsigned char src1[num_test_pixels * 4], src2[num_test_pixels * 4];
+  unsigned char expected[num_test_pixels * 4], result[num_test_pixels * 4];
+  fill_random_byte(src1, num_test_pixels, 1);
+  fill_random_byte(src2, num_test_pixels, 2);
+
+  for (int i = 0; i < num_test_pixels; i++) {
+    IMB_blend_color_byte(expected + i * 4, src1 + i * 4, src2 + i * 4, mode);
+  }
+
+  IMB_blend_color_byte_n(result, src1, src2, num_test_pixels, mode);
+  for (int i = 0; i < num_test_pixels * 4; i++) {
+    EXPECT_EQ(result[i], expected[i]) << "mode " << mode << ", channel " << i;
+  }
+}
+
+static void test_blend_float_n(IMB_BlendMode mode)
+{
+  float src1[num_test_pixels * 4], src2[num_test_pixels * 4];
+  float expected[num_test_pixels * 4], result[num_test_pixels * 4];
+  fill_random_float(src1, num_test_pixels, 1);
+  fill_random_float(src2, num_test_pixels, 2);
+
+  for (int i = 0; i < num_test_pixels; i++) {
+    IMB_blend_color_float(expected + i * 4, src1 + i * 4, src2 + i * 4, mode);
+  }
+
+  IMB_blend_color_float_n(result, src1, src2, num_test_pixels, mode);
+  for (int i = 0; i < num_test_pixels * 4; i++) {
+    EXPECT_FLOAT_EQ(result[i], expected[i]) << "mode " << mode << ", channel " << i;
+  }
+}
+
+TEST_F(imbuf_rectop, BlendSpanByte)
+{
+  for (int mode = IMB_BLEND_MIX; mode <= IMB_BLEND_INTERPOLATE; mode++) {
+    test_blend_byte_n((IMB_BlendMode)mode);
+  }
+  test_blend_byte_n(IMB_BLEND_COPY);
+}
+
+TEST_F(imbuf_rectop, BlendSpanFloat)
+{
+  for (int mode = IMB_BLEND_MIX; mode <= IMB_BLEND_INTERPOLATE; mode++) {
+    test_blend_float_n((IMB_BlendMode)mode);
+  }
+  test_blend_float_n(IMB_BLEND_COPY);
+}
+
+/* Fully transparent source pixels leave the destination untouched. */
+TEST_F(imbuf_rectop, RectBlendTransparent)
+{
+  const int size = 16;
+  ImBuf *dbuf = IMB_allocImBuf(size, size, 32, IB_rect);
+  ImBuf *obuf = IMB_allocImBuf(size, size, 32, IB_rect);
+  ImBuf *sbuf = IMB_allocImBuf(size, size, 32, IB_rect);
+  fill_random_byte((unsigned char *)obuf->rect, size * size, 3);
+  fill_random_byte((unsigned char *)sbuf->rect, size * size, 4);
+  memset(dbuf->rect, 0x7f, sizeof(unsigned int) * size * size);
+
+  IMB_rectblend(dbuf,
+                obuf,
+                sbuf,
+                nullptr,
+                nullptr,
+                nullptr,
+                0.0f,
+                0,
+                0,
+                0,
+                0,
+                0,
+                0,
+                size,
+                size,
+                IMB_BLEND_ADD,
+                false);
+
+  const unsigned char *drect = (const unsigned char *)dbuf->rect;
+  const unsigned char *orect = (const unsigned char *)obuf->rect;
+  const unsigned char *srect = (const unsigned char *)sbuf->rect;
+  for (int i = 0; i < size * size; i++) {
+    unsigned char expected[4] = {0x7f, 0x7f, 0x7f, 0x7f};
+    if (srect[i * 4 + 3] != 0) {
+      IMB_blend_color_byte(expected, orect + i * 4, srect + i * 4, IMB_BLEND_ADD);
+    }
+    for (int c = 0; c < 4; c++) {
+      EXPECT_EQ(drect[i * 4 + c], expected[c]);
+    }
+  }
+
+  IMB_freeImBuf(dbuf);
+  IMB_freeImBuf(obuf);
+  IMB_freeImBuf(sbuf);
+}
+
+/* Painting with a stroke mask matches blending every pixel with its masked alpha. */
+TEST_F(imbuf_rectop, RectBlendMasked)
+{
+  const int size = 16;
+  const float mask_max = 0.75f;
+  ImBuf *dbuf = IMB_allocImBuf(size, size, 32, IB_rect);
+  ImBuf *obuf = IMB_allocImBuf(size, size, 32, IB_rect);
+  ImBuf *sbuf = IMB_allocImBuf(size, size, 32, IB_rect);
+  fill_random_byte((unsigned char *)obuf->rect, size * size, 5);
+  fill_random_byte((unsigned char *)sbuf->rect, size * size, 6);
+  memcpy(dbuf->rect, obuf->rect, sizeof(unsigned int) * size * size);
+
+  unsigned short curvemask[size * size], dmask[size * size], dmask_orig[size * size];
+  RNG *rng = BLI_rng_new(7);
+  for (int i = 0; i < size * size; i++) {
+    curvemask[i] = (i % 5 == 0) ? 0 : BLI_rng_get_int(rng) & 0xffff;
+    dmask[i] = dmask_orig[i] = (i % 3 == 0) ? 0xffff : BLI_rng_get_int(rng) & 0x7fff;
+  }
+  BLI_rng_free(rng);
+
+  IMB_rectblend(dbuf,
+                obuf,
+                sbuf,
+                dmask,
+                curvemask,
+                nullptr,
+                mask_max,
+                0,
+                0,
+                0,
+                0,
+                0,
+                0,
+                size,
+                size,
+                IMB_BLEND_MUL,
+                false);
+
+  const unsigned char *drect = (const unsigned char *)dbuf->rect;
+  const unsigned char *orect = (const unsigned char *)obuf->rect;
+  const unsigned char *srect = (const unsigned char *)sbuf->rect;
+  for (int i = 0; i < size * size; i++) {
+    unsigned char expected[4];
+    unsigned short expected_dmask = dmask_orig[i];
+    memcpy(expected, orect + i * 4, 4);
+
+    const float mask_lim = mask_max * curvemask[i];
+    if (srect[i * 4 + 3] && mask_lim) {
+      const float mask = min_ff(dmask_orig[i] + mask_lim -
+                                    (dmask_orig[i] * (curvemask[i] / 65535.0f)),
+                                65535.0f);
+      if (mask > dmask_orig[i]) {
+        expected_dmask = mask;
+        unsigned char mask_src[4];
+        memcpy(mask_src, srect + i * 4, 3);
+        mask_src[3] = divide_round_i(srect[i * 4 + 3] * mask, 65535);
+        IMB_blend_color_byte(expected, orect + i * 4, mask_src, IMB_BLEND_MUL);
+      }
+    }
+
+    EXPECT_EQ(dmask[i], expected_dmask);
+    for (int c = 0; c < 4; c++) {
+      EXPECT_EQ(drect[i * 4 + c], expected[c]);
+    }
+  }
+
+  IMB_freeImBuf(dbuf);
+  IMB_freeImBuf(obuf);
+  IMB_freeImBuf(sbuf);
+}
+
+}  // namespace blender::imbuf::tests
@@ -24,8 +24,10 @@
 
 #include <math.h>
 
+#include "BLI_math_base.h"
 #include "BLI_math_color.h"
 #include "BLI_math_interp.h"
+#include "BLI_simd.h"
 #include "BLI_utildefines.h"
 #include "MEM_guardedalloc.h"
 
@@ -1928,3 +1930,435 @@ void IMB_scaleImBuf_threaded(ImBuf *ibuf, unsigned int newx, unsigned int newy)
     ibuf->rect_float = init_data.float_buffer;
   }
 }
+
+/* -------------------------------------------------------------------- */
+/** \name Separable Filtered Scaling
+ *
+ * Two pass resampler: every output pixel is a weighted sum of a run of input pixels along one
+ * axis, first horizontally and then vertically. The weights only depend on the output column
+ * (or row), so they are computed once per axis. When down-scaling, the kernel is stretched by
+ * the scale factor so it also acts as the low-pass filter that prevents aliasing.
+ * \{ */
+
+/* Fixed point precision of the byte weights, leaves room for the 8 bit input and for negative
+ * lobes of the kernels without overflowing the 32 bit accumulator. */
+#define SCALE_FILTER_PRECISION_BITS (32 - 8 - 2)
+/* Number of elements of a scanline accumulated at once by the vertical byte pass. */
+#define SCALE_FILTER_CHUNK_SIZE 1024
+
+typedef struct ScaleFilterWeights {
+  /* First input pixel and number of taps, for every output pixel. */
+  int *bounds;
+  /* `kernel_size` weights for every output pixel, normalized to sum up to one. */
+  float *weights;
+  /* Same weights in fixed point, used for byte buffers. */
+  int *weights_int;
+  int kernel_size;
+} ScaleFilterWeights;
+
+typedef struct ScaleFilterPass {
+  const ScaleFilterWeights *weights;
+  int channels;
+  /* Number of pixels in input and output scanlines. */
+  int in_width;
+  int out_width;
+
+  const uchar *in_byte;
+  uchar *out_byte;
+  const float *in_float;
+  float *out_float;
+} ScaleFilterPass;
+
+static float scale_filter_box(float x)
+{
+  return (x > -0.5f && x <= 0.5f) ? 1.0f : 0.0f;
+}
+
+static float scale_filter_bilinear(float x)
+{
+  x = fabsf(x);
+  return (x < 1.0f) ? 1.0f - x : 0.0f;
+}
+
+/* Mitchell-Netravali with B = C = 1/3. */
+static float scale_filter_mitchell(float x)
+{
+  x = fabsf(x);
+  if (x < 1.0f) {
+    return ((7.0f * x - 12.0f) * x * x + 16.0f / 3.0f) / 6.0f;
+  }
+  if (x < 2.0f) {
+    return (((-7.0f / 3.0f * x + 12.0f) * x - 20.0f) * x + 32.0f / 3.0f) / 6.0f;
+  }
+  return 0.0f;
+}
+
+static float scale_filter_sinc(float x)
+{
+  if (x == 0.0f) {
+    return 1.0f;
+  }
+  x *= (float)M_PI;
+  return sinf(x) / x;
+}
+
+static float scale_filter_lanczos3(float x)
+{
+  if (x > -3.0f && x < 3.0f) {
+    return scale_filter_sinc(x) * scale_filter_sinc(x / 3.0f);
+  }
+  return 0.0f;
+}
+
+static void scale_filter_kernel_get(eIMBScaleFilter filter,
+                                    float (**r_eval)(float x),
+                                    float *r_radius)
+{
+  switch (filter) {
+    case IMB_SCALE_FILTER_BOX:
+      *r_eval = scale_filter_box;
+      *r_radius = 0.5f;
+      break;
+    case IMB_SCALE_FILTER_BILINEAR:
+      *r_eval = scale_filter_bilinear;
+      *r_radius = 1.0f;
+      break;
+    case IMB_SCALE_FILTER_MITCHELL:
+      *r_eval = scale_filter_mitchell;
+      *r_radius = 2.0f;
+      break;
+    case IMB_SCALE_FILTER_LANCZOS3:
+    default:
+      *r_eval = scale_filter_lanczos3;
+      *r_radius = 3.0f;
+      break;
+  }
+}
+
+static void scale_filter_weights_init(ScaleFilterWeights *w,
+                                      eIMBScaleFilter filter,
+                                      int in_size,
+                                      int out_size)
+{
+  float (*eval)(float x);
+  float radius;
+  scale_filter_kernel_get(filter, &eval, &radius);
+
+  const double scale = (double)in_size / out_size;
+  const double filter_scale = max_dd(scale, 1.0);
+  const double support = radius * filter_scale;
+  const double inv_filter_scale = 1.0 / filter_scale;
+
+  w->kernel_size = (int)ceil(support) * 2 + 1;
+  w->bounds = MEM_mallocN(sizeof(int[2]) * out_size, __func__);
+  w->weights = MEM_calloc_arrayN((size_t)out_size * w->kernel_size, sizeof(float), __func__);
+  w->weights_int = MEM_calloc_arrayN((size_t)out_size * w->kernel_size, sizeof(int), __func__);
+
+  for (int i = 0; i < out_size; i++) {
+    const double center = (i + 0.5) * scale;
+    const int first = max_ii((int)(center - support + 0.5), 0);
+    const int last = min_ii((int)(center + support + 0.5), in_size);
+    const int taps = max_ii(min_ii(last - first, w->kernel_size), 1);
+    float *weights = w->weights + (size_t)i * w->kernel_size;
+    int *weights_int = w->weights_int + (size_t)i * w->kernel_size;
+
+    double total = 0.0;
+    for (int j = 0; j < taps; j++) {
+      weights[j] = eval((float)((first + j - center + 0.5) * inv_filter_scale));
+      total += weights[j];
+    }
+    for (int j = 0; j < taps; j++) {
+      weights[j] = (total != 0.0) ? (float)(weights[j] / total) : 1.0f / taps;
+      weights_int[j] = (int)lround(weights[j] * (1 << SCALE_FILTER_PRECISION_BITS));
+    }
+
+    w->bounds[i * 2] = first;
+    w->bounds[i * 2 + 1] = taps;
+  }
+}
+
+static void scale_filter_weights_free(ScaleFilterWeights *w)
+{
+  MEM_SAFE_FREE(w->bounds);
+  MEM_SAFE_FREE(w->weights);
+  MEM_SAFE_FREE(w->weights_int);
+}
+
+BLI_INLINE uchar scale_filter_clip_byte(int value)
+{
+  if (value < 0) {
+    return 0;
+  }
+  value >>= SCALE_FILTER_PRECISION_BITS;
+  return (value > 255) ? 255 : (uchar)value;
+}
+
+static void scale_filter_horizontal_byte(void *custom_data, int scanline)
+{
+  const ScaleFilterPass *pass = custom_data;
+  const ScaleFilterWeights *w = pass->weights;
+  const uchar *in = pass->in_byte + (size_t)scanline * pass->in_width * 4;
+  uchar *out = pass->out_byte + (size_t)scanline * pass->out_width * 4;
+
+  for (int x = 0; x < pass->out_width; x++, out += 4) {
+    const uchar *src = in + w->bounds[x * 2] * 4;
+    const int taps = w->bounds[x * 2 + 1];
+    const int *k = w->weights_int + (size_t)x * w->kernel_size;
+    const int round = 1 << (SCALE_FILTER_PRECISION_BITS - 1);
+    int sum[4] = {round, round, round, round};
+
+    for (int i = 0; i < taps; i++, src += 4) {
+      sum[0] += src[0] * k[i];
+      sum[1] += src[1] * k[i];
+      sum[2] += src[2] * k[i];
+      sum[3] += src[3] * k[i];
+    }
+
+    out[0] = scale_filter_clip_byte(sum[0]);
+    out[1] = scale_filter_clip_byte(sum[1]);
+    out[2] = scale_filter_clip_byte(sum[2]);
+    out[3] = scale_filter_clip_byte(sum[3]);
+  }
+}
+
+static void scale_filter_vertical_byte(void *custom_data, int scanline)
+{
+  const ScaleFilterPass *pass = custom_data;
+  const ScaleFilterWeights *w = pass->weights;
+  /* Vertically every byte is filtered independently, so channels don't matter. */
+  const size_t row_size = (size_t)pass->out_width * 4;
+  const uchar *in = pass->in_byte + (size_t)w->bounds[scanline * 2] * row_size;
+  uchar *out = pass->out_byte + (size_t)scanline * row_size;
+  const int taps = w->bounds[scanline * 2 + 1];
+  const int *k = w->weights_int + (size_t)scanline * w->kernel_size;
+  int sum[SCALE_FILTER_CHUNK_SIZE];
+
+  for (size_t start = 0; start < row_size; start += SCALE_FILTER_CHUNK_SIZE) {
+    const int len = (int)min_zz(row_size - start, SCALE_FILTER_CHUNK_SIZE);
+
+    for (int j = 0; j < len; j++) {
+      sum[j] = 1 << (SCALE_FILTER_PRECISION_BITS - 1);
+    }
+    for (int i = 0; i < taps; i++) {
+      const uchar *src = in + i * row_size + start;
+      const int weight = k[i];
+      for (int j = 0; j < len; j++) {
+        sum[j] += src[j] * weight;
+      }
+    }
+    for (int j = 0; j < len; j++) {
+      out[start + j] = scale_filter_clip_byte(sum[j]);
+    }
+  }
+}
+
+static void scale_filter_horizontal_float(void *custom_data, int scanline)
+{
+  const ScaleFilterPass *pass = custom_data;
+  const ScaleFilterWeights *w = pass->weights;
+  const int channels = pass->channels;
+  const float *in = pass->in_float + (size_t)scanline * pass->in_width * channels;
+  float *out = pass->out_float + (size_t)scanline * pass->out_width * channels;
+
+#ifdef BLI_HAVE_SSE2
+  if (channels == 4) {
+    for (int x = 0; x < pass->out_width; x++, out += 4) {
+      const float *src = in + w->bounds[x * 2] * 4;
+      const int taps = w->bounds[x * 2 + 1];
+      const float *k = w->weights + (size_t)x * w->kernel_size;
+      __m128 sum = _mm_setzero_ps();
+      for (int i = 0; i < taps; i++, src += 4) {
+        sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(src), _mm_set1_ps(k[i])));
+      }
+      _mm_storeu_ps(out, sum);
+    }
+    return;
+  }
+#endif
+
+  for (int x = 0; x < pass->out_width; x++, out += channels) {
+    const float *src = in + w->bounds[x * 2] * channels;
+    const int taps = w->bounds[x * 2 + 1];
+    const float *k = w->weights + (size_t)x * w->kernel_size;
+    for (int c = 0; c < channels; c++) {
+      out[c] = 0.0f;
+    }
+    for (int i = 0; i < taps; i++, src += channels) {
+      for (int c = 0; c < channels; c++) {
+        out[c] += src[c] * k[i];
+      }
+    }
+  }
+}
+
+static void scale_filter_vertical_float(void *custom_data, int scanline)
+{
+  const ScaleFilterPass *pass = custom_data;
+  const ScaleFilterWeights *w = pass->weights;
+  const size_t row_size = (size_t)pass->out_width * pass->channels;
+  const float *in = pass->in_float + (size_t)w->bounds[scanline * 2] * row_size;
+  float *out = pass->out_float + (size_t)scanline * row_size;
+  const int taps = w->bounds[scanline * 2 + 1];
+  const float *k = w->weights + (size_t)scanline * w->kernel_size;
+
+  /* Accumulate whole rows at once, the output row stays in cache while the input rows are
+   * streamed through. */
+  for (size_t j = 0; j < row_size; j++) {
+    out[j] = in[j] * k[0];
+  }
+  for (int i = 1; i < taps; i++) {
+    const float *src = in + i * row_size;
+    const float weight = k[i];
+    size_t j = 0;
+#ifdef BLI_HAVE_SSE2
+    const __m128 weight_v = _mm_set1_ps(weight);
+    for (; j + 4 <= row_size; j += 4) {
+      _mm_storeu_ps(out + j,
+                    _mm_add_ps(_mm_loadu_ps(out + j), _mm_mul_ps(_mm_loadu_ps(src + j), weight_v)));
+    }
+#endif
+    for (; j < row_size; j++) {
+      out[j] += src[j] * weight;
+    }
+  }
+}
+
+/**
+ * Resample a buffer of `in_x * in_y` pixels to `out_x * out_y`. Either of the weights can be
+ * NULL when that axis keeps its size.
+ */
+static void *scale_filter_buffer(const void *in,
+                                 const bool is_float,
+                                 const int channels,
+                                 const int in_x,
+                                 const int in_y,
+                                 const int out_x,
+                                 const int out_y,
+                                 const ScaleFilterWeights *weights_x,
+                                 const ScaleFilterWeights *weights_y)
+{
+  const size_t pixel_size = is_float ? sizeof(float) * channels : sizeof(uchar[4]);
+  const void *src = in;
+  void *tmp = NULL;
+  void *out = NULL;
+
+  if (weights_x) {
+    out = MEM_mallocN(pixel_size * out_x * in_y, "scale filter horizontal");
+    ScaleFilterPass pass = {
+        .weights = weights_x,
+        .channels = channels,
+        .in_width = in_x,
+        .out_width = out_x,
+    };
+    if (is_float) {
+      pass.in_float = src;
+      pass.out_float = out;
+    }
+    else {
+      pass.in_byte = src;
+      pass.out_byte = out;
+    }
+    IMB_processor_apply_threaded_scanlines(
+        in_y,
+        is_float ? scale_filter_horizontal_float : scale_filter_horizontal_byte,
+        &pass);
+    src = tmp = out;
+  }
+
+  if (weights_y) {
+    out = MEM_mallocN(pixel_size * out_x * out_y, "scale filter vertical");
+    ScaleFilterPass pass = {
+        .weights = weights_y,
+        .channels = channels,
+        .in_width = out_x,
+        .out_width = out_x,
+    };
+    if (is_float) {
+      pass.in_float = src;
+      pass.out_float = out;
+    }
+    else {
+      pass.in_byte = src;
+      pass.out_byte = out;
+    }
+    IMB_processor_apply_threaded_scanlines(
+        out_y, is_float ? scale_filter_vertical_float : scale_filter_vertical_byte, &pass);
+    MEM_SAFE_FREE(tmp);
+  }
+
+  return out;
+}
+
+/**
+ * Scale with a separable filter, multi-threaded over scanlines. Unlike #IMB_scaleImBuf the
+ * reconstruction kernel can be chosen, and float buffers may have any number of channels.
+ *
+ * Return true if \a ibuf is modified.
+ */
+bool IMB_scaleImBuf_filtered(struct ImBuf *ibuf,
+                             unsigned int newx,
+                             unsigned int newy,
+                             const eIMBScaleFilter filter)
+{
+  BLI_assert_msg(newx > 0 && newy > 0, "Images must be at least 1 on both dimensions!");
+
+  if (ibuf == NULL) {
+    return false;
+  }
+  if (ibuf->rect == NULL && ibuf->rect_float == NULL) {
+    return false;
+  }
+
+  if (newx == ibuf->x && newy == ibuf->y) {
+    return false;
+  }
+
+  scalefast_Z_ImBuf(ibuf, newx, newy);
+
+  ScaleFilterWeights weights_x = {NULL}, weights_y = {NULL};
+  if (newx != ibuf->x) {
+    scale_filter_weights_init(&weights_x, filter, ibuf->x, newx);
+  }
+  if (newy != ibuf->y) {
+    scale_filter_weights_init(&weights_y, filter, ibuf->y, newy);
+  }
+
+  if (ibuf->rect) {
+    uchar *rect = scale_filter_buffer(ibuf->rect,
+                                      false,
+                                      4,
+                                      ibuf->x,
+                                      ibuf->y,
+                                      newx,
+                                      newy,
+                                      weights_x.bounds ? &weights_x : NULL,
+                                      weights_y.bounds ? &weights_y : NULL);
+    imb_freerectImBuf(ibuf);
+    ibuf->mall |= IB_rect;
+    ibuf->rect = (unsigned int *)rect;
+  }
+
+  if (ibuf->rect_float) {
+    float *rect_float = scale_filter_buffer(ibuf->rect_float,
+                                            true,
+                                            ibuf->channels,
+                                            ibuf->x,
+                                            ibuf->y,
+                                            newx,
+                                            newy,
+                                            weights_x.bounds ? &weights_x : NULL,
+                                            weights_y.bounds ? &weights_y : NULL);
+    imb_freerectfloatImBuf(ibuf);
+    ibuf->mall |= IB_rectfloat;
+    ibuf->rect_float = rect_float;
+  }
+
+  scale_filter_weights_free(&weights_x);
+  scale_filter_weights_free(&weights_y);
+
+  ibuf->x = newx;
+  ibuf->y = newy;
+  return true;
+}
+
+/** \} */
@@ -0,0 +1,179 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "imbuf_testing.hh"
+
+#include "IMB_imbuf.h"
+#include "IMB_imbuf_types.h"
+
+#include "BLI_utildefines.h"
+
+#include "PIL_time.h"
+
+namespace blender::imbuf::tests {
+
+using imbuf_scaling = ImBufTest;
+
+using imbuf_scaling_performance = imbuf_scaling;
+
+static const eIMBScaleFilter scale_filters[] = {
+    IMB_SCALE_FILTER_BOX,
+    IMB_SCALE_FILTER_BILINEAR,
+    IMB_SCALE_FILTER_MITCHELL,
+    IMB_SCALE_FILTER_LANCZOS3,
+};
+
+static const char *scale_filter_names[] = {"box", "bilinear", "mitchell", "lanczos3"};
+
+static ImBuf *create_test_image(int width, int height, bool use_float)
+{
+  ImBuf *ibuf = IMB_allocImBuf(width, height, 32, use_float ? IB_rectfloat : IB_rect);
+  for (int y = 0; y < height; y++) {
+    for (int x = 0; x < width; x++) {
+      const size_t offset = ((size_t)y * width + x) * 4;
+      /* Diagonal gradient with a checker pattern, to have both smooth and sharp areas. */
+      const float value = ((x / 8 + y / 8) % 2) ? (float)(x + y) / (width + height) : 0.5f;
+      if (use_float) {
+        ibuf->rect_float[offset + 0] = value;
+        ibuf->rect_float[offset + 1] = 1.0f - value;
+        ibuf->rect_float[offset + 2] = value * 0.5f;
+        ibuf->rect_float[offset + 3] = 1.0f;
+      }
+      else {
+        unsigned char *rect = (unsigned char *)ibuf->rect;
+        rect[offset + 0] = (unsigned char)(value * 255.0f);
+        rect[offset + 1] = (unsigned char)((1.0f - value) * 255.0f);
+        rect[offset + 2] = (unsigned char)(value * 127.0f);
+        rect[offset + 3] = 255;
+      }
+    }
+  }
+  return ibuf;
+}
+
+static void fill_constant(ImBuf *ibuf, const float color[4])
+{
+  const size_t num_pixels = (size_t)ibuf->x * ibuf->y;
+  for (size_t i = 0; i < num_pixels; i++) {
+    for (int c = 0; c < 4; c++) {
+      if (ibuf->rect_float) {
+        ibuf->rect_float[i * 4 + c] = color[c];
+      }
+      if (ibuf->rect) {
+        ((unsigned char *)ibuf->rect)[i * 4 + c] = (unsigned char)(color[c] * 255.0f);
+      }
+    }
+  }
+}
+
+/* Normalized kernels must keep a constant image constant, in both directions. */
+static void test_scale_constant(int width, int height, int newx, int newy)
+{
+  const float color[4] = {0.2f, 0.4f, 0.6f, 1.0f};
+  for (const eIMBScaleFilter filter : scale_filters) {
+    ImBuf *ibuf = IMB_allocImBuf(width, height, 32, IB_rect | IB_rectfloat);
+    fill_constant(ibuf, color);
+
+    EXPECT_TRUE(IMB_scaleImBuf_filtered(ibuf, newx, newy, filter));
+    EXPECT_EQ(ibuf->x, newx);
+    EXPECT_EQ(ibuf->y, newy);
+
+    const unsigned char *rect = (const unsigned char *)ibuf->rect;
+    for (size_t i = 0; i < (size_t)newx * newy * 4; i++) {
+      EXPECT_NEAR(ibuf->rect_float[i], color[i % 4], 1e-5f);
+      EXPECT_NEAR(rect[i], (unsigned char)(color[i % 4] * 255.0f), 1);
+    }
+    IMB_freeImBuf(ibuf);
+  }
+}
+
+TEST_F(imbuf_scaling, FilteredDownscaleConstant)
+{
+  test_scale_constant(61, 37, 17, 11);
+}
+
+TEST_F(imbuf_scaling, FilteredUpscaleConstant)
+{
+  test_scale_constant(13, 7, 40, 29);
+}
+
+TEST_F(imbuf_scaling, FilteredSingleAxis)
+{
+  test_scale_constant(32, 32, 32, 9);
+  test_scale_constant(32, 32, 9, 32);
+}
+
+TEST_F(imbuf_scaling, FilteredSameSize)
+{
+  ImBuf *ibuf = create_test_image(16, 16, false);
+  EXPECT_FALSE(IMB_scaleImBuf_filtered(ibuf, 16, 16, IMB_SCALE_FILTER_LANCZOS3));
+  IMB_freeImBuf(ibuf);
+}
+
+TEST_F(imbuf_scaling, FilteredBoxHalf)
+{
+  /* Halving with a box filter averages exactly two by two pixels. */
+  ImBuf *ibuf = create_test_image(64, 64, true);
+  ImBuf *ref = IMB_dupImBuf(ibuf);
+  IMB_scaleImBuf_filtered(ibuf, 32, 32, IMB_SCALE_FILTER_BOX);
+
+  for (int y = 0; y < 32; y++) {
+    for (int x = 0; x < 32; x++) {
+      for (int c = 0; c < 4; c++) {
+        const float *src = ref->rect_float + ((size_t)(y * 2) * 64 + x * 2) * 4 + c;
+        const float expected = (src[0] + src[4] + src[64 * 4] + src[64 * 4 + 4]) * 0.25f;
+        EXPECT_NEAR(ibuf->rect_float[((size_t)y * 32 + x) * 4 + c], expected, 1e-5f);
+      }
+    }
+  }
+
+  IMB_freeImBuf(ref);
+  IMB_freeImBuf(ibuf);
+}
+
+/* Reports the throughput of every kernel, in input megapixels per second. */
+static void test_scale_performance(bool use_float, int newx, int newy)
+{
+  const int width = 1920, height = 1080, num_runs = 4;
+  ImBuf *source = create_test_image(width, height, use_float);
+
+  for (int i = 0; i < ARRAY_SIZE(scale_filters); i++) {
+    double time_total = 0.0;
+    for (int run = 0; run < num_runs; run++) {
+      ImBuf *ibuf = IMB_dupImBuf(source);
+      const double time_start = PIL_check_seconds_timer();
+      IMB_scaleImBuf_filtered(ibuf, newx, newy, scale_filters[i]);
+      time_total += PIL_check_seconds_timer() - time_start;
+      IMB_freeImBuf(ibuf);
+    }
+    const double mpixels = (double)width * height * num_runs / 1e6;
+    printf("%s %s %dx%d -> %dx%d: %.1f Mpix/s\n",
+           use_float ? "float" : "byte",
+           scale_filter_names[i],
+           width,
+           height,
+           newx,
+           newy,
+           mpixels / time_total);
+  }
+
+  IMB_freeImBuf(source);
+}
+
+TEST_F(imbuf_scaling_performance, ByteDownscale)
+{
+  test_scale_performance(false, 960, 540);
+}
+
+TEST_F(imbuf_scaling_performance, FloatDownscale)
+{
+  test_scale_performance(true, 960, 540);
+}
+
+TEST_F(imbuf_scaling_performance, ByteUpscale)
+{
+  test_scale_performance(false, 3840, 2160);
+}
+
+}  // namespace blender::imbuf::tests
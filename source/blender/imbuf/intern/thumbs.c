@@ -356,15 +356,6 @@ static ImBuf *thumb_create_ex(const char *file_path,
       return NULL; /* unknown size */
   }
 
-  /* exception, skip images over 100mb */
-  if (source == THB_SOURCE_IMAGE) {
-    const size_t file_size = BLI_file_size(file_path);
-    if (file_size != -1 && file_size > THUMB_SIZE_MAX) {
-      // printf("file too big: %d, skipping %s\n", (int)size, file_path);
-      return NULL;
-    }
-  }
-
   if (get_thumb_dir(tdir, size)) {
     BLI_snprintf(tpath, FILE_MAX, "%s%s", tdir, thumb);
     //      thumb[8] = '\0'; /* shorten for tempname, not needed anymore */
@@ -384,7 +375,8 @@ static ImBuf *thumb_create_ex(const char *file_path,
         if (img == NULL) {
           switch (source) {
             case THB_SOURCE_IMAGE:
-              img = IMB_loadiffname(file_path, IB_rect | IB_metadata, NULL);
+              /* Skips big files unless they can be decoded at a reduced resolution. */
+              img = IMB_thumb_load_image(file_path, tsize, NULL);
               break;
             case THB_SOURCE_BLEND:
               img = IMB_thumb_load_blend(file_path, blen_group, blen_id);
@@ -401,22 +393,25 @@ static ImBuf *thumb_create_ex(const char *file_path,
           if (BLI_stat(file_path, &info) != -1) {
             BLI_snprintf(mtime, sizeof(mtime), "%ld", (long int)info.st_mtime);
           }
-          BLI_snprintf(cwidth, sizeof(cwidth), "%d", img->x);
-          BLI_snprintf(cheight, sizeof(cheight), "%d", img->y);
+          /* Images loaded at a reduced resolution store their full size. */
+          if (!IMB_metadata_get_field(
+                  img->metadata, "Thumb::Image::Width", cwidth, sizeof(cwidth)) ||
+              !IMB_metadata_get_field(
+                  img->metadata, "Thumb::Image::Height", cheight, sizeof(cheight))) {
+            BLI_snprintf(cwidth, sizeof(cwidth), "%d", img->x);
+            BLI_snprintf(cheight, sizeof(cheight), "%d", img->y);
+          }
         }
       }
       else if (THB_SOURCE_MOVIE == source) {
         struct anim *anim = NULL;
         anim = IMB_open_anim(file_path, IB_rect | IB_metadata, 0, NULL);
         if (anim != NULL) {
+          /* The first frame is a key-frame, it decodes without seeking. */
           img = IMB_anim_absolute(anim, 0, IMB_TC_NONE, IMB_PROXY_NONE);
           if (img == NULL) {
             printf("not an anim; %s\n", file_path);
           }
-          else {
-            IMB_freeImBuf(img);
-            img = IMB_anim_previewframe(anim);
-          }
           IMB_free_anim(anim);
         }
         if (BLI_stat(file_path, &info) != -1) {
@@ -447,7 +442,7 @@ static ImBuf *thumb_create_ex(const char *file_path,
         imb_freerectfloatImBuf(img);
       }
 
-      IMB_scaleImBuf(img, ex, ey);
+      IMB_scaleImBuf_filtered(img, ex, ey, IMB_SCALE_FILTER_BOX);
     }
     BLI_snprintf(desc, sizeof(desc), "Thumbnail for %s", uri);
     IMB_metadata_ensure(&img->metadata);
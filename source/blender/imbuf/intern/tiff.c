@@ -637,7 +637,8 @@ ImBuf *imb_loadtiff(const unsigned char *mem,
     TIFFGetField(image, TIFFTAG_PIXAR_TEXTUREFORMAT, &format);
 
     if (format && STREQ(format, "Plain Texture") && TIFFIsTiled(image)) {
-      int numlevel = TIFFNumberOfDirectories(image);
+      /* The first level is the image itself. */
+      int numlevel = min_ii(TIFFNumberOfDirectories(image), IMB_MIPMAP_LEVELS + 1);
 
       /* create empty mipmap levels in advance */
       for (level = 0; level < numlevel; level++) {
@@ -63,6 +63,8 @@ struct AlembicExportParams {
   bool export_particles;
   bool export_custom_properties;
   bool use_instancing;
+  /* Evaluate several frames at the same time, see #DEG_frame_evaluator_new. */
+  bool use_parallel_frames;
   enum eEvaluationMode evaluation_mode;
 
   /* See MOD_TRIANGULATE_NGON_xxx and MOD_TRIANGULATE_QUAD_xxx
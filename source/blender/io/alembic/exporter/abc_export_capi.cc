@@ -40,6 +40,8 @@
 #include "BLI_fileops.h"
 #include "BLI_path_util.h"
 #include "BLI_string.h"
+#include "BLI_threads.h"
+#include "BLI_vector.hh"
 
 #include "WM_api.h"
 #include "WM_types.h"
@@ -75,6 +77,73 @@ static void build_depsgraph(Depsgraph *depsgraph, const bool visible_objects_onl
   }
 }
 
+/* Upper limit for the number of frames evaluated at the same time, each of them uses a copy of
+ * the exported data. */
+static const int MAX_PARALLEL_FRAMES = 8;
+
+/* Evaluate frames on several dependency graphs at the same time, while writing them in order. */
+static void export_frames_parallel(ExportJobData *data,
+                                   ABCArchive *abc_archive,
+                                   ABCHierarchyIterator &iter,
+                                   short *stop,
+                                   short *do_update,
+                                   float *progress)
+{
+  Scene *scene = DEG_get_input_scene(data->depsgraph);
+  ViewLayer *view_layer = DEG_get_input_view_layer(data->depsgraph);
+
+  Vector<double> frames(abc_archive->frames_begin(), abc_archive->frames_end());
+  Vector<float> graph_frames;
+  for (const double frame : frames) {
+    graph_frames.append(static_cast<float>(frame));
+  }
+
+  const int graphs_num = std::min(
+      {BLI_system_thread_count(), MAX_PARALLEL_FRAMES, static_cast<int>(frames.size())});
+  Vector<Depsgraph *> graphs = {data->depsgraph};
+  for (int i = 1; i < graphs_num; i++) {
+    Depsgraph *depsgraph = DEG_graph_new(
+        data->bmain, scene, view_layer, data->params.evaluation_mode);
+    build_depsgraph(depsgraph, data->params.visible_objects_only);
+    BKE_scene_graph_update_tagged(depsgraph, data->bmain);
+    graphs.append(depsgraph);
+  }
+
+  DepsgraphFrameEvaluator *evaluator = DEG_frame_evaluator_new(
+      graphs.data(), graphs.size(), graph_frames.data(), graph_frames.size());
+
+  /* Writing the animated frames is not 100% of the work, but it's our best guess. */
+  const float progress_per_frame = 1.0f / std::max(int64_t(1), frames.size());
+
+  /* Frames come out of the evaluator in order, the exact value of the frame is needed to find
+   * the export subset. */
+  for (const double frame : frames) {
+    if (G.is_break || (stop != nullptr && *stop)) {
+      break;
+    }
+
+    float graph_frame;
+    Depsgraph *depsgraph = DEG_frame_evaluator_next(evaluator, &graph_frame);
+    BLI_assert(depsgraph != nullptr && graph_frame == static_cast<float>(frame));
+
+    CLOG_INFO(&LOG, 2, "Exporting frame %.2f", frame);
+    ExportSubset export_subset = abc_archive->export_subset_for_frame(frame);
+    iter.set_depsgraph(depsgraph);
+    iter.set_export_subset(export_subset);
+    iter.iterate_and_write();
+
+    *progress += progress_per_frame;
+    *do_update = true;
+  }
+
+  DEG_frame_evaluator_free(evaluator);
+
+  iter.set_depsgraph(data->depsgraph);
+  for (Depsgraph *depsgraph : graphs.as_span().drop_front(1)) {
+    DEG_graph_free(depsgraph);
+  }
+}
+
 static void export_startjob(void *customdata,
                             /* Cannot be const, this function implements wm_jobs_start_callback.
                              * NOLINTNEXTLINE: readability-non-const-parameter. */
@@ -133,7 +202,11 @@ static void export_startjob(void *customdata,
 
   ABCHierarchyIterator iter(data->depsgraph, abc_archive.get(), data->params);
 
-  if (export_animation) {
+  if (export_animation && data->params.use_parallel_frames) {
+    CLOG_INFO(&LOG, 2, "Exporting animation, evaluating frames in parallel");
+    export_frames_parallel(data, abc_archive.get(), iter, stop, do_update, progress);
+  }
+  else if (export_animation) {
     CLOG_INFO(&LOG, 2, "Exporting animation");
 
     /* Writing the animated frames is not 100% of the work, but it's our best guess. */
@@ -84,7 +84,7 @@ static void get_loop_normals(struct Mesh *mesh,
                              bool has_flat_shaded_poly);
 
 ABCGenericMeshWriter::ABCGenericMeshWriter(const ABCWriterConstructorArgs &args)
-    : ABCAbstractWriter(args), is_subd_(false)
+    : ABCAbstractWriter(args), is_subd_(false), is_liquid_sim_(false)
 {
 }
 
@@ -109,8 +109,8 @@ void ABCGenericMeshWriter::create_alembic_objects(const HierarchyContext *contex
     type.set(subsurf_modifier_ == nullptr);
   }
 
-  Scene *scene_eval = DEG_get_evaluated_scene(args_.depsgraph);
-  liquid_sim_modifier_ = get_liquid_sim_modifier(scene_eval, context->object);
+  Scene *scene_eval = DEG_get_evaluated_scene(args_.hierarchy_iterator->get_depsgraph());
+  is_liquid_sim_ = get_liquid_sim_modifier(scene_eval, context->object) != nullptr;
 }
 
 Alembic::Abc::OObject ABCGenericMeshWriter::get_alembic_object() const
@@ -284,8 +284,8 @@ void ABCGenericMeshWriter::write_mesh(HierarchyContext &context, Mesh *mesh)
     write_generated_coordinates(abc_poly_mesh_schema_.getArbGeomParams(), m_custom_data_config);
   }
 
-  if (liquid_sim_modifier_ != nullptr) {
-    get_velocities(mesh, velocities);
+  if (is_liquid_sim_) {
+    get_velocities(context.object, mesh, velocities);
     mesh_sample.setVelocities(V3fArraySample(velocities));
   }
 
@@ -368,7 +368,7 @@ void ABCGenericMeshWriter::write_face_sets(Object *object, struct Mesh *mesh, Sc
 
 void ABCGenericMeshWriter::write_arb_geo_params(struct Mesh *me)
 {
-  if (liquid_sim_modifier_ != nullptr) {
+  if (is_liquid_sim_) {
     /* We don't need anything more for liquid meshes. */
     return;
   }
@@ -387,17 +387,22 @@ void ABCGenericMeshWriter::write_arb_geo_params(struct Mesh *me)
   write_custom_data(arb_geom_params, m_custom_data_config, &me->ldata, CD_MLOOPCOL);
 }
 
-void ABCGenericMeshWriter::get_velocities(struct Mesh *mesh, std::vector<Imath::V3f> &vels)
+void ABCGenericMeshWriter::get_velocities(Object *object,
+                                          struct Mesh *mesh,
+                                          std::vector<Imath::V3f> &vels)
 {
   const int totverts = mesh->totvert;
 
   vels.clear();
   vels.resize(totverts);
 
-  FluidsimModifierData *fmd = reinterpret_cast<FluidsimModifierData *>(liquid_sim_modifier_);
-  FluidsimSettings *fss = fmd->fss;
+  /* The object is evaluated in the depsgraph of the frame that is written. */
+  Scene *scene_eval = DEG_get_evaluated_scene(args_.hierarchy_iterator->get_depsgraph());
+  FluidsimModifierData *fmd = reinterpret_cast<FluidsimModifierData *>(
+      get_liquid_sim_modifier(scene_eval, object));
 
-  if (fss->meshVelocities) {
+  if (fmd != nullptr && fmd->fss->meshVelocities) {
+    FluidsimSettings *fss = fmd->fss;
     float *mesh_vels = reinterpret_cast<float *>(fss->meshVelocities);
 
     for (int i = 0; i < totverts; i++) {
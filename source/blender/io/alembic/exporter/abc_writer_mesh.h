@@ -45,7 +45,9 @@ class ABCGenericMeshWriter : public ABCAbstractWriter {
    * exported object. */
   bool is_subd_;
   ModifierData *subsurf_modifier_;
-  ModifierData *liquid_sim_modifier_;
+  /* The modifier itself is looked up for every frame, as frames can be evaluated on different
+   * dependency graphs. */
+  bool is_liquid_sim_;
 
   CDStreamConfig m_custom_data_config;
 
@@ -73,7 +75,7 @@ class ABCGenericMeshWriter : public ABCAbstractWriter {
   ModifierData *get_liquid_sim_modifier(Scene *scene_eval, Object *ob_eval);
 
   void write_arb_geo_params(Mesh *me);
-  void get_velocities(Mesh *mesh, std::vector<Imath::V3f> &vels);
+  void get_velocities(Object *object, Mesh *mesh, std::vector<Imath::V3f> &vels);
   void get_geo_groups(Object *object,
                       Mesh *mesh,
                       std::map<std::string, std::vector<int32_t>> &geo_groups);
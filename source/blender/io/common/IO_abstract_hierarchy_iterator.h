@@ -236,6 +236,11 @@ class AbstractHierarchyIterator {
   /* Release all writers. Call after all frames have been exported. */
   void release_writers();
 
+  /* Iterate over another depsgraph from now on, for when frames are evaluated on different
+   * dependency graphs. The graph must be built from the same data as the current one. */
+  void set_depsgraph(Depsgraph *depsgraph);
+  Depsgraph *get_depsgraph() const;
+
   /* Determine which subset of writers is used for exporting.
    * Set this before calling iterate_and_write().
    *
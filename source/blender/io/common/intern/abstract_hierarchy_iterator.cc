@@ -211,6 +211,21 @@ void AbstractHierarchyIterator::release_writers()
   writers_.clear();
 }
 
+void AbstractHierarchyIterator::set_depsgraph(Depsgraph *depsgraph)
+{
+  if (depsgraph_ == depsgraph) {
+    return;
+  }
+  depsgraph_ = depsgraph;
+  /* This is keyed by evaluated IDs, which are different in every graph. */
+  duplisource_export_path_.clear();
+}
+
+Depsgraph *AbstractHierarchyIterator::get_depsgraph() const
+{
+  return depsgraph_;
+}
+
 void AbstractHierarchyIterator::set_export_subset(ExportSubset export_subset)
 {
   export_subset_ = export_subset;
@@ -680,7 +680,11 @@ typedef struct bAction {
    * (if 0, will be set to whatever ID first evaluates it).
    */
   int idroot;
-  char _pad[4];
+  /**
+   * Runtime, changes every time the evaluated copy of the action is copied from the original
+   * again, which re-allocates its F-Curves. See #BKE_animsys_action_tag_copied.
+   */
+  unsigned int eval_generation;
 
   PreviewImage *preview;
 } bAction;
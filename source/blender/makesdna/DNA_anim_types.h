@@ -1116,6 +1116,8 @@ typedef struct AnimData {
 
   /** Runtime data, for depsgraph evaluation. */
   FCurve **driver_array;
+  /** Runtime data, resolved RNA paths of the active action F-Curves, see #AnimBindingCache. */
+  struct AnimBindingCache *binding_cache;
 
   /* settings for animation evaluation */
   /** User-defined settings. */
@@ -53,6 +53,8 @@ typedef struct CustomDataLayer {
   char name[64];
   /** Layer data. */
   void *data;
+  /** Run-time owner of data which is shared with layers of other CustomData, see #CD_SHARE. */
+  struct CustomDataSharingInfo *sharing_info;
 } CustomDataLayer;
 
 #define MAX_CUSTOMDATA_LAYER_NAME 64
@@ -32,6 +32,7 @@ extern "C" {
 #endif
 
 struct AnimData;
+struct ArmatureDeformWeights;
 struct BVHCache;
 struct Ipo;
 struct Key;
@@ -103,6 +104,9 @@ typedef struct Mesh_Runtime {
   /** Non-manifold boundary data for Shrinkwrap Target Project. */
   struct ShrinkwrapBoundaryData *shrinkwrap_data;
 
+  /** Compact vertex group weights for armature deformation, see `armature_deform.c`. */
+  struct ArmatureDeformWeights *armature_deform_weights;
+
   /** Set by modifier stack if only deformed from original. */
   char deformed_only;
   /**
@@ -5360,6 +5360,11 @@ static void rna_def_userdef_system(BlenderRNA *brna)
        0,
        "None",
        "Requires fast storage, but uses minimum CPU resources"},
+      {USER_SEQ_DISK_CACHE_COMPRESSION_FAST,
+       "FAST",
+       0,
+       "Fast",
+       "Requires fast storage, but compression and decompression are fast enough for playback"},
       {USER_SEQ_DISK_CACHE_COMPRESSION_LOW,
        "LOW",
        0,
@@ -28,6 +28,7 @@
 #include "BLI_stack.hh"
 #include "BLI_task.h"
 #include "BLI_task.hh"
+#include "BLI_trace.h"
 #include "BLI_vector_set.hh"
 
 namespace blender::modifiers::geometry_nodes {
@@ -829,6 +830,8 @@ class GeometryNodesEvaluator {
     }
     node_state.has_been_executed = true;
 
+    TraceScope trace_scope("geometry_nodes", bnode.name);
+
     /* Use the geometry node execute callback if it exists. */
     if (bnode.typeinfo->geometry_node_execute != nullptr) {
       this->execute_geometry_node(node, node_state);
@@ -53,6 +53,8 @@
 
 #include "DNA_ID.h"
 
+#include "IMB_moviecache.h"
+
 #include "UI_interface_icons.h"
 
 /* for notifiers */
@@ -350,6 +352,28 @@ static PyObject *bpy_app_preview_render_size_get(PyObject *UNUSED(self), void *c
   return PyLong_FromLong((long)UI_icon_preview_to_render_size(POINTER_AS_INT(closure)));
 }
 
+PyDoc_STRVAR(bpy_app_cache_stats_doc,
+             "Dictionary of image caches sharing the memory cache limit, "
+             "mapping the cache name to a tuple of its number of buffers and size in bytes "
+             "(read-only)");
+static PyObject *bpy_app_cache_stats_get(PyObject *UNUSED(self), void *UNUSED(closure))
+{
+  MovieCacheStats stats[16];
+  const int stats_len = IMB_moviecache_get_stats(stats, ARRAY_SIZE(stats));
+
+  PyObject *dict = PyDict_New();
+  for (int i = 0; i < stats_len; i++) {
+    PyObject *item = PyTuple_New(2);
+    PyTuple_SET_ITEMS(item,
+                      PyLong_FromLong(stats[i].totitem),
+                      PyLong_FromSize_t(stats[i].memory_in_use));
+    PyDict_SetItemString(dict, stats[i].name, item);
+    Py_DECREF(item);
+  }
+
+  return dict;
+}
+
 static PyObject *bpy_app_autoexec_fail_message_get(PyObject *UNUSED(self), void *UNUSED(closure))
 {
   return PyC_UnicodeFromByte(G.autoexec_fail);
@@ -439,6 +463,7 @@ static PyGetSetDef bpy_app_getsets[] = {
      NULL},
     {"tempdir", bpy_app_tempdir_get, NULL, bpy_app_tempdir_doc, NULL},
     {"driver_namespace", bpy_app_driver_dict_get, NULL, bpy_app_driver_dict_doc, NULL},
+    {"cache_stats", bpy_app_cache_stats_get, NULL, bpy_app_cache_stats_doc, NULL},
 
     {"render_icon_size",
      bpy_app_preview_render_size_get,
@@ -27,6 +27,8 @@
 #include "DNA_listBase.h"
 #include "DNA_vec_types.h"
 
+#include "BLI_threads.h"
+
 struct Image;
 struct ImageFormatData;
 struct Main;
@@ -155,6 +157,14 @@ typedef struct RenderResult {
   char *error;
 
   struct StampData *stamp_data;
+
+  /* Multilayer image file that passes without pixels are read from on demand, and the color
+   * space to convert them from (MAX_COLORSPACE_NAME). See #RE_pass_ensure_loaded. */
+  void *exrhandle;
+  char exr_colorspace[64];
+  bool exr_predivide;
+  /* Serializes reads from `exrhandle`, kept after the file is closed. */
+  ThreadMutex *exr_lock;
 } RenderResult;
 
 typedef struct RenderStats {
@@ -313,6 +323,8 @@ bool RE_WriteRenderResult(struct ReportList *reports,
                           int layer);
 struct RenderResult *RE_MultilayerConvert(
     void *exrhandle, const char *colorspace, bool predivide, int rectx, int recty);
+bool RE_pass_ensure_loaded(struct RenderResult *rr, struct RenderPass *rpass);
+void RE_render_result_ensure_loaded(struct RenderResult *rr);
 
 /* display and event callbacks */
 void RE_display_init_cb(struct Render *re,
@@ -106,6 +106,7 @@
 #include "pipeline.h"
 #include "render_result.h"
 #include "render_types.h"
+#include "render_writer.h"
 
 /* render flow
  *
@@ -1369,12 +1370,27 @@ static void do_render_sequencer(Render *re)
                              true,
                              &context);
 
+  /* When rendering animation, following frames are rendered by worker threads while this one is
+   * written to disk. */
+  if ((re->flag & R_ANIMATION) && recurs_depth == 1 && re->seq_pipeline == NULL) {
+    re->seq_pipeline = SEQ_render_pipeline_start(
+        &context, cfra, re->r.efra, re->r.frame_step, BKE_render_num_threads(&re->r));
+  }
+
   /* the renderresult gets destroyed during the rendering, so we first collect all ibufs
    * and then we populate the final renderesult */
 
+  const bool use_pipeline = re->seq_pipeline != NULL &&
+                            SEQ_render_pipeline_give_ibufs(re->seq_pipeline, cfra, ibuf_arr);
+
   for (view_id = 0; view_id < tot_views; view_id++) {
     context.view_id = view_id;
-    out = SEQ_render_give_ibuf(&context, cfra, 0);
+    if (use_pipeline) {
+      out = ibuf_arr[view_id];
+    }
+    else {
+      out = SEQ_render_give_ibuf(&context, cfra, 0);
+    }
 
     if (out) {
       ibuf_arr[view_id] = IMB_dupImBuf(out);
@@ -1856,6 +1872,14 @@ static void render_pipeline_free(Render *re)
     RE_engine_free(re->engine);
     re->engine = NULL;
   }
+  if (re->seq_pipeline != NULL) {
+    SEQ_render_pipeline_end(re->seq_pipeline);
+    re->seq_pipeline = NULL;
+  }
+  if (re->writer != NULL) {
+    render_writer_free(re->writer);
+    re->writer = NULL;
+  }
   if (re->pipeline_depsgraph != NULL) {
     DEG_graph_free(re->pipeline_depsgraph);
     re->pipeline_depsgraph = NULL;
@@ -2222,14 +2246,11 @@ static int do_write_image_or_movie(Render *re,
                              (re_type->flag & RE_USE_POSTPROCESS);
 
   if (do_write_file) {
+    const bool is_movie = BKE_imtype_is_movie(scene->r.im_format.imtype);
+
     RE_AcquireResultImageViews(re, &rres);
 
-    /* write movie or image */
-    if (BKE_imtype_is_movie(scene->r.im_format.imtype)) {
-      RE_WriteRenderViewsMovie(
-          re->reports, &rres, scene, &re->r, mh, re->movie_ctx_arr, totvideos, false);
-    }
-    else {
+    if (!is_movie) {
       if (name_override) {
         BLI_strncpy(name, name_override, sizeof(name));
       }
@@ -2243,7 +2264,17 @@ static int do_write_image_or_movie(Render *re,
                                      true,
                                      NULL);
       }
+    }
 
+    if (re->writer != NULL) {
+      /* Copy the result and write it while the next frame renders. */
+      ok = render_writer_push(re->writer, scene, &re->r, &rres, is_movie ? "" : name);
+    }
+    else if (is_movie) {
+      RE_WriteRenderViewsMovie(
+          re->reports, &rres, scene, &re->r, mh, re->movie_ctx_arr, totvideos, false);
+    }
+    else {
       /* write images as individual images or stereo */
       ok = RE_WriteRenderViewsImage(re->reports, &rres, scene, true, name);
     }
@@ -2299,6 +2330,21 @@ static void get_videos_dimensions(const Render *re,
   BKE_scene_multiview_videos_dimensions_get(rd, width, height, r_width, r_height);
 }
 
+/* Run the write callbacks of frames which are saved by now, with the frame set as current one as
+ * it was while rendering it. */
+static void render_callback_exec_written_frames(Render *re, Scene *scene)
+{
+  const int cfra = scene->r.cfra;
+  int frame;
+
+  while (render_writer_pop_written(re->writer, &frame)) {
+    scene->r.cfra = frame;
+    render_callback_exec_id(re, re->main, &scene->id, BKE_CB_EVT_RENDER_WRITE);
+  }
+
+  scene->r.cfra = cfra;
+}
+
 static void re_movie_free_all(Render *re, bMovieHandle *mh, int totvideos)
 {
   int i;
@@ -2388,6 +2434,11 @@ void RE_RenderAnim(Render *re,
     }
   }
 
+  if (do_write_file) {
+    /* Frames are saved from a background thread while the next one renders. */
+    re->writer = render_writer_create(re->reports, mh, re->movie_ctx_arr, totvideos);
+  }
+
   /* Ugly global still... is to prevent renderwin events and signal subsurfs etc to make full resol
    * is also set by caller renderwin.c */
   G.is_rendering = true;
@@ -2557,11 +2608,27 @@ void RE_RenderAnim(Render *re,
       if (G.is_break == false) {
         /* keep after file save */
         render_callback_exec_id(re, re->main, &scene->id, BKE_CB_EVT_RENDER_POST);
-        render_callback_exec_id(re, re->main, &scene->id, BKE_CB_EVT_RENDER_WRITE);
+        if (re->writer != NULL) {
+          /* Only for frames whose file exists, which may be earlier ones. */
+          render_callback_exec_written_frames(re, scene);
+        }
+        else {
+          render_callback_exec_id(re, re->main, &scene->id, BKE_CB_EVT_RENDER_WRITE);
+        }
       }
     }
   }
 
+  if (re->writer != NULL) {
+    /* Frames rendered before a cancel are still saved. */
+    if (!render_writer_wait(re->writer)) {
+      G.is_break = true;
+    }
+    render_callback_exec_written_frames(re, scene);
+    render_writer_free(re->writer);
+    re->writer = NULL;
+  }
+
   /* end movie */
   if (is_movie && do_write_file) {
     re_movie_free_all(re, mh, totvideos);
@@ -28,6 +28,8 @@
 
 #include "MEM_guardedalloc.h"
 
+#include "atomic_ops.h"
+
 #include "BLI_ghash.h"
 #include "BLI_hash_md5.h"
 #include "BLI_listbase.h"
@@ -123,6 +125,13 @@ void render_result_free(RenderResult *rr)
 
   BKE_stamp_data_free(rr->stamp_data);
 
+  if (rr->exrhandle) {
+    IMB_exr_close(rr->exrhandle);
+  }
+  if (rr->exr_lock) {
+    BLI_mutex_free(rr->exr_lock);
+  }
+
   MEM_freeN(rr);
 }
 
@@ -726,9 +735,29 @@ static int order_render_passes(const void *a, const void *b)
   return (rpa->view_id < rpb->view_id);
 }
 
+static void render_result_pass_to_scene_linear(RenderPass *rpass,
+                                               const char *colorspace,
+                                               bool predivide)
+{
+  if (rpass->channels >= 3) {
+    const char *to_colorspace = IMB_colormanagement_role_colorspace_name_get(
+        COLOR_ROLE_SCENE_LINEAR);
+    IMB_colormanagement_transform(rpass->rect,
+                                  rpass->rectx,
+                                  rpass->recty,
+                                  rpass->channels,
+                                  colorspace,
+                                  to_colorspace,
+                                  predivide);
+  }
+}
+
 /**
  * From imbuf, if a handle was returned and
  * it's not a single-layer multi-view we convert this to render result.
+ *
+ * When the handle reads passes on demand, the render result takes ownership of it and the
+ * passes have no pixels until #RE_pass_ensure_loaded is called.
  */
 RenderResult *render_result_new_from_exr(
     void *exrhandle, const char *colorspace, bool predivide, int rectx, int recty)
@@ -736,14 +765,19 @@ RenderResult *render_result_new_from_exr(
   RenderResult *rr = MEM_callocN(sizeof(RenderResult), __func__);
   RenderLayer *rl;
   RenderPass *rpass;
-  const char *to_colorspace = IMB_colormanagement_role_colorspace_name_get(
-      COLOR_ROLE_SCENE_LINEAR);
 
   rr->rectx = rectx;
   rr->recty = recty;
 
   IMB_exr_multilayer_convert(exrhandle, rr, ml_addview_cb, ml_addlayer_cb, ml_addpass_cb);
 
+  if (IMB_exr_reads_on_demand(exrhandle)) {
+    rr->exrhandle = exrhandle;
+    rr->exr_lock = BLI_mutex_alloc();
+    BLI_strncpy(rr->exr_colorspace, colorspace, sizeof(rr->exr_colorspace));
+    rr->exr_predivide = predivide;
+  }
+
   for (rl = rr->layers.first; rl; rl = rl->next) {
     rl->rectx = rectx;
     rl->recty = recty;
@@ -754,14 +788,8 @@ RenderResult *render_result_new_from_exr(
       rpass->rectx = rectx;
       rpass->recty = recty;
 
-      if (rpass->channels >= 3) {
-        IMB_colormanagement_transform(rpass->rect,
-                                      rpass->rectx,
-                                      rpass->recty,
-                                      rpass->channels,
-                                      colorspace,
-                                      to_colorspace,
-                                      predivide);
+      if (rpass->rect) {
+        render_result_pass_to_scene_linear(rpass, colorspace, predivide);
       }
     }
   }
@@ -769,6 +797,109 @@ RenderResult *render_result_new_from_exr(
   return rr;
 }
 
+static bool render_result_pass_load(RenderResult *rr, RenderLayer *rl, RenderPass *rpass)
+{
+  float *rect = IMB_exr_read_pass(rr->exrhandle, rl->name, rpass->name, rpass->view);
+  if (rect == NULL) {
+    return false;
+  }
+
+  /* Only publish the buffer once converted, readers check it without locking. The atomic
+   * operation orders the writes of the conversion before it. */
+  RenderPass rpass_load = *rpass;
+  rpass_load.rect = rect;
+  render_result_pass_to_scene_linear(&rpass_load, rr->exr_colorspace, rr->exr_predivide);
+  atomic_cas_ptr((void **)&rpass->rect, NULL, rect);
+  return true;
+}
+
+/* Must be called with `rr->exr_lock` held. */
+static void render_result_exr_close(RenderResult *rr)
+{
+  IMB_exr_close(rr->exrhandle);
+  rr->exrhandle = NULL;
+}
+
+/* Must be called with `rr->exr_lock` held. */
+static bool render_result_all_passes_loaded(const RenderResult *rr)
+{
+  LISTBASE_FOREACH (const RenderLayer *, rl, &rr->layers) {
+    LISTBASE_FOREACH (const RenderPass *, rpass, &rl->passes) {
+      if (rpass->rect == NULL) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+/* Pass buffer as published by #render_result_pass_load. */
+static float *render_pass_rect_get(RenderPass *rpass)
+{
+  return atomic_cas_ptr((void **)&rpass->rect, NULL, NULL);
+}
+
+/**
+ * Read the pixels of a pass from the multilayer file, if not done yet.
+ * Returns false when the pass has no pixels.
+ */
+bool RE_pass_ensure_loaded(RenderResult *rr, RenderPass *rpass)
+{
+  if (render_pass_rect_get(rpass)) {
+    return true;
+  }
+
+  /* Not read from a multilayer file. */
+  if (rr->exr_lock == NULL) {
+    return false;
+  }
+
+  bool loaded = false;
+  BLI_mutex_lock(rr->exr_lock);
+  if (rpass->rect) {
+    loaded = true;
+  }
+  else if (rr->exrhandle) {
+    LISTBASE_FOREACH (RenderLayer *, rl, &rr->layers) {
+      if (BLI_findindex(&rl->passes, rpass) != -1) {
+        loaded = render_result_pass_load(rr, rl, rpass);
+        break;
+      }
+    }
+    /* The file isn't needed anymore. */
+    if (loaded && render_result_all_passes_loaded(rr)) {
+      render_result_exr_close(rr);
+    }
+  }
+  BLI_mutex_unlock(rr->exr_lock);
+
+  return loaded;
+}
+
+/**
+ * Read all passes that were not read from the multilayer file yet, for code that accesses the
+ * pixels of every pass. Closes the file afterwards.
+ */
+void RE_render_result_ensure_loaded(RenderResult *rr)
+{
+  if (rr->exr_lock == NULL) {
+    return;
+  }
+
+  BLI_mutex_lock(rr->exr_lock);
+  if (rr->exrhandle) {
+    LISTBASE_FOREACH (RenderLayer *, rl, &rr->layers) {
+      LISTBASE_FOREACH (RenderPass *, rpass, &rl->passes) {
+        if (rpass->rect == NULL) {
+          render_result_pass_load(rr, rl, rpass);
+        }
+      }
+    }
+    render_result_exr_close(rr);
+  }
+  BLI_mutex_unlock(rr->exr_lock);
+}
+
 void render_result_view_new(RenderResult *rr, const char *viewname)
 {
   RenderView *rv = MEM_callocN(sizeof(RenderView), "new render view");
@@ -1643,8 +1774,13 @@ static RenderView *duplicate_render_view(RenderView *rview)
 
 RenderResult *RE_DuplicateRenderResult(RenderResult *rr)
 {
+  /* The copy doesn't share the multilayer file. */
+  RE_render_result_ensure_loaded(rr);
+
   RenderResult *new_rr = MEM_mallocN(sizeof(RenderResult), "new duplicated render result");
   *new_rr = *rr;
+  new_rr->exrhandle = NULL;
+  new_rr->exr_lock = NULL;
   new_rr->next = new_rr->prev = NULL;
   new_rr->layers.first = new_rr->layers.last = NULL;
   new_rr->views.first = new_rr->views.last = NULL;
@@ -126,6 +126,11 @@ struct Render {
   Depsgraph *pipeline_depsgraph;
   Scene *pipeline_scene_eval;
 
+  /* Sequencer frames rendered ahead of the current one during animation render. */
+  struct SeqRenderPipeline *seq_pipeline;
+  /* Writes frames in the background during animation render. */
+  struct RenderWriter *writer;
+
   /* callbacks */
   void (*display_init)(void *handle, RenderResult *rr);
   void *dih;
@@ -0,0 +1,305 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/** \file
+ * \ingroup render
+ */
+
+#include <string.h>
+
+#include "MEM_guardedalloc.h"
+
+#include "DNA_scene_types.h"
+#include "DNA_windowmanager_types.h"
+
+#include "BLI_listbase.h"
+#include "BLI_path_util.h"
+#include "BLI_string.h"
+#include "BLI_threads.h"
+#include "BLI_utildefines.h"
+
+#include "BKE_colortools.h"
+#include "BKE_image.h"
+#include "BKE_report.h"
+#include "BKE_writeavi.h"
+
+#include "RE_pipeline.h"
+
+#include "render_writer.h"
+
+/* Frames waiting to be written or being written. Each one holds a copy of the render result, so
+ * the render thread is blocked once this many frames are in flight. */
+#define RENDER_WRITER_MAX_FRAMES 2
+
+typedef struct RenderWriteJob {
+  struct RenderWriteJob *next, *prev;
+
+  int frame;
+  char name[FILE_MAX];
+
+  /* Copies, the originals change while the next frame renders. */
+  RenderResult *rr;
+  Scene scene;
+  RenderData rd;
+
+  ReportList reports;
+} RenderWriteJob;
+
+typedef struct RenderWriter {
+  ReportList *reports;
+
+  bMovieHandle *mh;
+  void **movie_ctx_arr;
+  int totvideos;
+
+  /* Jobs waiting for the writer thread. */
+  ListBase queue;
+  /* Frames written successfully, not yet popped by the render thread. */
+  ListBase written;
+  /* Reports of finished jobs, moved to #RenderWriter.reports by the render thread. */
+  ListBase pending_reports;
+  int tot_in_flight;
+  bool has_error;
+  bool stop;
+
+  ListBase threads;
+  ThreadMutex mutex;
+  ThreadCondition cond;
+} RenderWriter;
+
+/* -------------------------------------------------------------------- */
+/** \name Writer Thread
+ * \{ */
+
+static void render_writer_job_free_data(RenderWriteJob *job)
+{
+  if (job->rr != NULL) {
+    RE_FreeRenderResult(job->rr);
+    job->rr = NULL;
+  }
+  BKE_color_managed_view_settings_free(&job->scene.view_settings);
+  BKE_reports_clear(&job->reports);
+}
+
+static bool render_writer_job_exec(RenderWriter *writer, RenderWriteJob *job)
+{
+  ReportList *reports = (writer->reports != NULL) ? &job->reports : NULL;
+
+  if (BKE_imtype_is_movie(job->scene.r.im_format.imtype)) {
+    return RE_WriteRenderViewsMovie(reports,
+                                    job->rr,
+                                    &job->scene,
+                                    &job->rd,
+                                    writer->mh,
+                                    writer->movie_ctx_arr,
+                                    writer->totvideos,
+                                    false);
+  }
+  return RE_WriteRenderViewsImage(reports, job->rr, &job->scene, true, job->name);
+}
+
+static void *render_writer_thread_run(void *data)
+{
+  RenderWriter *writer = data;
+
+  BLI_mutex_lock(&writer->mutex);
+
+  while (true) {
+    RenderWriteJob *job = writer->queue.first;
+
+    if (job == NULL) {
+      if (writer->stop) {
+        break;
+      }
+      BLI_condition_wait(&writer->cond, &writer->mutex);
+      continue;
+    }
+
+    BLI_remlink(&writer->queue, job);
+    BLI_mutex_unlock(&writer->mutex);
+
+    const bool ok = render_writer_job_exec(writer, job);
+
+    /* Release the memory before letting the render thread queue another frame. */
+    RE_FreeRenderResult(job->rr);
+    job->rr = NULL;
+
+    BLI_mutex_lock(&writer->mutex);
+
+    BLI_movelisttolist(&writer->pending_reports, &job->reports.list);
+    if (ok) {
+      BLI_addtail(&writer->written, job);
+    }
+    else {
+      writer->has_error = true;
+    }
+    writer->tot_in_flight--;
+    BLI_condition_notify_all(&writer->cond);
+
+    if (!ok) {
+      render_writer_job_free_data(job);
+      MEM_freeN(job);
+    }
+  }
+
+  BLI_mutex_unlock(&writer->mutex);
+
+  return NULL;
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Render Thread API
+ * \{ */
+
+RenderWriter *render_writer_create(ReportList *reports,
+                                   bMovieHandle *mh,
+                                   void **movie_ctx_arr,
+                                   int totvideos)
+{
+  RenderWriter *writer = MEM_callocN(sizeof(RenderWriter), "RenderWriter");
+
+  writer->reports = reports;
+  writer->mh = mh;
+  writer->movie_ctx_arr = movie_ctx_arr;
+  writer->totvideos = totvideos;
+
+  BLI_mutex_init(&writer->mutex);
+  BLI_condition_init(&writer->cond);
+
+  BLI_threadpool_init(&writer->threads, render_writer_thread_run, 1);
+  BLI_threadpool_insert(&writer->threads, writer);
+
+  return writer;
+}
+
+/* Must be called with the mutex locked. */
+static void render_writer_flush_reports(RenderWriter *writer)
+{
+  if (writer->reports != NULL) {
+    BLI_movelisttolist(&writer->reports->list, &writer->pending_reports);
+  }
+}
+
+/* Only multi-layer files need the render layers, other formats only write combined views. */
+static RenderResult *render_writer_result_copy(RenderResult *rr, const Scene *scene)
+{
+  RenderResult rr_views = *rr;
+
+  if (!ELEM(scene->r.im_format.imtype, R_IMF_IMTYPE_OPENEXR, R_IMF_IMTYPE_MULTILAYER)) {
+    BLI_listbase_clear(&rr_views.layers);
+  }
+
+  return RE_DuplicateRenderResult(&rr_views);
+}
+
+bool render_writer_push(RenderWriter *writer,
+                        const Scene *scene,
+                        const RenderData *rd,
+                        RenderResult *rr,
+                        const char *name)
+{
+  BLI_mutex_lock(&writer->mutex);
+  while (writer->tot_in_flight >= RENDER_WRITER_MAX_FRAMES && !writer->has_error) {
+    BLI_condition_wait(&writer->cond, &writer->mutex);
+  }
+  render_writer_flush_reports(writer);
+  const bool has_error = writer->has_error;
+  BLI_mutex_unlock(&writer->mutex);
+
+  if (has_error) {
+    return false;
+  }
+
+  RenderWriteJob *job = MEM_callocN(sizeof(RenderWriteJob), "RenderWriteJob");
+  job->frame = scene->r.cfra;
+  BLI_strncpy(job->name, name, sizeof(job->name));
+  job->rr = render_writer_result_copy(rr, scene);
+  job->scene = *scene;
+  BKE_color_managed_view_settings_copy(&job->scene.view_settings, &scene->view_settings);
+  job->rd = *rd;
+
+  if (writer->reports != NULL) {
+    BKE_reports_init(&job->reports, writer->reports->flag);
+    job->reports.printlevel = writer->reports->printlevel;
+    job->reports.storelevel = writer->reports->storelevel;
+  }
+
+  BLI_mutex_lock(&writer->mutex);
+  BLI_addtail(&writer->queue, job);
+  writer->tot_in_flight++;
+  BLI_condition_notify_all(&writer->cond);
+  BLI_mutex_unlock(&writer->mutex);
+
+  return true;
+}
+
+bool render_writer_pop_written(RenderWriter *writer, int *r_frame)
+{
+  BLI_mutex_lock(&writer->mutex);
+  render_writer_flush_reports(writer);
+  RenderWriteJob *job = BLI_pophead(&writer->written);
+  BLI_mutex_unlock(&writer->mutex);
+
+  if (job == NULL) {
+    return false;
+  }
+
+  *r_frame = job->frame;
+  render_writer_job_free_data(job);
+  MEM_freeN(job);
+
+  return true;
+}
+
+bool render_writer_wait(RenderWriter *writer)
+{
+  BLI_mutex_lock(&writer->mutex);
+  while (writer->tot_in_flight > 0) {
+    BLI_condition_wait(&writer->cond, &writer->mutex);
+  }
+  render_writer_flush_reports(writer);
+  const bool ok = !writer->has_error;
+  BLI_mutex_unlock(&writer->mutex);
+
+  return ok;
+}
+
+void render_writer_free(RenderWriter *writer)
+{
+  BLI_mutex_lock(&writer->mutex);
+  writer->stop = true;
+  BLI_condition_notify_all(&writer->cond);
+  BLI_mutex_unlock(&writer->mutex);
+
+  /* Queued frames are still written. */
+  BLI_threadpool_end(&writer->threads);
+
+  render_writer_flush_reports(writer);
+
+  LISTBASE_FOREACH_MUTABLE (RenderWriteJob *, job, &writer->written) {
+    render_writer_job_free_data(job);
+    MEM_freeN(job);
+  }
+
+  BLI_condition_end(&writer->cond);
+  BLI_mutex_end(&writer->mutex);
+
+  MEM_freeN(writer);
+}
+
+/** \} */
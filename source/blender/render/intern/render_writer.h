@@ -0,0 +1,76 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/** \file
+ * \ingroup render
+ *
+ * Writes the results of an animation render from a background thread, so encoding and saving a
+ * frame overlaps with rendering the next one.
+ */
+
+#pragma once
+
+struct RenderData;
+struct RenderResult;
+struct RenderWriter;
+struct ReportList;
+struct Scene;
+struct bMovieHandle;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Start the writer thread. Reports of failed writes end up in `reports`, they are moved there
+ * by the functions below, which are all to be called from the render thread.
+ */
+struct RenderWriter *render_writer_create(struct ReportList *reports,
+                                          struct bMovieHandle *mh,
+                                          void **movie_ctx_arr,
+                                          int totvideos);
+
+/**
+ * Queue the current frame of `scene` for writing. The views and stamp data of `rr` are copied
+ * (render layers too for OpenEXR), along with the output settings of `scene` and `rd`.
+ * Blocks while too many frames are waiting to be written.
+ *
+ * \return false when writing an earlier frame failed, the frame is not queued then.
+ */
+bool render_writer_push(struct RenderWriter *writer,
+                        const struct Scene *scene,
+                        const struct RenderData *rd,
+                        struct RenderResult *rr,
+                        const char *name);
+
+/**
+ * Get the next frame that was written successfully, in the order frames were pushed.
+ * Does not wait for frames still being written.
+ */
+bool render_writer_pop_written(struct RenderWriter *writer, int *r_frame);
+
+/**
+ * Wait for all queued frames to be written.
+ *
+ * \return false when writing any of the frames failed.
+ */
+bool render_writer_wait(struct RenderWriter *writer);
+
+void render_writer_free(struct RenderWriter *writer);
+
+#ifdef __cplusplus
+}
+#endif
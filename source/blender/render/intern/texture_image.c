@@ -52,6 +52,7 @@
 #include "texture_common.h"
 
 static void boxsample(ImBuf *ibuf,
+                      ImTileReader *tiles,
                       float minx,
                       float miny,
                       float maxx,
@@ -62,12 +63,33 @@ static void boxsample(ImBuf *ibuf,
 
 /* *********** IMAGEWRAPPING ****************** */
 
+/* Images sampled through the tile cache have no pixel buffers of their own. */
+static bool ibuf_has_pixels(const ImBuf *ibuf)
+{
+  return ibuf->rect || ibuf->rect_float || (ibuf->flags & IB_tilecache);
+}
+
+static bool ibuf_is_tiled(const ImBuf *ibuf)
+{
+  return (ibuf->flags & IB_tilecache) && ibuf->rect == NULL && ibuf->rect_float == NULL;
+}
+
 /* x and y have to be checked for image size */
-static void ibuf_get_color(float col[4], struct ImBuf *ibuf, int x, int y)
+static void ibuf_get_color(float col[4], struct ImBuf *ibuf, ImTileReader *tiles, int x, int y)
 {
   int ofs = y * ibuf->x + x;
 
-  if (ibuf->rect_float) {
+  if (ibuf_is_tiled(ibuf)) {
+    unsigned char rect[4];
+    IMB_tiled_pixel_get(tiles, ibuf, x, y, rect);
+    rgba_uchar_to_float(col, rect);
+
+    /* same as byte images below */
+    col[0] *= col[3];
+    col[1] *= col[3];
+    col[2] *= col[3];
+  }
+  else if (ibuf->rect_float) {
     if (ibuf->channels == 4) {
       const float *fp = ibuf->rect_float + 4 * ofs;
       copy_v4_v4(col, fp);
@@ -140,11 +162,11 @@ int imagewrap(Tex *tex,
     fy = texvec[1];
   }
 
-  ImBuf *ibuf = BKE_image_pool_acquire_ibuf(ima, iuser, pool);
+  ImBuf *ibuf = BKE_image_pool_acquire_ibuf_tilecache(ima, iuser, pool);
 
   ima->flag |= IMA_USED_FOR_RENDER;
 
-  if (ibuf == NULL || (ibuf->rect == NULL && ibuf->rect_float == NULL)) {
+  if (ibuf == NULL || !ibuf_has_pixels(ibuf)) {
     BKE_image_pool_release_ibuf(ima, ibuf, pool);
     return retval;
   }
@@ -247,6 +269,9 @@ int imagewrap(Tex *tex,
     }
   }
 
+  ImTileReader tiles;
+  IMB_tile_reader_init(&tiles);
+
   /* interpolate */
   if (tex->imaflag & TEX_INTERPOL) {
     float filterx, filtery;
@@ -260,6 +285,7 @@ int imagewrap(Tex *tex,
     fy -= (float)(yi - y) / (float)ibuf->y;
 
     boxsample(ibuf,
+              &tiles,
               fx - filterx,
               fy - filtery,
               fx + filterx,
@@ -269,7 +295,7 @@ int imagewrap(Tex *tex,
               (tex->extend == TEX_EXTEND));
   }
   else { /* no filtering */
-    ibuf_get_color(&texres->tr, ibuf, x, y);
+    ibuf_get_color(&texres->tr, ibuf, &tiles, x, y);
   }
 
   if (texres->nor) {
@@ -291,7 +317,7 @@ int imagewrap(Tex *tex,
 
       if (x < ibuf->x - 1) {
         float col[4];
-        ibuf_get_color(col, ibuf, x + 1, y);
+        ibuf_get_color(col, ibuf, &tiles, x + 1, y);
         val2 = (col[0] + col[1] + col[2]);
       }
       else {
@@ -300,7 +326,7 @@ int imagewrap(Tex *tex,
 
       if (y < ibuf->y - 1) {
         float col[4];
-        ibuf_get_color(col, ibuf, x, y + 1);
+        ibuf_get_color(col, ibuf, &tiles, x, y + 1);
         val3 = (col[0] + col[1] + col[2]);
       }
       else {
@@ -313,6 +339,8 @@ int imagewrap(Tex *tex,
     }
   }
 
+  IMB_tile_reader_end(&tiles);
+
   if (texres->talpha) {
     texres->tin = texres->ta;
   }
@@ -519,7 +547,7 @@ static float clipy_rctf(rctf *rf, float y1, float y2)
   return 1.0;
 }
 
-static void boxsampleclip(struct ImBuf *ibuf, rctf *rf, TexResult *texres)
+static void boxsampleclip(struct ImBuf *ibuf, ImTileReader *tiles, rctf *rf, TexResult *texres)
 {
   /* Sample box, is clipped already, and minx etc. have been set at ibuf size.
    * Enlarge with anti-aliased edges of the pixels. */
@@ -546,7 +574,7 @@ static void boxsampleclip(struct ImBuf *ibuf, rctf *rf, TexResult *texres)
   }
 
   if (starty == endy && startx == endx) {
-    ibuf_get_color(&texres->tr, ibuf, startx, starty);
+    ibuf_get_color(&texres->tr, ibuf, tiles, startx, starty);
   }
   else {
     div = texres->tr = texres->tg = texres->tb = texres->ta = 0.0;
@@ -569,7 +597,7 @@ static void boxsampleclip(struct ImBuf *ibuf, rctf *rf, TexResult *texres)
       if (startx == endx) {
         mulx = muly;
 
-        ibuf_get_color(col, ibuf, startx, y);
+        ibuf_get_color(col, ibuf, tiles, startx, y);
 
         texres->ta += mulx * col[3];
         texres->tr += mulx * col[0];
@@ -587,7 +615,7 @@ static void boxsampleclip(struct ImBuf *ibuf, rctf *rf, TexResult *texres)
             mulx *= (rf->xmax - x);
           }
 
-          ibuf_get_color(col, ibuf, x, y);
+          ibuf_get_color(col, ibuf, tiles, x, y);
 
           if (mulx == 1.0f) {
             texres->ta += col[3];
@@ -621,6 +649,7 @@ static void boxsampleclip(struct ImBuf *ibuf, rctf *rf, TexResult *texres)
 }
 
 static void boxsample(ImBuf *ibuf,
+                      ImTileReader *tiles,
                       float minx,
                       float miny,
                       float maxx,
@@ -687,7 +716,7 @@ static void boxsample(ImBuf *ibuf,
   if (count > 1) {
     tot = texres->tr = texres->tb = texres->tg = texres->ta = 0.0;
     while (count--) {
-      boxsampleclip(ibuf, rf, &texr);
+      boxsampleclip(ibuf, tiles, rf, &texr);
 
       opp = square_rctf(rf);
       tot += opp;
@@ -710,7 +739,7 @@ static void boxsample(ImBuf *ibuf,
     }
   }
   else {
-    boxsampleclip(ibuf, rf, texres);
+    boxsampleclip(ibuf, tiles, rf, texres);
   }
 
   if (texres->talpha == 0) {
@@ -737,6 +766,7 @@ typedef struct afdata_t {
   float majrad, minrad, theta;
   int iProbes;
   float dusc, dvsc;
+  ImTileReader *tiles;
 } afdata_t;
 
 /* this only used here to make it easier to pass extend flags as single int */
@@ -746,7 +776,8 @@ enum { TXC_XMIR = 1, TXC_YMIR, TXC_REPT, TXC_EXTD };
  * Similar to `ibuf_get_color()` but clips/wraps coords according to repeat/extend flags
  * returns true if out of range in clip-mode.
  */
-static int ibuf_get_color_clip(float col[4], ImBuf *ibuf, int x, int y, int extflag)
+static int ibuf_get_color_clip(
+    float col[4], ImBuf *ibuf, ImTileReader *tiles, int x, int y, int extflag)
 {
   int clip = 0;
   switch (extflag) {
@@ -790,7 +821,16 @@ static int ibuf_get_color_clip(float col[4], ImBuf *ibuf, int x, int y, int extf
     }
   }
 
-  if (ibuf->rect_float) {
+  if (ibuf_is_tiled(ibuf)) {
+    unsigned char rect[4];
+    IMB_tiled_pixel_get(tiles, ibuf, x, y, rect);
+    const float inv_alpha_fac = (1.0f / 255.0f) * rect[3] * (1.0f / 255.0f);
+    col[0] = rect[0] * inv_alpha_fac;
+    col[1] = rect[1] * inv_alpha_fac;
+    col[2] = rect[2] * inv_alpha_fac;
+    col[3] = clip ? 0.0f : rect[3] * (1.0f / 255.0f);
+  }
+  else if (ibuf->rect_float) {
     const float *fp = ibuf->rect_float + (x + y * ibuf->x) * ibuf->channels;
     if (ibuf->channels == 1) {
       col[0] = col[1] = col[2] = col[3] = *fp;
@@ -815,7 +855,7 @@ static int ibuf_get_color_clip(float col[4], ImBuf *ibuf, int x, int y, int extf
 
 /* as above + bilerp */
 static int ibuf_get_color_clip_bilerp(
-    float col[4], ImBuf *ibuf, float u, float v, int intpol, int extflag)
+    float col[4], ImBuf *ibuf, ImTileReader *tiles, float u, float v, int intpol, int extflag)
 {
   if (intpol) {
     float c00[4], c01[4], c10[4], c11[4];
@@ -824,17 +864,35 @@ static int ibuf_get_color_clip_bilerp(
     const float w00 = (1.0f - uf) * (1.0f - vf), w10 = uf * (1.0f - vf), w01 = (1.0f - uf) * vf,
                 w11 = uf * vf;
     const int x1 = (int)ufl, y1 = (int)vfl, x2 = x1 + 1, y2 = y1 + 1;
-    int clip = ibuf_get_color_clip(c00, ibuf, x1, y1, extflag);
-    clip |= ibuf_get_color_clip(c10, ibuf, x2, y1, extflag);
-    clip |= ibuf_get_color_clip(c01, ibuf, x1, y2, extflag);
-    clip |= ibuf_get_color_clip(c11, ibuf, x2, y2, extflag);
+    if (ibuf_is_tiled(ibuf) && x1 >= 0 && y1 >= 0 && x2 < ibuf->x && y2 < ibuf->y) {
+      /* Read all four pixels directly, no wrapping needed inside the image. */
+      unsigned char rect[2][2][4];
+      IMB_tiled_rect_get(tiles, ibuf, x1, y1, 2, 2, &rect[0][0][0]);
+      const float w[2][2] = {{w00, w10}, {w01, w11}};
+      zero_v4(col);
+      for (int j = 0; j < 2; j++) {
+        for (int i = 0; i < 2; i++) {
+          const float alpha = rect[j][i][3] * (1.0f / 255.0f);
+          const float fac = w[j][i] * (1.0f / 255.0f) * alpha;
+          col[0] += rect[j][i][0] * fac;
+          col[1] += rect[j][i][1] * fac;
+          col[2] += rect[j][i][2] * fac;
+          col[3] += w[j][i] * alpha;
+        }
+      }
+      return 0;
+    }
+    int clip = ibuf_get_color_clip(c00, ibuf, tiles, x1, y1, extflag);
+    clip |= ibuf_get_color_clip(c10, ibuf, tiles, x2, y1, extflag);
+    clip |= ibuf_get_color_clip(c01, ibuf, tiles, x1, y2, extflag);
+    clip |= ibuf_get_color_clip(c11, ibuf, tiles, x2, y2, extflag);
     col[0] = w00 * c00[0] + w10 * c10[0] + w01 * c01[0] + w11 * c11[0];
     col[1] = w00 * c00[1] + w10 * c10[1] + w01 * c01[1] + w11 * c11[1];
     col[2] = w00 * c00[2] + w10 * c10[2] + w01 * c01[2] + w11 * c11[2];
     col[3] = clip ? 0.0f : w00 * c00[3] + w10 * c10[3] + w01 * c01[3] + w11 * c11[3];
     return clip;
   }
-  return ibuf_get_color_clip(col, ibuf, (int)u, (int)v, extflag);
+  return ibuf_get_color_clip(col, ibuf, tiles, (int)u, (int)v, extflag);
 }
 
 static void area_sample(TexResult *texr, ImBuf *ibuf, float fx, float fy, afdata_t *AFD)
@@ -858,7 +916,7 @@ static void area_sample(TexResult *texr, ImBuf *ibuf, float fx, float fy, afdata
       const float pu = fx + su * AFD->dxt[0] + sv * AFD->dyt[0];
       const float pv = fy + su * AFD->dxt[1] + sv * AFD->dyt[1];
       const int out = ibuf_get_color_clip_bilerp(
-          tc, ibuf, pu * ibuf->x, pv * ibuf->y, AFD->intpol, AFD->extflag);
+          tc, ibuf, AFD->tiles, pu * ibuf->x, pv * ibuf->y, AFD->intpol, AFD->extflag);
       clip |= out;
       cw += out ? 0.0f : 1.0f;
       texr->tr += tc[0];
@@ -883,7 +941,7 @@ typedef struct ReadEWAData {
 static void ewa_read_pixel_cb(void *userdata, int x, int y, float result[4])
 {
   ReadEWAData *data = (ReadEWAData *)userdata;
-  ibuf_get_color_clip(result, data->ibuf, x, y, data->AFD->extflag);
+  ibuf_get_color_clip(result, data->ibuf, data->AFD->tiles, x, y, data->AFD->extflag);
 }
 
 static void ewa_eval(TexResult *texr, ImBuf *ibuf, float fx, float fy, afdata_t *AFD)
@@ -931,7 +989,7 @@ static void feline_eval(TexResult *texr, ImBuf *ibuf, float fx, float fy, afdata
     const float wt = EWA_WTS[(int)(n * n * D)];
 #endif
     /* `const int out =` */ ibuf_get_color_clip_bilerp(
-        tc, ibuf, ibuf->x * u, ibuf->y * v, AFD->intpol, AFD->extflag);
+        tc, ibuf, AFD->tiles, ibuf->x * u, ibuf->y * v, AFD->intpol, AFD->extflag);
     /* TXF alpha: `clip |= out;`
      * TXF alpha: `cw += out ? 0.0f : wt;` */
     texr->tr += tc[0] * wt;
@@ -990,7 +1048,8 @@ static void image_mipmap_test(Tex *tex, ImBuf *ibuf)
       }
       BLI_thread_unlock(LOCK_IMAGE);
     }
-    if (ibuf->mipmap[0] == NULL) {
+    /* Tiled images have their mipmaps stored in the file. */
+    if (ibuf->mipmap[0] == NULL && !ibuf_is_tiled(ibuf)) {
       BLI_thread_lock(LOCK_IMAGE);
       if (ibuf->mipmap[0] == NULL) {
         IMB_makemipmap(ibuf, tex->imaflag & TEX_GAUSS_MIP);
@@ -1047,10 +1106,10 @@ static int imagewraposa_aniso(Tex *tex,
     if (skip_load_image && !BKE_image_has_loaded_ibuf(ima)) {
       return retval;
     }
-    ibuf = BKE_image_pool_acquire_ibuf(ima, &tex->iuser, pool);
+    ibuf = BKE_image_pool_acquire_ibuf_tilecache(ima, &tex->iuser, pool);
   }
 
-  if ((ibuf == NULL) || ((ibuf->rect == NULL) && (ibuf->rect_float == NULL))) {
+  if ((ibuf == NULL) || !ibuf_has_pixels(ibuf)) {
     if (ima) {
       BKE_image_pool_release_ibuf(ima, ibuf, pool);
     }
@@ -1241,6 +1300,9 @@ static int imagewraposa_aniso(Tex *tex,
   copy_v2_v2(AFD.dyt, dyt);
   AFD.intpol = intpol;
   AFD.extflag = extflag;
+  ImTileReader tiles;
+  IMB_tile_reader_init(&tiles);
+  AFD.tiles = &tiles;
 
   /* brecht: added stupid clamping here, large dx/dy can give very large
    * filter sizes which take ages to render, it may be better to do this
@@ -1446,6 +1508,8 @@ static int imagewraposa_aniso(Tex *tex,
    * so for now commented out also disabled in imagewraposa()
    * to be able to compare results with blender's default texture filtering */
 
+  IMB_tile_reader_end(&tiles);
+
   /* brecht: tried to fix this, see "TXF alpha" comments */
 
   /* do not de-premul for generated alpha, it is already in straight */
@@ -1506,11 +1570,11 @@ int imagewraposa(Tex *tex,
       return retval;
     }
 
-    ibuf = BKE_image_pool_acquire_ibuf(ima, &tex->iuser, pool);
+    ibuf = BKE_image_pool_acquire_ibuf_tilecache(ima, &tex->iuser, pool);
 
     ima->flag |= IMA_USED_FOR_RENDER;
   }
-  if (ibuf == NULL || (ibuf->rect == NULL && ibuf->rect_float == NULL)) {
+  if (ibuf == NULL || !ibuf_has_pixels(ibuf)) {
     if (ima) {
       BKE_image_pool_release_ibuf(ima, ibuf, pool);
     }
@@ -1744,6 +1808,9 @@ int imagewraposa(Tex *tex,
     }
   }
 
+  ImTileReader tiles;
+  IMB_tile_reader_init(&tiles);
+
   /* Choice: */
   if (tex->imaflag & TEX_MIPMAP) {
     ImBuf *previbuf, *curibuf;
@@ -1793,10 +1860,18 @@ int imagewraposa(Tex *tex,
       // minx*= 1.35f;
       // miny*= 1.35f;
 
-      boxsample(
-          curibuf, fx - minx, fy - miny, fx + minx, fy + miny, texres, imaprepeat, imapextend);
+      boxsample(curibuf,
+                &tiles,
+                fx - minx,
+                fy - miny,
+                fx + minx,
+                fy + miny,
+                texres,
+                imaprepeat,
+                imapextend);
       val1 = texres->tr + texres->tg + texres->tb;
       boxsample(curibuf,
+                &tiles,
                 fx - minx + dxt[0],
                 fy - miny + dxt[1],
                 fx + minx + dxt[0],
@@ -1806,6 +1881,7 @@ int imagewraposa(Tex *tex,
                 imapextend);
       val2 = texr.tr + texr.tg + texr.tb;
       boxsample(curibuf,
+                &tiles,
                 fx - minx + dyt[0],
                 fy - miny + dyt[1],
                 fx + minx + dyt[0],
@@ -1821,8 +1897,15 @@ int imagewraposa(Tex *tex,
 
       if (previbuf != curibuf) { /* interpolate */
 
-        boxsample(
-            previbuf, fx - minx, fy - miny, fx + minx, fy + miny, &texr, imaprepeat, imapextend);
+        boxsample(previbuf,
+                  &tiles,
+                  fx - minx,
+                  fy - miny,
+                  fx + minx,
+                  fy + miny,
+                  &texr,
+                  imaprepeat,
+                  imapextend);
 
         /* calc rgb */
         dx = 2.0f * (pixsize - maxd) / pixsize;
@@ -1842,6 +1925,7 @@ int imagewraposa(Tex *tex,
 
         val1 = dy * val1 + dx * (texr.tr + texr.tg + texr.tb);
         boxsample(previbuf,
+                  &tiles,
                   fx - minx + dxt[0],
                   fy - miny + dxt[1],
                   fx + minx + dxt[0],
@@ -1851,6 +1935,7 @@ int imagewraposa(Tex *tex,
                   imapextend);
         val2 = dy * val2 + dx * (texr.tr + texr.tg + texr.tb);
         boxsample(previbuf,
+                  &tiles,
                   fx - minx + dyt[0],
                   fy - miny + dyt[1],
                   fx + minx + dyt[0],
@@ -1880,10 +1965,10 @@ int imagewraposa(Tex *tex,
       maxy = fy + miny;
       miny = fy - miny;
 
-      boxsample(curibuf, minx, miny, maxx, maxy, texres, imaprepeat, imapextend);
+      boxsample(curibuf, &tiles, minx, miny, maxx, maxy, texres, imaprepeat, imapextend);
 
       if (previbuf != curibuf) { /* interpolate */
-        boxsample(previbuf, minx, miny, maxx, maxy, &texr, imaprepeat, imapextend);
+        boxsample(previbuf, &tiles, minx, miny, maxx, maxy, &texr, imaprepeat, imapextend);
 
         fx = 2.0f * (pixsize - maxd) / pixsize;
 
@@ -1916,9 +2001,18 @@ int imagewraposa(Tex *tex,
     }
 
     if (texres->nor && (tex->imaflag & TEX_NORMALMAP) == 0) {
-      boxsample(ibuf, fx - minx, fy - miny, fx + minx, fy + miny, texres, imaprepeat, imapextend);
+      boxsample(ibuf,
+                &tiles,
+                fx - minx,
+                fy - miny,
+                fx + minx,
+                fy + miny,
+                texres,
+                imaprepeat,
+                imapextend);
       val1 = texres->tr + texres->tg + texres->tb;
       boxsample(ibuf,
+                &tiles,
                 fx - minx + dxt[0],
                 fy - miny + dxt[1],
                 fx + minx + dxt[0],
@@ -1928,6 +2022,7 @@ int imagewraposa(Tex *tex,
                 imapextend);
       val2 = texr.tr + texr.tg + texr.tb;
       boxsample(ibuf,
+                &tiles,
                 fx - minx + dyt[0],
                 fy - miny + dyt[1],
                 fx + minx + dyt[0],
@@ -1942,10 +2037,20 @@ int imagewraposa(Tex *tex,
       texres->nor[1] = (val1 - val3);
     }
     else {
-      boxsample(ibuf, fx - minx, fy - miny, fx + minx, fy + miny, texres, imaprepeat, imapextend);
+      boxsample(ibuf,
+                &tiles,
+                fx - minx,
+                fy - miny,
+                fx + minx,
+                fy + miny,
+                texres,
+                imaprepeat,
+                imapextend);
     }
   }
 
+  IMB_tile_reader_end(&tiles);
+
   if (tex->imaflag & TEX_CALCALPHA) {
     texres->ta = texres->tin = texres->ta * max_fff(texres->tr, texres->tg, texres->tb);
   }
@@ -1989,15 +2094,18 @@ void image_sample(
     Image *ima, float fx, float fy, float dx, float dy, float result[4], struct ImagePool *pool)
 {
   TexResult texres;
-  ImBuf *ibuf = BKE_image_pool_acquire_ibuf(ima, NULL, pool);
+  ImBuf *ibuf = BKE_image_pool_acquire_ibuf_tilecache(ima, NULL, pool);
 
   if (UNLIKELY(ibuf == NULL)) {
     zero_v4(result);
     return;
   }
 
+  ImTileReader tiles;
+  IMB_tile_reader_init(&tiles);
   texres.talpha = true; /* boxsample expects to be initialized */
-  boxsample(ibuf, fx, fy, fx + dx, fy + dy, &texres, 0, 1);
+  boxsample(ibuf, &tiles, fx, fy, fx + dx, fy + dy, &texres, 0, 1);
+  IMB_tile_reader_end(&tiles);
   copy_v4_v4(result, &texres.tr);
 
   ima->flag |= IMA_USED_FOR_RENDER;
@@ -2020,7 +2128,13 @@ void ibuf_sample(ImBuf *ibuf, float fx, float fy, float dx, float dy, float resu
   AFD.intpol = 1;
   AFD.extflag = TXC_EXTD;
 
+  ImTileReader tiles;
+  IMB_tile_reader_init(&tiles);
+  AFD.tiles = &tiles;
+
   ewa_eval(&texres, ibuf, fx, fy, &AFD);
 
+  IMB_tile_reader_end(&tiles);
+
   copy_v4_v4(result, &texres.tr);
 }
@@ -33,6 +33,7 @@ struct Scene;
 void SEQ_prefetch_stop_all(void);
 void SEQ_prefetch_stop(struct Scene *scene);
 bool SEQ_prefetch_need_redraw(struct Main *bmain, struct Scene *scene);
+float SEQ_prefetch_fill_rate_get(struct Scene *scene);
 
 #ifdef __cplusplus
 }
@@ -27,16 +27,24 @@
 extern "C" {
 #endif
 
+struct ImBuf;
 struct ListBase;
 struct Main;
 struct Scene;
+struct SeqRenderPipeline;
 struct Sequence;
 
+/* Prefetch renders several frames at once, each of its threads uses own task ID starting at
+ * #SEQ_TASK_PREFETCH_RENDER. */
+#define SEQ_PREFETCH_MAX_THREADS 8
+
 typedef enum eSeqTaskId {
   SEQ_TASK_MAIN_RENDER,
   SEQ_TASK_PREFETCH_RENDER,
 } eSeqTaskId;
 
+#define SEQ_TASK_MAX (SEQ_TASK_PREFETCH_RENDER + SEQ_PREFETCH_MAX_THREADS)
+
 typedef struct SeqRenderData {
   struct Main *bmain;
   struct Depsgraph *depsgraph;
@@ -79,6 +87,17 @@ void SEQ_render_new_render_data(struct Main *bmain,
 int SEQ_render_evaluate_frame(struct ListBase *seqbase, int timeline_frame);
 struct StripElem *SEQ_render_give_stripelem(struct Sequence *seq, int timeline_frame);
 
+/* Frame pipeline for final renders, see render_pipeline.c */
+struct SeqRenderPipeline *SEQ_render_pipeline_start(const SeqRenderData *context,
+                                                    int start_frame,
+                                                    int end_frame,
+                                                    int frame_step,
+                                                    int num_threads);
+bool SEQ_render_pipeline_give_ibufs(struct SeqRenderPipeline *pipeline,
+                                    int timeline_frame,
+                                    struct ImBuf **r_ibuf_arr);
+void SEQ_render_pipeline_end(struct SeqRenderPipeline *pipeline);
+
 void SEQ_render_imbuf_from_sequencer_space(struct Scene *scene, struct ImBuf *ibuf);
 void SEQ_render_pixel_from_sequencer_space_v4(struct Scene *scene, float pixel[4]);
 
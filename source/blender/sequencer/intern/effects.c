@@ -34,6 +34,7 @@
 #include "BLI_math.h" /* windows needs for M_PI */
 #include "BLI_path_util.h"
 #include "BLI_rect.h"
+#include "BLI_simd.h"
 #include "BLI_string.h"
 #include "BLI_threads.h"
 #include "BLI_utildefines.h"
@@ -53,8 +54,6 @@
 #include "IMB_imbuf_types.h"
 #include "IMB_metadata.h"
 
-#include "BLI_math_color_blend.h"
-
 #include "RNA_access.h"
 
 #include "RE_pipeline.h"
@@ -123,6 +122,75 @@ static void slice_get_float_buffers(const SeqRenderData *context,
   }
 }
 
+/*********************** Pixel rows *************************/
+
+/* The classic effects blend a row of pixels at a time, with the factor of the field the row
+ * belongs to. Where SSE2 is available byte rows are done four pixels at a time and float rows a
+ * pixel at a time, with the same results as the scalar code. Gamma cross looks up its curve in
+ * tables for every channel and stays scalar. */
+
+#ifdef BLI_HAVE_SSE2
+
+/* Broadcast the alpha of both pixels stored in 16 bit lanes to all their channels. */
+BLI_INLINE __m128i effect_alpha_epu16(__m128i x)
+{
+  x = _mm_shufflelo_epi16(x, _MM_SHUFFLE(3, 3, 3, 3));
+  return _mm_shufflehi_epi16(x, _MM_SHUFFLE(3, 3, 3, 3));
+}
+
+/* Keep the alpha of `a` in the four byte pixels of `result`. */
+BLI_INLINE __m128i effect_alpha_keep_byte(__m128i result, __m128i a)
+{
+  const __m128i alpha_mask = _mm_set1_epi32((int)0xff000000);
+  return _mm_or_si128(_mm_andnot_si128(alpha_mask, result), _mm_and_si128(alpha_mask, a));
+}
+
+/* Keep the alpha of `a` in the float pixel `result`. */
+BLI_INLINE __m128 effect_alpha_keep_float(__m128 result, __m128 a)
+{
+  const __m128 rgb_mask = _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1));
+  return _mm_or_ps(_mm_and_ps(rgb_mask, result), _mm_andnot_ps(rgb_mask, a));
+}
+
+/* Same as #straight_uchar_to_premul_float. */
+BLI_INLINE __m128 effect_straight_uchar_to_premul_sse2(const unsigned char color[4])
+{
+  const float alpha = color[3] * (1.0f / 255.0f);
+  const float fac = alpha * (1.0f / 255.0f);
+  int packed;
+
+  memcpy(&packed, color, sizeof(packed));
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i c = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(packed), zero), zero);
+  return _mm_mul_ps(_mm_cvtepi32_ps(c), _mm_set_ps(1.0f / 255.0f, fac, fac, fac));
+}
+
+/* Same as #premul_float_to_straight_uchar. */
+BLI_INLINE void effect_premul_float_to_straight_uchar_sse2(unsigned char result[4], __m128 color)
+{
+  const float alpha = _mm_cvtss_f32(_mm_shuffle_ps(color, color, _MM_SHUFFLE(3, 3, 3, 3)));
+
+  if (!(alpha == 0.0f || alpha == 1.0f)) {
+    const float alpha_inv = 1.0f / alpha;
+    color = _mm_mul_ps(color, _mm_set_ps(1.0f, alpha_inv, alpha_inv, alpha_inv));
+  }
+
+  /* Clamp and round like #unit_float_to_uchar_clamp. */
+  const __m128 is_zero = _mm_cmple_ps(color, _mm_setzero_ps());
+  const __m128 is_one = _mm_cmpgt_ps(color, _mm_set1_ps(1.0f - 0.5f / 255.0f));
+  __m128 value = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(255.0f), color), _mm_set1_ps(0.5f));
+  value = _mm_andnot_ps(_mm_or_ps(is_zero, is_one), value);
+  value = _mm_or_ps(value, _mm_and_ps(is_one, _mm_set1_ps(255.0f)));
+
+  __m128i packed = _mm_cvttps_epi32(value);
+  packed = _mm_packs_epi32(packed, packed);
+  packed = _mm_packus_epi16(packed, packed);
+  const int packed_int = _mm_cvtsi128_si32(packed);
+  memcpy(result, &packed_int, sizeof(packed_int));
+}
+
+#endif /* BLI_HAVE_SSE2 */
+
 /*********************** Glow effect *************************/
 
 enum {
@@ -204,6 +272,46 @@ static void init_alpha_over_or_under(Sequence *seq)
   seq->seq1 = seq2;
 }
 
+static void do_alphaover_row_byte(float fac,
+                                  int width,
+                                  const unsigned char *cp1,
+                                  const unsigned char *cp2,
+                                  unsigned char *rt)
+{
+  if (fac <= 0.0f) {
+    memcpy(rt, cp2, sizeof(unsigned char[4]) * width);
+    return;
+  }
+
+  for (; width > 0; width--, cp1 += 4, cp2 += 4, rt += 4) {
+    /* rt = rt1 over rt2  (alpha from rt1) */
+    const float mfac = 1.0f - fac * (cp1[3] * (1.0f / 255.0f));
+
+    if (mfac <= 0.0f) {
+      *((unsigned int *)rt) = *((const unsigned int *)cp1);
+      continue;
+    }
+
+#ifdef BLI_HAVE_SSE2
+    const __m128 rt1 = effect_straight_uchar_to_premul_sse2(cp1);
+    const __m128 rt2 = effect_straight_uchar_to_premul_sse2(cp2);
+    effect_premul_float_to_straight_uchar_sse2(
+        rt, _mm_add_ps(_mm_mul_ps(_mm_set1_ps(fac), rt1), _mm_mul_ps(_mm_set1_ps(mfac), rt2)));
+#else
+    float tempc[4], rt1[4], rt2[4];
+    straight_uchar_to_premul_float(rt1, cp1);
+    straight_uchar_to_premul_float(rt2, cp2);
+
+    tempc[0] = fac * rt1[0] + mfac * rt2[0];
+    tempc[1] = fac * rt1[1] + mfac * rt2[1];
+    tempc[2] = fac * rt1[2] + mfac * rt2[2];
+    tempc[3] = fac * rt1[3] + mfac * rt2[3];
+
+    premul_float_to_straight_uchar(rt, tempc);
+#endif
+  }
+}
+
 static void do_alphaover_effect_byte(float facf0,
                                      float facf1,
                                      int x,
@@ -212,149 +320,46 @@ static void do_alphaover_effect_byte(float facf0,
                                      unsigned char *rect2,
                                      unsigned char *out)
 {
-  float fac2, mfac, fac, fac4;
-  int xo;
-  unsigned char *cp1, *cp2, *rt;
-  float tempc[4], rt1[4], rt2[4];
-
-  xo = x;
-  cp1 = rect1;
-  cp2 = rect2;
-  rt = out;
-
-  fac2 = facf0;
-  fac4 = facf1;
-
-  while (y--) {
-    x = xo;
-    while (x--) {
-      /* rt = rt1 over rt2  (alpha from rt1) */
-
-      straight_uchar_to_premul_float(rt1, cp1);
-      straight_uchar_to_premul_float(rt2, cp2);
-
-      fac = fac2;
-      mfac = 1.0f - fac2 * rt1[3];
+  for (int i = 0; i < y; i++, rect1 += x * 4, rect2 += x * 4, out += x * 4) {
+    do_alphaover_row_byte((i & 1) ? facf1 : facf0, x, rect1, rect2, out);
+  }
+}
 
-      if (fac <= 0.0f) {
-        *((unsigned int *)rt) = *((unsigned int *)cp2);
-      }
-      else if (mfac <= 0.0f) {
-        *((unsigned int *)rt) = *((unsigned int *)cp1);
-      }
-      else {
-        tempc[0] = fac * rt1[0] + mfac * rt2[0];
-        tempc[1] = fac * rt1[1] + mfac * rt2[1];
-        tempc[2] = fac * rt1[2] + mfac * rt2[2];
-        tempc[3] = fac * rt1[3] + mfac * rt2[3];
+static void do_alphaover_row_float(
+    float fac, int width, const float *rt1, const float *rt2, float *rt)
+{
+  if (fac <= 0.0f) {
+    memcpy(rt, rt2, sizeof(float[4]) * width);
+    return;
+  }
 
-        premul_float_to_straight_uchar(rt, tempc);
-      }
-      cp1 += 4;
-      cp2 += 4;
-      rt += 4;
-    }
+  for (; width > 0; width--, rt1 += 4, rt2 += 4, rt += 4) {
+    /* rt = rt1 over rt2  (alpha from rt1) */
+    const float mfac = 1.0f - (fac * rt1[3]);
 
-    if (y == 0) {
-      break;
+    if (mfac <= 0.0f) {
+      memcpy(rt, rt1, sizeof(float[4]));
+      continue;
     }
-    y--;
-
-    x = xo;
-    while (x--) {
-      straight_uchar_to_premul_float(rt1, cp1);
-      straight_uchar_to_premul_float(rt2, cp2);
-
-      fac = fac4;
-      mfac = 1.0f - (fac4 * rt1[3]);
 
-      if (fac <= 0.0f) {
-        *((unsigned int *)rt) = *((unsigned int *)cp2);
-      }
-      else if (mfac <= 0.0f) {
-        *((unsigned int *)rt) = *((unsigned int *)cp1);
-      }
-      else {
-        tempc[0] = fac * rt1[0] + mfac * rt2[0];
-        tempc[1] = fac * rt1[1] + mfac * rt2[1];
-        tempc[2] = fac * rt1[2] + mfac * rt2[2];
-        tempc[3] = fac * rt1[3] + mfac * rt2[3];
-
-        premul_float_to_straight_uchar(rt, tempc);
-      }
-      cp1 += 4;
-      cp2 += 4;
-      rt += 4;
-    }
+#ifdef BLI_HAVE_SSE2
+    _mm_storeu_ps(rt,
+                  _mm_add_ps(_mm_mul_ps(_mm_set1_ps(fac), _mm_loadu_ps(rt1)),
+                             _mm_mul_ps(_mm_set1_ps(mfac), _mm_loadu_ps(rt2))));
+#else
+    rt[0] = fac * rt1[0] + mfac * rt2[0];
+    rt[1] = fac * rt1[1] + mfac * rt2[1];
+    rt[2] = fac * rt1[2] + mfac * rt2[2];
+    rt[3] = fac * rt1[3] + mfac * rt2[3];
+#endif
   }
 }
 
 static void do_alphaover_effect_float(
     float facf0, float facf1, int x, int y, float *rect1, float *rect2, float *out)
 {
-  float fac2, mfac, fac, fac4;
-  int xo;
-  float *rt1, *rt2, *rt;
-
-  xo = x;
-  rt1 = rect1;
-  rt2 = rect2;
-  rt = out;
-
-  fac2 = facf0;
-  fac4 = facf1;
-
-  while (y--) {
-    x = xo;
-    while (x--) {
-      /* rt = rt1 over rt2  (alpha from rt1) */
-
-      fac = fac2;
-      mfac = 1.0f - (fac2 * rt1[3]);
-
-      if (fac <= 0.0f) {
-        memcpy(rt, rt2, sizeof(float[4]));
-      }
-      else if (mfac <= 0) {
-        memcpy(rt, rt1, sizeof(float[4]));
-      }
-      else {
-        rt[0] = fac * rt1[0] + mfac * rt2[0];
-        rt[1] = fac * rt1[1] + mfac * rt2[1];
-        rt[2] = fac * rt1[2] + mfac * rt2[2];
-        rt[3] = fac * rt1[3] + mfac * rt2[3];
-      }
-      rt1 += 4;
-      rt2 += 4;
-      rt += 4;
-    }
-
-    if (y == 0) {
-      break;
-    }
-    y--;
-
-    x = xo;
-    while (x--) {
-      fac = fac4;
-      mfac = 1.0f - (fac4 * rt1[3]);
-
-      if (fac <= 0.0f) {
-        memcpy(rt, rt2, sizeof(float[4]));
-      }
-      else if (mfac <= 0.0f) {
-        memcpy(rt, rt1, sizeof(float[4]));
-      }
-      else {
-        rt[0] = fac * rt1[0] + mfac * rt2[0];
-        rt[1] = fac * rt1[1] + mfac * rt2[1];
-        rt[2] = fac * rt1[2] + mfac * rt2[2];
-        rt[3] = fac * rt1[3] + mfac * rt2[3];
-      }
-      rt1 += 4;
-      rt2 += 4;
-      rt += 4;
-    }
+  for (int i = 0; i < y; i++, rect1 += x * 4, rect2 += x * 4, out += x * 4) {
+    do_alphaover_row_float((i & 1) ? facf1 : facf0, x, rect1, rect2, out);
   }
 }
 
@@ -390,6 +395,55 @@ static void do_alphaover_effect(const SeqRenderData *context,
 
 /*********************** Alpha Under *************************/
 
+static void do_alphaunder_row_byte(float fac,
+                                   int width,
+                                   const unsigned char *cp1,
+                                   const unsigned char *cp2,
+                                   unsigned char *rt)
+{
+  for (; width > 0; width--, cp1 += 4, cp2 += 4, rt += 4) {
+    /* rt = rt1 under rt2  (alpha from rt2) */
+    const float alpha2 = cp2[3] * (1.0f / 255.0f);
+
+    /* this complex optimization is because the
+     * 'skybuf' can be crossed in
+     */
+    if (alpha2 <= 0.0f && fac >= 1.0f) {
+      *((unsigned int *)rt) = *((const unsigned int *)cp1);
+      continue;
+    }
+    if (alpha2 >= 1.0f) {
+      *((unsigned int *)rt) = *((const unsigned int *)cp2);
+      continue;
+    }
+
+    const float fac_under = fac * (1.0f - alpha2);
+
+    if (fac_under <= 0.0f) {
+      *((unsigned int *)rt) = *((const unsigned int *)cp2);
+      continue;
+    }
+
+#ifdef BLI_HAVE_SSE2
+    const __m128 rt1 = effect_straight_uchar_to_premul_sse2(cp1);
+    const __m128 rt2 = effect_straight_uchar_to_premul_sse2(cp2);
+    effect_premul_float_to_straight_uchar_sse2(
+        rt, _mm_add_ps(_mm_mul_ps(_mm_set1_ps(fac_under), rt1), rt2));
+#else
+    float tempc[4], rt1[4], rt2[4];
+    straight_uchar_to_premul_float(rt1, cp1);
+    straight_uchar_to_premul_float(rt2, cp2);
+
+    tempc[0] = (fac_under * rt1[0] + rt2[0]);
+    tempc[1] = (fac_under * rt1[1] + rt2[1]);
+    tempc[2] = (fac_under * rt1[2] + rt2[2]);
+    tempc[3] = (fac_under * rt1[3] + rt2[3]);
+
+    premul_float_to_straight_uchar(rt, tempc);
+#endif
+  }
+}
+
 static void do_alphaunder_effect_byte(float facf0,
                                       float facf1,
                                       int x,
@@ -398,170 +452,53 @@ static void do_alphaunder_effect_byte(float facf0,
                                       unsigned char *rect2,
                                       unsigned char *out)
 {
-  float fac2, fac, fac4;
-  int xo;
-  unsigned char *cp1, *cp2, *rt;
-  float tempc[4], rt1[4], rt2[4];
-
-  xo = x;
-  cp1 = rect1;
-  cp2 = rect2;
-  rt = out;
-
-  fac2 = facf0;
-  fac4 = facf1;
-
-  while (y--) {
-    x = xo;
-    while (x--) {
-      /* rt = rt1 under rt2  (alpha from rt2) */
-      straight_uchar_to_premul_float(rt1, cp1);
-      straight_uchar_to_premul_float(rt2, cp2);
-
-      /* this complex optimization is because the
-       * 'skybuf' can be crossed in
-       */
-      if (rt2[3] <= 0.0f && fac2 >= 1.0f) {
-        *((unsigned int *)rt) = *((unsigned int *)cp1);
-      }
-      else if (rt2[3] >= 1.0f) {
-        *((unsigned int *)rt) = *((unsigned int *)cp2);
-      }
-      else {
-        fac = (fac2 * (1.0f - rt2[3]));
+  for (int i = 0; i < y; i++, rect1 += x * 4, rect2 += x * 4, out += x * 4) {
+    do_alphaunder_row_byte((i & 1) ? facf1 : facf0, x, rect1, rect2, out);
+  }
+}
 
-        if (fac <= 0) {
-          *((unsigned int *)rt) = *((unsigned int *)cp2);
-        }
-        else {
-          tempc[0] = (fac * rt1[0] + rt2[0]);
-          tempc[1] = (fac * rt1[1] + rt2[1]);
-          tempc[2] = (fac * rt1[2] + rt2[2]);
-          tempc[3] = (fac * rt1[3] + rt2[3]);
+static void do_alphaunder_row_float(
+    float fac, int width, const float *rt1, const float *rt2, float *rt)
+{
+  for (; width > 0; width--, rt1 += 4, rt2 += 4, rt += 4) {
+    /* rt = rt1 under rt2  (alpha from rt2) */
 
-          premul_float_to_straight_uchar(rt, tempc);
-        }
-      }
-      cp1 += 4;
-      cp2 += 4;
-      rt += 4;
+    /* this complex optimization is because the
+     * 'skybuf' can be crossed in
+     */
+    if (rt2[3] <= 0 && fac >= 1.0f) {
+      memcpy(rt, rt1, sizeof(float[4]));
+      continue;
     }
-
-    if (y == 0) {
-      break;
+    if (rt2[3] >= 1.0f) {
+      memcpy(rt, rt2, sizeof(float[4]));
+      continue;
     }
-    y--;
-
-    x = xo;
-    while (x--) {
-      straight_uchar_to_premul_float(rt1, cp1);
-      straight_uchar_to_premul_float(rt2, cp2);
 
-      if (rt2[3] <= 0.0f && fac4 >= 1.0f) {
-        *((unsigned int *)rt) = *((unsigned int *)cp1);
-      }
-      else if (rt2[3] >= 1.0f) {
-        *((unsigned int *)rt) = *((unsigned int *)cp2);
-      }
-      else {
-        fac = (fac4 * (1.0f - rt2[3]));
+    const float fac_under = fac * (1.0f - rt2[3]);
 
-        if (fac <= 0) {
-          *((unsigned int *)rt) = *((unsigned int *)cp2);
-        }
-        else {
-          tempc[0] = (fac * rt1[0] + rt2[0]);
-          tempc[1] = (fac * rt1[1] + rt2[1]);
-          tempc[2] = (fac * rt1[2] + rt2[2]);
-          tempc[3] = (fac * rt1[3] + rt2[3]);
-
-          premul_float_to_straight_uchar(rt, tempc);
-        }
-      }
-      cp1 += 4;
-      cp2 += 4;
-      rt += 4;
+    if (fac_under == 0) {
+      memcpy(rt, rt2, sizeof(float[4]));
+      continue;
     }
+
+#ifdef BLI_HAVE_SSE2
+    const __m128 s1 = _mm_mul_ps(_mm_set1_ps(fac_under), _mm_loadu_ps(rt1));
+    _mm_storeu_ps(rt, _mm_add_ps(s1, _mm_loadu_ps(rt2)));
+#else
+    rt[0] = fac_under * rt1[0] + rt2[0];
+    rt[1] = fac_under * rt1[1] + rt2[1];
+    rt[2] = fac_under * rt1[2] + rt2[2];
+    rt[3] = fac_under * rt1[3] + rt2[3];
+#endif
   }
 }
 
 static void do_alphaunder_effect_float(
     float facf0, float facf1, int x, int y, float *rect1, float *rect2, float *out)
 {
-  float fac2, fac, fac4;
-  int xo;
-  float *rt1, *rt2, *rt;
-
-  xo = x;
-  rt1 = rect1;
-  rt2 = rect2;
-  rt = out;
-
-  fac2 = facf0;
-  fac4 = facf1;
-
-  while (y--) {
-    x = xo;
-    while (x--) {
-      /* rt = rt1 under rt2  (alpha from rt2) */
-
-      /* this complex optimization is because the
-       * 'skybuf' can be crossed in
-       */
-      if (rt2[3] <= 0 && fac2 >= 1.0f) {
-        memcpy(rt, rt1, sizeof(float[4]));
-      }
-      else if (rt2[3] >= 1.0f) {
-        memcpy(rt, rt2, sizeof(float[4]));
-      }
-      else {
-        fac = fac2 * (1.0f - rt2[3]);
-
-        if (fac == 0) {
-          memcpy(rt, rt2, sizeof(float[4]));
-        }
-        else {
-          rt[0] = fac * rt1[0] + rt2[0];
-          rt[1] = fac * rt1[1] + rt2[1];
-          rt[2] = fac * rt1[2] + rt2[2];
-          rt[3] = fac * rt1[3] + rt2[3];
-        }
-      }
-      rt1 += 4;
-      rt2 += 4;
-      rt += 4;
-    }
-
-    if (y == 0) {
-      break;
-    }
-    y--;
-
-    x = xo;
-    while (x--) {
-      if (rt2[3] <= 0 && fac4 >= 1.0f) {
-        memcpy(rt, rt1, sizeof(float[4]));
-      }
-      else if (rt2[3] >= 1.0f) {
-        memcpy(rt, rt2, sizeof(float[4]));
-      }
-      else {
-        fac = fac4 * (1.0f - rt2[3]);
-
-        if (fac == 0) {
-          memcpy(rt, rt2, sizeof(float[4]));
-        }
-        else {
-          rt[0] = fac * rt1[0] + rt2[0];
-          rt[1] = fac * rt1[1] + rt2[1];
-          rt[2] = fac * rt1[2] + rt2[2];
-          rt[3] = fac * rt1[3] + rt2[3];
-        }
-      }
-      rt1 += 4;
-      rt2 += 4;
-      rt += 4;
-    }
+  for (int i = 0; i < y; i++, rect1 += x * 4, rect2 += x * 4, out += x * 4) {
+    do_alphaunder_row_float((i & 1) ? facf1 : facf0, x, rect1, rect2, out);
   }
 }
 
@@ -597,6 +534,45 @@ static void do_alphaunder_effect(const SeqRenderData *context,
 
 /*********************** Cross *************************/
 
+static void do_cross_row_byte(float facf,
+                              int width,
+                              const unsigned char *rt1,
+                              const unsigned char *rt2,
+                              unsigned char *rt)
+{
+  const int fac2 = (int)(256.0f * facf);
+  const int fac1 = 256 - fac2;
+  int i = 0;
+
+#ifdef BLI_HAVE_SSE2
+  /* The weighted sum fits in 16 bits as long as both factors are in range. */
+  if (fac2 >= 0 && fac2 <= 256) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i f1 = _mm_set1_epi16((short)fac1);
+    const __m128i f2 = _mm_set1_epi16((short)fac2);
+
+    for (; i + 4 <= width; i += 4) {
+      const __m128i s1 = _mm_loadu_si128((const __m128i *)(rt1 + i * 4));
+      const __m128i s2 = _mm_loadu_si128((const __m128i *)(rt2 + i * 4));
+      const __m128i lo = _mm_add_epi16(_mm_mullo_epi16(f1, _mm_unpacklo_epi8(s1, zero)),
+                                       _mm_mullo_epi16(f2, _mm_unpacklo_epi8(s2, zero)));
+      const __m128i hi = _mm_add_epi16(_mm_mullo_epi16(f1, _mm_unpackhi_epi8(s1, zero)),
+                                       _mm_mullo_epi16(f2, _mm_unpackhi_epi8(s2, zero)));
+      _mm_storeu_si128((__m128i *)(rt + i * 4),
+                       _mm_packus_epi16(_mm_srli_epi16(lo, 8), _mm_srli_epi16(hi, 8)));
+    }
+  }
+#endif
+
+  for (; i < width; i++) {
+    const int j = i * 4;
+    rt[j + 0] = (fac1 * rt1[j + 0] + fac2 * rt2[j + 0]) >> 8;
+    rt[j + 1] = (fac1 * rt1[j + 1] + fac2 * rt2[j + 1]) >> 8;
+    rt[j + 2] = (fac1 * rt1[j + 2] + fac2 * rt2[j + 2]) >> 8;
+    rt[j + 3] = (fac1 * rt1[j + 3] + fac2 * rt2[j + 3]) >> 8;
+  }
+}
+
 static void do_cross_effect_byte(float facf0,
                                  float facf1,
                                  int x,
@@ -605,98 +581,39 @@ static void do_cross_effect_byte(float facf0,
                                  unsigned char *rect2,
                                  unsigned char *out)
 {
-  int fac1, fac2, fac3, fac4;
-  int xo;
-  unsigned char *rt1, *rt2, *rt;
-
-  xo = x;
-  rt1 = rect1;
-  rt2 = rect2;
-  rt = out;
-
-  fac2 = (int)(256.0f * facf0);
-  fac1 = 256 - fac2;
-  fac4 = (int)(256.0f * facf1);
-  fac3 = 256 - fac4;
-
-  while (y--) {
-    x = xo;
-    while (x--) {
-      rt[0] = (fac1 * rt1[0] + fac2 * rt2[0]) >> 8;
-      rt[1] = (fac1 * rt1[1] + fac2 * rt2[1]) >> 8;
-      rt[2] = (fac1 * rt1[2] + fac2 * rt2[2]) >> 8;
-      rt[3] = (fac1 * rt1[3] + fac2 * rt2[3]) >> 8;
+  for (int i = 0; i < y; i++, rect1 += x * 4, rect2 += x * 4, out += x * 4) {
+    do_cross_row_byte((i & 1) ? facf1 : facf0, x, rect1, rect2, out);
+  }
+}
 
-      rt1 += 4;
-      rt2 += 4;
-      rt += 4;
-    }
+static void do_cross_row_float(
+    float fac2, int width, const float *rt1, const float *rt2, float *rt)
+{
+  const float fac1 = 1.0f - fac2;
 
-    if (y == 0) {
-      break;
-    }
-    y--;
+#ifdef BLI_HAVE_SSE2
+  const __m128 f1 = _mm_set1_ps(fac1);
+  const __m128 f2 = _mm_set1_ps(fac2);
 
-    x = xo;
-    while (x--) {
-      rt[0] = (fac3 * rt1[0] + fac4 * rt2[0]) >> 8;
-      rt[1] = (fac3 * rt1[1] + fac4 * rt2[1]) >> 8;
-      rt[2] = (fac3 * rt1[2] + fac4 * rt2[2]) >> 8;
-      rt[3] = (fac3 * rt1[3] + fac4 * rt2[3]) >> 8;
-
-      rt1 += 4;
-      rt2 += 4;
-      rt += 4;
-    }
+  for (; width > 0; width--, rt1 += 4, rt2 += 4, rt += 4) {
+    _mm_storeu_ps(
+        rt, _mm_add_ps(_mm_mul_ps(f1, _mm_loadu_ps(rt1)), _mm_mul_ps(f2, _mm_loadu_ps(rt2))));
+  }
+#else
+  for (; width > 0; width--, rt1 += 4, rt2 += 4, rt += 4) {
+    rt[0] = fac1 * rt1[0] + fac2 * rt2[0];
+    rt[1] = fac1 * rt1[1] + fac2 * rt2[1];
+    rt[2] = fac1 * rt1[2] + fac2 * rt2[2];
+    rt[3] = fac1 * rt1[3] + fac2 * rt2[3];
   }
+#endif
 }
 
 static void do_cross_effect_float(
     float facf0, float facf1, int x, int y, float *rect1, float *rect2, float *out)
 {
-  float fac1, fac2, fac3, fac4;
-  int xo;
-  float *rt1, *rt2, *rt;
-
-  xo = x;
-  rt1 = rect1;
-  rt2 = rect2;
-  rt = out;
-
-  fac2 = facf0;
-  fac1 = 1.0f - fac2;
-  fac4 = facf1;
-  fac3 = 1.0f - fac4;
-
-  while (y--) {
-    x = xo;
-    while (x--) {
-      rt[0] = fac1 * rt1[0] + fac2 * rt2[0];
-      rt[1] = fac1 * rt1[1] + fac2 * rt2[1];
-      rt[2] = fac1 * rt1[2] + fac2 * rt2[2];
-      rt[3] = fac1 * rt1[3] + fac2 * rt2[3];
-
-      rt1 += 4;
-      rt2 += 4;
-      rt += 4;
-    }
-
-    if (y == 0) {
-      break;
-    }
-    y--;
-
-    x = xo;
-    while (x--) {
-      rt[0] = fac3 * rt1[0] + fac4 * rt2[0];
-      rt[1] = fac3 * rt1[1] + fac4 * rt2[1];
-      rt[2] = fac3 * rt1[2] + fac4 * rt2[2];
-      rt[3] = fac3 * rt1[3] + fac4 * rt2[3];
-
-      rt1 += 4;
-      rt2 += 4;
-      rt += 4;
-    }
+  for (int i = 0; i < y; i++, rect1 += x * 4, rect2 += x * 4, out += x * 4) {
+    do_cross_row_float((i & 1) ? facf1 : facf0, x, rect1, rect2, out);
   }
 }
 
@@ -1030,6 +947,44 @@ static void do_gammacross_effect(const SeqRenderData *context,
 
 /*********************** Add *************************/
 
+static void do_add_row_byte(float facf,
+                            int width,
+                            const unsigned char *cp1,
+                            const unsigned char *cp2,
+                            unsigned char *rt)
+{
+  const int fac = (int)(256.0f * facf);
+  int i = 0;
+
+#ifdef BLI_HAVE_SSE2
+  /* The per pixel factor fits in 16 bits as long as the factor is in range. */
+  if (fac >= 0 && fac <= 256) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i f = _mm_set1_epi16((short)fac);
+
+    for (; i + 4 <= width; i += 4) {
+      const __m128i s1 = _mm_loadu_si128((const __m128i *)(cp1 + i * 4));
+      const __m128i s2 = _mm_loadu_si128((const __m128i *)(cp2 + i * 4));
+      const __m128i s2_lo = _mm_unpacklo_epi8(s2, zero);
+      const __m128i s2_hi = _mm_unpackhi_epi8(s2, zero);
+      const __m128i lo = _mm_mulhi_epu16(_mm_mullo_epi16(f, effect_alpha_epu16(s2_lo)), s2_lo);
+      const __m128i hi = _mm_mulhi_epu16(_mm_mullo_epi16(f, effect_alpha_epu16(s2_hi)), s2_hi);
+      const __m128i result = _mm_adds_epu8(s1, _mm_packus_epi16(lo, hi));
+      _mm_storeu_si128((__m128i *)(rt + i * 4), effect_alpha_keep_byte(result, s1));
+    }
+  }
+#endif
+
+  for (; i < width; i++) {
+    const int j = i * 4;
+    const int m = fac * (int)cp2[j + 3];
+    rt[j + 0] = min_ii(cp1[j + 0] + ((m * cp2[j + 0]) >> 16), 255);
+    rt[j + 1] = min_ii(cp1[j + 1] + ((m * cp2[j + 1]) >> 16), 255);
+    rt[j + 2] = min_ii(cp1[j + 2] + ((m * cp2[j + 2]) >> 16), 255);
+    rt[j + 3] = cp1[j + 3];
+  }
+}
+
 static void do_add_effect_byte(float facf0,
                                float facf1,
                                int x,
@@ -1038,98 +993,33 @@ static void do_add_effect_byte(float facf0,
                                unsigned char *rect2,
                                unsigned char *out)
 {
-  int xo, fac1, fac3;
-  unsigned char *cp1, *cp2, *rt;
-
-  xo = x;
-  cp1 = rect1;
-  cp2 = rect2;
-  rt = out;
-
-  fac1 = (int)(256.0f * facf0);
-  fac3 = (int)(256.0f * facf1);
-
-  while (y--) {
-    x = xo;
-
-    while (x--) {
-      const int m = fac1 * (int)cp2[3];
-      rt[0] = min_ii(cp1[0] + ((m * cp2[0]) >> 16), 255);
-      rt[1] = min_ii(cp1[1] + ((m * cp2[1]) >> 16), 255);
-      rt[2] = min_ii(cp1[2] + ((m * cp2[2]) >> 16), 255);
-      rt[3] = cp1[3];
-
-      cp1 += 4;
-      cp2 += 4;
-      rt += 4;
-    }
-
-    if (y == 0) {
-      break;
-    }
-    y--;
-
-    x = xo;
-    while (x--) {
-      const int m = fac3 * (int)cp2[3];
-      rt[0] = min_ii(cp1[0] + ((m * cp2[0]) >> 16), 255);
-      rt[1] = min_ii(cp1[1] + ((m * cp2[1]) >> 16), 255);
-      rt[2] = min_ii(cp1[2] + ((m * cp2[2]) >> 16), 255);
-      rt[3] = cp1[3];
+  for (int i = 0; i < y; i++, rect1 += x * 4, rect2 += x * 4, out += x * 4) {
+    do_add_row_byte((i & 1) ? facf1 : facf0, x, rect1, rect2, out);
+  }
+}
 
-      cp1 += 4;
-      cp2 += 4;
-      rt += 4;
-    }
+static void do_add_row_float(float fac, int width, const float *rt1, const float *rt2, float *rt)
+{
+  for (; width > 0; width--, rt1 += 4, rt2 += 4, rt += 4) {
+    const float m = (1.0f - (rt1[3] * (1.0f - fac))) * rt2[3];
+#ifdef BLI_HAVE_SSE2
+    const __m128 s1 = _mm_loadu_ps(rt1);
+    const __m128 result = _mm_add_ps(s1, _mm_mul_ps(_mm_set1_ps(m), _mm_loadu_ps(rt2)));
+    _mm_storeu_ps(rt, effect_alpha_keep_float(result, s1));
+#else
+    rt[0] = rt1[0] + m * rt2[0];
+    rt[1] = rt1[1] + m * rt2[1];
+    rt[2] = rt1[2] + m * rt2[2];
+    rt[3] = rt1[3];
+#endif
   }
 }
 
 static void do_add_effect_float(
     float facf0, float facf1, int x, int y, float *rect1, float *rect2, float *out)
 {
-  int xo;
-  float fac1, fac3;
-  float *rt1, *rt2, *rt;
-
-  xo = x;
-  rt1 = rect1;
-  rt2 = rect2;
-  rt = out;
-
-  fac1 = facf0;
-  fac3 = facf1;
-
-  while (y--) {
-    x = xo;
-    while (x--) {
-      const float m = (1.0f - (rt1[3] * (1.0f - fac1))) * rt2[3];
-      rt[0] = rt1[0] + m * rt2[0];
-      rt[1] = rt1[1] + m * rt2[1];
-      rt[2] = rt1[2] + m * rt2[2];
-      rt[3] = rt1[3];
-
-      rt1 += 4;
-      rt2 += 4;
-      rt += 4;
-    }
-
-    if (y == 0) {
-      break;
-    }
-    y--;
-
-    x = xo;
-    while (x--) {
-      const float m = (1.0f - (rt1[3] * (1.0f - fac3))) * rt2[3];
-      rt[0] = rt1[0] + m * rt2[0];
-      rt[1] = rt1[1] + m * rt2[1];
-      rt[2] = rt1[2] + m * rt2[2];
-      rt[3] = rt1[3];
-
-      rt1 += 4;
-      rt2 += 4;
-      rt += 4;
-    }
+  for (int i = 0; i < y; i++, rect1 += x * 4, rect2 += x * 4, out += x * 4) {
+    do_add_row_float((i & 1) ? facf1 : facf0, x, rect1, rect2, out);
   }
 }
 
@@ -1165,106 +1055,83 @@ static void do_add_effect(const SeqRenderData *context,
 
 /*********************** Sub *************************/
 
-static void do_sub_effect_byte(float facf0,
-                               float facf1,
-                               int x,
-                               int y,
-                               unsigned char *rect1,
-                               unsigned char *rect2,
-                               unsigned char *out)
+static void do_sub_row_byte(float facf,
+                            int width,
+                            const unsigned char *cp1,
+                            const unsigned char *cp2,
+                            unsigned char *rt)
 {
-  int xo, fac1, fac3;
-  unsigned char *cp1, *cp2, *rt;
+  const int fac = (int)(256.0f * facf);
+  int i = 0;
 
-  xo = x;
-  cp1 = rect1;
-  cp2 = rect2;
-  rt = out;
+#ifdef BLI_HAVE_SSE2
+  /* The per pixel factor fits in 16 bits as long as the factor is in range. */
+  if (fac >= 0 && fac <= 256) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i f = _mm_set1_epi16((short)fac);
 
-  fac1 = (int)(256.0f * facf0);
-  fac3 = (int)(256.0f * facf1);
-
-  while (y--) {
-    x = xo;
-    while (x--) {
-      const int m = fac1 * (int)cp2[3];
-      rt[0] = max_ii(cp1[0] - ((m * cp2[0]) >> 16), 0);
-      rt[1] = max_ii(cp1[1] - ((m * cp2[1]) >> 16), 0);
-      rt[2] = max_ii(cp1[2] - ((m * cp2[2]) >> 16), 0);
-      rt[3] = cp1[3];
-
-      cp1 += 4;
-      cp2 += 4;
-      rt += 4;
+    for (; i + 4 <= width; i += 4) {
+      const __m128i s1 = _mm_loadu_si128((const __m128i *)(cp1 + i * 4));
+      const __m128i s2 = _mm_loadu_si128((const __m128i *)(cp2 + i * 4));
+      const __m128i s2_lo = _mm_unpacklo_epi8(s2, zero);
+      const __m128i s2_hi = _mm_unpackhi_epi8(s2, zero);
+      const __m128i lo = _mm_mulhi_epu16(_mm_mullo_epi16(f, effect_alpha_epu16(s2_lo)), s2_lo);
+      const __m128i hi = _mm_mulhi_epu16(_mm_mullo_epi16(f, effect_alpha_epu16(s2_hi)), s2_hi);
+      const __m128i result = _mm_subs_epu8(s1, _mm_packus_epi16(lo, hi));
+      _mm_storeu_si128((__m128i *)(rt + i * 4), effect_alpha_keep_byte(result, s1));
     }
+  }
+#endif
 
-    if (y == 0) {
-      break;
-    }
-    y--;
+  for (; i < width; i++) {
+    const int j = i * 4;
+    const int m = fac * (int)cp2[j + 3];
+    rt[j + 0] = max_ii(cp1[j + 0] - ((m * cp2[j + 0]) >> 16), 0);
+    rt[j + 1] = max_ii(cp1[j + 1] - ((m * cp2[j + 1]) >> 16), 0);
+    rt[j + 2] = max_ii(cp1[j + 2] - ((m * cp2[j + 2]) >> 16), 0);
+    rt[j + 3] = cp1[j + 3];
+  }
+}
+
+static void do_sub_effect_byte(float facf0,
+                               float facf1,
+                               int x,
+                               int y,
+                               unsigned char *rect1,
+                               unsigned char *rect2,
+                               unsigned char *out)
+{
+  for (int i = 0; i < y; i++, rect1 += x * 4, rect2 += x * 4, out += x * 4) {
+    do_sub_row_byte((i & 1) ? facf1 : facf0, x, rect1, rect2, out);
+  }
+}
 
-    x = xo;
-    while (x--) {
-      const int m = fac3 * (int)cp2[3];
-      rt[0] = max_ii(cp1[0] - ((m * cp2[0]) >> 16), 0);
-      rt[1] = max_ii(cp1[1] - ((m * cp2[1]) >> 16), 0);
-      rt[2] = max_ii(cp1[2] - ((m * cp2[2]) >> 16), 0);
-      rt[3] = cp1[3];
+static void do_sub_row_float(float fac, int width, const float *rt1, const float *rt2, float *rt)
+{
+  const float fac_inv = 1.0f - fac;
 
-      cp1 += 4;
-      cp2 += 4;
-      rt += 4;
-    }
+  for (; width > 0; width--, rt1 += 4, rt2 += 4, rt += 4) {
+    const float m = (1.0f - (rt1[3] * fac_inv)) * rt2[3];
+#ifdef BLI_HAVE_SSE2
+    const __m128 s1 = _mm_loadu_ps(rt1);
+    const __m128 result = _mm_max_ps(
+        _mm_sub_ps(s1, _mm_mul_ps(_mm_set1_ps(m), _mm_loadu_ps(rt2))), _mm_setzero_ps());
+    _mm_storeu_ps(rt, effect_alpha_keep_float(result, s1));
+#else
+    rt[0] = max_ff(rt1[0] - m * rt2[0], 0.0f);
+    rt[1] = max_ff(rt1[1] - m * rt2[1], 0.0f);
+    rt[2] = max_ff(rt1[2] - m * rt2[2], 0.0f);
+    rt[3] = rt1[3];
+#endif
   }
 }
 
 static void do_sub_effect_float(
     float UNUSED(facf0), float facf1, int x, int y, float *rect1, float *rect2, float *out)
 {
-  int xo;
-  float /* fac1, */ fac3_inv;
-  float *rt1, *rt2, *rt;
-
-  xo = x;
-  rt1 = rect1;
-  rt2 = rect2;
-  rt = out;
-
-  /* UNUSED */
-  // fac1 = facf0;
-  fac3_inv = 1.0f - facf1;
-
-  while (y--) {
-    x = xo;
-    while (x--) {
-      const float m = (1.0f - (rt1[3] * fac3_inv)) * rt2[3];
-      rt[0] = max_ff(rt1[0] - m * rt2[0], 0.0f);
-      rt[1] = max_ff(rt1[1] - m * rt2[1], 0.0f);
-      rt[2] = max_ff(rt1[2] - m * rt2[2], 0.0f);
-      rt[3] = rt1[3];
-
-      rt1 += 4;
-      rt2 += 4;
-      rt += 4;
-    }
-
-    if (y == 0) {
-      break;
-    }
-    y--;
-
-    x = xo;
-    while (x--) {
-      const float m = (1.0f - (rt1[3] * fac3_inv)) * rt2[3];
-      rt[0] = max_ff(rt1[0] - m * rt2[0], 0.0f);
-      rt[1] = max_ff(rt1[1] - m * rt2[1], 0.0f);
-      rt[2] = max_ff(rt1[2] - m * rt2[2], 0.0f);
-      rt[3] = rt1[3];
-
-      rt1 += 4;
-      rt2 += 4;
-      rt += 4;
-    }
+  /* Only the factor of the second field is used. */
+  for (int i = 0; i < y; i++, rect1 += x * 4, rect2 += x * 4, out += x * 4) {
+    do_sub_row_float(facf1, x, rect1, rect2, out);
   }
 }
 
@@ -1409,111 +1276,99 @@ static void do_drop_effect_float(
 
 /*********************** Mul *************************/
 
-static void do_mul_effect_byte(float facf0,
-                               float facf1,
-                               int x,
-                               int y,
-                               unsigned char *rect1,
-                               unsigned char *rect2,
-                               unsigned char *out)
+static void do_mul_row_byte(float facf,
+                            int width,
+                            const unsigned char *rt1,
+                            const unsigned char *rt2,
+                            unsigned char *rt)
 {
-  int xo, fac1, fac3;
-  unsigned char *rt1, *rt2, *rt;
-
-  xo = x;
-  rt1 = rect1;
-  rt2 = rect2;
-  rt = out;
-
-  fac1 = (int)(256.0f * facf0);
-  fac3 = (int)(256.0f * facf1);
+  const int fac = (int)(256.0f * facf);
+  int i = 0;
 
   /* Formula:
-   * `fac * (a * b) + (1 - fac) * a => fac * a * (b - 1) + axaux = c * px + py * s;` // + centx
-   * `yaux = -s * px + c * py;` // + centy */
-
-  while (y--) {
-
-    x = xo;
-    while (x--) {
+   * `fac * (a * b) + (1 - fac) * a => fac * a * (b - 1) + a` */
 
-      rt[0] = rt1[0] + ((fac1 * rt1[0] * (rt2[0] - 255)) >> 16);
-      rt[1] = rt1[1] + ((fac1 * rt1[1] * (rt2[1] - 255)) >> 16);
-      rt[2] = rt1[2] + ((fac1 * rt1[2] * (rt2[2] - 255)) >> 16);
-      rt[3] = rt1[3] + ((fac1 * rt1[3] * (rt2[3] - 255)) >> 16);
+#ifdef BLI_HAVE_SSE2
+  /* `fac * a` fits in 16 bits as long as the factor is in range. The shift of the negative
+   * product rounds down, so the unsigned product is subtracted rounded up. */
+  if (fac >= 0 && fac <= 256) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i one = _mm_set1_epi16(1);
+    const __m128i max = _mm_set1_epi16(255);
+    const __m128i f = _mm_set1_epi16((short)fac);
+    __m128i result[2];
 
-      rt1 += 4;
-      rt2 += 4;
-      rt += 4;
-    }
+    for (; i + 4 <= width; i += 4) {
+      const __m128i s1 = _mm_loadu_si128((const __m128i *)(rt1 + i * 4));
+      const __m128i s2 = _mm_loadu_si128((const __m128i *)(rt2 + i * 4));
 
-    if (y == 0) {
-      break;
+      for (int half = 0; half < 2; half++) {
+        const __m128i a = half ? _mm_unpackhi_epi8(s1, zero) : _mm_unpacklo_epi8(s1, zero);
+        const __m128i b = half ? _mm_unpackhi_epi8(s2, zero) : _mm_unpacklo_epi8(s2, zero);
+        const __m128i p = _mm_mullo_epi16(f, a);
+        const __m128i q = _mm_sub_epi16(max, b);
+        /* Adding the all ones comparison result cancels the one for exact products. */
+        const __m128i sub = _mm_add_epi16(
+            _mm_add_epi16(_mm_mulhi_epu16(p, q), one),
+            _mm_cmpeq_epi16(_mm_mullo_epi16(p, q), zero));
+        result[half] = _mm_sub_epi16(a, sub);
+      }
+      _mm_storeu_si128((__m128i *)(rt + i * 4), _mm_packus_epi16(result[0], result[1]));
     }
-    y--;
-
-    x = xo;
-    while (x--) {
-
-      rt[0] = rt1[0] + ((fac3 * rt1[0] * (rt2[0] - 255)) >> 16);
-      rt[1] = rt1[1] + ((fac3 * rt1[1] * (rt2[1] - 255)) >> 16);
-      rt[2] = rt1[2] + ((fac3 * rt1[2] * (rt2[2] - 255)) >> 16);
-      rt[3] = rt1[3] + ((fac3 * rt1[3] * (rt2[3] - 255)) >> 16);
+  }
+#endif
 
-      rt1 += 4;
-      rt2 += 4;
-      rt += 4;
-    }
+  for (; i < width; i++) {
+    const int j = i * 4;
+    rt[j + 0] = rt1[j + 0] + ((fac * rt1[j + 0] * (rt2[j + 0] - 255)) >> 16);
+    rt[j + 1] = rt1[j + 1] + ((fac * rt1[j + 1] * (rt2[j + 1] - 255)) >> 16);
+    rt[j + 2] = rt1[j + 2] + ((fac * rt1[j + 2] * (rt2[j + 2] - 255)) >> 16);
+    rt[j + 3] = rt1[j + 3] + ((fac * rt1[j + 3] * (rt2[j + 3] - 255)) >> 16);
   }
 }
 
-static void do_mul_effect_float(
-    float facf0, float facf1, int x, int y, float *rect1, float *rect2, float *out)
+static void do_mul_effect_byte(float facf0,
+                               float facf1,
+                               int x,
+                               int y,
+                               unsigned char *rect1,
+                               unsigned char *rect2,
+                               unsigned char *out)
 {
-  int xo;
-  float fac1, fac3;
-  float *rt1, *rt2, *rt;
-
-  xo = x;
-  rt1 = rect1;
-  rt2 = rect2;
-  rt = out;
-
-  fac1 = facf0;
-  fac3 = facf1;
+  for (int i = 0; i < y; i++, rect1 += x * 4, rect2 += x * 4, out += x * 4) {
+    do_mul_row_byte((i & 1) ? facf1 : facf0, x, rect1, rect2, out);
+  }
+}
 
+static void do_mul_row_float(float fac, int width, const float *rt1, const float *rt2, float *rt)
+{
   /* Formula:
    * `fac * (a * b) + (1 - fac) * a => fac * a * (b - 1) + a`. */
 
-  while (y--) {
-    x = xo;
-    while (x--) {
-      rt[0] = rt1[0] + fac1 * rt1[0] * (rt2[0] - 1.0f);
-      rt[1] = rt1[1] + fac1 * rt1[1] * (rt2[1] - 1.0f);
-      rt[2] = rt1[2] + fac1 * rt1[2] * (rt2[2] - 1.0f);
-      rt[3] = rt1[3] + fac1 * rt1[3] * (rt2[3] - 1.0f);
-
-      rt1 += 4;
-      rt2 += 4;
-      rt += 4;
-    }
-
-    if (y == 0) {
-      break;
-    }
-    y--;
+#ifdef BLI_HAVE_SSE2
+  const __m128 f = _mm_set1_ps(fac);
+  const __m128 one = _mm_set1_ps(1.0f);
 
-    x = xo;
-    while (x--) {
-      rt[0] = rt1[0] + fac3 * rt1[0] * (rt2[0] - 1.0f);
-      rt[1] = rt1[1] + fac3 * rt1[1] * (rt2[1] - 1.0f);
-      rt[2] = rt1[2] + fac3 * rt1[2] * (rt2[2] - 1.0f);
-      rt[3] = rt1[3] + fac3 * rt1[3] * (rt2[3] - 1.0f);
+  for (; width > 0; width--, rt1 += 4, rt2 += 4, rt += 4) {
+    const __m128 a = _mm_loadu_ps(rt1);
+    _mm_storeu_ps(
+        rt, _mm_add_ps(a, _mm_mul_ps(_mm_mul_ps(f, a), _mm_sub_ps(_mm_loadu_ps(rt2), one))));
+  }
+#else
+  for (; width > 0; width--, rt1 += 4, rt2 += 4, rt += 4) {
+    rt[0] = rt1[0] + fac * rt1[0] * (rt2[0] - 1.0f);
+    rt[1] = rt1[1] + fac * rt1[1] * (rt2[1] - 1.0f);
+    rt[2] = rt1[2] + fac * rt1[2] * (rt2[2] - 1.0f);
+    rt[3] = rt1[3] + fac * rt1[3] * (rt2[3] - 1.0f);
+  }
+#endif
+}
 
-      rt1 += 4;
-      rt2 += 4;
-      rt += 4;
-    }
+static void do_mul_effect_float(
+    float facf0, float facf1, int x, int y, float *rect1, float *rect2, float *out)
+{
+  for (int i = 0; i < y; i++, rect1 += x * 4, rect2 += x * 4, out += x * 4) {
+    do_mul_row_float((i & 1) ? facf1 : facf0, x, rect1, rect2, out);
   }
 }
 
@@ -1548,179 +1403,106 @@ static void do_mul_effect(const SeqRenderData *context,
 }
 
 /*********************** Blend Mode ***************************************/
-typedef void (*IMB_blend_func_byte)(unsigned char *dst,
-                                    const unsigned char *src1,
-                                    const unsigned char *src2);
-typedef void (*IMB_blend_func_float)(float *dst, const float *src1, const float *src2);
-
-BLI_INLINE void apply_blend_function_byte(float facf0,
-                                          float facf1,
-                                          int x,
-                                          int y,
-                                          unsigned char *rect1,
-                                          unsigned char *rect2,
-                                          unsigned char *out,
-                                          IMB_blend_func_byte blend_function)
-{
-  int xo;
-  unsigned char *rt1, *rt2, *rt;
-  unsigned int achannel;
-  xo = x;
-  rt1 = rect1;
-  rt2 = rect2;
-  rt = out;
-  while (y--) {
-    for (x = xo; x > 0; x--) {
-      achannel = rt1[3];
-      rt1[3] = (unsigned int)achannel * facf0;
-      blend_function(rt, rt1, rt2);
-      rt1[3] = achannel;
-      rt[3] = rt1[3];
-      rt1 += 4;
-      rt2 += 4;
-      rt += 4;
-    }
-    if (y == 0) {
-      break;
-    }
-    y--;
-    for (x = xo; x > 0; x--) {
-      achannel = rt1[3];
-      rt1[3] = (unsigned int)achannel * facf1;
-      blend_function(rt, rt1, rt2);
-      rt1[3] = achannel;
-      rt[3] = rt1[3];
-      rt1 += 4;
-      rt2 += 4;
-      rt += 4;
-    }
-  }
-}
-
-BLI_INLINE void apply_blend_function_float(float facf0,
-                                           float facf1,
-                                           int x,
-                                           int y,
-                                           float *rect1,
-                                           float *rect2,
-                                           float *out,
-                                           IMB_blend_func_float blend_function)
-{
-  int xo;
-  float *rt1, *rt2, *rt;
-  float achannel;
-  xo = x;
-  rt1 = rect1;
-  rt2 = rect2;
-  rt = out;
-  while (y--) {
-    for (x = xo; x > 0; x--) {
-      achannel = rt1[3];
-      rt1[3] = achannel * facf0;
-      blend_function(rt, rt1, rt2);
-      rt1[3] = achannel;
-      rt[3] = rt1[3];
-      rt1 += 4;
-      rt2 += 4;
-      rt += 4;
-    }
-    if (y == 0) {
-      break;
-    }
-    y--;
-    for (x = xo; x > 0; x--) {
-      achannel = rt1[3];
-      rt1[3] = achannel * facf1;
-      blend_function(rt, rt1, rt2);
-      rt1[3] = achannel;
-      rt[3] = rt1[3];
-      rt1 += 4;
-      rt2 += 4;
-      rt += 4;
-    }
-  }
-}
 
-static void do_blend_effect_float(
-    float facf0, float facf1, int x, int y, float *rect1, float *rect2, int btype, float *out)
+static bool seq_blend_mode_to_imbuf(int btype, IMB_BlendMode *r_mode)
 {
   switch (btype) {
     case SEQ_TYPE_ADD:
-      apply_blend_function_float(facf0, facf1, x, y, rect1, rect2, out, blend_color_add_float);
-      break;
+      *r_mode = IMB_BLEND_ADD;
+      return true;
     case SEQ_TYPE_SUB:
-      apply_blend_function_float(facf0, facf1, x, y, rect1, rect2, out, blend_color_sub_float);
-      break;
+      *r_mode = IMB_BLEND_SUB;
+      return true;
     case SEQ_TYPE_MUL:
-      apply_blend_function_float(facf0, facf1, x, y, rect1, rect2, out, blend_color_mul_float);
-      break;
+      *r_mode = IMB_BLEND_MUL;
+      return true;
     case SEQ_TYPE_DARKEN:
-      apply_blend_function_float(facf0, facf1, x, y, rect1, rect2, out, blend_color_darken_float);
-      break;
+      *r_mode = IMB_BLEND_DARKEN;
+      return true;
     case SEQ_TYPE_COLOR_BURN:
-      apply_blend_function_float(facf0, facf1, x, y, rect1, rect2, out, blend_color_burn_float);
-      break;
+      *r_mode = IMB_BLEND_COLORBURN;
+      return true;
     case SEQ_TYPE_LINEAR_BURN:
-      apply_blend_function_float(
-          facf0, facf1, x, y, rect1, rect2, out, blend_color_linearburn_float);
-      break;
+      *r_mode = IMB_BLEND_LINEARBURN;
+      return true;
     case SEQ_TYPE_SCREEN:
-      apply_blend_function_float(facf0, facf1, x, y, rect1, rect2, out, blend_color_screen_float);
-      break;
+      *r_mode = IMB_BLEND_SCREEN;
+      return true;
     case SEQ_TYPE_LIGHTEN:
-      apply_blend_function_float(facf0, facf1, x, y, rect1, rect2, out, blend_color_lighten_float);
-      break;
+      *r_mode = IMB_BLEND_LIGHTEN;
+      return true;
     case SEQ_TYPE_DODGE:
-      apply_blend_function_float(facf0, facf1, x, y, rect1, rect2, out, blend_color_dodge_float);
-      break;
+      *r_mode = IMB_BLEND_COLORDODGE;
+      return true;
     case SEQ_TYPE_OVERLAY:
-      apply_blend_function_float(facf0, facf1, x, y, rect1, rect2, out, blend_color_overlay_float);
-      break;
+      *r_mode = IMB_BLEND_OVERLAY;
+      return true;
     case SEQ_TYPE_SOFT_LIGHT:
-      apply_blend_function_float(
-          facf0, facf1, x, y, rect1, rect2, out, blend_color_softlight_float);
-      break;
+      *r_mode = IMB_BLEND_SOFTLIGHT;
+      return true;
     case SEQ_TYPE_HARD_LIGHT:
-      apply_blend_function_float(
-          facf0, facf1, x, y, rect1, rect2, out, blend_color_hardlight_float);
-      break;
+      *r_mode = IMB_BLEND_HARDLIGHT;
+      return true;
     case SEQ_TYPE_PIN_LIGHT:
-      apply_blend_function_float(
-          facf0, facf1, x, y, rect1, rect2, out, blend_color_pinlight_float);
-      break;
+      *r_mode = IMB_BLEND_PINLIGHT;
+      return true;
     case SEQ_TYPE_LIN_LIGHT:
-      apply_blend_function_float(
-          facf0, facf1, x, y, rect1, rect2, out, blend_color_linearlight_float);
-      break;
+      *r_mode = IMB_BLEND_LINEARLIGHT;
+      return true;
     case SEQ_TYPE_VIVID_LIGHT:
-      apply_blend_function_float(
-          facf0, facf1, x, y, rect1, rect2, out, blend_color_vividlight_float);
-      break;
+      *r_mode = IMB_BLEND_VIVIDLIGHT;
+      return true;
     case SEQ_TYPE_BLEND_COLOR:
-      apply_blend_function_float(facf0, facf1, x, y, rect1, rect2, out, blend_color_color_float);
-      break;
+      *r_mode = IMB_BLEND_COLOR;
+      return true;
     case SEQ_TYPE_HUE:
-      apply_blend_function_float(facf0, facf1, x, y, rect1, rect2, out, blend_color_hue_float);
-      break;
+      *r_mode = IMB_BLEND_HUE;
+      return true;
     case SEQ_TYPE_SATURATION:
-      apply_blend_function_float(
-          facf0, facf1, x, y, rect1, rect2, out, blend_color_saturation_float);
-      break;
+      *r_mode = IMB_BLEND_SATURATION;
+      return true;
     case SEQ_TYPE_VALUE:
-      apply_blend_function_float(
-          facf0, facf1, x, y, rect1, rect2, out, blend_color_luminosity_float);
-      break;
+      *r_mode = IMB_BLEND_LUMINOSITY;
+      return true;
     case SEQ_TYPE_DIFFERENCE:
-      apply_blend_function_float(
-          facf0, facf1, x, y, rect1, rect2, out, blend_color_difference_float);
-      break;
+      *r_mode = IMB_BLEND_DIFFERENCE;
+      return true;
     case SEQ_TYPE_EXCLUSION:
-      apply_blend_function_float(
-          facf0, facf1, x, y, rect1, rect2, out, blend_color_exclusion_float);
-      break;
+      *r_mode = IMB_BLEND_EXCLUSION;
+      return true;
     default:
-      break;
+      return false;
+  }
+}
+
+/* Blend a row at a time, with the alpha of the first strip scaled by the factor in a copy of the
+ * row. The result keeps the alpha of the first strip. */
+static void do_blend_effect_float(
+    float facf0, float facf1, int x, int y, float *rect1, float *rect2, int btype, float *out)
+{
+  IMB_BlendMode mode;
+  if (!seq_blend_mode_to_imbuf(btype, &mode)) {
+    return;
+  }
+
+  float *row1 = MEM_mallocN(sizeof(float[4]) * x, __func__);
+
+  for (int i = 0; i < y; i++, rect1 += x * 4, rect2 += x * 4, out += x * 4) {
+    const float fac = (i % 2) ? facf1 : facf0;
+
+    memcpy(row1, rect1, sizeof(float[4]) * x);
+    for (int j = 0; j < x; j++) {
+      row1[j * 4 + 3] *= fac;
+    }
+
+    IMB_blend_color_float_n(out, row1, rect2, x, mode);
+
+    for (int j = 0; j < x; j++) {
+      out[j * 4 + 3] = rect1[j * 4 + 3];
+    }
   }
+
+  MEM_freeN(row1);
 }
 
 static void do_blend_effect_byte(float facf0,
@@ -1732,79 +1514,29 @@ static void do_blend_effect_byte(float facf0,
                                  int btype,
                                  unsigned char *out)
 {
-  switch (btype) {
-    case SEQ_TYPE_ADD:
-      apply_blend_function_byte(facf0, facf1, x, y, rect1, rect2, out, blend_color_add_byte);
-      break;
-    case SEQ_TYPE_SUB:
-      apply_blend_function_byte(facf0, facf1, x, y, rect1, rect2, out, blend_color_sub_byte);
-      break;
-    case SEQ_TYPE_MUL:
-      apply_blend_function_byte(facf0, facf1, x, y, rect1, rect2, out, blend_color_mul_byte);
-      break;
-    case SEQ_TYPE_DARKEN:
-      apply_blend_function_byte(facf0, facf1, x, y, rect1, rect2, out, blend_color_darken_byte);
-      break;
-    case SEQ_TYPE_COLOR_BURN:
-      apply_blend_function_byte(facf0, facf1, x, y, rect1, rect2, out, blend_color_burn_byte);
-      break;
-    case SEQ_TYPE_LINEAR_BURN:
-      apply_blend_function_byte(
-          facf0, facf1, x, y, rect1, rect2, out, blend_color_linearburn_byte);
-      break;
-    case SEQ_TYPE_SCREEN:
-      apply_blend_function_byte(facf0, facf1, x, y, rect1, rect2, out, blend_color_screen_byte);
-      break;
-    case SEQ_TYPE_LIGHTEN:
-      apply_blend_function_byte(facf0, facf1, x, y, rect1, rect2, out, blend_color_lighten_byte);
-      break;
-    case SEQ_TYPE_DODGE:
-      apply_blend_function_byte(facf0, facf1, x, y, rect1, rect2, out, blend_color_dodge_byte);
-      break;
-    case SEQ_TYPE_OVERLAY:
-      apply_blend_function_byte(facf0, facf1, x, y, rect1, rect2, out, blend_color_overlay_byte);
-      break;
-    case SEQ_TYPE_SOFT_LIGHT:
-      apply_blend_function_byte(facf0, facf1, x, y, rect1, rect2, out, blend_color_softlight_byte);
-      break;
-    case SEQ_TYPE_HARD_LIGHT:
-      apply_blend_function_byte(facf0, facf1, x, y, rect1, rect2, out, blend_color_hardlight_byte);
-      break;
-    case SEQ_TYPE_PIN_LIGHT:
-      apply_blend_function_byte(facf0, facf1, x, y, rect1, rect2, out, blend_color_pinlight_byte);
-      break;
-    case SEQ_TYPE_LIN_LIGHT:
-      apply_blend_function_byte(
-          facf0, facf1, x, y, rect1, rect2, out, blend_color_linearlight_byte);
-      break;
-    case SEQ_TYPE_VIVID_LIGHT:
-      apply_blend_function_byte(
-          facf0, facf1, x, y, rect1, rect2, out, blend_color_vividlight_byte);
-      break;
-    case SEQ_TYPE_BLEND_COLOR:
-      apply_blend_function_byte(facf0, facf1, x, y, rect1, rect2, out, blend_color_color_byte);
-      break;
-    case SEQ_TYPE_HUE:
-      apply_blend_function_byte(facf0, facf1, x, y, rect1, rect2, out, blend_color_hue_byte);
-      break;
-    case SEQ_TYPE_SATURATION:
-      apply_blend_function_byte(
-          facf0, facf1, x, y, rect1, rect2, out, blend_color_saturation_byte);
-      break;
-    case SEQ_TYPE_VALUE:
-      apply_blend_function_byte(
-          facf0, facf1, x, y, rect1, rect2, out, blend_color_luminosity_byte);
-      break;
-    case SEQ_TYPE_DIFFERENCE:
-      apply_blend_function_byte(
-          facf0, facf1, x, y, rect1, rect2, out, blend_color_difference_byte);
-      break;
-    case SEQ_TYPE_EXCLUSION:
-      apply_blend_function_byte(facf0, facf1, x, y, rect1, rect2, out, blend_color_exclusion_byte);
-      break;
-    default:
-      break;
+  IMB_BlendMode mode;
+  if (!seq_blend_mode_to_imbuf(btype, &mode)) {
+    return;
+  }
+
+  unsigned char *row1 = MEM_mallocN(sizeof(unsigned char[4]) * x, __func__);
+
+  for (int i = 0; i < y; i++, rect1 += x * 4, rect2 += x * 4, out += x * 4) {
+    const float fac = (i % 2) ? facf1 : facf0;
+
+    memcpy(row1, rect1, sizeof(unsigned char[4]) * x);
+    for (int j = 0; j < x; j++) {
+      row1[j * 4 + 3] = (unsigned int)rect1[j * 4 + 3] * fac;
+    }
+
+    IMB_blend_color_byte_n(out, row1, rect2, x, mode);
+
+    for (int j = 0; j < x; j++) {
+      out[j * 4 + 3] = rect1[j * 4 + 3];
+    }
   }
+
+  MEM_freeN(row1);
 }
 
 static void do_blend_mode_effect(const SeqRenderData *context,
@@ -3881,6 +3613,10 @@ static int early_out_text(Sequence *seq, float UNUSED(facf0), float UNUSED(facf1
   return EARLY_NO_INPUT;
 }
 
+/* BLF font state is global, text strips can be rendered from multiple threads when the frame
+ * pipeline is used for final render. */
+static ThreadMutex text_render_mutex = BLI_MUTEX_INITIALIZER;
+
 static ImBuf *do_text_effect(const SeqRenderData *context,
                              Sequence *seq,
                              float UNUSED(timeline_frame),
@@ -3901,6 +3637,8 @@ static ImBuf *do_text_effect(const SeqRenderData *context,
   int y_ofs, x, y;
   double proxy_size_comp;
 
+  BLI_mutex_lock(&text_render_mutex);
+
   if (data->text_blf_id == SEQ_FONT_NOT_LOADED) {
     data->text_blf_id = -1;
 
@@ -4001,6 +3739,8 @@ static ImBuf *do_text_effect(const SeqRenderData *context,
 
   BLF_disable(font, font_flags);
 
+  BLI_mutex_unlock(&text_render_mutex);
+
   return out;
 }
 
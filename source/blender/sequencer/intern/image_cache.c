@@ -33,6 +33,7 @@
 #include "IMB_colormanagement.h"
 #include "IMB_imbuf.h"
 #include "IMB_imbuf_types.h"
+#include "IMB_moviecache.h"
 
 #include "BLI_blenlib.h"
 #include "BLI_endian_defines.h"
@@ -48,6 +49,14 @@
 #include "BKE_main.h"
 #include "BKE_scene.h"
 
+#ifdef WITH_LZO
+#  ifdef WITH_SYSTEM_LZO
+#    include <lzo/lzo1x.h>
+#  else
+#    include "minilzo.h"
+#  endif
+#endif
+
 #include "SEQ_prefetch.h"
 #include "SEQ_relations.h"
 #include "SEQ_render.h"
@@ -71,7 +80,8 @@
  * If the cache is full all entries for pending frame will have is_temp_cache set.
  *
  * Linking: We use links to reduce number of iterations over entries needed to manage cache.
- * Entries are linked in order as they are put into cache.
+ * Entries are linked in order as they are put into cache, separately for each task (thread),
+ * because prefetching renders multiple frames at once.
  * Only permanent (is_temp_cache = 0) cache entries are linked.
  * Putting #SEQ_CACHE_STORE_FINAL_OUT will reset linking
  *
@@ -89,8 +99,13 @@
  * For each cached non-temp image, image data and supplementary info are written to HDD.
  * Multiple(DCACHE_IMAGES_PER_FILE) images share the same file.
  * Each of these files contains header DiskCacheHeader followed by image data.
- * Zlib compression with user definable level can be used to compress image data(per image)
+ * Zlib compression with user definable level can be used to compress image data(per image).
+ * Fast compression uses LZO instead, which is cheap enough to keep up with playback.
  * Images are written in order in which they are rendered.
+ * Writing is done by a background thread, so rendering doesn't wait for compression and I/O.
+ * Amount of queued images is limited, when the queue is full rendering waits for writes.
+ * When an image is read from disk, following frames are read ahead by the same thread and put
+ * into RAM cache, so playback of frames cached on disk doesn't stall on every frame.
  * Overwriting of individual entry is not possible.
  * Stored images are deleted by invalidation, or when size of all files exceeds maximum
  * size specified in user preferences.
@@ -102,11 +117,25 @@
 /* <cache type>-<resolution X>x<resolution Y>-<rendersize>%(<view_id>)-<frame no>.dcf */
 #define DCACHE_FNAME_FORMAT "%d-%dx%d-%d%%(%d)-%d.dcf"
 #define DCACHE_IMAGES_PER_FILE 100
-#define DCACHE_CURRENT_VERSION 1
+#define DCACHE_CURRENT_VERSION 2
 #define COLORSPACE_NAME_MAX 64 /* XXX: defined in imb intern */
+/* Maximum number of queued disk cache reads and writes. */
+#define DCACHE_IO_QUEUE_MAX 16
+/* Number of frames read from disk into RAM ahead of frame which was requested. */
+#define DCACHE_READ_AHEAD_FRAMES 8
+#define DCACHE_LZO_OUT_LEN(size) ((size) + (size) / 16 + 64 + 3)
+
+/* Name under which the RAM cache reports its memory to the shared movie cache budget. */
+#define SEQ_CACHE_MEMORY_OWNER "Sequencer Cache"
+
+typedef enum eDiskCacheCodec {
+  DCACHE_CODEC_ZLIB = 0,
+  DCACHE_CODEC_LZO = 1,
+} eDiskCacheCodec;
 
 typedef struct DiskCacheHeaderEntry {
   unsigned char encoding;
+  unsigned char codec; /* eDiskCacheCodec */
   uint64_t frameno;
   uint64_t size_compressed;
   uint64_t size_raw;
@@ -124,6 +153,16 @@ typedef struct SeqDiskCache {
   ListBase files;
   ThreadMutex read_write_mutex;
   size_t size_total;
+
+  /* Background I/O thread, processes #DiskCacheTask items. */
+  ThreadQueue *io_queue;
+  ListBase io_threads;
+  ThreadMutex io_mutex;
+  ThreadCondition io_cond;
+  int io_tasks_pending;
+  /* Last frame queued for read-ahead, to not queue the same frames repeatedly. */
+  struct Sequence *read_ahead_seq;
+  float read_ahead_frame;
 } SeqDiskCache;
 
 typedef struct DiskCacheFile {
@@ -146,13 +185,16 @@ typedef struct SeqCache {
   ThreadMutex iterator_mutex;
   struct BLI_mempool *keys_pool;
   struct BLI_mempool *items_pool;
-  struct SeqCacheKey *last_key;
+  /* Last linked key of each task, frames rendered concurrently are linked separately. */
+  struct SeqCacheKey *last_key[SEQ_TASK_MAX];
   SeqDiskCache *disk_cache;
 } SeqCache;
 
 typedef struct SeqCacheItem {
   struct SeqCache *cache_owner;
   struct ImBuf *ibuf;
+  /* Memory reported to the shared cache budget. */
+  size_t size;
 } SeqCacheItem;
 
 typedef struct SeqCacheKey {
@@ -176,6 +218,9 @@ static float seq_cache_timeline_frame_to_frame_index(Sequence *seq,
                                                      float timeline_frame,
                                                      int type);
 static float seq_cache_frame_index_to_timeline_frame(Sequence *seq, float frame_index);
+static void seq_disk_cache_io_start(SeqDiskCache *disk_cache);
+static void seq_disk_cache_io_flush(SeqDiskCache *disk_cache);
+static void seq_disk_cache_io_end(SeqDiskCache *disk_cache);
 
 static char *seq_disk_cache_base_dir(void)
 {
@@ -187,6 +232,7 @@ static int seq_disk_cache_compression_level(void)
   switch (U.sequencer_disk_cache_compression) {
     case USER_SEQ_DISK_CACHE_COMPRESSION_NONE:
       return 0;
+    case USER_SEQ_DISK_CACHE_COMPRESSION_FAST:
     case USER_SEQ_DISK_CACHE_COMPRESSION_LOW:
       return 1;
     case USER_SEQ_DISK_CACHE_COMPRESSION_HIGH:
@@ -196,6 +242,16 @@ static int seq_disk_cache_compression_level(void)
   return U.sequencer_disk_cache_compression;
 }
 
+static eDiskCacheCodec seq_disk_cache_codec(void)
+{
+#ifdef WITH_LZO
+  if (U.sequencer_disk_cache_compression == USER_SEQ_DISK_CACHE_COMPRESSION_FAST) {
+    return DCACHE_CODEC_LZO;
+  }
+#endif
+  return DCACHE_CODEC_ZLIB;
+}
+
 static size_t seq_disk_cache_size_limit(void)
 {
   return (size_t)U.sequencer_disk_cache_size_limit * (1024 * 1024 * 1024);
@@ -491,29 +547,79 @@ static void seq_disk_cache_invalidate(Scene *scene,
   BLI_mutex_unlock(&disk_cache->read_write_mutex);
 }
 
+#ifdef WITH_LZO
+static size_t lzo_mem_to_file_at_pos(void *buf, size_t len, FILE *file, size_t offset)
+{
+  lzo_uint out_len = DCACHE_LZO_OUT_LEN(len);
+  unsigned char *out = MEM_mallocN(out_len, "SeqDiskCache LZO buffer");
+  void *wrkmem = MEM_mallocN(LZO1X_MEM_COMPRESS, "SeqDiskCache LZO work memory");
+  size_t bytes_written = 0;
+
+  if (lzo1x_1_compress(buf, (lzo_uint)len, out, &out_len, wrkmem) == LZO_E_OK) {
+    BLI_fseek(file, offset, SEEK_SET);
+    if (fwrite(out, 1, out_len, file) == out_len) {
+      bytes_written = out_len;
+    }
+  }
+
+  MEM_freeN(wrkmem);
+  MEM_freeN(out);
+  return bytes_written;
+}
+
+static size_t lzo_file_to_mem_at_pos(
+    void *buf, size_t len, FILE *file, size_t offset, size_t size_compressed)
+{
+  unsigned char *in = MEM_mallocN(size_compressed, "SeqDiskCache LZO buffer");
+  size_t bytes_read = 0;
+
+  BLI_fseek(file, offset, SEEK_SET);
+  if (fread(in, 1, size_compressed, file) == size_compressed) {
+    lzo_uint out_len = len;
+    if (lzo1x_decompress_safe(in, (lzo_uint)size_compressed, buf, &out_len, NULL) == LZO_E_OK) {
+      bytes_read = out_len;
+    }
+  }
+
+  MEM_freeN(in);
+  return bytes_read;
+}
+#endif
+
 static size_t deflate_imbuf_to_file(ImBuf *ibuf,
                                     FILE *file,
                                     int level,
                                     DiskCacheHeaderEntry *header_entry)
 {
-  if (ibuf->rect) {
-    return BLI_gzip_mem_to_file_at_pos(
-        ibuf->rect, header_entry->size_raw, file, header_entry->offset, level);
+  void *buf = ibuf->rect ? (void *)ibuf->rect : (void *)ibuf->rect_float;
+
+#ifdef WITH_LZO
+  if (header_entry->codec == DCACHE_CODEC_LZO) {
+    return lzo_mem_to_file_at_pos(buf, header_entry->size_raw, file, header_entry->offset);
   }
+#endif
 
   return BLI_gzip_mem_to_file_at_pos(
-      ibuf->rect_float, header_entry->size_raw, file, header_entry->offset, level);
+      buf, header_entry->size_raw, file, header_entry->offset, level);
 }
 
 static size_t inflate_file_to_imbuf(ImBuf *ibuf, FILE *file, DiskCacheHeaderEntry *header_entry)
 {
-  if (ibuf->rect) {
-    return BLI_ungzip_file_to_mem_at_pos(
-        ibuf->rect, header_entry->size_raw, file, header_entry->offset);
+  void *buf = ibuf->rect ? (void *)ibuf->rect : (void *)ibuf->rect_float;
+
+  if (header_entry->codec == DCACHE_CODEC_LZO) {
+#ifdef WITH_LZO
+    return lzo_file_to_mem_at_pos(buf,
+                                  header_entry->size_raw,
+                                  file,
+                                  header_entry->offset,
+                                  header_entry->size_compressed);
+#else
+    return 0;
+#endif
   }
 
-  return BLI_ungzip_file_to_mem_at_pos(
-      ibuf->rect_float, header_entry->size_raw, file, header_entry->offset);
+  return BLI_ungzip_file_to_mem_at_pos(buf, header_entry->size_raw, file, header_entry->offset);
 }
 
 static bool seq_disk_cache_read_header(FILE *file, DiskCacheHeader *header)
@@ -578,6 +684,7 @@ static int seq_disk_cache_add_header_entry(SeqCacheKey *key, ImBuf *ibuf, DiskCa
 
   header->entry[i].offset = offset;
   header->entry[i].frameno = key->frame_index;
+  header->entry[i].codec = seq_disk_cache_codec();
 
   /* Store colorspace name of ibuf. */
   const char *colorspace_name;
@@ -716,6 +823,7 @@ static ImBuf *seq_disk_cache_read_file(SeqDiskCache *disk_cache, SeqCacheKey *ke
 #undef DCACHE_IMAGES_PER_FILE
 #undef COLORSPACE_NAME_MAX
 #undef DCACHE_CURRENT_VERSION
+#undef DCACHE_LZO_OUT_LEN
 
 static bool seq_cmp_render_data(const SeqRenderData *a, const SeqRenderData *b)
 {
@@ -813,7 +921,19 @@ static size_t seq_cache_get_mem_total(void)
 static void seq_cache_keyfree(void *val)
 {
   SeqCacheKey *key = val;
-  BLI_mempool_free(key->cache_owner->keys_pool, key);
+  SeqCache *cache = key->cache_owner;
+
+  /* Don't link to freed key, frame of this task was recycled while being rendered. */
+  if (cache->last_key[key->task_id] == key) {
+    cache->last_key[key->task_id] = NULL;
+  }
+
+  BLI_mempool_free(cache->keys_pool, key);
+}
+
+static void seq_cache_reset_links(SeqCache *cache)
+{
+  memset(cache->last_key, 0, sizeof(cache->last_key));
 }
 
 static void seq_cache_valfree(void *val)
@@ -822,6 +942,7 @@ static void seq_cache_valfree(void *val)
 
   if (item->ibuf) {
     IMB_freeImBuf(item->ibuf);
+    IMB_moviecache_external_remove(SEQ_CACHE_MEMORY_OWNER, item->size);
   }
 
   BLI_mempool_free(item->cache_owner->items_pool, item);
@@ -846,40 +967,47 @@ static int get_stored_types_flag(Scene *scene, SeqCacheKey *key)
 static void seq_cache_put_ex(Scene *scene, SeqCacheKey *key, ImBuf *ibuf)
 {
   SeqCache *cache = seq_cache_get_from_scene(scene);
+  SeqCacheKey **last_key = &cache->last_key[key->task_id];
   SeqCacheItem *item;
   item = BLI_mempool_alloc(cache->items_pool);
   item->cache_owner = cache;
   item->ibuf = ibuf;
+  item->size = 0;
+
+  if (ibuf) {
+    item->size = IMB_get_size_in_memory(ibuf);
+    IMB_moviecache_external_add(SEQ_CACHE_MEMORY_OWNER, item->size);
+  }
 
   const int stored_types_flag = get_stored_types_flag(scene, key);
 
   /* Item stored for later use. */
   if (stored_types_flag & key->type) {
     key->is_temp_cache = false;
-    key->link_prev = cache->last_key;
+    key->link_prev = *last_key;
   }
 
   /* Store pointer to last cached key. */
-  SeqCacheKey *temp_last_key = cache->last_key;
+  SeqCacheKey *temp_last_key = *last_key;
 
   if (BLI_ghash_reinsert(cache->hash, key, item, seq_cache_keyfree, seq_cache_valfree)) {
     IMB_refImBuf(ibuf);
 
     if (!key->is_temp_cache) {
-      cache->last_key = key;
+      *last_key = key;
     }
   }
 
   /* Set last_key's reference to this key so we can look up chain backwards.
-   * Item is already put in cache, so cache->last_key points to current key.
+   * Item is already put in cache, so last_key points to current key.
    */
   if (!key->is_temp_cache && temp_last_key) {
-    temp_last_key->link_next = cache->last_key;
+    temp_last_key->link_next = *last_key;
   }
 
   /* Reset linking. */
   if (key->type == SEQ_CACHE_STORE_FINAL_OUT) {
-    cache->last_key = NULL;
+    *last_key = NULL;
   }
 }
 
@@ -1124,20 +1252,19 @@ static void seq_disk_cache_create(Main *bmain, Scene *scene)
   BLI_mutex_lock(&cache_create_lock);
   SeqCache *cache = seq_cache_get_from_scene(scene);
 
-  if (cache == NULL) {
-    return;
-  }
-
-  if (cache->disk_cache != NULL) {
+  if (cache == NULL || cache->disk_cache != NULL) {
+    BLI_mutex_unlock(&cache_create_lock);
     return;
   }
 
-  cache->disk_cache = MEM_callocN(sizeof(SeqDiskCache), "SeqDiskCache");
-  cache->disk_cache->bmain = bmain;
-  BLI_mutex_init(&cache->disk_cache->read_write_mutex);
-  seq_disk_cache_handle_versioning(cache->disk_cache);
-  seq_disk_cache_get_files(cache->disk_cache, seq_disk_cache_base_dir());
-  cache->disk_cache->timestamp = scene->ed->disk_cache_timestamp;
+  SeqDiskCache *disk_cache = MEM_callocN(sizeof(SeqDiskCache), "SeqDiskCache");
+  disk_cache->bmain = bmain;
+  BLI_mutex_init(&disk_cache->read_write_mutex);
+  seq_disk_cache_handle_versioning(disk_cache);
+  seq_disk_cache_get_files(disk_cache, seq_disk_cache_base_dir());
+  disk_cache->timestamp = scene->ed->disk_cache_timestamp;
+  seq_disk_cache_io_start(disk_cache);
+  cache->disk_cache = disk_cache;
   BLI_mutex_unlock(&cache_create_lock);
 }
 
@@ -1149,7 +1276,6 @@ static void seq_cache_create(Main *bmain, Scene *scene)
     cache->keys_pool = BLI_mempool_create(sizeof(SeqCacheKey), 0, 64, BLI_MEMPOOL_NOP);
     cache->items_pool = BLI_mempool_create(sizeof(SeqCacheItem), 0, 64, BLI_MEMPOOL_NOP);
     cache->hash = BLI_ghash_new(seq_cache_hashhash, seq_cache_hashcmp, "SeqCache hash");
-    cache->last_key = NULL;
     cache->bmain = bmain;
     BLI_mutex_init(&cache->iterator_mutex);
     scene->ed->cache = cache;
@@ -1190,6 +1316,182 @@ static SeqCacheKey *seq_cache_allocate_key(SeqCache *cache,
   return key;
 }
 
+/* -------------------------------------------------------------------- */
+/** \name Disk Cache Background I/O
+ * \{ */
+
+typedef enum eDiskCacheTaskType {
+  DCACHE_TASK_WRITE,
+  DCACHE_TASK_READ_AHEAD,
+} eDiskCacheTaskType;
+
+typedef struct DiskCacheTask {
+  eDiskCacheTaskType type;
+  /* Copy of the key, RAM cache entry may be freed before the task is processed. */
+  SeqCacheKey key;
+  /* Image to be written, task owns a reference. */
+  ImBuf *ibuf;
+} DiskCacheTask;
+
+static void seq_disk_cache_read_ahead_exec(SeqDiskCache *disk_cache, SeqCacheKey *key)
+{
+  Scene *scene = key->context.scene;
+  SeqCache *cache = key->cache_owner;
+
+  if (seq_cache_is_full()) {
+    return;
+  }
+
+  seq_cache_lock(scene);
+  const bool is_cached = BLI_ghash_haskey(cache->hash, key);
+  seq_cache_unlock(scene);
+
+  if (is_cached) {
+    return;
+  }
+
+  BLI_mutex_lock(&disk_cache->read_write_mutex);
+  ImBuf *ibuf = seq_disk_cache_read_file(disk_cache, key);
+  BLI_mutex_unlock(&disk_cache->read_write_mutex);
+
+  if (ibuf == NULL) {
+    return;
+  }
+
+  seq_cache_lock(scene);
+  if (!BLI_ghash_haskey(cache->hash, key)) {
+    /* Don't link to the chain of frame being rendered at the moment. */
+    SeqCacheKey *last_key = cache->last_key[key->task_id];
+    cache->last_key[key->task_id] = NULL;
+    SeqCacheKey *new_key = seq_cache_allocate_key(
+        cache, &key->context, key->seq, key->timeline_frame, key->type);
+    seq_cache_put_ex(scene, new_key, ibuf);
+    cache->last_key[key->task_id] = last_key;
+  }
+  seq_cache_unlock(scene);
+
+  IMB_freeImBuf(ibuf);
+}
+
+static void *seq_disk_cache_io_thread(void *disk_cache_v)
+{
+  SeqDiskCache *disk_cache = disk_cache_v;
+  DiskCacheTask *task;
+
+  while ((task = BLI_thread_queue_pop(disk_cache->io_queue))) {
+    switch (task->type) {
+      case DCACHE_TASK_WRITE:
+        BLI_mutex_lock(&disk_cache->read_write_mutex);
+        seq_disk_cache_write_file(disk_cache, &task->key, task->ibuf);
+        BLI_mutex_unlock(&disk_cache->read_write_mutex);
+        seq_disk_cache_enforce_limits(disk_cache);
+        IMB_freeImBuf(task->ibuf);
+        break;
+      case DCACHE_TASK_READ_AHEAD:
+        seq_disk_cache_read_ahead_exec(disk_cache, &task->key);
+        break;
+    }
+    MEM_freeN(task);
+
+    BLI_mutex_lock(&disk_cache->io_mutex);
+    disk_cache->io_tasks_pending--;
+    BLI_condition_notify_all(&disk_cache->io_cond);
+    BLI_mutex_unlock(&disk_cache->io_mutex);
+  }
+
+  return NULL;
+}
+
+static void seq_disk_cache_io_start(SeqDiskCache *disk_cache)
+{
+  disk_cache->io_queue = BLI_thread_queue_init();
+  BLI_mutex_init(&disk_cache->io_mutex);
+  BLI_condition_init(&disk_cache->io_cond);
+  BLI_threadpool_init(&disk_cache->io_threads, seq_disk_cache_io_thread, 1);
+  BLI_threadpool_insert(&disk_cache->io_threads, disk_cache);
+}
+
+/* Wait until all queued tasks are processed. Must be done before strips referenced by queued keys
+ * can be freed or their files deleted. */
+static void seq_disk_cache_io_flush(SeqDiskCache *disk_cache)
+{
+  BLI_mutex_lock(&disk_cache->io_mutex);
+  while (disk_cache->io_tasks_pending > 0) {
+    BLI_condition_wait(&disk_cache->io_cond, &disk_cache->io_mutex);
+  }
+  disk_cache->read_ahead_seq = NULL;
+  BLI_mutex_unlock(&disk_cache->io_mutex);
+}
+
+static void seq_disk_cache_io_end(SeqDiskCache *disk_cache)
+{
+  seq_disk_cache_io_flush(disk_cache);
+  BLI_thread_queue_nowait(disk_cache->io_queue);
+  BLI_threadpool_end(&disk_cache->io_threads);
+  BLI_thread_queue_free(disk_cache->io_queue);
+  BLI_condition_end(&disk_cache->io_cond);
+  BLI_mutex_end(&disk_cache->io_mutex);
+}
+
+/* Must be called with `io_mutex` locked. */
+static void seq_disk_cache_io_push(SeqDiskCache *disk_cache,
+                                   eDiskCacheTaskType type,
+                                   const SeqCacheKey *key,
+                                   ImBuf *ibuf)
+{
+  DiskCacheTask *task = MEM_callocN(sizeof(DiskCacheTask), "DiskCacheTask");
+  task->type = type;
+  task->key = *key;
+  task->key.link_prev = NULL;
+  task->key.link_next = NULL;
+  task->ibuf = ibuf;
+
+  disk_cache->io_tasks_pending++;
+  BLI_thread_queue_push(disk_cache->io_queue, task);
+}
+
+/* Queue image to be written, blocks when too many images are waiting to be written. */
+static void seq_disk_cache_write_async(SeqDiskCache *disk_cache, SeqCacheKey *key, ImBuf *ibuf)
+{
+  BLI_mutex_lock(&disk_cache->io_mutex);
+  while (disk_cache->io_tasks_pending >= DCACHE_IO_QUEUE_MAX) {
+    BLI_condition_wait(&disk_cache->io_cond, &disk_cache->io_mutex);
+  }
+  IMB_refImBuf(ibuf);
+  seq_disk_cache_io_push(disk_cache, DCACHE_TASK_WRITE, key, ibuf);
+  BLI_mutex_unlock(&disk_cache->io_mutex);
+}
+
+/* Queue reading of frames following `key` into RAM cache. Read-ahead is skipped when the I/O
+ * thread is busy, it must never delay rendering. */
+static void seq_disk_cache_read_ahead(SeqDiskCache *disk_cache, const SeqCacheKey *key)
+{
+  Sequence *seq = key->seq;
+  float timeline_frame = key->timeline_frame + 1;
+  const float end_frame = min_ff(key->timeline_frame + DCACHE_READ_AHEAD_FRAMES,
+                                 seq->enddisp - 1);
+
+  BLI_mutex_lock(&disk_cache->io_mutex);
+  if (disk_cache->read_ahead_seq == seq && disk_cache->read_ahead_frame >= timeline_frame &&
+      disk_cache->read_ahead_frame <= end_frame) {
+    timeline_frame = disk_cache->read_ahead_frame + 1;
+  }
+
+  for (; timeline_frame <= end_frame; timeline_frame++) {
+    if (disk_cache->io_tasks_pending >= DCACHE_IO_QUEUE_MAX) {
+      break;
+    }
+    SeqCacheKey read_key;
+    seq_cache_populate_key(&read_key, &key->context, seq, timeline_frame, key->type);
+    seq_disk_cache_io_push(disk_cache, DCACHE_TASK_READ_AHEAD, &read_key, NULL);
+    disk_cache->read_ahead_seq = seq;
+    disk_cache->read_ahead_frame = timeline_frame;
+  }
+  BLI_mutex_unlock(&disk_cache->io_mutex);
+}
+
+/** \} */
+
 /* ***************************** API ****************************** */
 
 void seq_cache_free_temp_cache(Scene *scene, short id, int timeline_frame)
@@ -1233,6 +1535,7 @@ void seq_cache_destruct(Scene *scene)
   BLI_mutex_end(&cache->iterator_mutex);
 
   if (cache->disk_cache != NULL) {
+    seq_disk_cache_io_end(cache->disk_cache);
     BLI_freelistN(&cache->disk_cache->files);
     BLI_mutex_end(&cache->disk_cache->read_write_mutex);
     MEM_freeN(cache->disk_cache);
@@ -1257,6 +1560,10 @@ void SEQ_cache_cleanup(Scene *scene)
     return;
   }
 
+  if (cache->disk_cache != NULL) {
+    seq_disk_cache_io_flush(cache->disk_cache);
+  }
+
   seq_cache_lock(scene);
 
   GHashIterator gh_iter;
@@ -1267,7 +1574,7 @@ void SEQ_cache_cleanup(Scene *scene)
     BLI_ghashIterator_step(&gh_iter);
     BLI_ghash_remove(cache->hash, key, seq_cache_keyfree, seq_cache_valfree);
   }
-  cache->last_key = NULL;
+  seq_cache_reset_links(cache);
   seq_cache_unlock(scene);
 }
 
@@ -1282,8 +1589,12 @@ void seq_cache_cleanup_sequence(Scene *scene,
     return;
   }
 
-  if (seq_disk_cache_is_enabled(cache->bmain) && cache->disk_cache != NULL) {
-    seq_disk_cache_invalidate(scene, seq, seq_changed, invalidate_types);
+  if (cache->disk_cache != NULL) {
+    seq_disk_cache_io_flush(cache->disk_cache);
+
+    if (seq_disk_cache_is_enabled(cache->bmain)) {
+      seq_disk_cache_invalidate(scene, seq, seq_changed, invalidate_types);
+    }
   }
 
   seq_cache_lock(scene);
@@ -1331,7 +1642,7 @@ void seq_cache_cleanup_sequence(Scene *scene,
       BLI_ghash_remove(cache->hash, key, seq_cache_keyfree, seq_cache_valfree);
     }
   }
-  cache->last_key = NULL;
+  seq_cache_reset_links(cache);
   seq_cache_unlock(scene);
 }
 
@@ -1396,6 +1707,11 @@ struct ImBuf *seq_cache_get(const SeqRenderData *context,
       SeqCacheKey *new_key = seq_cache_allocate_key(cache, context, seq, timeline_frame, type);
       seq_cache_put_ex(scene, new_key, ibuf);
     }
+
+    /* Final frames are read sequentially during playback, intermediate images are not. */
+    if (key.type == SEQ_CACHE_STORE_FINAL_OUT) {
+      seq_disk_cache_read_ahead(cache->disk_cache, &key);
+    }
   }
 
   return ibuf;
@@ -1421,8 +1737,9 @@ bool seq_cache_put_if_possible(
     return true;
   }
 
-  seq_cache_set_temp_cache_linked(scene, scene->ed->cache->last_key);
-  scene->ed->cache->last_key = NULL;
+  SeqCache *cache = seq_cache_get_from_scene(scene);
+  seq_cache_set_temp_cache_linked(scene, cache->last_key[context->task_id]);
+  cache->last_key[context->task_id] = NULL;
   return false;
 }
 
@@ -1465,10 +1782,7 @@ void seq_cache_put(
         seq_disk_cache_create(context->bmain, context->scene);
       }
 
-      BLI_mutex_lock(&cache->disk_cache->read_write_mutex);
-      seq_disk_cache_write_file(cache->disk_cache, key, i);
-      BLI_mutex_unlock(&cache->disk_cache->read_write_mutex);
-      seq_disk_cache_enforce_limits(cache->disk_cache);
+      seq_disk_cache_write_async(cache->disk_cache, key, i);
     }
   }
 }
@@ -1497,11 +1811,13 @@ void SEQ_cache_iterate(
     interrupt = callback_iter(userdata, key->seq, key->timeline_frame, key->type);
   }
 
-  cache->last_key = NULL;
+  seq_cache_reset_links(cache);
   seq_cache_unlock(scene);
 }
 
+/* The budget is shared with image and movie clip caches, which are never made to free their
+ * buffers for the sequencer: this cache only frees its own. */
 bool seq_cache_is_full(void)
 {
-  return seq_cache_get_mem_total() < MEM_get_memory_in_use();
+  return seq_cache_get_mem_total() < IMB_moviecache_get_memory_in_use();
 }
@@ -34,8 +34,12 @@
 #include "DNA_windowmanager_types.h"
 
 #include "BLI_listbase.h"
+#include "BLI_math_base.h"
+#include "BLI_system.h"
 #include "BLI_threads.h"
 
+#include "PIL_time.h"
+
 #include "IMB_imbuf.h"
 #include "IMB_imbuf_types.h"
 
@@ -61,34 +65,60 @@
 #include "prefetch.h"
 #include "render.h"
 
+/* Time over which frames are counted for the fill rate shown in cache overlay, in seconds. */
+#define SEQ_PREFETCH_FILL_RATE_WINDOW 0.5
+
+/* Renders one frame at a time from its own evaluated copy of the scene, so multiple frames can
+ * be rendered at once. */
+typedef struct PrefetchWorker {
+  struct PrefetchJob *pfjob;
+
+  struct Main *bmain_eval;
+  struct Scene *scene_eval;
+  struct Depsgraph *depsgraph;
+  /* The scene changed since the depsgraph was built, it is rebuilt by the worker thread. */
+  bool depsgraph_outdated;
+
+  /* context, both use task ID of this worker */
+  struct SeqRenderData context;
+  struct SeqRenderData context_cpy;
+} PrefetchWorker;
+
 typedef struct PrefetchJob {
   struct PrefetchJob *next, *prev;
 
   struct Main *bmain;
-  struct Main *bmain_eval;
   struct Scene *scene;
-  struct Scene *scene_eval;
-  struct Depsgraph *depsgraph;
 
+  PrefetchWorker *workers;
+  int tot_workers;
+  int tot_workers_running;
+  int tot_workers_waiting;
+
+  /* Protects prefetch area and control variables. */
   ThreadMutex prefetch_suspend_mutex;
   ThreadCondition prefetch_suspend_cond;
+  /* Depsgraph evaluation is not done concurrently, rendering is. */
+  ThreadMutex eval_mutex;
 
   ListBase threads;
 
-  /* context */
-  struct SeqRenderData context;
-  struct SeqRenderData context_cpy;
-  struct ListBase *seqbasep;
-  struct ListBase *seqbasep_cpy;
-
-  /* prefetch area */
+  /* prefetch area, frames up to `cfra + num_frames_prefetched` are prefetched or being
+   * rendered */
   float cfra;
   int num_frames_prefetched;
 
+  /* fill rate statistics */
+  double fill_rate_time;
+  int fill_rate_frames;
+  float fill_rate;
+  bool fill_rate_reset;
+
   /* control */
   bool running;
-  bool waiting;
   bool stop;
+  /* Prefetching was stopped because the scene changed, see #SEQ_prefetch_stop. */
+  bool scene_changed;
 } PrefetchJob;
 
 static bool seq_prefetch_is_playing(const Main *bmain)
@@ -131,6 +161,7 @@ bool seq_prefetch_job_is_running(Scene *scene)
   return pfjob->running;
 }
 
+/* All threads are suspended. */
 static bool seq_prefetch_job_is_waiting(Scene *scene)
 {
   PrefetchJob *pfjob = seq_prefetch_job_get(scene);
@@ -139,7 +170,8 @@ static bool seq_prefetch_job_is_waiting(Scene *scene)
     return false;
   }
 
-  return pfjob->waiting;
+  return pfjob->tot_workers_waiting > 0 &&
+         pfjob->tot_workers_waiting == pfjob->tot_workers_running;
 }
 
 static Sequence *sequencer_prefetch_get_original_sequence(Sequence *seq, ListBase *seqbase)
@@ -171,8 +203,10 @@ Sequence *seq_prefetch_get_original_sequence(Sequence *seq, Scene *scene)
 SeqRenderData *seq_prefetch_get_original_context(const SeqRenderData *context)
 {
   PrefetchJob *pfjob = seq_prefetch_job_get(context->scene);
+  const int worker_index = context->task_id - SEQ_TASK_PREFETCH_RENDER;
 
-  return &pfjob->context;
+  BLI_assert(worker_index >= 0 && worker_index < pfjob->tot_workers);
+  return &pfjob->workers[worker_index].context;
 }
 
 static bool seq_prefetch_is_cache_full(Scene *scene)
@@ -190,10 +224,6 @@ static float seq_prefetch_cfra(PrefetchJob *pfjob)
 {
   return pfjob->cfra + pfjob->num_frames_prefetched;
 }
-static AnimationEvalContext seq_prefetch_anim_eval_context(PrefetchJob *pfjob)
-{
-  return BKE_animsys_eval_context_construct(pfjob->depsgraph, seq_prefetch_cfra(pfjob));
-}
 
 void seq_prefetch_get_time_range(Scene *scene, int *start, int *end)
 {
@@ -203,37 +233,75 @@ void seq_prefetch_get_time_range(Scene *scene, int *start, int *end)
   *end = seq_prefetch_cfra(pfjob);
 }
 
-static void seq_prefetch_free_depsgraph(PrefetchJob *pfjob)
+static void seq_prefetch_free_depsgraph(PrefetchWorker *worker)
 {
-  if (pfjob->depsgraph != NULL) {
-    DEG_graph_free(pfjob->depsgraph);
+  if (worker->depsgraph != NULL) {
+    DEG_graph_free(worker->depsgraph);
   }
-  pfjob->depsgraph = NULL;
-  pfjob->scene_eval = NULL;
+  worker->depsgraph = NULL;
+  worker->scene_eval = NULL;
 }
 
-static void seq_prefetch_update_depsgraph(PrefetchJob *pfjob)
+static void seq_prefetch_update_depsgraph(PrefetchWorker *worker, float timeline_frame)
 {
-  DEG_evaluate_on_framechange(pfjob->depsgraph, seq_prefetch_cfra(pfjob));
+  PrefetchJob *pfjob = worker->pfjob;
+
+  BLI_mutex_lock(&pfjob->eval_mutex);
+  worker->scene_eval->ed->prefetch_job = NULL;
+
+  DEG_evaluate_on_framechange(worker->depsgraph, timeline_frame);
+  AnimData *adt = BKE_animdata_from_id(&worker->scene_eval->id);
+  AnimationEvalContext anim_eval_context = BKE_animsys_eval_context_construct(worker->depsgraph,
+                                                                              timeline_frame);
+  BKE_animsys_evaluate_animdata(
+      &worker->scene_eval->id, adt, &anim_eval_context, ADT_RECALC_ALL, false);
+
+  /* This is quite hacky solution:
+   * We need cross-reference original scene with copy for cache.
+   * However depsgraph must not have this data, because it will try to kill this job.
+   * Scene copy don't reference original scene. Perhaps, this could be done by depsgraph.
+   * Set to NULL before return!
+   */
+  worker->scene_eval->ed->prefetch_job = pfjob;
+  BLI_mutex_unlock(&pfjob->eval_mutex);
 }
 
-static void seq_prefetch_init_depsgraph(PrefetchJob *pfjob)
+/* Must be called with `eval_mutex` held. */
+static void seq_prefetch_init_depsgraph(PrefetchWorker *worker)
 {
-  Main *bmain = pfjob->bmain_eval;
+  PrefetchJob *pfjob = worker->pfjob;
+  Main *bmain = worker->bmain_eval;
   Scene *scene = pfjob->scene;
   ViewLayer *view_layer = BKE_view_layer_default_render(scene);
 
-  pfjob->depsgraph = DEG_graph_new(bmain, scene, view_layer, DAG_EVAL_RENDER);
-  DEG_debug_name_set(pfjob->depsgraph, "SEQUENCER PREFETCH");
+  worker->depsgraph = DEG_graph_new(bmain, scene, view_layer, DAG_EVAL_RENDER);
+  DEG_debug_name_set(worker->depsgraph, "SEQUENCER PREFETCH");
 
   /* Make sure there is a correct evaluated scene pointer. */
-  DEG_graph_build_for_render_pipeline(pfjob->depsgraph);
+  DEG_graph_build_for_render_pipeline(worker->depsgraph);
 
   /* Update immediately so we have proper evaluated scene. */
-  seq_prefetch_update_depsgraph(pfjob);
+  DEG_evaluate_on_framechange(worker->depsgraph, seq_prefetch_cfra(pfjob));
 
-  pfjob->scene_eval = DEG_get_evaluated_scene(pfjob->depsgraph);
-  pfjob->scene_eval->ed->cache_flag = 0;
+  worker->scene_eval = DEG_get_evaluated_scene(worker->depsgraph);
+  worker->scene_eval->ed->cache_flag = 0;
+}
+
+/* Builds the depsgraph of the worker from its thread, when there is none yet or the scene changed
+ * since it was built. Workers started again without changes keep their evaluated scene. */
+static void seq_prefetch_ensure_depsgraph(PrefetchWorker *worker)
+{
+  PrefetchJob *pfjob = worker->pfjob;
+
+  if (worker->depsgraph != NULL && !worker->depsgraph_outdated) {
+    return;
+  }
+
+  BLI_mutex_lock(&pfjob->eval_mutex);
+  seq_prefetch_free_depsgraph(worker);
+  seq_prefetch_init_depsgraph(worker);
+  worker->depsgraph_outdated = false;
+  BLI_mutex_unlock(&pfjob->eval_mutex);
 }
 
 static void seq_prefetch_update_area(PrefetchJob *pfjob)
@@ -279,9 +347,11 @@ void SEQ_prefetch_stop(Scene *scene)
   }
 
   pfjob->stop = true;
+  /* Scene changes stop prefetching, so workers have to rebuild their depsgraph. */
+  pfjob->scene_changed = true;
 
   while (pfjob->running) {
-    BLI_condition_notify_one(&pfjob->prefetch_suspend_cond);
+    BLI_condition_notify_all(&pfjob->prefetch_suspend_cond);
   }
 }
 
@@ -290,32 +360,43 @@ static void seq_prefetch_update_context(const SeqRenderData *context)
   PrefetchJob *pfjob;
   pfjob = seq_prefetch_job_get(context->scene);
 
-  SEQ_render_new_render_data(pfjob->bmain_eval,
-                             pfjob->depsgraph,
-                             pfjob->scene_eval,
-                             context->rectx,
-                             context->recty,
-                             context->preview_render_size,
-                             false,
-                             &pfjob->context_cpy);
-  pfjob->context_cpy.is_prefetch_render = true;
-  pfjob->context_cpy.task_id = SEQ_TASK_PREFETCH_RENDER;
-
-  SEQ_render_new_render_data(pfjob->bmain,
-                             pfjob->depsgraph,
-                             pfjob->scene,
-                             context->rectx,
-                             context->recty,
-                             context->preview_render_size,
-                             false,
-                             &pfjob->context);
-  pfjob->context.is_prefetch_render = false;
+  for (int i = 0; i < pfjob->tot_workers; i++) {
+    PrefetchWorker *worker = &pfjob->workers[i];
+
+    /* The worker sets the depsgraph once it is built. */
+    SEQ_render_new_render_data(pfjob->bmain,
+                               NULL,
+                               pfjob->scene,
+                               context->rectx,
+                               context->recty,
+                               context->preview_render_size,
+                               false,
+                               &worker->context);
+    worker->context.is_prefetch_render = false;
+
+    /* Same ID as prefetch context, because context will be swapped, but we still
+     * want to assign this ID to cache entries created in this thread.
+     * This is to allow "temp cache" work correctly for all threads.
+     */
+    worker->context.task_id = SEQ_TASK_PREFETCH_RENDER + i;
+  }
+}
 
-  /* Same ID as prefetch context, because context will be swapped, but we still
-   * want to assign this ID to cache entries created in this thread.
-   * This is to allow "temp cache" work correctly for both threads.
-   */
-  pfjob->context.task_id = SEQ_TASK_PREFETCH_RENDER;
+/* Called by the worker thread once its depsgraph is built. */
+static void seq_prefetch_update_context_cpy(PrefetchWorker *worker)
+{
+  worker->context.depsgraph = worker->depsgraph;
+
+  SEQ_render_new_render_data(worker->bmain_eval,
+                             worker->depsgraph,
+                             worker->scene_eval,
+                             worker->context.rectx,
+                             worker->context.recty,
+                             worker->context.preview_render_size,
+                             false,
+                             &worker->context_cpy);
+  worker->context_cpy.is_prefetch_render = true;
+  worker->context_cpy.task_id = worker->context.task_id;
 }
 
 static void seq_prefetch_update_scene(Scene *scene)
@@ -326,17 +407,22 @@ static void seq_prefetch_update_scene(Scene *scene)
     return;
   }
 
+  /* Only flag the depsgraphs here, building them is left to the workers. */
+  if (pfjob->scene_changed || pfjob->scene != scene) {
+    for (int i = 0; i < pfjob->tot_workers; i++) {
+      pfjob->workers[i].depsgraph_outdated = true;
+    }
+  }
   pfjob->scene = scene;
-  seq_prefetch_free_depsgraph(pfjob);
-  seq_prefetch_init_depsgraph(pfjob);
+  pfjob->scene_changed = false;
 }
 
 static void seq_prefetch_resume(Scene *scene)
 {
   PrefetchJob *pfjob = seq_prefetch_job_get(scene);
 
-  if (pfjob && pfjob->waiting) {
-    BLI_condition_notify_one(&pfjob->prefetch_suspend_cond);
+  if (pfjob && pfjob->tot_workers_waiting > 0) {
+    BLI_condition_notify_all(&pfjob->prefetch_suspend_cond);
   }
 }
 
@@ -349,30 +435,35 @@ void seq_prefetch_free(Scene *scene)
 
   SEQ_prefetch_stop(scene);
 
-  BLI_threadpool_remove(&pfjob->threads, pfjob);
+  for (int i = 0; i < pfjob->tot_workers; i++) {
+    BLI_threadpool_remove(&pfjob->threads, &pfjob->workers[i]);
+  }
   BLI_threadpool_end(&pfjob->threads);
   BLI_mutex_end(&pfjob->prefetch_suspend_mutex);
+  BLI_mutex_end(&pfjob->eval_mutex);
   BLI_condition_end(&pfjob->prefetch_suspend_cond);
-  seq_prefetch_free_depsgraph(pfjob);
-  BKE_main_free(pfjob->bmain_eval);
+  for (int i = 0; i < pfjob->tot_workers; i++) {
+    seq_prefetch_free_depsgraph(&pfjob->workers[i]);
+    BKE_main_free(pfjob->workers[i].bmain_eval);
+  }
+  MEM_freeN(pfjob->workers);
   MEM_freeN(pfjob);
   scene->ed->prefetch_job = NULL;
 }
 
 /* Skip frame if we need to render 3D scene strip. Rendering 3D scene requires main lock or setting
  * up render job that doesn't have API to do openGL renders which can be used for sequencer. */
-static bool seq_prefetch_do_skip_frame(PrefetchJob *pfjob, ListBase *seqbase)
+static bool seq_prefetch_do_skip_frame(PrefetchWorker *worker, ListBase *seqbase, float cfra)
 {
-  float cfra = seq_prefetch_cfra(pfjob);
   Sequence *seq_arr[MAXSEQ + 1];
   int count = seq_get_shown_sequences(seqbase, cfra, 0, seq_arr);
-  SeqRenderData *ctx = &pfjob->context_cpy;
+  SeqRenderData *ctx = &worker->context_cpy;
   ImBuf *ibuf = NULL;
 
   /* Disable prefetching 3D scene strips, but check for disk cache. */
   for (int i = 0; i < count; i++) {
     if (seq_arr[i]->type == SEQ_TYPE_META &&
-        seq_prefetch_do_skip_frame(pfjob, &seq_arr[i]->seqbase)) {
+        seq_prefetch_do_skip_frame(worker, &seq_arr[i]->seqbase, cfra)) {
       return true;
     }
 
@@ -423,58 +514,76 @@ static bool seq_prefetch_do_skip_frame(PrefetchJob *pfjob, ListBase *seqbase)
   return false;
 }
 
+/* Nothing to hand out to threads. */
 static bool seq_prefetch_need_suspend(PrefetchJob *pfjob)
 {
   return seq_prefetch_is_cache_full(pfjob->scene) || seq_prefetch_is_scrubbing(pfjob->bmain) ||
-         (seq_prefetch_cfra(pfjob) >= pfjob->scene->r.efra);
+         (seq_prefetch_cfra(pfjob) > pfjob->scene->r.efra);
 }
 
-static void seq_prefetch_do_suspend(PrefetchJob *pfjob)
+/* Must be called with `prefetch_suspend_mutex` held. */
+static void seq_prefetch_fill_rate_update(PrefetchJob *pfjob)
 {
-  BLI_mutex_lock(&pfjob->prefetch_suspend_mutex);
-  while (seq_prefetch_need_suspend(pfjob) &&
-         (pfjob->scene->ed->cache_flag & SEQ_CACHE_PREFETCH_ENABLE) && !pfjob->stop) {
-    pfjob->waiting = true;
-    BLI_condition_wait(&pfjob->prefetch_suspend_cond, &pfjob->prefetch_suspend_mutex);
-    seq_prefetch_update_area(pfjob);
+  const double time = PIL_check_seconds_timer();
+
+  pfjob->fill_rate_frames++;
+
+  const double elapsed = time - pfjob->fill_rate_time;
+  if (elapsed >= SEQ_PREFETCH_FILL_RATE_WINDOW) {
+    pfjob->fill_rate = (float)(pfjob->fill_rate_frames / elapsed);
+    pfjob->fill_rate_frames = 0;
+    pfjob->fill_rate_time = time;
   }
-  pfjob->waiting = false;
-  BLI_mutex_unlock(&pfjob->prefetch_suspend_mutex);
 }
 
-static void *seq_prefetch_frames(void *job)
+/* Must be called with `prefetch_suspend_mutex` held. */
+static void seq_prefetch_fill_rate_reset(PrefetchJob *pfjob)
 {
-  PrefetchJob *pfjob = (PrefetchJob *)job;
+  pfjob->fill_rate = 0.0f;
+  pfjob->fill_rate_frames = 0;
+  pfjob->fill_rate_time = PIL_check_seconds_timer();
+  pfjob->fill_rate_reset = false;
+}
 
-  while (seq_prefetch_cfra(pfjob) <= pfjob->scene->r.efra) {
-    pfjob->scene_eval->ed->prefetch_job = NULL;
+static void seq_prefetch_render_frame(PrefetchWorker *worker, float timeline_frame)
+{
+  PrefetchJob *pfjob = worker->pfjob;
 
-    seq_prefetch_update_depsgraph(pfjob);
-    AnimData *adt = BKE_animdata_from_id(&pfjob->context_cpy.scene->id);
-    AnimationEvalContext anim_eval_context = seq_prefetch_anim_eval_context(pfjob);
-    BKE_animsys_evaluate_animdata(
-        &pfjob->context_cpy.scene->id, adt, &anim_eval_context, ADT_RECALC_ALL, false);
+  seq_prefetch_update_depsgraph(worker, timeline_frame);
 
-    /* This is quite hacky solution:
-     * We need cross-reference original scene with copy for cache.
-     * However depsgraph must not have this data, because it will try to kill this job.
-     * Scene copy don't reference original scene. Perhaps, this could be done by depsgraph.
-     * Set to NULL before return!
-     */
-    pfjob->scene_eval->ed->prefetch_job = pfjob;
+  ListBase *seqbase = SEQ_active_seqbase_get(SEQ_editing_get(pfjob->scene, false));
+  if (seq_prefetch_do_skip_frame(worker, seqbase, timeline_frame)) {
+    return;
+  }
 
-    ListBase *seqbase = SEQ_active_seqbase_get(SEQ_editing_get(pfjob->scene, false));
-    if (seq_prefetch_do_skip_frame(pfjob, seqbase)) {
-      pfjob->num_frames_prefetched++;
-      continue;
-    }
+  ImBuf *ibuf = SEQ_render_give_ibuf(&worker->context_cpy, timeline_frame, 0);
+  seq_cache_free_temp_cache(pfjob->scene, worker->context.task_id, timeline_frame);
+  IMB_freeImBuf(ibuf);
+}
 
-    ImBuf *ibuf = SEQ_render_give_ibuf(&pfjob->context_cpy, seq_prefetch_cfra(pfjob), 0);
-    seq_cache_free_temp_cache(pfjob->scene, pfjob->context.task_id, seq_prefetch_cfra(pfjob));
-    IMB_freeImBuf(ibuf);
+static void *seq_prefetch_frames(void *worker_v)
+{
+  PrefetchWorker *worker = (PrefetchWorker *)worker_v;
+  PrefetchJob *pfjob = worker->pfjob;
+
+  seq_prefetch_ensure_depsgraph(worker);
+  seq_prefetch_update_context_cpy(worker);
+
+  BLI_mutex_lock(&pfjob->prefetch_suspend_mutex);
+  while ((pfjob->scene->ed->cache_flag & SEQ_CACHE_PREFETCH_ENABLE) && !pfjob->stop) {
+    seq_prefetch_update_area(pfjob);
 
     /* Suspend thread if there is nothing to be prefetched. */
-    seq_prefetch_do_suspend(pfjob);
+    if (seq_prefetch_need_suspend(pfjob)) {
+      pfjob->tot_workers_waiting++;
+      if (pfjob->tot_workers_waiting == pfjob->tot_workers_running) {
+        /* Don't count time spent suspended. */
+        pfjob->fill_rate_reset = true;
+      }
+      BLI_condition_wait(&pfjob->prefetch_suspend_cond, &pfjob->prefetch_suspend_mutex);
+      pfjob->tot_workers_waiting--;
+      continue;
+    }
 
     /* Avoid "collision" with main thread, but make sure to fetch at least few frames */
     if (pfjob->num_frames_prefetched > 5 &&
@@ -482,21 +591,41 @@ static void *seq_prefetch_frames(void *job)
       break;
     }
 
-    if (!(pfjob->scene->ed->cache_flag & SEQ_CACHE_PREFETCH_ENABLE) || pfjob->stop) {
-      break;
+    if (pfjob->fill_rate_reset) {
+      seq_prefetch_fill_rate_reset(pfjob);
     }
 
-    seq_prefetch_update_area(pfjob);
+    const float timeline_frame = seq_prefetch_cfra(pfjob);
     pfjob->num_frames_prefetched++;
+    BLI_mutex_unlock(&pfjob->prefetch_suspend_mutex);
+
+    seq_prefetch_render_frame(worker, timeline_frame);
+
+    BLI_mutex_lock(&pfjob->prefetch_suspend_mutex);
+    seq_prefetch_fill_rate_update(pfjob);
   }
+  BLI_mutex_unlock(&pfjob->prefetch_suspend_mutex);
+
+  seq_cache_free_temp_cache(pfjob->scene, worker->context.task_id, seq_prefetch_cfra(pfjob));
+  worker->scene_eval->ed->prefetch_job = NULL;
 
-  seq_cache_free_temp_cache(pfjob->scene, pfjob->context.task_id, seq_prefetch_cfra(pfjob));
-  pfjob->running = false;
-  pfjob->scene_eval->ed->prefetch_job = NULL;
+  BLI_mutex_lock(&pfjob->prefetch_suspend_mutex);
+  pfjob->tot_workers_running--;
+  if (pfjob->tot_workers_running == 0) {
+    pfjob->running = false;
+  }
+  BLI_mutex_unlock(&pfjob->prefetch_suspend_mutex);
 
   return NULL;
 }
 
+/* Each thread keeps own evaluated copy of the scene and frames are rendered using threads
+ * already, so only a fraction of the cores is used to render multiple frames at once. */
+static int seq_prefetch_num_workers(void)
+{
+  return clamp_i(BLI_system_thread_count() / 4, 1, SEQ_PREFETCH_MAX_THREADS);
+}
+
 static PrefetchJob *seq_prefetch_start_ex(const SeqRenderData *context, float cfra)
 {
   PrefetchJob *pfjob = seq_prefetch_job_get(context->scene);
@@ -506,13 +635,21 @@ static PrefetchJob *seq_prefetch_start_ex(const SeqRenderData *context, float cf
       pfjob = (PrefetchJob *)MEM_callocN(sizeof(PrefetchJob), "PrefetchJob");
       context->scene->ed->prefetch_job = pfjob;
 
-      BLI_threadpool_init(&pfjob->threads, seq_prefetch_frames, 1);
+      pfjob->tot_workers = seq_prefetch_num_workers();
+      pfjob->workers = MEM_callocN(sizeof(PrefetchWorker) * pfjob->tot_workers,
+                                   "PrefetchWorker");
+
+      BLI_threadpool_init(&pfjob->threads, seq_prefetch_frames, pfjob->tot_workers);
       BLI_mutex_init(&pfjob->prefetch_suspend_mutex);
+      BLI_mutex_init(&pfjob->eval_mutex);
       BLI_condition_init(&pfjob->prefetch_suspend_cond);
 
-      pfjob->bmain_eval = BKE_main_new();
       pfjob->scene = context->scene;
-      seq_prefetch_init_depsgraph(pfjob);
+      for (int i = 0; i < pfjob->tot_workers; i++) {
+        PrefetchWorker *worker = &pfjob->workers[i];
+        worker->pfjob = pfjob;
+        worker->bmain_eval = BKE_main_new();
+      }
     }
   }
   pfjob->bmain = context->bmain;
@@ -520,15 +657,21 @@ static PrefetchJob *seq_prefetch_start_ex(const SeqRenderData *context, float cf
   pfjob->cfra = cfra;
   pfjob->num_frames_prefetched = 1;
 
-  pfjob->waiting = false;
+  pfjob->tot_workers_running = pfjob->tot_workers;
+  pfjob->tot_workers_waiting = 0;
   pfjob->stop = false;
   pfjob->running = true;
+  seq_prefetch_fill_rate_reset(pfjob);
 
   seq_prefetch_update_scene(context->scene);
   seq_prefetch_update_context(context);
 
-  BLI_threadpool_remove(&pfjob->threads, pfjob);
-  BLI_threadpool_insert(&pfjob->threads, pfjob);
+  for (int i = 0; i < pfjob->tot_workers; i++) {
+    BLI_threadpool_remove(&pfjob->threads, &pfjob->workers[i]);
+  }
+  for (int i = 0; i < pfjob->tot_workers; i++) {
+    BLI_threadpool_insert(&pfjob->threads, &pfjob->workers[i]);
+  }
 
   return pfjob;
 }
@@ -576,3 +719,18 @@ bool SEQ_prefetch_need_redraw(Main *bmain, Scene *scene)
   }
   return false;
 }
+
+/**
+ * Rate at which prefetching fills the cache, in frames per second.
+ * Zero when prefetching is not running or suspended.
+ */
+float SEQ_prefetch_fill_rate_get(Scene *scene)
+{
+  PrefetchJob *pfjob = seq_prefetch_job_get(scene);
+
+  if (!pfjob || !pfjob->running || seq_prefetch_job_is_waiting(scene)) {
+    return 0.0f;
+  }
+
+  return pfjob->fill_rate;
+}
@@ -36,8 +36,10 @@
 
 #include "BLI_linklist.h"
 #include "BLI_listbase.h"
+#include "BLI_math_base.h"
 #include "BLI_path_util.h"
 #include "BLI_rect.h"
+#include "BLI_task.h"
 
 #include "BKE_anim_data.h"
 #include "BKE_animsys.h"
@@ -527,14 +529,39 @@ static void sequencer_image_crop_init(const Sequence *seq,
   BLI_rctf_init(r_crop, left, in->x - right, bottom, in->y - top);
 }
 
+static float seq_preview_scale_factor_get(const SeqRenderData *context)
+{
+  const Scene *scene = context->scene;
+  return context->preview_render_size == SEQ_RENDER_SIZE_SCENE ?
+             (float)scene->r.size / 100 :
+             SEQ_rendersize_to_scale_factor(context->preview_render_size);
+}
+
+/**
+ * Without crop and transform, the image may only need to be resized to fill the output exactly.
+ * The separable scaling filter does this much faster than #IMB_transform and filters properly
+ * when down-scaling, instead of point sampling.
+ */
+static bool sequencer_preprocess_is_scale_only(const SeqRenderData *context,
+                                               const Sequence *seq,
+                                               const ImBuf *in,
+                                               const bool is_proxy_image)
+{
+  if (sequencer_use_crop(seq) || sequencer_use_transform(seq)) {
+    return false;
+  }
+
+  const float image_scale_factor = seq_need_scale_to_render_size(seq, is_proxy_image) ?
+                                       1.0f :
+                                       seq_preview_scale_factor_get(context);
+  return round_fl_to_int(in->x * image_scale_factor) == context->rectx &&
+         round_fl_to_int(in->y * image_scale_factor) == context->recty;
+}
+
 static void sequencer_preprocess_transform_crop(
     ImBuf *in, ImBuf *out, const SeqRenderData *context, Sequence *seq, const bool is_proxy_image)
 {
-  const Scene *scene = context->scene;
-  const float preview_scale_factor = context->preview_render_size == SEQ_RENDER_SIZE_SCENE ?
-                                         (float)scene->r.size / 100 :
-                                         SEQ_rendersize_to_scale_factor(
-                                             context->preview_render_size);
+  const float preview_scale_factor = seq_preview_scale_factor_get(context);
   const bool do_scale_to_render_size = seq_need_scale_to_render_size(seq, is_proxy_image);
   const float image_scale_factor = do_scale_to_render_size ? 1.0f : preview_scale_factor;
 
@@ -606,8 +633,24 @@ static ImBuf *input_preprocess(const SeqRenderData *context,
     IMB_filtery(preprocessed_ibuf);
   }
 
-  if (sequencer_use_crop(seq) || sequencer_use_transform(seq) || context->rectx != ibuf->x ||
-      context->recty != ibuf->y) {
+  if ((context->rectx != ibuf->x || context->recty != ibuf->y) &&
+      sequencer_preprocess_is_scale_only(context, seq, ibuf, is_proxy_image)) {
+    preprocessed_ibuf = IMB_makeSingleUser(ibuf);
+    ibuf = preprocessed_ibuf;
+
+    /* Match #sequencer_preprocess_transform_crop, which only outputs one buffer. */
+    if (preprocessed_ibuf->rect_float) {
+      imb_freerectImBuf(preprocessed_ibuf);
+    }
+    IMB_scaleImBuf_filtered(preprocessed_ibuf,
+                            context->rectx,
+                            context->recty,
+                            context->for_render ? IMB_SCALE_FILTER_MITCHELL :
+                                                  IMB_SCALE_FILTER_BILINEAR);
+    seq_imbuf_assign_spaces(scene, preprocessed_ibuf);
+  }
+  else if (sequencer_use_crop(seq) || sequencer_use_transform(seq) ||
+           context->rectx != ibuf->x || context->recty != ibuf->y) {
     const int x = context->rectx;
     const int y = context->recty;
     preprocessed_ibuf = IMB_allocImBuf(x, y, 32, ibuf->rect_float ? IB_rectfloat : IB_rect);
@@ -1831,6 +1874,107 @@ static ImBuf *seq_render_strip_stack_apply_effect(
   return out;
 }
 
+typedef struct StackRenderData {
+  const SeqRenderData *context;
+  SeqRenderState *state;
+  float timeline_frame;
+  Sequence **seq_arr;
+  ImBuf **ibuf_arr;
+} StackRenderData;
+
+/* Only strips which don't depend on other strips or on global state can be rendered
+ * concurrently. Image and movie strips are where decoding time goes. */
+static bool seq_render_strip_stack_can_render_parallel(const Sequence *seq)
+{
+  return ELEM(seq->type, SEQ_TYPE_IMAGE, SEQ_TYPE_MOVIE);
+}
+
+static void seq_render_strip_stack_render_task(void *__restrict userdata,
+                                               const int iter,
+                                               const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  StackRenderData *data = userdata;
+  data->ibuf_arr[iter] = seq_render_strip(
+      data->context, data->state, data->seq_arr[iter], data->timeline_frame);
+}
+
+/**
+ * Render inputs of strips in range `[base_index, count)` which will be blended, in parallel.
+ * Strips which can't be rendered concurrently are left NULL in `r_ibuf_arr`.
+ */
+static void seq_render_strip_stack_render_inputs(const SeqRenderData *context,
+                                                 SeqRenderState *state,
+                                                 Sequence **seq_arr,
+                                                 int base_index,
+                                                 bool base_is_cached,
+                                                 int count,
+                                                 float timeline_frame,
+                                                 ImBuf **r_ibuf_arr)
+{
+  Sequence *render_seq_arr[MAXSEQ + 1];
+  int render_index_arr[MAXSEQ + 1];
+  int render_count = 0;
+
+  for (int i = base_index; i < count; i++) {
+    Sequence *seq = seq_arr[i];
+    const int early_out = seq_get_early_out_for_blend_mode(seq);
+    bool is_rendered;
+
+    if (i == base_index) {
+      is_rendered = !base_is_cached && (seq->blend_mode == SEQ_BLEND_REPLACE ||
+                                        early_out != EARLY_USE_INPUT_1);
+    }
+    else {
+      is_rendered = early_out == EARLY_DO_EFFECT;
+    }
+
+    if (is_rendered && seq_render_strip_stack_can_render_parallel(seq)) {
+      render_seq_arr[render_count] = seq;
+      render_index_arr[render_count] = i;
+      render_count++;
+    }
+  }
+
+  if (render_count < 2) {
+    return;
+  }
+
+  ImBuf *render_ibuf_arr[MAXSEQ + 1];
+  StackRenderData data = {
+      .context = context,
+      .state = state,
+      .timeline_frame = timeline_frame,
+      .seq_arr = render_seq_arr,
+      .ibuf_arr = render_ibuf_arr,
+  };
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1;
+  BLI_task_parallel_range(
+      0, render_count, &data, seq_render_strip_stack_render_task, &settings);
+
+  for (int i = 0; i < render_count; i++) {
+    r_ibuf_arr[render_index_arr[i]] = render_ibuf_arr[i];
+  }
+}
+
+/* Use image rendered by #seq_render_strip_stack_render_inputs if there is one. */
+static ImBuf *seq_render_strip_stack_give_input(const SeqRenderData *context,
+                                                SeqRenderState *state,
+                                                Sequence **seq_arr,
+                                                ImBuf **ibuf_arr,
+                                                int index,
+                                                float timeline_frame)
+{
+  if (ibuf_arr[index] != NULL) {
+    ImBuf *ibuf = ibuf_arr[index];
+    ibuf_arr[index] = NULL;
+    return ibuf;
+  }
+  return seq_render_strip(context, state, seq_arr[index], timeline_frame);
+}
+
 static ImBuf *seq_render_strip_stack(const SeqRenderData *context,
                                      SeqRenderState *state,
                                      ListBase *seqbasep,
@@ -1838,8 +1982,10 @@ static ImBuf *seq_render_strip_stack(const SeqRenderData *context,
                                      int chanshown)
 {
   Sequence *seq_arr[MAXSEQ + 1];
+  ImBuf *ibuf_arr[MAXSEQ + 1] = {NULL};
   int count;
   int i;
+  int early_out = EARLY_NO_INPUT;
   ImBuf *out = NULL;
 
   count = seq_get_shown_sequences(seqbasep, timeline_frame, chanshown, (Sequence **)&seq_arr);
@@ -1848,36 +1994,49 @@ static ImBuf *seq_render_strip_stack(const SeqRenderData *context,
     return NULL;
   }
 
+  /* Find the lowest strip which has to be looked at, everything below it is either covered by
+   * it or already cached as composite. */
   for (i = count - 1; i >= 0; i--) {
-    int early_out;
     Sequence *seq = seq_arr[i];
 
     out = seq_cache_get(context, seq, timeline_frame, SEQ_CACHE_STORE_COMPOSITE);
 
-    if (out) {
+    if (out || seq->blend_mode == SEQ_BLEND_REPLACE) {
       break;
     }
-    if (seq->blend_mode == SEQ_BLEND_REPLACE) {
-      out = seq_render_strip(context, state, seq, timeline_frame);
+
+    early_out = seq_get_early_out_for_blend_mode(seq);
+
+    if (ELEM(early_out, EARLY_NO_INPUT, EARLY_USE_INPUT_2) || i == 0) {
       break;
     }
+  }
 
-    early_out = seq_get_early_out_for_blend_mode(seq);
+  /* Decode and preprocess independent inputs concurrently, blending is done in channel order. */
+  seq_render_strip_stack_render_inputs(
+      context, state, seq_arr, i, out != NULL, count, timeline_frame, ibuf_arr);
 
-    switch (early_out) {
-      case EARLY_NO_INPUT:
-      case EARLY_USE_INPUT_2:
-        out = seq_render_strip(context, state, seq, timeline_frame);
-        break;
-      case EARLY_USE_INPUT_1:
-        if (i == 0) {
+  if (out == NULL) {
+    Sequence *seq = seq_arr[i];
+
+    if (seq->blend_mode == SEQ_BLEND_REPLACE) {
+      out = seq_render_strip_stack_give_input(
+          context, state, seq_arr, ibuf_arr, i, timeline_frame);
+    }
+    else {
+      switch (early_out) {
+        case EARLY_NO_INPUT:
+        case EARLY_USE_INPUT_2:
+          out = seq_render_strip_stack_give_input(
+              context, state, seq_arr, ibuf_arr, i, timeline_frame);
+          break;
+        case EARLY_USE_INPUT_1:
           out = IMB_allocImBuf(context->rectx, context->recty, 32, IB_rect);
-        }
-        break;
-      case EARLY_DO_EFFECT:
-        if (i == 0) {
+          break;
+        case EARLY_DO_EFFECT: {
           ImBuf *ibuf1 = IMB_allocImBuf(context->rectx, context->recty, 32, IB_rect);
-          ImBuf *ibuf2 = seq_render_strip(context, state, seq, timeline_frame);
+          ImBuf *ibuf2 = seq_render_strip_stack_give_input(
+              context, state, seq_arr, ibuf_arr, i, timeline_frame);
 
           out = seq_render_strip_stack_apply_effect(context, seq, timeline_frame, ibuf1, ibuf2);
 
@@ -1885,11 +2044,9 @@ static ImBuf *seq_render_strip_stack(const SeqRenderData *context,
 
           IMB_freeImBuf(ibuf1);
           IMB_freeImBuf(ibuf2);
+          break;
         }
-        break;
-    }
-    if (out) {
-      break;
+      }
     }
   }
 
@@ -1899,7 +2056,8 @@ static ImBuf *seq_render_strip_stack(const SeqRenderData *context,
 
     if (seq_get_early_out_for_blend_mode(seq) == EARLY_DO_EFFECT) {
       ImBuf *ibuf1 = out;
-      ImBuf *ibuf2 = seq_render_strip(context, state, seq, timeline_frame);
+      ImBuf *ibuf2 = seq_render_strip_stack_give_input(
+          context, state, seq_arr, ibuf_arr, i, timeline_frame);
 
       out = seq_render_strip_stack_apply_effect(context, seq, timeline_frame, ibuf1, ibuf2);
 
@@ -1952,7 +2110,13 @@ ImBuf *SEQ_render_give_ibuf(const SeqRenderData *context, float timeline_frame,
   seq_cache_free_temp_cache(context->scene, context->task_id, timeline_frame);
 
   if (count && !out) {
-    BLI_mutex_lock(&seq_render_mutex);
+    /* Prefetch threads render their own evaluated copies of the scene, so multiple frames can be
+     * prefetched at once. */
+    const bool use_lock = !context->is_prefetch_render;
+
+    if (use_lock) {
+      BLI_mutex_lock(&seq_render_mutex);
+    }
     out = seq_render_strip_stack(context, &state, seqbasep, timeline_frame, chanshown);
 
     if (context->is_prefetch_render) {
@@ -1962,7 +2126,9 @@ ImBuf *SEQ_render_give_ibuf(const SeqRenderData *context, float timeline_frame,
       seq_cache_put_if_possible(
           context, seq_arr[count - 1], timeline_frame, SEQ_CACHE_STORE_FINAL_OUT, out);
     }
-    BLI_mutex_unlock(&seq_render_mutex);
+    if (use_lock) {
+      BLI_mutex_unlock(&seq_render_mutex);
+    }
   }
 
   seq_prefetch_start(context, timeline_frame);
@@ -0,0 +1,424 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2021 Blender Foundation.
+ * All rights reserved.
+ */
+
+/** \file
+ * \ingroup sequencer
+ *
+ * Frame pipeline for final sequencer renders.
+ *
+ * Several frames of the timeline are rendered ahead of the render thread by worker threads.
+ * Each worker owns an isolated evaluated copy of the scene (the same way prefetching does), so
+ * strips, movie handles and effect data are never shared between frames in flight. Results are
+ * stored in a bounded ring of frame slots and handed to the render thread in timeline order.
+ */
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "MEM_guardedalloc.h"
+
+#include "DNA_anim_types.h"
+#include "DNA_scene_types.h"
+#include "DNA_sequence_types.h"
+
+#include "BLI_listbase.h"
+#include "BLI_math_base.h"
+#include "BLI_threads.h"
+#include "BLI_utildefines.h"
+
+#include "IMB_imbuf.h"
+#include "IMB_imbuf_types.h"
+
+#include "BKE_anim_data.h"
+#include "BKE_animsys.h"
+#include "BKE_layer.h"
+#include "BKE_main.h"
+#include "BKE_scene.h"
+
+#include "DEG_depsgraph.h"
+#include "DEG_depsgraph_build.h"
+#include "DEG_depsgraph_debug.h"
+#include "DEG_depsgraph_query.h"
+
+#include "SEQ_relations.h"
+#include "SEQ_render.h"
+#include "SEQ_sequencer.h"
+#include "SEQ_time.h"
+
+#include "render.h"
+
+/* Upper limit of frames in flight, each frame slot holds full resolution images of all views. */
+#define SEQ_RENDER_PIPELINE_MAX_WORKERS 8
+
+typedef enum eSeqPipelineFrameState {
+  SEQ_PIPELINE_FRAME_PENDING = 0,
+  SEQ_PIPELINE_FRAME_RENDERING,
+  SEQ_PIPELINE_FRAME_DONE,
+  /* Frame can not be rendered in isolation, render thread has to render it. */
+  SEQ_PIPELINE_FRAME_MAIN_THREAD,
+} eSeqPipelineFrameState;
+
+typedef struct SeqPipelineFrame {
+  eSeqPipelineFrameState state;
+  /* One image per view. */
+  ImBuf **ibuf_arr;
+} SeqPipelineFrame;
+
+typedef struct SeqPipelineWorker {
+  struct SeqRenderPipeline *pipeline;
+
+  Main *bmain_eval;
+  Depsgraph *depsgraph;
+  Scene *scene_eval;
+  SeqRenderData context;
+} SeqPipelineWorker;
+
+typedef struct SeqRenderPipeline {
+  Scene *scene;
+
+  int start_frame;
+  int frame_step;
+  int tot_frames;
+  int tot_views;
+
+  /* Ring of frame slots, frame index `i` is stored in `frames[i % tot_slots]`. */
+  SeqPipelineFrame *frames;
+  int tot_slots;
+  /* Next frame index to be picked up by a worker. */
+  int next_frame;
+  /* All frames before this index were handed over to the render thread. */
+  int consumed_frame;
+
+  SeqPipelineWorker *workers;
+  int tot_workers;
+  ListBase threads;
+
+  ThreadMutex mutex;
+  ThreadCondition cond;
+  /* Depsgraph evaluation is not done concurrently, rendering is. */
+  ThreadMutex eval_mutex;
+
+  bool stop;
+} SeqRenderPipeline;
+
+/* -------------------------------------------------------------------- */
+/** \name Workers
+ * \{ */
+
+/* 3D scene strips need the render pipeline or an OpenGL context, neither of which can be used
+ * from worker threads. Scene strips using sequencer strips are rendered from original data. */
+static bool seq_render_pipeline_frame_needs_main_thread(ListBase *seqbase, int timeline_frame)
+{
+  LISTBASE_FOREACH (Sequence *, seq, seqbase) {
+    if (!SEQ_time_strip_intersects_frame(seq, timeline_frame)) {
+      continue;
+    }
+    if (seq->type == SEQ_TYPE_SCENE) {
+      return true;
+    }
+    if (seq->type == SEQ_TYPE_META &&
+        seq_render_pipeline_frame_needs_main_thread(&seq->seqbase, timeline_frame)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static void seq_render_pipeline_worker_init(SeqRenderPipeline *pipeline,
+                                            SeqPipelineWorker *worker,
+                                            const SeqRenderData *context)
+{
+  Scene *scene = pipeline->scene;
+  ViewLayer *view_layer = BKE_view_layer_default_render(scene);
+
+  worker->pipeline = pipeline;
+  worker->bmain_eval = BKE_main_new();
+  worker->depsgraph = DEG_graph_new(worker->bmain_eval, scene, view_layer, DAG_EVAL_RENDER);
+  DEG_debug_name_set(worker->depsgraph, "SEQUENCER RENDER PIPELINE");
+  DEG_graph_build_for_render_pipeline(worker->depsgraph);
+  DEG_evaluate_on_framechange(worker->depsgraph, pipeline->start_frame);
+
+  worker->scene_eval = DEG_get_evaluated_scene(worker->depsgraph);
+  /* Cache of the evaluated copy would only duplicate memory, frames are not revisited. */
+  worker->scene_eval->ed->cache_flag = 0;
+
+  SEQ_render_new_render_data(worker->bmain_eval,
+                             worker->depsgraph,
+                             worker->scene_eval,
+                             context->rectx,
+                             context->recty,
+                             context->preview_render_size,
+                             context->for_render,
+                             &worker->context);
+  worker->context.skip_cache = true;
+}
+
+static void seq_render_pipeline_worker_free(SeqPipelineWorker *worker)
+{
+  if (worker->depsgraph != NULL) {
+    DEG_graph_free(worker->depsgraph);
+  }
+  if (worker->bmain_eval != NULL) {
+    BKE_main_free(worker->bmain_eval);
+  }
+}
+
+static void seq_render_pipeline_worker_update(SeqPipelineWorker *worker, int timeline_frame)
+{
+  SeqRenderPipeline *pipeline = worker->pipeline;
+
+  BLI_mutex_lock(&pipeline->eval_mutex);
+  DEG_evaluate_on_framechange(worker->depsgraph, timeline_frame);
+  AnimData *adt = BKE_animdata_from_id(&worker->scene_eval->id);
+  AnimationEvalContext anim_eval_context = BKE_animsys_eval_context_construct(worker->depsgraph,
+                                                                              timeline_frame);
+  BKE_animsys_evaluate_animdata(
+      &worker->scene_eval->id, adt, &anim_eval_context, ADT_RECALC_ALL, false);
+  BLI_mutex_unlock(&pipeline->eval_mutex);
+}
+
+/* \return false if the frame has to be rendered by render thread. */
+static bool seq_render_pipeline_worker_render(SeqPipelineWorker *worker,
+                                              int timeline_frame,
+                                              ImBuf **r_ibuf_arr)
+{
+  SeqRenderPipeline *pipeline = worker->pipeline;
+
+  seq_render_pipeline_worker_update(worker, timeline_frame);
+
+  Editing *ed = SEQ_editing_get(worker->scene_eval, false);
+  if (ed == NULL || seq_render_pipeline_frame_needs_main_thread(ed->seqbasep, timeline_frame)) {
+    return false;
+  }
+
+  for (int view_id = 0; view_id < pipeline->tot_views; view_id++) {
+    worker->context.view_id = view_id;
+    r_ibuf_arr[view_id] = seq_render_give_ibuf_seqbase(
+        &worker->context, timeline_frame, 0, ed->seqbasep);
+  }
+
+  /* Close movies which are not needed anymore, otherwise all movies used by the edit stay open
+   * in every worker. */
+  SEQ_relations_free_all_anim_ibufs(worker->scene_eval, timeline_frame);
+
+  return true;
+}
+
+static void seq_render_pipeline_frame_free_ibufs(SeqRenderPipeline *pipeline,
+                                                 SeqPipelineFrame *frame)
+{
+  for (int view_id = 0; view_id < pipeline->tot_views; view_id++) {
+    if (frame->ibuf_arr[view_id] != NULL) {
+      IMB_freeImBuf(frame->ibuf_arr[view_id]);
+      frame->ibuf_arr[view_id] = NULL;
+    }
+  }
+}
+
+static void *seq_render_pipeline_worker_run(void *worker_v)
+{
+  SeqPipelineWorker *worker = (SeqPipelineWorker *)worker_v;
+  SeqRenderPipeline *pipeline = worker->pipeline;
+
+  BLI_mutex_lock(&pipeline->mutex);
+  while (!pipeline->stop && pipeline->next_frame < pipeline->tot_frames) {
+    const int frame_index = pipeline->next_frame;
+
+    /* Don't get further ahead of the render thread than there are slots. */
+    if (frame_index >= pipeline->consumed_frame + pipeline->tot_slots) {
+      BLI_condition_wait(&pipeline->cond, &pipeline->mutex);
+      continue;
+    }
+
+    SeqPipelineFrame *frame = &pipeline->frames[frame_index % pipeline->tot_slots];
+    frame->state = SEQ_PIPELINE_FRAME_RENDERING;
+    pipeline->next_frame++;
+    BLI_mutex_unlock(&pipeline->mutex);
+
+    const int timeline_frame = pipeline->start_frame + frame_index * pipeline->frame_step;
+    const bool rendered = seq_render_pipeline_worker_render(
+        worker, timeline_frame, frame->ibuf_arr);
+
+    BLI_mutex_lock(&pipeline->mutex);
+    frame->state = rendered ? SEQ_PIPELINE_FRAME_DONE : SEQ_PIPELINE_FRAME_MAIN_THREAD;
+    BLI_condition_notify_all(&pipeline->cond);
+  }
+  BLI_mutex_unlock(&pipeline->mutex);
+
+  return NULL;
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Public API
+ * \{ */
+
+/**
+ * Start rendering frames `start_frame` to `end_frame` ahead of the caller.
+ *
+ * \return NULL when there is nothing to gain from the pipeline, callers should then render with
+ * #SEQ_render_give_ibuf as usual.
+ */
+SeqRenderPipeline *SEQ_render_pipeline_start(const SeqRenderData *context,
+                                             int start_frame,
+                                             int end_frame,
+                                             int frame_step,
+                                             int num_threads)
+{
+  Scene *scene = context->scene;
+  Editing *ed = SEQ_editing_get(scene, false);
+
+  if (ed == NULL || BLI_listbase_is_empty(&ed->seqbase) || end_frame <= start_frame) {
+    return NULL;
+  }
+
+  /* Render thread itself is busy with writing output, so one worker is already a gain. */
+  const int tot_workers = min_ii(num_threads, SEQ_RENDER_PIPELINE_MAX_WORKERS);
+  if (tot_workers < 1) {
+    return NULL;
+  }
+
+  SeqRenderPipeline *pipeline = MEM_callocN(sizeof(SeqRenderPipeline), "SeqRenderPipeline");
+  pipeline->scene = scene;
+  pipeline->start_frame = start_frame;
+  pipeline->frame_step = max_ii(frame_step, 1);
+  pipeline->tot_frames = (end_frame - start_frame) / pipeline->frame_step + 1;
+  pipeline->tot_views = BKE_scene_multiview_num_views_get(&scene->r);
+
+  /* One frame being written by render thread, one being rendered per worker. */
+  pipeline->tot_slots = tot_workers + 1;
+  pipeline->frames = MEM_callocN(sizeof(SeqPipelineFrame) * pipeline->tot_slots,
+                                 "SeqRenderPipeline frames");
+  for (int i = 0; i < pipeline->tot_slots; i++) {
+    pipeline->frames[i].ibuf_arr = MEM_callocN(sizeof(ImBuf *) * pipeline->tot_views,
+                                               "SeqRenderPipeline views");
+  }
+
+  BLI_mutex_init(&pipeline->mutex);
+  BLI_mutex_init(&pipeline->eval_mutex);
+  BLI_condition_init(&pipeline->cond);
+
+  /* Depsgraphs are built here, building is not thread safe. */
+  pipeline->tot_workers = tot_workers;
+  pipeline->workers = MEM_callocN(sizeof(SeqPipelineWorker) * tot_workers,
+                                  "SeqRenderPipeline workers");
+  for (int i = 0; i < tot_workers; i++) {
+    seq_render_pipeline_worker_init(pipeline, &pipeline->workers[i], context);
+  }
+
+  BLI_threadpool_init(&pipeline->threads, seq_render_pipeline_worker_run, tot_workers);
+  for (int i = 0; i < tot_workers; i++) {
+    BLI_threadpool_insert(&pipeline->threads, &pipeline->workers[i]);
+  }
+
+  return pipeline;
+}
+
+/**
+ * Take images of all views of `timeline_frame` from the pipeline, frames before it which were
+ * not requested are discarded. Frames must be requested in increasing order.
+ *
+ * \return false when the frame is not provided by the pipeline and has to be rendered by the
+ * caller. Otherwise `r_ibuf_arr` is filled with one image (or NULL) per view, owned by caller.
+ */
+bool SEQ_render_pipeline_give_ibufs(SeqRenderPipeline *pipeline,
+                                    int timeline_frame,
+                                    ImBuf **r_ibuf_arr)
+{
+  const int frame_offset = timeline_frame - pipeline->start_frame;
+  if (frame_offset < 0 || frame_offset % pipeline->frame_step != 0) {
+    return false;
+  }
+
+  const int frame_index = frame_offset / pipeline->frame_step;
+  bool rendered = false;
+
+  BLI_mutex_lock(&pipeline->mutex);
+
+  if (frame_index < pipeline->consumed_frame || frame_index >= pipeline->tot_frames) {
+    BLI_mutex_unlock(&pipeline->mutex);
+    return false;
+  }
+
+  /* Claim or wait for the requested frame, discard skipped ones (existing files not overwritten
+   * for example). */
+  while (pipeline->consumed_frame <= frame_index) {
+    const int index = pipeline->consumed_frame;
+    SeqPipelineFrame *frame = &pipeline->frames[index % pipeline->tot_slots];
+
+    if (index >= pipeline->next_frame) {
+      /* Not picked up by any worker yet, nothing to wait for. */
+      pipeline->next_frame = index + 1;
+      frame->state = SEQ_PIPELINE_FRAME_MAIN_THREAD;
+    }
+
+    while (ELEM(frame->state, SEQ_PIPELINE_FRAME_PENDING, SEQ_PIPELINE_FRAME_RENDERING)) {
+      BLI_condition_wait(&pipeline->cond, &pipeline->mutex);
+    }
+
+    if (index == frame_index && frame->state == SEQ_PIPELINE_FRAME_DONE) {
+      memcpy(r_ibuf_arr, frame->ibuf_arr, sizeof(ImBuf *) * pipeline->tot_views);
+      memset(frame->ibuf_arr, 0, sizeof(ImBuf *) * pipeline->tot_views);
+      rendered = true;
+    }
+    else {
+      seq_render_pipeline_frame_free_ibufs(pipeline, frame);
+    }
+
+    frame->state = SEQ_PIPELINE_FRAME_PENDING;
+    pipeline->consumed_frame++;
+  }
+
+  /* Slots were freed, let workers continue. */
+  BLI_condition_notify_all(&pipeline->cond);
+  BLI_mutex_unlock(&pipeline->mutex);
+
+  return rendered;
+}
+
+void SEQ_render_pipeline_end(SeqRenderPipeline *pipeline)
+{
+  BLI_mutex_lock(&pipeline->mutex);
+  pipeline->stop = true;
+  BLI_condition_notify_all(&pipeline->cond);
+  BLI_mutex_unlock(&pipeline->mutex);
+
+  /* Waits for frames being rendered to finish. */
+  BLI_threadpool_end(&pipeline->threads);
+
+  for (int i = 0; i < pipeline->tot_workers; i++) {
+    seq_render_pipeline_worker_free(&pipeline->workers[i]);
+  }
+  for (int i = 0; i < pipeline->tot_slots; i++) {
+    seq_render_pipeline_frame_free_ibufs(pipeline, &pipeline->frames[i]);
+    MEM_freeN(pipeline->frames[i].ibuf_arr);
+  }
+
+  BLI_condition_end(&pipeline->cond);
+  BLI_mutex_end(&pipeline->eval_mutex);
+  BLI_mutex_end(&pipeline->mutex);
+
+  MEM_freeN(pipeline->workers);
+  MEM_freeN(pipeline->frames);
+  MEM_freeN(pipeline);
+}
+
+/** \} */